@@ -0,0 +1,180 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+#include <donut/engine/BenchmarkResults.h>
+#include <nvrhi/nvrhi.h>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace donut::vfs
+{
+    class IFileSystem;
+}
+
+namespace donut::engine
+{
+    class SceneCamera;
+
+    namespace animation
+    {
+        class Sampler;
+        class Sequence;
+    }
+}
+
+namespace donut::app
+{
+    class BaseCamera;
+    class FirstPersonCamera;
+
+    struct CameraPathSample
+    {
+        dm::float3 position = 0.f;
+        dm::float3 direction = dm::float3(0.f, 0.f, 1.f);
+        dm::float3 up = dm::float3(0.f, 1.f, 0.f);
+    };
+
+    /*
+    CameraPath is a camera trajectory stored as an animation::Sequence with the "position", "direction"
+    and "up" tracks, interpolated with Catmull-Rom splines. Paths can be written by hand in the JSON
+    format of Sequence::Save, or recorded from an interactively controlled camera.
+    */
+    class CameraPath
+    {
+    private:
+        std::shared_ptr<engine::animation::Sequence> m_Sequence;
+        std::shared_ptr<engine::animation::Sampler> m_Position;
+        std::shared_ptr<engine::animation::Sampler> m_Direction;
+        std::shared_ptr<engine::animation::Sampler> m_Up;
+
+        bool m_Recording = false;
+        float m_RecordingTime = 0.f;
+        float m_LastKeyframeTime = 0.f;
+        float m_KeyframeInterval = 0.f;
+        CameraPathSample m_LastRecordedSample;
+
+        void CreateTracks();
+
+    public:
+        CameraPath();
+
+        void AddKeyframe(float time, const CameraPathSample& sample);
+        [[nodiscard]] std::optional<CameraPathSample> Evaluate(float time) const;
+        [[nodiscard]] float GetDuration() const;
+        [[nodiscard]] const std::shared_ptr<engine::animation::Sequence>& GetSequence() const { return m_Sequence; }
+
+        // Recording replaces the path with keyframes taken from the camera every keyframeInterval seconds.
+        void BeginRecording(float keyframeInterval = 0.25f);
+        void RecordCamera(float elapsedTime, const BaseCamera& camera);
+        void EndRecording();
+        [[nodiscard]] bool IsRecording() const { return m_Recording; }
+
+        bool Load(vfs::IFileSystem& fs, const std::filesystem::path& fileName);
+        bool Save(const std::filesystem::path& fileName) const;
+
+        static CameraPathSample GetCameraSample(const BaseCamera& camera);
+        static void ApplyToCamera(const CameraPathSample& sample, FirstPersonCamera& camera);
+        // Sets the local transform of the camera's node so that the camera has the sample's world pose.
+        static void ApplyToSceneCamera(const CameraPathSample& sample, engine::SceneCamera& camera);
+    };
+
+    struct CameraPathBenchmarkParameters
+    {
+        // Path time advanced every frame, in seconds, independent of the real frame time
+        double timeStep = 1.0 / 60.0;
+        // Frames rendered at the start of the path before the measurement starts
+        uint32_t warmupFrames = 30;
+        uint32_t maxFramesInFlight = 4;
+    };
+
+    /*
+    CameraPathBenchmark replays a camera path with a fixed time step so that runs are comparable,
+    and records the CPU and GPU time of every frame.
+
+    Per frame, while IsRunning():
+        if (auto sample = benchmark.Advance())
+            CameraPath::ApplyToCamera(*sample, camera);   // instead of camera.Animate()
+        benchmark.BeginFrame(commandList);
+        ... render ...
+        benchmark.EndFrame(commandList);
+        benchmark.Poll();
+
+    The CPU time is measured between BeginFrame and EndFrame, the GPU time with a timer query around
+    the same commands. When the run ends, GetResults() holds the frames and Analyze() the report.
+    */
+    class CameraPathBenchmark
+    {
+    private:
+        struct GpuQuery
+        {
+            nvrhi::TimerQueryHandle query;
+            size_t frameIndex = 0;
+            bool pending = false;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        std::shared_ptr<CameraPath> m_Path;
+        CameraPathBenchmarkParameters m_Params;
+        engine::BenchmarkResults m_Results;
+
+        std::vector<GpuQuery> m_Queries;
+        uint32_t m_NextQuery = 0;
+        GpuQuery* m_CurrentQuery = nullptr;
+
+        std::chrono::high_resolution_clock::time_point m_FrameStart;
+        uint32_t m_FrameCounter = 0;
+        double m_Time = 0.0;
+        bool m_Running = false;
+        bool m_InFrame = false;
+
+        void ResolveQueries(bool wait);
+
+    public:
+        CameraPathBenchmark(nvrhi::IDevice* device, std::shared_ptr<CameraPath> path, const CameraPathBenchmarkParameters& params = CameraPathBenchmarkParameters());
+
+        void Start();
+        [[nodiscard]] bool IsRunning() const { return m_Running; }
+        [[nodiscard]] bool IsWarmingUp() const { return m_Running && m_FrameCounter < m_Params.warmupFrames; }
+
+        // Advances the path by one time step and returns the camera pose for this frame.
+        // Returns nothing and ends the run once the end of the path is reached.
+        std::optional<CameraPathSample> Advance();
+
+        void BeginFrame(nvrhi::ICommandList* commandList);
+        void EndFrame(nvrhi::ICommandList* commandList);
+
+        // Collects the GPU times that are available, without waiting.
+        void Poll();
+
+        // Waits for the outstanding GPU times. Called automatically when the run ends.
+        void Finish();
+
+        [[nodiscard]] const engine::BenchmarkResults& GetResults() const { return m_Results; }
+        [[nodiscard]] engine::BenchmarkResults& GetResults() { return m_Results; }
+    };
+}
@@ -82,6 +82,7 @@ freely, subject to the following restrictions:
 #include <nvrhi/nvrhi.h>
 #include <donut/core/log.h>
 
+#include <filesystem>
 #include <list>
 #include <functional>
 #include <optional>
@@ -162,6 +163,11 @@ namespace donut::app
         bool enableComputeQueue = false;
         bool enableCopyQueue = false;
 
+        // With CreateHeadlessDevice, creates swapChainBufferCount offscreen render targets of
+        // backBufferWidth x backBufferHeight in swapChainFormat that act as the back buffers.
+        // Required for RunHeadless().
+        bool headlessBackBuffers = false;
+
         // Index of the adapter (DX11, DX12) or physical device (Vk) on which to initialize the device.
         // Negative values mean automatic detection.
         // The order of indices matches that returned by DeviceManager::EnumerateAdapters.
@@ -206,6 +212,28 @@ namespace donut::app
 
     class IRenderPass;
 
+    struct HeadlessRunParameters
+    {
+        uint32_t numFrames = 300;
+        // Frames rendered before the measurement starts, not included in the results
+        uint32_t warmupFrames = 10;
+        // Time step in seconds passed to Animate(), independent of the real frame time
+        double timeStep = 1.0 / 60.0;
+        // If not empty, the per-frame timings and their percentiles (see engine::BenchmarkResults) are written into this JSON file
+        std::filesystem::path resultsFileName;
+    };
+
+    struct HeadlessFrameTiming
+    {
+        uint32_t frameIndex = 0;
+        // CPU time spent in the frame, excluding the wait for frames in flight
+        double cpuTimeMs = 0.0;
+        // Time between the starts of this frame and the next one
+        double frameTimeMs = 0.0;
+        // GPU time of the frame's command lists, negative if it couldn't be measured
+        double gpuTimeMs = -1.0;
+    };
+
     struct AdapterInfo
     {
         typedef std::array<uint8_t, 16> UUID;
@@ -251,6 +279,12 @@ namespace donut::app
 
         void RunMessageLoop();
 
+        // Runs a fixed number of frames without a window on a device created with CreateHeadlessDevice
+        // and headlessBackBuffers, rendering into the offscreen back buffers. The render passes and
+        // callbacks are invoked as in RunMessageLoop, except for window and input events.
+        bool RunHeadless(const HeadlessRunParameters& params);
+        [[nodiscard]] const std::vector<HeadlessFrameTiming>& GetHeadlessFrameTimings() const { return m_HeadlessFrameTimings; }
+
         // returns the size of the window in screen coordinates
         void GetWindowDimensions(int& width, int& height);
         // returns the screen coordinate to pixel coordinate scale factor
@@ -292,8 +326,16 @@ namespace donut::app
 
         std::vector<nvrhi::FramebufferHandle> m_SwapChainFramebuffers;
 
+        // Back buffers of a headless device, returned by the GetBackBuffer functions of all backends
+        std::vector<nvrhi::TextureHandle> m_OffscreenBackBuffers;
+        uint32_t m_OffscreenBackBufferIndex = 0;
+        std::vector<HeadlessFrameTiming> m_HeadlessFrameTimings;
+
         DeviceManager();
 
+        bool CreateOffscreenBackBuffers();
+        bool WriteHeadlessResults(const HeadlessRunParameters& params) const;
+
         void UpdateWindowSize();
         bool ShouldRenderUnfocused() const;
 
@@ -90,11 +90,17 @@ protected:
 
     nvrhi::ITexture* GetCurrentBackBuffer() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return m_OffscreenBackBuffers[m_OffscreenBackBufferIndex];
+
         return m_RhiBackBuffer;
     }
 
     nvrhi::ITexture* GetBackBuffer(uint32_t index) override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return index < m_OffscreenBackBuffers.size() ? m_OffscreenBackBuffers[index].Get() : nullptr;
+
         if (index == 0)
             return m_RhiBackBuffer;
 
@@ -103,11 +109,17 @@ protected:
 
     uint32_t GetCurrentBackBufferIndex() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return m_OffscreenBackBufferIndex;
+
         return 0;
     }
 
     uint32_t GetBackBufferCount() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return uint32_t(m_OffscreenBackBuffers.size());
+
         return 1;
     }
 
@@ -99,20 +99,28 @@ protected:
 
     nvrhi::ITexture* GetCurrentBackBuffer() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return m_OffscreenBackBuffers[m_OffscreenBackBufferIndex];
         return m_SwapChainImages[m_SwapChainIndex].rhiHandle;
     }
     nvrhi::ITexture* GetBackBuffer(uint32_t index) override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return index < m_OffscreenBackBuffers.size() ? m_OffscreenBackBuffers[index].Get() : nullptr;
         if (index < m_SwapChainImages.size())
             return m_SwapChainImages[index].rhiHandle;
         return nullptr;
     }
     uint32_t GetCurrentBackBufferIndex() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return m_OffscreenBackBufferIndex;
         return m_SwapChainIndex;
     }
     uint32_t GetBackBufferCount() override
     {
+        if (!m_OffscreenBackBuffers.empty())
+            return uint32_t(m_OffscreenBackBuffers.size());
         return uint32_t(m_SwapChainImages.size());
     }
 
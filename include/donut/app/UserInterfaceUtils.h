@@ -32,6 +32,8 @@ namespace donut::engine
     class DirectionalLight;
     class PointLight;
     class SpotLight;
+    class Profiler;
+    class MemoryReport;
 }
 
 namespace donut::app
@@ -47,4 +49,10 @@ namespace donut::app
     bool LightEditor(engine::Light& light);
 
     bool AzimuthElevationSliders(math::double3& direction, bool negative = false);
+
+    // Draws the aggregated CPU and GPU scope timings of the profiler, plus controls to reset them and capture a trace.
+    void ProfilerStats(engine::Profiler& profiler);
+
+    // Draws the memory usage by category, with controls to save snapshots and show the changes since one of them.
+    void MemoryStats(engine::MemoryReport& report);
 }
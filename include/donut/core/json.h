@@ -41,6 +41,7 @@ namespace donut::vfs
 namespace donut::json
 {
     bool LoadFromFile(vfs::IFileSystem& fs, const std::filesystem::path& jsonFileName, Json::Value& documentRoot);
+    bool SaveToFile(vfs::IFileSystem& fs, const std::filesystem::path& jsonFileName, const Json::Value& documentRoot);
 
     template<typename T> T Read(const Json::Value& node, const T& defaultValue);
     template<typename T> void Write(Json::Value& node, const T& value);
@@ -67,7 +67,7 @@ namespace donut::math
 
 		[[nodiscard]] vector<T, 4> toXYZW() const
 		{
-			return vector(x, y, z, w);
+			return vector<T, 4>(x, y, z, w);
 		}
 
 		[[nodiscard]] vector<T, 4> toWXYZ() const
@@ -392,7 +392,7 @@ namespace donut::math
 		T sinHalfTheta = std::sin(T(0.5) * radians);
 		T cosHalfTheta = std::cos(T(0.5) * radians);
 
-		return quaternion<T>(cosHalfTheta, axis * sinHalfTheta);
+		return quaternion<T>::fromWXYZ(cosHalfTheta, axis * sinHalfTheta);
 	}
 
 	template<typename T>
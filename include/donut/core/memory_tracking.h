@@ -0,0 +1,161 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Memory accounting by subsystem. Memory is attributed to a category either by explicit tagging
+// (memory::Tag, memory::Allocate/Free) or by the counting allocator used by some containers (memory::vector).
+// The counters are global atomics, so tagging is cheap enough to stay enabled in release builds.
+
+namespace donut::memory
+{
+    enum class Category : uint32_t
+    {
+        // CPU memory
+        MeshData,           // BufferGroup vertex and index arrays, released after the GPU upload
+        TextureData,        // texture pixels loaded or decoded on the CPU, released after the GPU upload
+        SceneGraph,         // scene graph nodes
+        FileBlobs,          // file contents held in vfs::Blob objects
+        AnimationKeyframes, // keyframes of animation samplers
+
+        // GPU memory allocated through Donut, as the sum of the resource sizes without driver padding
+        GpuMeshBuffers,     // index and vertex buffers, including skinned copies
+        GpuTextures,        // textures loaded through TextureCache
+        GpuRenderTargets,   // render targets owned by Donut passes and the render graph
+        GpuSceneBuffers,    // instance, material, geometry and joint buffers of the scene
+
+        Count
+    };
+
+    constexpr size_t CategoryCount = size_t(Category::Count);
+
+    [[nodiscard]] const char* GetCategoryName(Category category);
+    [[nodiscard]] bool IsGpuCategory(Category category);
+
+    // Records an allocation or release of 'bytes' in the category; Free must match a previous Allocate.
+    void Allocate(Category category, size_t bytes);
+    void Free(Category category, size_t bytes);
+
+    struct CategoryStats
+    {
+        int64_t bytes = 0;
+        int64_t peakBytes = 0;
+        // Number of live allocations, i.e. tags with a non-zero size or counted container buffers
+        int64_t allocations = 0;
+    };
+
+    struct Snapshot
+    {
+        std::array<CategoryStats, CategoryCount> categories;
+
+        [[nodiscard]] const CategoryStats& operator[](Category category) const { return categories[size_t(category)]; }
+        [[nodiscard]] int64_t GetTotalBytes(bool gpu) const;
+    };
+
+    [[nodiscard]] Snapshot GetSnapshot();
+
+    // Resets the peaks to the current values
+    void ResetPeaks();
+
+    // Returns 'after - before' for the sizes and allocation counts. Peaks are taken from 'after'.
+    [[nodiscard]] Snapshot Diff(const Snapshot& before, const Snapshot& after);
+
+    // Formats a snapshot as a table with one line per category and CPU/GPU totals. The layout is stable,
+    // so reports saved at different times can also be compared with a text diff tool.
+    [[nodiscard]] std::string FormatReport(const Snapshot& snapshot);
+    [[nodiscard]] std::string FormatDiff(const Snapshot& before, const Snapshot& after);
+
+    // Formats a byte count with a binary unit, e.g. "12.50 MB"; negative values are formatted with a sign.
+    [[nodiscard]] std::string FormatBytes(int64_t bytes);
+
+    // A tag attributes a size that changes over time to a category, and releases it when destroyed.
+    // Embed it next to the memory it describes: copies of the owner account for their own copy of the data.
+    class Tag
+    {
+    private:
+        Category m_Category;
+        size_t m_Bytes = 0;
+
+    public:
+        explicit Tag(Category category, size_t bytes = 0);
+        Tag(const Tag& other);
+        Tag(Tag&& other) noexcept;
+        Tag& operator=(const Tag& other);
+        Tag& operator=(Tag&& other) noexcept;
+        ~Tag();
+
+        void Set(size_t bytes);
+        // Moves the current size to another category
+        void SetCategory(Category category);
+
+        [[nodiscard]] size_t GetBytes() const { return m_Bytes; }
+        [[nodiscard]] Category GetCategory() const { return m_Category; }
+    };
+
+    // A standard allocator that counts its allocations in a category
+    template<typename T, Category C>
+    class CountingAllocator
+    {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = CountingAllocator<U, C>;
+        };
+
+        CountingAllocator() noexcept = default;
+
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U, C>&) noexcept { }
+
+        T* allocate(size_t n)
+        {
+            T* result = std::allocator<T>().allocate(n);
+            Allocate(C, n * sizeof(T));
+            return result;
+        }
+
+        void deallocate(T* p, size_t n) noexcept
+        {
+            Free(C, n * sizeof(T));
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U, C>&) const noexcept { return true; }
+
+        template<typename U>
+        bool operator!=(const CountingAllocator<U, C>&) const noexcept { return false; }
+    };
+
+    template<typename T, Category C>
+    using vector = std::vector<T, CountingAllocator<T, C>>;
+}
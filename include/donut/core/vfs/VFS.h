@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <donut/core/memory_tracking.h>
 #include <memory>
 #include <string>
 #include <filesystem>
@@ -70,17 +71,21 @@ namespace donut::vfs
     };
 
     // Specific blob implementation that owns the data and frees it when deleted.
+    // The data is accounted as memory::Category::FileBlobs unless the owner moves it to another category.
     class Blob : public IBlob
     {
     private:
         void* m_data;
         size_t m_size;
+        memory::Tag m_MemoryTag;
 
     public:
-        Blob(void* data, size_t size);
+        Blob(void* data, size_t size, memory::Category category = memory::Category::FileBlobs);
         ~Blob() override;
         [[nodiscard]] const void* data() const override;
         [[nodiscard]] size_t size() const override;
+
+        void SetMemoryCategory(memory::Category category) { m_MemoryTag.SetCategory(category); }
     };
 
     // Basic interface for the virtual file system.
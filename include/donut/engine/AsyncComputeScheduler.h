@@ -0,0 +1,145 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <functional>
+#include <vector>
+
+namespace donut::engine
+{
+    // Result of AsyncComputeScheduler::ScheduleCompute, used to wait for the job on the graphics queue.
+    struct AsyncComputeJob
+    {
+        // Command list instance returned by executeCommandLists on the compute queue, 0 if the job ran inline
+        uint64_t computeInstance = 0;
+
+        [[nodiscard]] bool IsAsync() const { return computeInstance != 0; }
+    };
+
+    // A resource that an async compute job shares with the graphics work, and the state in which it crosses the queues.
+    // Resources that keep their initial state cross in that state instead, see AsyncComputeScheduler.
+    struct AsyncComputeTextureHandoff
+    {
+        nvrhi::ITexture* texture = nullptr;
+        nvrhi::ResourceStates state = nvrhi::ResourceStates::ShaderResource;
+    };
+
+    struct AsyncComputeBufferHandoff
+    {
+        nvrhi::IBuffer* buffer = nullptr;
+        nvrhi::ResourceStates state = nvrhi::ResourceStates::ShaderResource;
+    };
+
+    struct AsyncComputeStats
+    {
+        uint32_t numAsyncJobs = 0;
+        uint32_t numInlineJobs = 0;
+        // Jobs that ran inline because a shared resource cannot be handed over to the compute queue
+        uint32_t numRejectedJobs = 0;
+        // Submissions of the graphics command list made to split it around the compute jobs
+        uint32_t numGraphicsSubmissions = 0;
+        uint32_t numCrossQueueWaits = 0;
+    };
+
+    /*
+    AsyncComputeScheduler moves compute-only passes to the compute queue and manages the cross-queue
+    synchronization, so that they can overlap with the raster work recorded on the graphics queue.
+
+    Typical use, for SSAO overlapping with shadow map rendering:
+
+        depthPass(commandList);
+        auto ssao = ssaoPass.ScheduleRender(scheduler, commandList, ssaoParams, view);
+        shadowPasses(commandList);
+        scheduler.WaitForCompute(commandList, ssao);
+        deferredLighting(commandList);
+
+    With async compute active, ScheduleCompute submits the graphics work recorded so far, and records the job
+    into a compute command list that waits for that submission. WaitForCompute submits the graphics work again
+    and makes the rest of the graphics queue wait for the job. The caller's command list is closed, executed and
+    reopened in the process, like ParallelGeometryRenderer does. Without a compute queue, or with async compute
+    disabled, the job is recorded inline into the graphics command list and waits are no-ops.
+
+    Jobs must only use compute work (dispatches, UAV clears, copies). SsaoPass::ScheduleRender,
+    ToneMappingPass::ScheduleExposureUpdate and MipMapGenPass::ScheduleDispatch wrap their passes into jobs.
+    LightProbeProcessingPass renders with draw calls and stays on the graphics queue.
+
+    The resources that a job shares with the graphics work are handed over in the listed states: the graphics
+    command list transitions them before it is submitted, the compute command list begins tracking them in those
+    states and returns them to those states at the end of the job, and the graphics command list begins tracking
+    them again in WaitForCompute. The graphics work recorded in between must not use them. Resources that keep
+    their initial state cross the queues in that state instead, because every command list restores it when it
+    closes, so it must be valid on compute queues, such as UnorderedAccess or ShaderResource. Handoff states that
+    are graphics-only, such as DepthWrite or RenderTarget, make the job run inline with an error. That is the case
+    for the GBufferRenderTargets textures, so async SSAO needs depth and normals that don't keep their initial
+    states, or that keep ShaderResource, e.g. copies of the G-buffer.
+    */
+    class AsyncComputeScheduler
+    {
+    public:
+        typedef std::function<void(nvrhi::ICommandList* commandList)> RecordFunc;
+
+    private:
+        nvrhi::DeviceHandle m_Device;
+        nvrhi::CommandListHandle m_ComputeCommandList;
+        bool m_Enabled;
+        bool m_ComputeQueueSupported;
+        uint64_t m_LastWaitedInstance = 0;
+        AsyncComputeStats m_Stats;
+
+        // Shared resources that don't keep their initial states, which the graphics command list
+        // begins tracking again when it waits for the job that used them
+        struct PendingHandoff
+        {
+            uint64_t computeInstance = 0;
+            std::vector<AsyncComputeTextureHandoff> textures;
+            std::vector<AsyncComputeBufferHandoff> buffers;
+        };
+        std::vector<PendingHandoff> m_PendingHandoffs;
+
+        uint64_t SubmitGraphics(nvrhi::ICommandList* commandList);
+        void RecordInline(nvrhi::ICommandList* commandList, const RecordFunc& record, const char* name);
+
+    public:
+        AsyncComputeScheduler(nvrhi::IDevice* device, bool enableAsyncCompute);
+
+        void SetAsyncComputeEnabled(bool enable) { m_Enabled = enable; }
+        [[nodiscard]] bool IsAsyncComputeEnabled() const { return m_Enabled; }
+        [[nodiscard]] bool IsComputeQueueSupported() const { return m_ComputeQueueSupported; }
+        [[nodiscard]] bool IsAsyncComputeActive() const { return m_Enabled && m_ComputeQueueSupported; }
+
+        // Records a compute job that depends on the graphics work recorded so far into commandList, which must be open.
+        // sharedTextures and sharedBuffers list the resources that the job uses together with the graphics work,
+        // they must stay alive until WaitForCompute.
+        AsyncComputeJob ScheduleCompute(nvrhi::ICommandList* commandList, const RecordFunc& record, const char* name = nullptr,
+            const std::vector<AsyncComputeTextureHandoff>& sharedTextures = {},
+            const std::vector<AsyncComputeBufferHandoff>& sharedBuffers = {});
+
+        // Makes the graphics work recorded into commandList after this call wait for the job,
+        // and begins tracking the resources shared with it and with the earlier jobs.
+        void WaitForCompute(nvrhi::ICommandList* commandList, const AsyncComputeJob& job);
+
+        [[nodiscard]] const AsyncComputeStats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = AsyncComputeStats(); }
+    };
+}
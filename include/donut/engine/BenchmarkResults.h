@@ -0,0 +1,119 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Json
+{
+    class Value;
+}
+
+namespace donut::engine
+{
+    // Nearest-rank percentile of a non-empty sorted array, with p in [0, 1].
+    // Used by both the benchmark reports and the Profiler statistics so that their numbers agree.
+    template<typename T>
+    T GetSortedPercentile(const std::vector<T>& sorted, double p)
+    {
+        const size_t index = size_t(p * double(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    struct BenchmarkFrame
+    {
+        uint32_t frameIndex = 0;
+        // Simulation time at the start of the frame, in seconds
+        double time = 0.0;
+        double cpuTimeMs = 0.0;
+        // Negative if the GPU time is not known (yet)
+        double gpuTimeMs = -1.0;
+    };
+
+    // Statistics of a set of samples, in the unit of the samples: milliseconds for the frame times
+    // in BenchmarkReport, nanoseconds for the microbenchmarks.
+    struct BenchmarkPercentiles
+    {
+        uint32_t numSamples = 0;
+        double avg = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    struct BenchmarkHitch
+    {
+        uint32_t frameIndex = 0;
+        double time = 0.0;
+        double valueMs = 0.0;
+        // Ratio of the frame time to the median
+        double ratio = 0.0;
+    };
+
+    struct BenchmarkReport
+    {
+        // Frame times in milliseconds
+        BenchmarkPercentiles cpu;
+        BenchmarkPercentiles gpu;
+        // Worst frames above the hitch threshold, sorted from the worst
+        std::vector<BenchmarkHitch> cpuHitches;
+        std::vector<BenchmarkHitch> gpuHitches;
+    };
+
+    /*
+    BenchmarkResults collects per-frame CPU and GPU times of a benchmark run and reports their
+    percentiles and the worst hitches, i.e. frames slower than hitchThreshold times the median.
+    GPU times usually arrive a few frames late and are filled in with SetGpuTime().
+    */
+    class BenchmarkResults
+    {
+    private:
+        std::vector<BenchmarkFrame> m_Frames;
+
+    public:
+        double hitchThreshold = 2.0;
+        uint32_t maxHitches = 10;
+
+        void Clear() { m_Frames.clear(); }
+
+        // Returns the index of the frame for SetGpuTime()
+        size_t AddFrame(const BenchmarkFrame& frame);
+        void SetGpuTime(size_t index, double gpuTimeMs);
+
+        [[nodiscard]] const std::vector<BenchmarkFrame>& GetFrames() const { return m_Frames; }
+        [[nodiscard]] BenchmarkReport Analyze() const;
+
+        // Writes the report and all frames as JSON. 'name' identifies the run, e.g. the path or build.
+        bool WriteJson(const std::filesystem::path& fileName, const std::string& name) const;
+
+        static BenchmarkPercentiles ComputePercentiles(std::vector<double> values);
+
+        // Writes the fields of 'percentiles' into 'node' with the same names as WriteJson
+        static void WritePercentiles(Json::Value& node, const BenchmarkPercentiles& percentiles);
+    };
+}
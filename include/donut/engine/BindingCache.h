@@ -23,35 +23,106 @@
 #pragma once
 
 #include <nvrhi/nvrhi.h>
+#include <atomic>
 #include <unordered_map>
 #include <shared_mutex>
 
 namespace donut::engine
 {
+    struct BindingCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+    };
+
     /*
     BindingCache maintains a dictionary that maps binding set descriptors
     into actual binding set objects. The binding sets are created on demand when 
     GetOrCreateBindingSet(...) is called and the requested binding set does not exist.
-    Created binding sets are stored for the lifetime of BindingCache, or until
-    Clear() is called.
+
+    Entries are looked up by hash and then compared with the full descriptor and layout,
+    so hash collisions never return a wrong binding set.
+
+    The cache is bounded in two ways:
+    - SetCapacity(n) evicts the least recently used entries when the cache grows beyond n entries.
+      The capacity defaults to DefaultCapacity, so caches that are never configured do not grow
+      without limit when the resources they reference are recreated;
+    - SetMaxUnusedFrames(n) evicts entries that have not been used in the last n frames when
+      BeginFrame() is called. This is disabled by default and requires BeginFrame() to be called
+      once per frame by the owner of the cache.
+    Evicting an entry releases the references that its binding set holds on the resources,
+    which lets transient or resized textures be destroyed.
     
     All BindingCache methods are thread-safe.
     */
     class BindingCache
     {
     private:
+        struct Entry
+        {
+            nvrhi::BindingSetHandle bindingSet;
+            nvrhi::BindingLayoutHandle layout;
+            std::atomic<uint64_t> lastUsedFrame;
+            std::atomic<uint64_t> lastUsedTick;
+
+            Entry(nvrhi::IBindingSet* _bindingSet, nvrhi::IBindingLayout* _layout, uint64_t frame, uint64_t tick)
+                : bindingSet(_bindingSet)
+                , layout(_layout)
+                , lastUsedFrame(frame)
+                , lastUsedTick(tick)
+            { }
+        };
+
         nvrhi::DeviceHandle m_Device;
-        std::unordered_map<size_t, nvrhi::BindingSetHandle> m_BindingSets;
-        std::shared_mutex m_Mutex;
+        std::unordered_multimap<size_t, Entry> m_BindingSets;
+        mutable std::shared_mutex m_Mutex;
+
+        size_t m_Capacity;
+        uint32_t m_MaxUnusedFrames = 0;
+        std::atomic<uint64_t> m_FrameIndex = 0;
+        std::atomic<uint64_t> m_UseTick = 0;
+
+        std::atomic<uint64_t> m_Hits = 0;
+        std::atomic<uint64_t> m_Misses = 0;
+        std::atomic<uint64_t> m_Evictions = 0;
+
+        static size_t GetHash(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout);
+        
+        // The caller must hold at least a shared lock on m_Mutex.
+        nvrhi::IBindingSet* FindEntry(size_t hash, const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout);
+        
+        // The caller must hold an exclusive lock on m_Mutex.
+        void EvictLeastRecentlyUsed();
 
     public:
-        BindingCache(nvrhi::IDevice* device)
+        static constexpr size_t DefaultCapacity = 1024;
+
+        BindingCache(nvrhi::IDevice* device, size_t capacity = DefaultCapacity)
             : m_Device(device)
+            , m_Capacity(capacity)
         { }
 
         nvrhi::BindingSetHandle GetCachedBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout);
         nvrhi::BindingSetHandle GetOrCreateBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout);
         void Clear();
+
+        // Limits the number of cached binding sets, 0 means unlimited.
+        // When the limit is exceeded, about 1/8 of the entries are evicted in LRU order.
+        // The order is tracked per lookup, so it does not depend on BeginFrame().
+        void SetCapacity(size_t maxEntries);
+        [[nodiscard]] size_t GetCapacity() const { return m_Capacity; }
+
+        // Evicts entries that were not used in this many frames on BeginFrame(), 0 disables the age-out.
+        void SetMaxUnusedFrames(uint32_t frames) { m_MaxUnusedFrames = frames; }
+        [[nodiscard]] uint32_t GetMaxUnusedFrames() const { return m_MaxUnusedFrames; }
+
+        // Advances the frame counter used for LRU tracking and ages out the unused entries.
+        void BeginFrame();
+
+        [[nodiscard]] BindingCacheStats GetStats() const;
+        void ResetStats();
     };
 
 }
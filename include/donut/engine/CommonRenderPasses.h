@@ -25,6 +25,7 @@
 #include <donut/core/math/math.h>
 #include <nvrhi/nvrhi.h>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace donut::engine
@@ -86,6 +87,11 @@ namespace donut::engine
         };
 
         std::unordered_map<PsoCacheKey, nvrhi::GraphicsPipelineHandle, PsoCacheKey::Hash> m_BlitPsoCache;
+        std::mutex m_BlitPsoMutex;
+
+        nvrhi::IShader* GetBlitShader(BlitSampler sampler, bool textureArray) const;
+        nvrhi::IGraphicsPipeline* GetOrCreateBlitPipeline(nvrhi::IFramebuffer* targetFramebuffer, nvrhi::IShader* shader,
+            const nvrhi::BlendState::RenderTarget& blendState);
         
     public:
         nvrhi::ShaderHandle m_FullscreenVS;
@@ -117,6 +123,11 @@ namespace donut::engine
 
         // Simplified form of BlitTexture that blits the entire source texture, mip 0 slice 0, into the entire target framebuffer using a linear sampler.
         void BlitTexture(nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* targetFramebuffer, nvrhi::ITexture* sourceTexture, BindingCache* bindingCache = nullptr);
+
+        // Creates the pipeline that BlitTexture would use with these parameters, to avoid compiling it on first use.
+        // Can be called from any thread.
+        void PrecreateBlitPipeline(nvrhi::IFramebuffer* targetFramebuffer, BlitSampler sampler = BlitSampler::Linear,
+            bool sourceIsTextureArray = false, const nvrhi::BlendState::RenderTarget& blendState = nvrhi::BlendState::RenderTarget());
     };
 
 }
\ No newline at end of file
@@ -25,6 +25,8 @@
 #include <nvrhi/nvrhi.h>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <mutex>
 
 namespace donut::engine
 {
@@ -58,6 +60,18 @@ namespace donut::engine
         DescriptorHandle& operator=(DescriptorHandle&&) = default;
     };
 
+    /*
+    DescriptorTableManager allocates descriptors in a bindless descriptor table.
+
+    Allocation and release are O(1), using a free list of table slots, and all methods are thread-safe.
+    Creating a descriptor for an item that is already in the table returns the existing index and
+    increments its reference count; the slot is freed when all references are released.
+    When the table is full, its capacity is doubled.
+
+    With SetBatchedWrites(true), descriptor writes are recorded and applied to the table
+    only when FlushPendingWrites() is called, typically once per frame before rendering.
+    This avoids one writeDescriptorTable call per descriptor while loading large scenes.
+    */
     class DescriptorTableManager : public std::enable_shared_from_this<DescriptorTableManager>
     {
     protected:
@@ -95,8 +109,17 @@ namespace donut::engine
 
         std::vector<nvrhi::BindingSetItem> m_Descriptors;
         std::unordered_map<nvrhi::BindingSetItem, DescriptorIndex, BindingSetItemHasher, BindingSetItemsEqual> m_DescriptorIndexMap;
-        std::vector<bool> m_AllocatedDescriptors;
-        int m_SearchStart = 0;
+        std::vector<uint32_t> m_ReferenceCounts; // 0 means that the slot is free
+        std::vector<DescriptorIndex> m_FreeList;
+        std::vector<DescriptorIndex> m_PendingWrites;
+        std::vector<bool> m_WritePending;
+        std::atomic<bool> m_BatchedWrites = false;
+        std::mutex m_Mutex;
+
+        // The caller must hold m_Mutex.
+        void Grow();
+        void WriteDescriptor(DescriptorIndex index);
+        void FlushPendingWritesLocked();
         
     public:
         DescriptorTableManager(nvrhi::IDevice* device, nvrhi::IBindingLayout* layout);
@@ -104,9 +127,26 @@ namespace donut::engine
         
         nvrhi::IDescriptorTable* GetDescriptorTable() const { return m_DescriptorTable; }
 
+        // Returns the index of the item in the table and adds a reference to it.
+        // Every call must be matched with a ReleaseDescriptor(...) call for the same index.
         DescriptorIndex CreateDescriptor(nvrhi::BindingSetItem item);
+
+        // Same as CreateDescriptor(...), but the returned handle owns the reference and releases it when destroyed.
+        // Handles created for the same item share the index, which stays valid until all of them are destroyed.
+        // Previously, the first handle to be destroyed freed the slot and left the other handles dangling.
         DescriptorHandle CreateDescriptorHandle(nvrhi::BindingSetItem item);
+
         nvrhi::BindingSetItem GetDescriptor(DescriptorIndex index);
+
+        // Removes one reference from the index, the slot is freed when the last reference is removed.
         void ReleaseDescriptor(DescriptorIndex index);
+
+        // Enables deferring the descriptor writes until FlushPendingWrites() is called.
+        // Disabling the batching flushes the pending writes.
+        void SetBatchedWrites(bool enable);
+        [[nodiscard]] bool IsBatchedWritesEnabled() const { return m_BatchedWrites; }
+
+        // Writes all descriptors that were created or released since the last flush into the table.
+        void FlushPendingWrites();
     };
 }
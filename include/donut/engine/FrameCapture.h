@@ -0,0 +1,181 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace donut::engine
+{
+    class BindingCache;
+    class CommonRenderPasses;
+
+    enum class FrameCaptureBackpressure
+    {
+        // Capture() waits for the oldest capture to be encoded when all staging textures are busy
+        Wait,
+        // Capture() skips the frame when all staging textures are busy
+        DropFrames
+    };
+
+    struct FrameCaptureStats
+    {
+        uint32_t captured = 0;
+        uint32_t written = 0;
+        uint32_t dropped = 0;
+        uint32_t failed = 0;
+        // Number of times Capture() had to wait for the GPU or the encoders
+        uint32_t stalls = 0;
+    };
+
+    /*
+    FrameCapture saves textures to image files without stalling the render loop. Capture() records
+    a copy into one of a pool of staging textures; Poll() checks the fences of earlier captures and
+    hands the mapped staging textures to encoder threads, which write the files. Staging textures
+    are unmapped and reused once their image is written.
+
+    The format is determined from the file extension: PNG, JPG, BMP and TGA are written with stb from
+    8-bit RGBA data, EXR with tinyexr from 32-bit float RGBA data, and RAW is the texel data of the
+    source format without a header, rows packed tightly. Textures in other formats are converted
+    with a blit first.
+
+    Poll() must be called after the command list passed to Capture() has been executed, typically
+    once per frame. When the encoders fall behind, all staging textures become busy and Capture()
+    applies the backpressure policy.
+    */
+    class FrameCapture
+    {
+    public:
+        struct CreateParameters
+        {
+            // Size of the staging texture pool, 0 means numEncoderThreads + 3
+            uint32_t numStagingTextures = 0;
+            // 0 means half of the hardware threads, at least 1
+            uint32_t numEncoderThreads = 0;
+            FrameCaptureBackpressure backpressure = FrameCaptureBackpressure::Wait;
+            bool saveAlphaChannel = false;
+            int jpegQuality = 95;
+            bool exrHalfFloat = true;
+            // Called from an encoder thread after each capture is encoded, with the file name and whether
+            // writing it succeeded. Captures are encoded in the order of the Capture() calls, so with one
+            // encoder thread the calls arrive in that order.
+            std::function<void(const std::string& fileName, bool success)> onFileWritten;
+        };
+
+    private:
+        enum class FileFormat
+        {
+            BMP,
+            PNG,
+            JPG,
+            TGA,
+            EXR,
+            RAW
+        };
+
+        enum class SlotState
+        {
+            Free,
+            Recorded,
+            InFlight,
+            Encoding,
+            Encoded
+        };
+
+        struct StagingSlot
+        {
+            nvrhi::StagingTextureHandle stagingTexture;
+            nvrhi::TextureHandle conversionTexture;
+            nvrhi::FramebufferHandle conversionFramebuffer;
+            nvrhi::EventQueryHandle query;
+            SlotState state = SlotState::Free;
+
+            std::string fileName;
+            FileFormat fileFormat = FileFormat::PNG;
+            const uint8_t* mappedData = nullptr;
+            size_t rowPitch = 0;
+            bool success = false;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        std::shared_ptr<CommonRenderPasses> m_CommonPasses;
+        std::unique_ptr<BindingCache> m_BindingCache;
+        CreateParameters m_Params;
+
+        std::vector<StagingSlot> m_Slots;
+        std::deque<uint32_t> m_RecordedSlots;
+        std::deque<uint32_t> m_InFlightSlots;
+        std::vector<std::thread> m_Threads;
+
+        // Guards the slot states and the encoding queue shared with the encoder threads
+        std::mutex m_Mutex;
+        std::condition_variable m_EncodeCondition;
+        std::condition_variable m_EncodedCondition;
+        std::deque<uint32_t> m_EncodeQueue;
+        bool m_Terminate = false;
+
+        FrameCaptureStats m_Stats;
+
+        std::filesystem::path m_SequenceDirectory;
+        std::string m_SequenceExtension;
+        uint32_t m_SequenceFrame = 0;
+        bool m_SequenceActive = false;
+
+        static bool GetFileFormat(const std::string& fileName, FileFormat& outFormat);
+        void WorkerThread();
+        bool EncodeSlot(const StagingSlot& slot);
+        void ProcessSlots(bool waitForOldest);
+        void ReleaseEncodedSlots();
+        bool AcquireSlot(uint32_t& outSlotIndex);
+
+    public:
+        FrameCapture(nvrhi::IDevice* device, std::shared_ptr<CommonRenderPasses> commonPasses, const CreateParameters& params);
+        ~FrameCapture();
+
+        // Records a copy of mip 0, slice 0 of the texture. Returns false if the frame was dropped
+        // or the file format is not supported.
+        bool Capture(nvrhi::ICommandList* commandList, nvrhi::ITexture* texture, const std::string& fileName);
+
+        // Captures are written into the directory as frame_00000.<extension>, frame_00001.<extension>...
+        // The frame number advances on dropped frames too, so drops show up as gaps.
+        void BeginSequence(const std::filesystem::path& directory, const std::string& extension = "png");
+        void EndSequence();
+        [[nodiscard]] bool IsSequenceActive() const { return m_SequenceActive; }
+        bool CaptureSequenceFrame(nvrhi::ICommandList* commandList, nvrhi::ITexture* texture);
+
+        void Poll();
+
+        // Waits until all captures are written.
+        void Flush();
+
+        [[nodiscard]] FrameCaptureStats GetStats();
+    };
+}
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <donut/core/math/math.h>
+#include <donut/core/memory_tracking.h>
 #include <string>
 #include <memory>
 #include <unordered_map>
@@ -61,6 +62,7 @@ namespace donut::engine::animation
     {
     protected:
         std::vector<Keyframe> m_Keyframes;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::AnimationKeyframes);
         InterpolationMode m_Mode = InterpolationMode::Step;
 
     public:
@@ -79,6 +81,7 @@ namespace donut::engine::animation
         [[nodiscard]] float GetEndTime() const;
 
         void Load(Json::Value& node);
+        void Save(Json::Value& node) const;
     };
 
     class Sequence
@@ -100,8 +103,12 @@ namespace donut::engine::animation
 
         void AddTrack(const std::string& name, const std::shared_ptr<Sampler>& track);
 
+        // Updates the duration from the end times of all tracks; call after adding keyframes to a track that is already in the sequence
+        void RecomputeDuration();
+
         [[nodiscard]] float GetDuration() const { return m_Duration; }
 
         void Load(Json::Value& node);
+        void Save(Json::Value& node) const;
     };
 }
@@ -24,6 +24,8 @@
 
 #include <donut/engine/SceneTypes.h>
 #include <nvrhi/nvrhi.h>
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 
@@ -48,21 +50,57 @@ namespace donut::engine
         uint32_t slot; // type depends on resource
     };
 
+    /*
+    MaterialBindingCache creates and stores one binding set per material for the given layout.
+
+    The binding sets are stored in the material itself (Material::bindingSlots), in a slot
+    that is reserved by each cache on creation, so the lookups done for every draw are lock-free.
+    Only creating a binding set takes a lock. When more than MaxSlots caches exist at the same time,
+    the extra ones fall back to a map protected by a mutex.
+
+    The binding sets are not updated automatically when a material's textures change:
+    call Material::bindingSlots.Invalidate() for that material, or Clear() to drop all binding sets.
+    Clear() and the destructor remove the binding sets of this cache from the materials that are
+    still alive, which releases the resources they reference, and must not be called concurrently
+    with rendering that uses this cache.
+    */
     class MaterialBindingCache
     {
+    public:
+        // Number of caches that can use the lock-free storage in the materials at the same time
+        static constexpr uint32_t MaxSlots = 16;
+
     private:
+        friend class MaterialBindingSlots;
+        struct Entry;
+
+        // Binding set in the locked map used when no slot is available
+        struct FallbackEntry
+        {
+            uint32_t materialVersion = 0;
+            nvrhi::BindingSetHandle bindingSet;
+        };
+
         nvrhi::DeviceHandle m_Device;
         nvrhi::BindingLayoutHandle m_BindingLayout;
-        std::unordered_map<const Material*, nvrhi::BindingSetHandle> m_BindingSets;
+        std::unordered_map<const Material*, FallbackEntry> m_BindingSets;
         std::vector<MaterialResourceBinding> m_BindingDesc;
         nvrhi::TextureHandle m_FallbackTexture;
         nvrhi::SamplerHandle m_Sampler;
         std::mutex m_Mutex;
         bool m_TrackLiveness;
 
+        uint32_t m_SlotIndex = ~0u;
+        std::atomic<uint64_t> m_Epoch = 0;
+        std::vector<std::unique_ptr<Entry>> m_RetiredEntries;
+        std::vector<std::weak_ptr<MaterialBindingSlots::Storage>> m_FilledSlots;
+
         nvrhi::BindingSetHandle CreateMaterialBindingSet(const Material* material);
         nvrhi::BindingSetItem GetTextureBindingSetItem(uint32_t slot, const std::shared_ptr<LoadedTexture>& texture) const;
 
+        // The caller must hold m_Mutex.
+        void RemoveEntriesFromMaterials();
+
     public:
         MaterialBindingCache(
             nvrhi::IDevice* device, 
@@ -73,6 +111,11 @@ namespace donut::engine
             nvrhi::ISampler* sampler,
             nvrhi::ITexture* fallbackTexture,
             bool trackLiveness = true);
+        ~MaterialBindingCache();
+
+        // Non-copyable because the cache owns a slot in every material
+        MaterialBindingCache(const MaterialBindingCache&) = delete;
+        MaterialBindingCache& operator=(const MaterialBindingCache&) = delete;
 
         nvrhi::IBindingLayout* GetLayout() const;
         nvrhi::IBindingSet* GetMaterialBindingSet(const Material* material);
@@ -0,0 +1,65 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/memory_tracking.h>
+#include <nvrhi/nvrhi.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace donut::engine
+{
+    // GPU memory sizes used for the memory::Category::Gpu* tags. The texture size is computed from the
+    // description (all mips, slices and samples) and does not include the tiling and alignment padding
+    // added by the driver, so the same resources report the same size on every API.
+    [[nodiscard]] uint64_t GetGpuMemorySize(const nvrhi::TextureDesc& desc);
+    [[nodiscard]] uint64_t GetGpuMemorySize(nvrhi::ITexture* texture);
+    [[nodiscard]] uint64_t GetGpuMemorySize(nvrhi::IBuffer* buffer);
+
+    /*
+    MemoryReport keeps named snapshots of the memory counters (see donut/core/memory_tracking.h) so that
+    the usage before and after an operation, such as loading a scene, can be compared.
+
+    RegisterConsoleCommands adds the 'memory' console command, and app::MemoryStats draws the counters
+    and snapshot differences in ImGui.
+    */
+    class MemoryReport
+    {
+    private:
+        std::map<std::string, memory::Snapshot> m_Snapshots;
+        mutable std::mutex m_Mutex;
+
+    public:
+        // Stores the current counters under the name, replacing a previous snapshot with the same name
+        void SaveSnapshot(const std::string& name);
+        void DeleteSnapshot(const std::string& name);
+        [[nodiscard]] bool GetSnapshot(const std::string& name, memory::Snapshot& outSnapshot) const;
+        [[nodiscard]] std::vector<std::string> GetSnapshotNames() const;
+
+        // Registers 'memory' with the subcommands report, snapshot, diff, list and reset_peaks.
+        // The command refers to this object, which must outlive the console.
+        bool RegisterConsoleCommands();
+    };
+}
@@ -0,0 +1,263 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace donut::engine
+{
+    struct ProfilerScopeStats
+    {
+        std::string name;
+        // Nesting level of the scope, 0 for top-level scopes
+        uint32_t depth = 0;
+        bool gpu = false;
+        // Number of frames in the history where the scope was recorded
+        uint32_t numSamples = 0;
+        // Per-frame times; a scope recorded several times in a frame contributes the sum
+        double minMs = 0.0;
+        double avgMs = 0.0;
+        double maxMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+    };
+
+    /*
+    Profiler records hierarchical CPU scopes and GPU timer-query scopes, aggregates them over a
+    window of frames, and can capture a range of frames into a Chrome trace JSON file
+    (chrome://tracing or https://ui.perfetto.dev).
+
+    The Donut passes and Scene::Refresh are instrumented with the DONUT_PROFILE_* macros, which do
+    nothing unless a profiler is made active with Profiler::SetActive(). The application calls
+    BeginFrame() and EndFrame() around each frame, e.g. from the DeviceManager callbacks.
+
+    CPU scopes are recorded into per-thread buffers that only take an uncontended lock, and the buffers
+    are merged into the frame at EndFrame(). Scopes that are still open at that point are dropped.
+
+    GPU results are read back a few frames later without stalling, unless more than
+    maxFramesInFlight frames are pending, in which case the oldest frame waits for its queries.
+    nvrhi timer queries only provide durations, so in the trace the GPU scopes of a frame are laid
+    out back to back from the start of the frame.
+    */
+    class Profiler
+    {
+    public:
+        struct CreateParameters
+        {
+            // Number of frames over which the statistics are computed
+            uint32_t historyFrames = 64;
+            uint32_t maxFramesInFlight = 4;
+        };
+
+    private:
+        struct Event
+        {
+            std::string name;
+            uint32_t parent = ~0u;
+            uint32_t threadIndex = 0;
+            double beginTime = 0.0;
+            double endTime = 0.0;
+            nvrhi::TimerQueryHandle query;
+            bool ended = false;
+        };
+
+        struct Frame
+        {
+            uint32_t serial = 0;
+            double beginTime = 0.0;
+            double endTime = 0.0;
+            std::vector<Event> cpuEvents;
+            std::vector<Event> gpuEvents;
+        };
+
+        // CPU scopes recorded by one thread in the current frame
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            std::thread::id threadId;
+            uint32_t threadIndex = 0;
+            uint32_t frameSerial = 0;
+            std::vector<Event> events;
+        };
+
+        struct ScopeHistory
+        {
+            std::string name;
+            uint32_t depth = 0;
+            bool gpu = false;
+            uint32_t order = 0;
+            uint32_t lastFrame = 0;
+            std::vector<float> samples;
+            uint32_t nextSample = 0;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        CreateParameters m_Params;
+        bool m_Enabled = true;
+        const uint64_t m_InstanceId;
+
+        std::chrono::steady_clock::time_point m_Epoch;
+        Frame m_CurrentFrame;
+        bool m_InFrame = false;
+        // Serial of the current frame for the CPU scopes, 0 outside of BeginFrame() / EndFrame()
+        std::atomic<uint32_t> m_CpuFrameSerial = 0;
+        uint32_t m_NextFrameSerial = 1;
+        std::deque<Frame> m_PendingFrames;
+
+        std::vector<std::unique_ptr<ThreadBuffer>> m_ThreadBuffers;
+        std::unordered_map<nvrhi::ICommandList*, std::vector<uint32_t>> m_GpuScopeStacks;
+        std::vector<nvrhi::TimerQueryHandle> m_QueryPool;
+
+        std::unordered_map<std::string, ScopeHistory> m_Scopes;
+        uint32_t m_LastResolvedFrame = 0;
+
+        uint32_t m_CaptureFramesRemaining = 0;
+        std::string m_CaptureFileName;
+        std::string m_CaptureEvents;
+        double m_CaptureStartTime = 0.0;
+
+        mutable std::mutex m_Mutex;
+
+        static std::atomic<Profiler*> s_ActiveProfiler;
+        static std::atomic<uint64_t> s_NextInstanceId;
+        static thread_local uint64_t s_ThreadBufferOwner;
+        static thread_local ThreadBuffer* s_ThreadBuffer;
+
+        double GetTime() const;
+        ThreadBuffer& GetThreadBuffer();
+        void MergeThreadBuffers();
+        bool ResolveFrame(Frame& frame, bool wait);
+        Event* FindGpuEvent(uint64_t token);
+        void AddSample(const std::string& key, const std::string& name, uint32_t depth, bool gpu, uint32_t order, uint32_t frameSerial, double timeMs);
+        void AppendCaptureEvents(const Frame& frame, const std::vector<double>& gpuTimesMs);
+        void WriteCapture();
+
+    public:
+        Profiler(nvrhi::IDevice* device, const CreateParameters& params);
+        ~Profiler();
+
+        // Makes the profiler receive the scopes recorded by the DONUT_PROFILE_* macros. Pass nullptr to disable.
+        static void SetActive(Profiler* profiler);
+        static Profiler* GetActive() { return s_ActiveProfiler.load(std::memory_order_acquire); }
+
+        void SetEnabled(bool enabled) { m_Enabled = enabled; }
+        [[nodiscard]] bool IsEnabled() const { return m_Enabled; }
+
+        void BeginFrame();
+        void EndFrame();
+
+        // Scope tokens encode the frame, so scopes that are still open at EndFrame() are dropped safely.
+        uint64_t BeginCpuScope(const char* name);
+        void EndCpuScope(uint64_t token);
+        uint64_t BeginGpuScope(nvrhi::ICommandList* commandList, const char* name);
+        void EndGpuScope(nvrhi::ICommandList* commandList, uint64_t token);
+
+        // Returns the aggregated statistics of the CPU or GPU scopes, in the order they were recorded in the latest frame.
+        [[nodiscard]] std::vector<ProfilerScopeStats> GetStats(bool gpu) const;
+        void ResetStats();
+
+        // Records the next numFrames completed frames and writes them into a Chrome trace JSON file.
+        bool BeginCapture(uint32_t numFrames, const std::string& fileName);
+        [[nodiscard]] bool IsCapturing() const;
+
+        // Registers the 'profiler' console command. The profiler must outlive the console.
+        bool RegisterConsoleCommands();
+    };
+
+    class ProfilerCpuScope
+    {
+    private:
+        Profiler* m_Profiler;
+        uint64_t m_Token = 0;
+
+    public:
+        explicit ProfilerCpuScope(const char* name)
+            : m_Profiler(Profiler::GetActive())
+        {
+            if (m_Profiler)
+                m_Token = m_Profiler->BeginCpuScope(name);
+        }
+
+        ~ProfilerCpuScope()
+        {
+            if (m_Profiler)
+                m_Profiler->EndCpuScope(m_Token);
+        }
+
+        ProfilerCpuScope(const ProfilerCpuScope&) = delete;
+        ProfilerCpuScope& operator=(const ProfilerCpuScope&) = delete;
+    };
+
+    // Measures both the CPU time spent recording the scope and the GPU time of the recorded commands.
+    class ProfilerGpuScope
+    {
+    private:
+        Profiler* m_Profiler;
+        nvrhi::ICommandList* m_CommandList;
+        uint64_t m_CpuToken = 0;
+        uint64_t m_GpuToken = 0;
+
+    public:
+        ProfilerGpuScope(nvrhi::ICommandList* commandList, const char* name)
+            : m_Profiler(Profiler::GetActive())
+            , m_CommandList(commandList)
+        {
+            if (m_Profiler)
+            {
+                m_CpuToken = m_Profiler->BeginCpuScope(name);
+                m_GpuToken = m_Profiler->BeginGpuScope(commandList, name);
+            }
+        }
+
+        ~ProfilerGpuScope()
+        {
+            if (m_Profiler)
+            {
+                m_Profiler->EndGpuScope(m_CommandList, m_GpuToken);
+                m_Profiler->EndCpuScope(m_CpuToken);
+            }
+        }
+
+        ProfilerGpuScope(const ProfilerGpuScope&) = delete;
+        ProfilerGpuScope& operator=(const ProfilerGpuScope&) = delete;
+    };
+}
+
+#define DONUT_PROFILER_CONCAT_IMPL(a, b) a##b
+#define DONUT_PROFILER_CONCAT(a, b) DONUT_PROFILER_CONCAT_IMPL(a, b)
+
+#define DONUT_PROFILE_CPU_SCOPE(name) \
+    ::donut::engine::ProfilerCpuScope DONUT_PROFILER_CONCAT(_profilerScope, __LINE__)(name)
+
+#define DONUT_PROFILE_GPU_SCOPE(commandList, name) \
+    ::donut::engine::ProfilerGpuScope DONUT_PROFILER_CONCAT(_profilerScope, __LINE__)(commandList, name)
@@ -51,6 +51,7 @@ namespace donut::engine
     class TextureCache;
     class DescriptorTableManager;
     class GltfImporter;
+    class UploadAllocator;
     
     class Scene
     {
@@ -61,12 +62,16 @@ namespace donut::engine
         std::shared_ptr<DescriptorTableManager> m_DescriptorTable;
         std::shared_ptr<SceneGraph> m_SceneGraph;
         std::shared_ptr<GltfImporter> m_GltfImporter;
+        std::shared_ptr<UploadAllocator> m_UploadAllocator;
         std::vector<SceneImportResult> m_Models;
         bool m_EnableBindlessResources = false;
+        bool m_CompactInstanceData = false;
         
         nvrhi::BufferHandle m_MaterialBuffer;
         nvrhi::BufferHandle m_GeometryBuffer;
         nvrhi::BufferHandle m_InstanceBuffer;
+        nvrhi::BufferHandle m_PrevTransformDeltaBuffer;
+        memory::Tag m_SceneBufferMemory = memory::Tag(memory::Category::GpuSceneBuffers);
 
         nvrhi::DeviceHandle m_Device;
         nvrhi::ShaderHandle m_SkinningShader;
@@ -97,17 +102,21 @@ namespace donut::engine
         void UpdateMaterial(const std::shared_ptr<Material>& material);
         void UpdateGeometry(const std::shared_ptr<MeshInfo>& mesh);
         void UpdateInstance(const std::shared_ptr<MeshInstance>& instance);
+        void UpdateCompactInstance(const std::shared_ptr<MeshInstance>& instance);
 
         void UpdateSkinnedMeshes(nvrhi::ICommandList* commandList, uint32_t frameIndex);
 
+        void WriteBuffer(nvrhi::ICommandList* commandList, nvrhi::IBuffer* buffer, const void* data, size_t size) const;
         void WriteMaterialBuffer(nvrhi::ICommandList* commandList) const;
         void WriteGeometryBuffer(nvrhi::ICommandList* commandList) const;
         void WriteInstanceBuffer(nvrhi::ICommandList* commandList) const;
+        void UpdateSceneBufferMemory();
 
         virtual void CreateMeshBuffers(nvrhi::ICommandList* commandList);
         virtual nvrhi::BufferHandle CreateMaterialBuffer();
         virtual nvrhi::BufferHandle CreateGeometryBuffer();
         virtual nvrhi::BufferHandle CreateInstanceBuffer();
+        virtual nvrhi::BufferHandle CreatePrevTransformDeltaBuffer();
         virtual nvrhi::BufferHandle CreateMaterialConstantBuffer(const std::string& debugName);
 
         virtual bool LoadCustomData(Json::Value& rootNode, tf::Executor* executor);
@@ -122,6 +131,20 @@ namespace donut::engine
             std::shared_ptr<DescriptorTableManager> descriptorTable,
             std::shared_ptr<SceneTypeFactory> sceneTypeFactory);
         
+        // Stores the instance buffer as CompactInstanceData instead of InstanceData, which makes it about 2x smaller.
+        // The previous transforms are only stored for instances that moved, as deltas in a separate buffer.
+        // The compact layout can only be read by the raster passes created with compactInstanceData = true
+        // and by InstanceCullingPass::Cull, not by shaders that use InstanceData directly, such as ray tracing
+        // or bindless passes. For that reason, compact mode is rejected when the scene has a descriptor table.
+        // Must be called before the scene buffers are created, i.e. before the first RefreshBuffers.
+        void SetCompactInstanceData(bool enable);
+        [[nodiscard]] bool IsCompactInstanceDataEnabled() const { return m_CompactInstanceData; }
+
+        // Routes the per-frame uploads of RefreshBuffers (material constants, instance, geometry and material
+        // buffers, skinning joints) through a frame upload allocator, flushed once at the end of RefreshBuffers.
+        // The application owns the allocator's BeginFrame/EndFrame calls. Mesh buffers are still uploaded directly.
+        void SetUploadAllocator(std::shared_ptr<UploadAllocator> allocator) { m_UploadAllocator = std::move(allocator); }
+
         void FinishedLoading(uint32_t frameIndex);
 
         // Processes animations, transforms, bounding boxes etc.
@@ -137,6 +160,10 @@ namespace donut::engine
 
         virtual bool LoadWithExecutor(const std::filesystem::path& sceneFileName, tf::Executor* executor);
 
+        // Uses a scene graph built in code, e.g. by SceneGenerator, instead of loading one from a file.
+        // Call FinishedLoading afterwards to create the mesh buffers.
+        void SetSceneGraph(std::shared_ptr<SceneGraph> sceneGraph) { m_SceneGraph = std::move(sceneGraph); }
+
         static const SceneLoadingStats& GetLoadingStats();
 
         [[nodiscard]] std::shared_ptr<SceneGraph> GetSceneGraph() const { return m_SceneGraph; }
@@ -144,5 +171,6 @@ namespace donut::engine
         [[nodiscard]] nvrhi::IBuffer* GetMaterialBuffer() const { return m_MaterialBuffer; }
         [[nodiscard]] nvrhi::IBuffer* GetGeometryBuffer() const { return m_GeometryBuffer; }
         [[nodiscard]] nvrhi::IBuffer* GetInstanceBuffer() const { return m_InstanceBuffer; }
+        [[nodiscard]] nvrhi::IBuffer* GetPrevTransformDeltaBuffer() const { return m_PrevTransformDeltaBuffer; }
     };
 }
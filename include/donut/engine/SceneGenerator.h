@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace donut::vfs
+{
+    class IFileSystem;
+}
+
+namespace donut::engine
+{
+    class SceneGraph;
+    class SceneGraphNode;
+    class SceneTypeFactory;
+    struct BufferGroup;
+    struct Material;
+    struct MeshInfo;
+
+    struct SceneGeneratorParameters
+    {
+        uint32_t seed = 1;
+
+        // Total number of nodes including the root. Nodes are added breadth-first with up to 'fanOut'
+        // children each; when the tree reaches 'maxDepth', the remaining nodes go to the deepest level
+        // and exceed the fan-out there.
+        uint32_t nodeCount = 1000;
+        uint32_t maxDepth = 6;
+        uint32_t fanOut = 8;
+
+        // Fraction of the non-root nodes that hold a mesh instance
+        float instanceRatio = 0.8f;
+        // 0 creates a separate mesh for every instance, 1 makes all instances share a single mesh
+        float meshReuseRatio = 0.9f;
+        uint32_t geometriesPerMesh = 1;
+        // Tessellation of the generated meshes, which are spheres with 'meshSegments' slices and half as many stacks
+        uint32_t meshSegments = 8;
+
+        uint32_t materialCount = 16;
+        // Fractions of the materials that are alpha tested and alpha blended, the rest are opaque
+        float alphaTestedMaterialRatio = 0.f;
+        float alphaBlendedMaterialRatio = 0.f;
+
+        // Lights are placed on the nodes without a mesh instance: one directional light, the rest point and spot lights
+        uint32_t lightCount = 4;
+
+        // Fraction of the non-root nodes that rotate, all driven by a single looping SceneGraphAnimation
+        float animatedNodeRatio = 0.05f;
+        float animationDuration = 4.f;
+
+        // Size of the cube around the origin that contains the generated nodes
+        float sceneExtent = 100.f;
+    };
+
+    struct SceneGeneratorStats
+    {
+        uint32_t nodes = 0;
+        uint32_t maxDepth = 0;
+        uint32_t meshInstances = 0;
+        uint32_t meshes = 0;
+        uint32_t materials = 0;
+        uint32_t lights = 0;
+        uint32_t animatedNodes = 0;
+        uint64_t vertices = 0;
+        uint64_t indices = 0;
+    };
+
+    /*
+    SceneGenerator builds synthetic scene graphs of a given size and shape for scalability tests and
+    benchmarks, so that problems can be reproduced without sharing the original content. All objects are
+    created through the SceneTypeFactory, like the glTF importer does, and the same parameters always
+    produce the same scene.
+
+    The generated graph can be used directly, for example with Scene::SetSceneGraph, or written out with
+    WriteGltf and loaded like any other model. Scene releases the CPU copies of the vertex and index data
+    when it creates the GPU buffers, so write the file before that.
+    */
+    class SceneGenerator
+    {
+    private:
+        std::shared_ptr<SceneTypeFactory> m_SceneTypeFactory;
+        SceneGeneratorStats m_Stats;
+
+        std::vector<std::shared_ptr<Material>> CreateMaterials(const SceneGeneratorParameters& params, std::mt19937& rng) const;
+        std::shared_ptr<MeshInfo> CreateMesh(const SceneGeneratorParameters& params, uint32_t meshIndex,
+            const std::vector<std::shared_ptr<Material>>& materials, BufferGroup& buffers, std::mt19937& rng) const;
+
+    public:
+        explicit SceneGenerator(std::shared_ptr<SceneTypeFactory> sceneTypeFactory);
+
+        [[nodiscard]] std::shared_ptr<SceneGraph> Generate(const SceneGeneratorParameters& params);
+
+        // Statistics of the last generated scene
+        [[nodiscard]] const SceneGeneratorStats& GetStats() const { return m_Stats; }
+
+        // Writes the meshes, materials, lights, node hierarchy and node animations of a scene graph as glTF 2.0.
+        // A '.glb' file name produces a single binary file, anything else a JSON file with a '.bin' buffer next to it.
+        // Textures, cameras, skinning and morph targets are not written: this covers what Generate creates.
+        static bool WriteGltf(const SceneGraph& sceneGraph, vfs::IFileSystem& fs, const std::filesystem::path& fileName);
+    };
+}
@@ -267,8 +267,9 @@ namespace donut::engine
         friend class SceneGraph;
         std::weak_ptr<SceneGraph> m_Graph;
         SceneGraphNode* m_Parent = nullptr;
-        std::vector<std::shared_ptr<SceneGraphNode>> m_Children;
+        memory::vector<std::shared_ptr<SceneGraphNode>, memory::Category::SceneGraph> m_Children;
         std::shared_ptr<SceneGraphLeaf> m_Leaf;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::SceneGraph, sizeof(SceneGraphNode));
 
         std::string m_Name;
         dm::daffine3 m_LocalTransform = dm::daffine3::identity();
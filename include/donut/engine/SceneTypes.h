@@ -23,9 +23,11 @@
 #pragma once
 
 #include <donut/core/math/math.h>
+#include <donut/core/memory_tracking.h>
 #include <donut/engine/DescriptorTableManager.h>
 #include <donut/shaders/light_types.h>
 #include <nvrhi/nvrhi.h>
+#include <atomic>
 #include <memory>
 
 struct MaterialConstants;
@@ -107,6 +109,28 @@ namespace donut::engine
 
     const char* MaterialDomainToString(MaterialDomain domain);
 
+    // Per-material storage for the binding sets created by MaterialBindingCache objects,
+    // which makes the binding set lookup an array access without locks. Copies start empty.
+    // The storage layout is private to MaterialBindingCache.
+    class MaterialBindingSlots
+    {
+    public:
+        MaterialBindingSlots();
+        MaterialBindingSlots(const MaterialBindingSlots&) : MaterialBindingSlots() { }
+        MaterialBindingSlots& operator=(const MaterialBindingSlots&) { return *this; }
+        ~MaterialBindingSlots();
+
+        // Makes the binding sets created for this material stale in all caches.
+        // Call this after changing the material's textures or constant buffer object.
+        void Invalidate();
+
+    private:
+        friend class MaterialBindingCache;
+
+        struct Storage;
+        std::shared_ptr<Storage> m_Storage;
+    };
+
     struct Material
     {
         std::string name;
@@ -180,6 +204,9 @@ namespace donut::engine
         int materialID = 0;
         bool dirty = true; // set this to true to make Scene update the material data
 
+        // Binding sets for the raster passes, see MaterialBindingCache
+        mutable MaterialBindingSlots bindingSlots;
+
         virtual ~Material() = default;
         void FillConstantBuffer(struct MaterialConstants& constants) const;
         bool SetProperty(const std::string& name, const dm::float4& value);
@@ -197,6 +224,7 @@ namespace donut::engine
         nvrhi::BufferHandle indexBuffer;
         nvrhi::BufferHandle vertexBuffer;
         nvrhi::BufferHandle instanceBuffer;
+        nvrhi::BufferHandle prevTransformDeltaBuffer; // only with Scene::SetCompactInstanceData(true)
         std::shared_ptr<DescriptorHandle> indexBufferDescriptor;
         std::shared_ptr<DescriptorHandle> vertexBufferDescriptor;
         std::shared_ptr<DescriptorHandle> instnaceBufferDescriptor;
@@ -213,6 +241,14 @@ namespace donut::engine
         std::vector<float> radiusData;
         std::vector<dm::float4> morphTargetData;
 
+        // Capacity of the data arrays above, set with updateCpuMemory by the code that fills or releases them
+        memory::Tag cpuMemory = memory::Tag(memory::Category::MeshData);
+        // Size of indexBuffer and vertexBuffer, set by Scene when it creates them
+        memory::Tag gpuMemory = memory::Tag(memory::Category::GpuMeshBuffers);
+
+        [[nodiscard]] size_t getCpuDataSize() const;
+        void updateCpuMemory() { cpuMemory.Set(getCpuDataSize()); }
+
         [[nodiscard]] bool hasAttribute(VertexAttribute attr) const { return vertexBufferRanges[int(attr)].byteSize != 0; }
         nvrhi::BufferRange& getVertexBufferRange(VertexAttribute attr) { return vertexBufferRanges[int(attr)]; }
         [[nodiscard]] const nvrhi::BufferRange& getVertexBufferRange(VertexAttribute attr) const { return vertexBufferRanges[int(attr)]; }
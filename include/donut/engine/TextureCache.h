@@ -74,6 +74,9 @@ namespace donut::engine
 
         // ArraySlice -> MipLevel -> TextureSubresourceData
         std::vector<std::vector<TextureSubresourceData>> dataLayout;
+
+        // Size of the GPU texture, set when the texture is created
+        memory::Tag gpuMemory = memory::Tag(memory::Category::GpuTextures);
     };
 
     class TextureCache
@@ -248,6 +251,7 @@ namespace donut::engine
     // Supported formats are: BMP, PNG, JPG, TGA.
     // Requires that no immediate command list is open at the time this function is called.
     // Creates and destroys temporary resources internally, so should NOT be called often.
+    // Use FrameCapture to save images every frame without waiting for the GPU.
     bool SaveTextureToFile(
         nvrhi::IDevice* device,
         CommonRenderPasses* pPasses,
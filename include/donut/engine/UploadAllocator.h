@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace donut::engine
+{
+    struct UploadAllocatorStats
+    {
+        // Bytes handed out, including alignment padding
+        uint64_t bytesAllocated = 0;
+        uint32_t numAllocations = 0;
+        uint32_t numCopies = 0;
+        uint32_t numFlushes = 0;
+        // Pages used during the frame, and all pages owned by the allocator including those still in flight
+        uint32_t numPagesUsed = 0;
+        uint32_t numPagesTotal = 0;
+        // Allocations larger than the page size get a dedicated page that is not recycled
+        uint32_t numOversizedAllocations = 0;
+    };
+
+    // A range of CPU-writable memory in one of the allocator's pages.
+    // The CPU address is valid until the next Flush().
+    struct UploadAllocation
+    {
+        nvrhi::IBuffer* buffer = nullptr;
+        uint64_t offset = 0;
+        void* cpuAddress = nullptr;
+
+        [[nodiscard]] bool IsValid() const { return cpuAddress != nullptr; }
+    };
+
+    /*
+    UploadAllocator is a frame-scoped linear allocator of upload memory.
+
+    Data is suballocated from large CPU-writable pages instead of going through a separate
+    upload allocation for every writeBuffer call. Write() stages the data and records a copy
+    into the destination buffer; all recorded copies are issued by a single Flush() per batch.
+    Allocate() returns raw ranges that can also be read by shaders directly through buffer ranges.
+
+    Frame protocol: BeginFrame() before recording, Flush() before the GPU consumes the data,
+    and EndFrame() after the command lists that use the data have been submitted.
+    Pages are recycled once the GPU has passed the EndFrame() of the frame that used them.
+    Volatile constant buffers already use nvrhi's per-command-list upload ring and don't need this.
+    */
+    class UploadAllocator
+    {
+    public:
+        struct CreateParameters
+        {
+            uint64_t pageSize = 1024 * 1024;
+        };
+
+    private:
+        struct Page
+        {
+            nvrhi::BufferHandle buffer;
+            uint64_t size = 0;
+            uint64_t used = 0;
+            uint8_t* mappedData = nullptr;
+        };
+
+        struct PendingCopy
+        {
+            nvrhi::BufferHandle destBuffer;
+            uint64_t destOffset;
+            nvrhi::IBuffer* srcBuffer;
+            uint64_t srcOffset;
+            uint64_t size;
+        };
+
+        struct FrameInFlight
+        {
+            nvrhi::EventQueryHandle query;
+            std::vector<Page> pages;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        CreateParameters m_Params;
+
+        std::vector<Page> m_FreePages;
+        std::vector<Page> m_CurrentPages;
+        std::deque<FrameInFlight> m_FramesInFlight;
+        std::vector<nvrhi::EventQueryHandle> m_QueryPool;
+        std::vector<PendingCopy> m_PendingCopies;
+
+        UploadAllocatorStats m_CurrentStats;
+        UploadAllocatorStats m_LastFrameStats;
+        uint64_t m_PeakBytesAllocated = 0;
+        uint32_t m_NumPagesTotal = 0;
+
+        std::mutex m_Mutex;
+
+        bool MapPage(Page& page);
+        Page* GetPageForAllocation(uint64_t size, uint64_t alignment);
+        UploadAllocation AllocateInternal(uint64_t size, uint64_t alignment);
+        void RetireCompletedFrames(bool wait);
+
+    public:
+        UploadAllocator(nvrhi::IDevice* device, const CreateParameters& params);
+        ~UploadAllocator();
+
+        void BeginFrame();
+        void EndFrame();
+
+        // Returns a range of at least 'size' bytes aligned to 'alignment', which must be a power of 2.
+        UploadAllocation Allocate(uint64_t size, uint64_t alignment = 16);
+
+        // Stages the data and records a copy into destBuffer, issued by the next Flush().
+        bool Write(nvrhi::IBuffer* destBuffer, const void* data, uint64_t size, uint64_t destOffset = 0);
+
+        // Issues all recorded copies into the command list. Invalidates the CPU addresses of previous allocations.
+        void Flush(nvrhi::ICommandList* commandList);
+
+        // Releases all pages after waiting for the frames in flight.
+        void Clear();
+
+        [[nodiscard]] uint64_t GetPageSize() const { return m_Params.pageSize; }
+        [[nodiscard]] const UploadAllocatorStats& GetCurrentFrameStats() const { return m_CurrentStats; }
+        [[nodiscard]] const UploadAllocatorStats& GetLastFrameStats() const { return m_LastFrameStats; }
+        // Largest bytesAllocated of any frame so far, a starting point for tuning the page size.
+        [[nodiscard]] uint64_t GetPeakBytesAllocated() const { return m_PeakBytesAllocated; }
+    };
+}
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <donut/core/memory_tracking.h>
 #include <donut/engine/BindingCache.h>
 #include <nvrhi/nvrhi.h>
 #include <memory>
@@ -69,6 +70,7 @@ namespace donut::render
         };
 
         std::vector<PerViewData> m_PerViewData;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
         nvrhi::BufferHandle m_BloomHBlurCB;
         nvrhi::BufferHandle m_BloomVBlurCB;
         nvrhi::ShaderHandle m_BloomBlurPixelShader;
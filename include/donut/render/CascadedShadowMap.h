@@ -26,21 +26,62 @@
 #include <donut/engine/ShadowMap.h>
 #include <donut/engine/View.h>
 #include <nvrhi/nvrhi.h>
+#include <array>
 #include <memory>
 
+namespace donut::engine
+{
+    class FramebufferFactory;
+}
+
 namespace donut::render
 {
     class PlanarShadowMap;
+    class IDrawStrategy;
+    class IGeometryPass;
+    class GeometryPassContext;
 
     class CascadedShadowMap : public engine::IShadowMap
     {
     private:
+        nvrhi::DeviceHandle m_Device;
         nvrhi::TextureHandle m_ShadowMapTexture;
         std::vector<std::shared_ptr<PlanarShadowMap>> m_Cascades;
         std::vector<std::shared_ptr<PlanarShadowMap>> m_PerObjectShadows;
         engine::CompositeView m_CompositeView;
         int m_NumberOfCascades;
 
+        struct CascadeFit
+        {
+            // Corners of the cascade's slice of the view frustum, in world space
+            std::array<dm::float3, 8> receiverCorners;
+            // Volume of the potential casters, in the view space of the cascade
+            dm::box3 casterVolume = dm::box3::empty();
+            bool fitted = false;
+        };
+
+        std::vector<CascadeFit> m_CascadeFits;
+
+        void SetCascadeReceivers(int cascade, const std::array<dm::float3, 8>& worldCorners);
+
+        struct CascadeCacheState
+        {
+            dm::float4x4 viewProjection = dm::float4x4::zero();
+            bool staticContentValid = false;
+            bool rendered = false;
+        };
+
+        // Static shadow caching, see SetStaticCachingEnabled and RenderCascades
+        nvrhi::TextureHandle m_StaticShadowMapTexture;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
+        std::shared_ptr<engine::FramebufferFactory> m_FramebufferFactory;
+        std::shared_ptr<engine::FramebufferFactory> m_StaticFramebufferFactory;
+        std::vector<CascadeCacheState> m_CascadeCache;
+        bool m_StaticCachingEnabled = false;
+        int m_FirstStaggeredCascade = 0;
+        uint32_t m_StaggeredUpdateInterval = 1;
+        uint32_t m_FrameIndex = 0;
+
     public:
         CascadedShadowMap(
             nvrhi::IDevice* device,
@@ -95,6 +136,46 @@ namespace donut::render
         void SetFalloffDistance(float distance);
 		void SetNumberOfCascadesUnsafe(int cascades);
 
+        // Enables caching of the static shadow casters. The static casters are rendered into a separate texture
+        // only when the cascade projection changes or InvalidateStaticCache() is called, and that texture is copied
+        // into the shadow map before the dynamic casters are drawn on top. Only applies to RenderCascades(...).
+        void SetStaticCachingEnabled(bool enabled);
+        [[nodiscard]] bool IsStaticCachingEnabled() const { return m_StaticCachingEnabled; }
+
+        // Discards the cached static casters. Call when the static geometry is added, removed or modified.
+        void InvalidateStaticCache();
+
+        // Updates the cascades starting with 'firstCascade' only every 'interval' frames, spreading the updates
+        // of different cascades over frames. The Setup... functions keep the projections of the cascades that
+        // are not due, and RenderCascades(...) leaves their contents intact. Use interval = 1 to disable.
+        void SetStaggeredCascadeUpdates(int firstCascade, uint32_t interval);
+
+        // Returns true if the cascade will be re-rendered by the next RenderCascades(...) call.
+        [[nodiscard]] bool IsCascadeUpdateDue(int cascade) const;
+
+        // Renders the cascades that are due this frame and advances the frame counter used for staggering.
+        // The static and dynamic strategies must produce disjoint sets of casters, see FilteredDrawStrategy.
+        // When static caching is disabled, both sets are rendered into the shadow map every time.
+        void RenderCascades(
+            nvrhi::ICommandList* commandList,
+            const std::shared_ptr<engine::SceneGraphNode>& rootNode,
+            IDrawStrategy& staticCasters,
+            IDrawStrategy& dynamicCasters,
+            IGeometryPass& depthPass,
+            GeometryPassContext& passContext);
+
+        // Fits each cascade to the casters that can shadow its receivers. The receivers of a cascade are its slice
+        // of the view frustum clipped to the scene bounds, and the caster volume is that region extruded towards
+        // the light up to the scene bounds. The near and far planes are moved to the closest caster in the volume
+        // and the farthest receiver, snapped to 1/32 of the cascade width to keep the projection stable.
+        // All volumes are in world space, the pre-view translation passed to Setup... only affects texel snapping.
+        // A single walk over the scene graph serves all cascades, pruning subgraphs outside of every volume.
+        // RenderCascades(...) skips the casters outside of the volumes. Call after one of the Setup... functions.
+        void FitCascadesToCasters(const engine::SceneGraph& scene);
+
+        // Returns false if the world space box is outside the caster volume of a fitted cascade.
+        [[nodiscard]] bool IsPotentialCaster(uint32_t cascade, const dm::box3& worldBounds) const;
+
         std::shared_ptr<engine::PlanarView> GetCascadeView(uint32_t cascade);
         std::shared_ptr<engine::PlanarView> GetPerObjectView(uint32_t object);
 
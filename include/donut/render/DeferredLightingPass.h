@@ -42,6 +42,7 @@ namespace donut::engine
 namespace donut::render
 {
     class GBufferRenderTargets;
+    class LightClusteringPass;
     
     class DeferredLightingPass
     {
@@ -53,16 +54,28 @@ namespace donut::render
         nvrhi::SamplerHandle m_ShadowSamplerComparison;
         nvrhi::BufferHandle m_DeferredLightingCB;
         nvrhi::ComputePipelineHandle m_Pso;
+        nvrhi::ComputePipelineHandle m_ClusteredPso;
+        nvrhi::ComputePipelineHandle m_TiledPso;
 
         nvrhi::BindingLayoutHandle m_BindingLayout;
+        nvrhi::BindingLayoutHandle m_ClusteredBindingLayout;
+        nvrhi::BindingLayoutHandle m_TiledBindingLayout;
         engine::BindingCache m_BindingSets;
 
+        // Light and shadow buffers used by the tiled lighting mode
+        nvrhi::BufferHandle m_LightBuffer;
+        nvrhi::BufferHandle m_ShadowBuffer;
+
         std::shared_ptr<engine::CommonRenderPasses> m_CommonPasses;
 
+        void EnsureBufferCapacity(nvrhi::BufferHandle& buffer, size_t numElements, uint32_t stride, const char* debugName);
+
     protected:
 
+        // lightingMode is one of the DEFERRED_LIGHTING_MODE_... values from deferred_lighting_cb.h
         virtual nvrhi::ShaderHandle CreateComputeShader(
-            engine::ShaderFactory& shaderFactory);
+            engine::ShaderFactory& shaderFactory,
+            int lightingMode);
 
     public:
         struct Inputs
@@ -81,6 +94,16 @@ namespace donut::render
             const std::vector<std::shared_ptr<engine::Light>>* lights = nullptr;
             const std::vector<std::shared_ptr<engine::LightProbe>>* lightProbes = nullptr;
 
+            // Optional light clusters. When set, the direct lighting comes from the clusters
+            // and 'lights' is ignored. The clusters must be updated for the single view being rendered.
+            const LightClusteringPass* lightClusters = nullptr;
+
+            // Enables tiled lighting: the lights are uploaded into a structured buffer, and the shader
+            // culls them against the depth bounds of each 16x16 tile. There is no limit on the number
+            // of lights, unlike the default mode, but each tile shades at most DEFERRED_TILED_MAX_LIGHTS_PER_TILE
+            // of them. Ignored when 'lightClusters' is set.
+            bool tiledLighting = false;
+
             dm::float3 ambientColorTop = 0.f;
             dm::float3 ambientColorBottom = 0.f;
 
@@ -24,6 +24,7 @@
 
 #include <donut/engine/SceneTypes.h>
 #include <donut/render/GeometryPasses.h>
+#include <bitset>
 #include <memory>
 #include <mutex>
 #include <nvrhi/nvrhi.h>
@@ -84,6 +85,10 @@ namespace donut::render
             // Using Buffer SRVs is often faster.
             bool useInputAssembler = false;
 
+            // Read the instance buffer as CompactInstanceData, see Scene::SetCompactInstanceData.
+            // Requires useInputAssembler = false.
+            bool compactInstanceData = false;
+
             uint32_t numConstantBufferVersions = 16;
         };
 
@@ -97,13 +102,17 @@ namespace donut::render
         nvrhi::BufferHandle m_DepthCB;
         nvrhi::BindingSetHandle m_ViewBindingSet;
         nvrhi::GraphicsPipelineHandle m_Pipelines[PipelineKey::Count];
+        // Keys whose pipelines are being compiled by PrecreatePipeline, protected by m_Mutex
+        std::bitset<PipelineKey::Count> m_PrecreatingPipelines;
         std::mutex m_Mutex;
+        PipelineCacheCounters m_PipelineCacheCounters;
 
         int m_DepthBias = 0;
         float m_DepthBiasClamp = 0.f;
         float m_SlopeScaledDepthBias = 0.f;
         bool m_IsDX11 = false;
         bool m_UseInputAssembler = false;
+        bool m_CompactInstanceData = false;
         bool m_TrackLiveness = true;
 
         std::unordered_map<const engine::BufferGroup*, nvrhi::BindingSetHandle> m_InputBindingSets;
@@ -140,6 +149,8 @@ namespace donut::render
         bool SetupMaterial(GeometryPassContext& context, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state) override;
         void SetupInputBuffers(GeometryPassContext& context, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state) override;
         void SetPushConstants(GeometryPassContext& context, nvrhi::ICommandList* commandList, nvrhi::GraphicsState& state, nvrhi::DrawArguments& args) override;
+        bool PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer) override;
+        [[nodiscard]] PipelineCacheStats GetPipelineCacheStats() const override { return m_PipelineCacheCounters.Get(); }
     };
 
 }
\ No newline at end of file
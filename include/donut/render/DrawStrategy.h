@@ -23,6 +23,7 @@
 #pragma once
 
 #include <donut/engine/SceneGraph.h>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -63,6 +64,30 @@ namespace donut::render
         void SetData(const DrawItem* data, size_t count);
     };
     
+    // Forwards the items of another strategy that pass a predicate,
+    // for example to separate static and dynamic shadow casters.
+    class FilteredDrawStrategy : public IDrawStrategy
+    {
+    public:
+        typedef std::function<bool(const DrawItem& item)> Predicate;
+
+    private:
+        IDrawStrategy& m_Inner;
+        Predicate m_Predicate;
+
+    public:
+        FilteredDrawStrategy(IDrawStrategy& inner, Predicate predicate)
+            : m_Inner(inner)
+            , m_Predicate(std::move(predicate))
+        { }
+
+        void PrepareForView(
+            const std::shared_ptr<engine::SceneGraphNode>& rootNode,
+            const engine::IView& view) override;
+
+        const DrawItem* GetNextItem() override;
+    };
+
     class InstancedOpaqueDrawStrategy : public IDrawStrategy
     {
     private:
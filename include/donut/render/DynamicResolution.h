@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+#include <nvrhi/nvrhi.h>
+#include <vector>
+
+namespace donut::engine
+{
+    class PlanarView;
+}
+
+namespace donut::render
+{
+    struct DynamicResolutionParameters
+    {
+        // GPU time budget for the measured part of the frame
+        float targetFrameTimeMs = 16.6f;
+        // Fraction of the budget kept in reserve, the controller aims at targetFrameTimeMs * (1 - headroom)
+        float headroom = 0.1f;
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        // Largest change of the scale in one adjustment, to avoid visible jumps
+        float maxScaleStep = 0.05f;
+        // Relative error from the target within which the scale is not changed
+        float deadBand = 0.05f;
+        // Weight of a new sample in the exponential moving average of the GPU time
+        float smoothing = 0.2f;
+        // Number of measured frames to wait after a change before adjusting again
+        uint32_t cooldownFrames = 4;
+    };
+
+    /*
+    DynamicResolutionController measures the GPU frame time with timer queries and picks a render
+    scale that keeps it within a target. Scene rendering uses a view whose viewport is the scaled
+    part of render targets allocated at the maximum size, and TemporalAntiAliasingPass::TemporalResolve
+    upscales from that view into the full-size output view. Only the viewport changes between frames,
+    so no textures are reallocated and framebuffers and binding sets stay valid.
+
+    Per frame:
+        controller.Update();                                  // consume finished queries, adjust the scale
+        controller.ApplyToView(renderView, outputViewport);   // before setting the matrices and jitter
+        controller.BeginFrame(commandList);
+        ... render at the scaled resolution, TAA resolve into the output view ...
+        controller.EndFrame(commandList);
+
+    Query results are read without stalling, so the scale reacts a few frames late.
+    */
+    class DynamicResolutionController
+    {
+    private:
+        struct Query
+        {
+            nvrhi::TimerQueryHandle handle;
+            bool pending = false;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        DynamicResolutionParameters m_Params;
+        std::vector<Query> m_Queries;
+        uint32_t m_CurrentQuery = 0;
+        bool m_InFrame = false;
+
+        float m_Scale = 1.f;
+        float m_SmoothedFrameTimeMs = 0.f;
+        float m_LastFrameTimeMs = 0.f;
+        uint32_t m_FramesSinceChange = 0;
+        bool m_Enabled = true;
+        bool m_HasSamples = false;
+
+    public:
+        DynamicResolutionController(nvrhi::IDevice* device, uint32_t maxFramesInFlight = 4);
+
+        void SetParameters(const DynamicResolutionParameters& params);
+        [[nodiscard]] const DynamicResolutionParameters& GetParameters() const { return m_Params; }
+
+        // When disabled, the scale stays where it is (see SetScale) and the GPU time is still measured.
+        void SetEnabled(bool enabled) { m_Enabled = enabled; }
+        [[nodiscard]] bool IsEnabled() const { return m_Enabled; }
+
+        // Timer query around the GPU work of the frame; both calls must use the same command list.
+        void BeginFrame(nvrhi::ICommandList* commandList);
+        void EndFrame(nvrhi::ICommandList* commandList);
+
+        // Collects finished measurements and updates the scale. Call once per frame before ApplyToView.
+        void Update();
+
+        // Feeds one measured GPU frame time into the controller. Update calls this for every finished
+        // query; applications that measure the frame by other means can call it directly instead.
+        void AddSample(float frameTimeMs);
+
+        void SetScale(float scale);
+        [[nodiscard]] float GetScale() const { return m_Scale; }
+        [[nodiscard]] float GetSmoothedFrameTimeMs() const { return m_SmoothedFrameTimeMs; }
+        [[nodiscard]] float GetLastFrameTimeMs() const { return m_LastFrameTimeMs; }
+
+        // Size of the scaled render area for an output of the given size, at least 1x1.
+        [[nodiscard]] dm::uint2 GetRenderSize(dm::uint2 outputSize) const;
+
+        // Sets the viewport of the view to the scaled area anchored at the origin of outputViewport.
+        // The pixel offset and matrices are left alone; call UpdateCache() after setting them.
+        void ApplyToView(engine::PlanarView& view, const nvrhi::Viewport& outputViewport) const;
+    };
+}
@@ -22,9 +22,11 @@
 
 #pragma once
 
+#include <donut/engine/BindingCache.h>
 #include <donut/engine/View.h>
 #include <donut/engine/SceneTypes.h>
 #include <donut/render/GeometryPasses.h>
+#include <bitset>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -55,6 +57,8 @@ namespace std
 
 namespace donut::render
 {
+    class LightClusteringPass;
+
     class ForwardShadingPass : public IGeometryPass
     {
     public:
@@ -77,6 +81,7 @@ namespace donut::render
         public:
             nvrhi::BindingSetHandle shadingBindingSet;
             nvrhi::BindingSetHandle inputBindingSet;
+            nvrhi::BindingSetHandle lightClusterBindingSet;
             PipelineKey keyTemplate;
 
             uint32_t positionOffset = 0;
@@ -100,6 +105,15 @@ namespace donut::render
             // Using Buffer SRVs is often faster.
             bool useInputAssembler = false;
 
+            // Read the instance buffer as CompactInstanceData, see Scene::SetCompactInstanceData.
+            // Requires useInputAssembler = false.
+            bool compactInstanceData = false;
+
+            // Enables the clustered lighting path: lights are taken from a LightClusteringPass
+            // and each pixel only iterates over the lights of its cluster.
+            // When enabled, use the PrepareLights overload that takes a LightClusteringPass.
+            bool clusteredLighting = false;
+
             uint32_t numConstantBufferVersions = 16;
         };
 
@@ -116,17 +130,24 @@ namespace donut::render
         nvrhi::BindingSetHandle m_ViewBindingSet;
         nvrhi::BindingLayoutHandle m_ShadingBindingLayout;
         nvrhi::BindingLayoutHandle m_InputBindingLayout;
+        nvrhi::BindingLayoutHandle m_LightClusterBindingLayout;
         engine::ViewType::Enum m_SupportedViewTypes = engine::ViewType::PLANAR;
         nvrhi::BufferHandle m_ForwardViewCB;
         nvrhi::BufferHandle m_ForwardLightCB;
         nvrhi::GraphicsPipelineHandle m_Pipelines[PipelineKey::Count];
+        // Keys whose pipelines are being compiled by PrecreatePipeline, protected by m_Mutex
+        std::bitset<PipelineKey::Count> m_PrecreatingPipelines;
         bool m_TrackLiveness = true;
         bool m_IsDX11 = false;
         bool m_UseInputAssembler = false;
+        bool m_CompactInstanceData = false;
+        bool m_ClusteredLighting = false;
         std::mutex m_Mutex;
+        PipelineCacheCounters m_PipelineCacheCounters;
 
         std::unordered_map<std::pair<nvrhi::ITexture*, nvrhi::ITexture*>, nvrhi::BindingSetHandle> m_ShadingBindingSets;
         std::unordered_map<const engine::BufferGroup*, nvrhi::BindingSetHandle> m_InputBindingSets;
+        engine::BindingCache m_LightClusterBindingSets;
         
         std::shared_ptr<engine::CommonRenderPasses> m_CommonPasses;
         std::shared_ptr<engine::MaterialBindingCache> m_MaterialBindings;
@@ -141,9 +162,11 @@ namespace donut::render
         virtual nvrhi::BindingSetHandle CreateShadingBindingSet(nvrhi::ITexture* shadowMapTexture, nvrhi::ITexture* diffuse, nvrhi::ITexture* specular, nvrhi::ITexture* environmentBrdf);
         virtual nvrhi::BindingLayoutHandle CreateInputBindingLayout();
         virtual nvrhi::BindingSetHandle CreateInputBindingSet(const engine::BufferGroup* bufferGroup);
+        virtual nvrhi::BindingLayoutHandle CreateLightClusterBindingLayout();
         virtual std::shared_ptr<engine::MaterialBindingCache> CreateMaterialBindingCache(engine::CommonRenderPasses& commonPasses);
         virtual nvrhi::GraphicsPipelineHandle CreateGraphicsPipeline(PipelineKey key, nvrhi::IFramebuffer* framebuffer);
         nvrhi::BindingSetHandle GetOrCreateInputBindingSet(const engine::BufferGroup* bufferGroup);
+        bool PrepareShadingBindingSet(Context& context, nvrhi::ITexture* shadowMapTexture, const std::vector<std::shared_ptr<engine::LightProbe>>& lightProbes);
 
     public:
         ForwardShadingPass(
@@ -164,6 +187,16 @@ namespace donut::render
             dm::float3 ambientColorBottom,
             const std::vector<std::shared_ptr<engine::LightProbe>>& lightProbes);
 
+        // Clustered lighting version of PrepareLights, requires CreateParameters::clusteredLighting.
+        // The light clusters must be updated for the view that is rendered with this context.
+        virtual void PrepareLights(
+            Context& context,
+            nvrhi::ICommandList* commandList,
+            const LightClusteringPass& lightClusters,
+            dm::float3 ambientColorTop,
+            dm::float3 ambientColorBottom,
+            const std::vector<std::shared_ptr<engine::LightProbe>>& lightProbes);
+
         // IGeometryPass implementation
 
         [[nodiscard]] engine::ViewType::Enum GetSupportedViewTypes() const override;
@@ -171,6 +204,8 @@ namespace donut::render
         bool SetupMaterial(GeometryPassContext& context, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state) override;
         void SetupInputBuffers(GeometryPassContext& context, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state) override;
         void SetPushConstants(GeometryPassContext& context, nvrhi::ICommandList* commandList, nvrhi::GraphicsState& state, nvrhi::DrawArguments& args) override;
+        bool PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer) override;
+        [[nodiscard]] PipelineCacheStats GetPipelineCacheStats() const override { return m_PipelineCacheCounters.Get(); }
     };
 
 }
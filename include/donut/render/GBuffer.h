@@ -23,6 +23,7 @@
 #pragma once
 
 #include <donut/core/math/math.h>
+#include <donut/core/memory_tracking.h>
 #include <nvrhi/nvrhi.h>
 #include <memory>
 
@@ -40,6 +41,7 @@ namespace donut::render
         dm::uint2 m_Size = dm::uint2::zero();
         dm::uint m_SampleCount = 0;
         bool m_UseReverseProjection = false;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
 
     public:
         nvrhi::TextureHandle Depth;
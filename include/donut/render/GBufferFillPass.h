@@ -25,6 +25,7 @@
 #include <donut/engine/View.h>
 #include <donut/engine/SceneTypes.h>
 #include <donut/render/GeometryPasses.h>
+#include <bitset>
 #include <memory>
 #include <mutex>
 
@@ -86,6 +87,10 @@ namespace donut::render
             // Using Buffer SRVs is often faster.
             bool useInputAssembler = false;
 
+            // Read the instance buffer as CompactInstanceData, see Scene::SetCompactInstanceData.
+            // Requires useInputAssembler = false.
+            bool compactInstanceData = false;
+
             uint32_t stencilWriteMask = 0;
             uint32_t numConstantBufferVersions = 16;
         };
@@ -103,7 +108,10 @@ namespace donut::render
         nvrhi::BufferHandle m_GBufferCB;
         engine::ViewType::Enum m_SupportedViewTypes = engine::ViewType::PLANAR;
         nvrhi::GraphicsPipelineHandle m_Pipelines[PipelineKey::Count];
+        // Keys whose pipelines are being compiled by PrecreatePipeline, protected by m_Mutex
+        std::bitset<PipelineKey::Count> m_PrecreatingPipelines;
         std::mutex m_Mutex;
+        PipelineCacheCounters m_PipelineCacheCounters;
 
         std::unordered_map<const engine::BufferGroup*, nvrhi::BindingSetHandle> m_InputBindingSets;
 
@@ -114,6 +122,7 @@ namespace donut::render
         bool m_EnableMotionVectors = false;
         bool m_IsDX11 = false;
         bool m_UseInputAssembler = false;
+        bool m_CompactInstanceData = false;
         uint32_t m_StencilWriteMask = 0;
         
         virtual nvrhi::ShaderHandle CreateVertexShader(engine::ShaderFactory& shaderFactory, const CreateParameters& params);
@@ -126,6 +135,7 @@ namespace donut::render
         virtual std::shared_ptr<engine::MaterialBindingCache> CreateMaterialBindingCache(engine::CommonRenderPasses& commonPasses);
         virtual nvrhi::GraphicsPipelineHandle CreateGraphicsPipeline(PipelineKey key, nvrhi::IFramebuffer* sampleFramebuffer);
         nvrhi::BindingSetHandle GetOrCreateInputBindingSet(const engine::BufferGroup* bufferGroup);
+        static bool GetAlphaTestedKey(const engine::Material* material, PipelineKey& key);
         
     public:
         GBufferFillPass(nvrhi::IDevice* device, std::shared_ptr<engine::CommonRenderPasses> commonPasses);
@@ -143,6 +153,8 @@ namespace donut::render
         bool SetupMaterial(GeometryPassContext& context, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state) override;
         void SetupInputBuffers(GeometryPassContext& context, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state) override;
         void SetPushConstants(GeometryPassContext& context, nvrhi::ICommandList* commandList, nvrhi::GraphicsState& state, nvrhi::DrawArguments& args) override;
+        bool PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer) override;
+        [[nodiscard]] PipelineCacheStats GetPipelineCacheStats() const override { return m_PipelineCacheCounters.Get(); }
     };
 
     class MaterialIDPass : public GBufferFillPass
@@ -24,9 +24,21 @@
 
 #include <donut/engine/View.h>
 #include <nvrhi/nvrhi.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef DONUT_WITH_TASKFLOW
+namespace tf
+{
+    class Executor;
+}
+#endif
 
 namespace donut::engine
 {
+    class SceneGraph;
     class SceneGraphNode;
     struct MeshInfo;
     struct MeshGeometry;
@@ -54,6 +66,29 @@ namespace donut::render
     class GeometryPassContext
     {
     };
+
+    struct PipelineCacheStats
+    {
+        uint64_t hits = 0;          // SetupMaterial calls that found an existing pipeline
+        uint64_t misses = 0;        // pipelines created on first use by SetupMaterial, i.e. potential hitches
+        uint64_t precreated = 0;    // pipelines created ahead of time by PrecreatePipeline
+    };
+
+    // Thread-safe counters used by the geometry passes to implement GetPipelineCacheStats
+    class PipelineCacheCounters
+    {
+    private:
+        std::atomic<uint64_t> m_Hits = 0;
+        std::atomic<uint64_t> m_Misses = 0;
+        std::atomic<uint64_t> m_Precreated = 0;
+
+    public:
+        void AddHit() { m_Hits.fetch_add(1, std::memory_order_relaxed); }
+        void AddMiss() { m_Misses.fetch_add(1, std::memory_order_relaxed); }
+        void AddPrecreated() { m_Precreated.fetch_add(1, std::memory_order_relaxed); }
+        void Reset();
+        [[nodiscard]] PipelineCacheStats Get() const;
+    };
     
     class IGeometryPass
     {
@@ -63,6 +98,15 @@ namespace donut::render
         virtual bool SetupMaterial(GeometryPassContext& context, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state) = 0;
         virtual void SetupInputBuffers(GeometryPassContext& context, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state) = 0;
         virtual void SetPushConstants(GeometryPassContext& context, nvrhi::ICommandList* commandList, nvrhi::GraphicsState& state, nvrhi::DrawArguments& args) = 0;
+
+        // Creates the pipeline and material bindings that SetupMaterial would use for this material, view and framebuffer,
+        // without recording any commands. Must be safe to call from multiple threads concurrently, and each pipeline
+        // must be compiled only once when several materials share it.
+        // Returns true if this call created a pipeline; false if the pipeline already exists or is being created
+        // by another thread, or if the pass doesn't render the material or doesn't support pre-creation.
+        virtual bool PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer) { return false; }
+        [[nodiscard]] virtual PipelineCacheStats GetPipelineCacheStats() const { return PipelineCacheStats(); }
+
         virtual ~IGeometryPass() = default;
     };
 
@@ -87,4 +131,73 @@ namespace donut::render
         GeometryPassContext& passContext,
         const char* passEvent = nullptr,
         bool materialEvents = false);
-}
\ No newline at end of file
+
+    // Pre-creates the pipelines that the pass needs to render all materials of the scene graph into the framebuffer,
+    // so that they are not compiled on first use. Call after loading the scene, once per pass and view configuration.
+    // Returns the number of pipelines created, i.e. the number of distinct pipelines that did not exist yet.
+    size_t PrecreatePipelines(
+        IGeometryPass& pass,
+        const engine::IView* view,
+        nvrhi::IFramebuffer* framebuffer,
+        const engine::SceneGraph& sceneGraph);
+
+#ifdef DONUT_WITH_TASKFLOW
+    // Same as above, but the pipelines are created on the executor's worker threads. Blocks until all are created.
+    size_t PrecreatePipelines(
+        IGeometryPass& pass,
+        const engine::IView* view,
+        nvrhi::IFramebuffer* framebuffer,
+        const engine::SceneGraph& sceneGraph,
+        tf::Executor& executor);
+
+    /*
+    ParallelGeometryRenderer records the child views of a composite view - and optionally, chunks of
+    large draw lists within each view - into separate command lists on the executor's worker threads.
+    The command lists are then submitted in view order, right after the work already recorded
+    into the caller's command list.
+
+    Every recorded command list gets its own draw strategy and pass context, created through
+    the factories passed to RenderCompositeView. The context factory is called on the worker thread
+    with the worker's command list open, so it can write the per-command-list state such as
+    volatile constant buffers (e.g. ForwardShadingPass::PrepareLights).
+
+    On DX11, which only supports immediate command lists, rendering falls back to RenderCompositeView.
+    */
+    class ParallelGeometryRenderer
+    {
+    public:
+        typedef std::function<std::unique_ptr<IDrawStrategy>()> DrawStrategyFactory;
+        typedef std::function<std::unique_ptr<GeometryPassContext>(nvrhi::ICommandList* commandList)> PassContextFactory;
+
+    private:
+        nvrhi::DeviceHandle m_Device;
+        tf::Executor& m_Executor;
+        std::vector<nvrhi::CommandListHandle> m_CommandLists;
+        size_t m_MaxDrawItemsPerCommandList = 0;
+
+        nvrhi::ICommandList* GetCommandList(size_t index);
+
+    public:
+        ParallelGeometryRenderer(nvrhi::IDevice* device, tf::Executor& executor);
+
+        // Splits the draw list of each child view into chunks of at most this many items,
+        // each recorded into a separate command list. 0 means one command list per child view.
+        void SetMaxDrawItemsPerCommandList(size_t count) { m_MaxDrawItemsPerCommandList = count; }
+        [[nodiscard]] size_t GetMaxDrawItemsPerCommandList() const { return m_MaxDrawItemsPerCommandList; }
+
+        // Same semantics as donut::render::RenderCompositeView, except that the draw strategy and pass context
+        // are created per command list. Note that 'commandList' is closed, executed and reopened by this function.
+        void RenderCompositeView(
+            nvrhi::ICommandList* commandList,
+            const engine::ICompositeView* compositeView,
+            const engine::ICompositeView* compositeViewPrev,
+            engine::FramebufferFactory& framebufferFactory,
+            const std::shared_ptr<engine::SceneGraphNode>& rootNode,
+            const DrawStrategyFactory& drawStrategyFactory,
+            IGeometryPass& pass,
+            const PassContextFactory& passContextFactory,
+            const char* passEvent = nullptr,
+            bool materialEvents = false);
+    };
+#endif
+}
@@ -0,0 +1,133 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/engine/BindingCache.h>
+#include <donut/engine/View.h>
+#include <nvrhi/nvrhi.h>
+#include <memory>
+#include <vector>
+
+namespace donut::engine
+{
+    class ShaderFactory;
+    class CommonRenderPasses;
+    class SceneGraph;
+    struct Material;
+    struct BufferGroup;
+}
+
+namespace donut::render
+{
+    class IGeometryPass;
+    class GeometryPassContext;
+
+    /*
+    InstanceCullingPass implements a GPU-driven rendering path for opaque and alpha-tested geometry.
+
+    All geometry instances of the scene are stored in a draw record buffer, grouped into buckets
+    by material, buffer group and cull mode. For every view, a compute shader culls the records
+    against the view frustum and, optionally, a HiZ depth pyramid, and appends the visible ones
+    into the indirect argument range of their bucket. RenderView then issues one drawIndexedIndirect
+    per bucket, so the CPU cost does not depend on the number of instances.
+
+    Argument slots that are not filled by the culling shader are cleared to zero and draw nothing.
+
+    The indirect draws rely on the startInstanceLocation field of the draw arguments to fetch
+    the instance transforms, so the geometry pass used with RenderView must be created with
+    useInputAssembler = true. The input assembler path doesn't support Scene::SetCompactInstanceData,
+    so RenderView refuses to draw the results of culling compact instances.
+    */
+    class InstanceCullingPass
+    {
+    public:
+        struct DrawBucket
+        {
+            const engine::Material* material = nullptr;
+            const engine::BufferGroup* buffers = nullptr;
+            nvrhi::RasterCullMode cullMode = nvrhi::RasterCullMode::Back;
+            uint32_t firstDraw = 0;
+            uint32_t numDraws = 0;
+        };
+
+    private:
+        nvrhi::DeviceHandle m_Device;
+        nvrhi::ShaderHandle m_ComputeShader;
+        nvrhi::ComputePipelineHandle m_Pipeline;
+        nvrhi::BindingLayoutHandle m_BindingLayout;
+        nvrhi::BufferHandle m_CullingCB;
+        nvrhi::BufferHandle m_DrawRecordBuffer;
+        nvrhi::BufferHandle m_DrawArgumentBuffer;
+        nvrhi::BufferHandle m_DrawCountBuffer;
+        engine::BindingCache m_BindingCache;
+
+        std::shared_ptr<engine::CommonRenderPasses> m_CommonPasses;
+        std::vector<DrawBucket> m_Buckets;
+        uint32_t m_NumDrawRecords = 0;
+        bool m_CompactInstanceData = false;
+
+    public:
+        InstanceCullingPass(
+            nvrhi::IDevice* device,
+            engine::ShaderFactory& shaderFactory,
+            std::shared_ptr<engine::CommonRenderPasses> commonPasses);
+
+        // Rebuilds the draw records and buckets from the mesh instances of the scene graph.
+        // Call this after the scene structure changes, once Scene::Refresh has assigned the instance indices.
+        void UpdateDrawRecords(nvrhi::ICommandList* commandList, const engine::SceneGraph& sceneGraph);
+
+        // Culls all draw records for the view and writes the compacted indirect arguments.
+        // 'instanceBuffer' is the scene instance buffer, see Scene::GetInstanceBuffer().
+        // 'compactInstanceData' must match Scene::IsCompactInstanceDataEnabled(). The results of culling
+        // compact instances can be read back, but not drawn with RenderView, see the class comment.
+        // 'hizTexture' is optional: it's a depth pyramid (e.g. previous frame depth reduced with MipMapGenPass)
+        // where every texel stores the farthest depth of its footprint - MODE_MIN for reverse depth, MODE_MAX otherwise.
+        void Cull(
+            nvrhi::ICommandList* commandList,
+            const engine::IView& view,
+            nvrhi::IBuffer* instanceBuffer,
+            nvrhi::ITexture* hizTexture = nullptr,
+            bool compactInstanceData = false);
+
+        // Draws the results of the last Cull(...) call with one indirect draw per bucket.
+        void RenderView(
+            nvrhi::ICommandList* commandList,
+            const engine::IView* view,
+            const engine::IView* viewPrev,
+            nvrhi::IFramebuffer* framebuffer,
+            IGeometryPass& pass,
+            GeometryPassContext& passContext);
+
+        [[nodiscard]] const std::vector<DrawBucket>& GetBuckets() const { return m_Buckets; }
+        [[nodiscard]] uint32_t GetNumDrawRecords() const { return m_NumDrawRecords; }
+
+        // Array of CullingDrawRecord, see instance_culling_cb.h
+        [[nodiscard]] nvrhi::IBuffer* GetDrawRecordBuffer() const { return m_DrawRecordBuffer; }
+
+        // Array of nvrhi::DrawIndexedIndirectArguments, one range per bucket
+        [[nodiscard]] nvrhi::IBuffer* GetDrawArgumentBuffer() const { return m_DrawArgumentBuffer; }
+
+        // Array of uint32_t, number of visible draws per bucket
+        [[nodiscard]] nvrhi::IBuffer* GetDrawCountBuffer() const { return m_DrawCountBuffer; }
+    };
+}
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+#include <nvrhi/nvrhi.h>
+#include <memory>
+#include <vector>
+
+namespace donut::engine
+{
+    class IView;
+    class Light;
+}
+
+namespace donut::render
+{
+    /*
+    LightClusteringPass assigns local lights to the cells of a froxel grid built for one view,
+    so that shading passes only iterate over the lights that can affect each pixel.
+
+    The grid is made of screen-space tiles and exponentially distributed depth slices.
+    Light assignment is done on the CPU: every point or spot light with a finite range is tested
+    against the view-space bounds of the clusters overlapped by its projection. Directional lights
+    and lights with infinite range are stored at the start of the light buffer and apply to all clusters.
+
+    The results are stored in GPU buffers that are consumed by ForwardShadingPass and DeferredLightingPass
+    through AddBindingLayoutItems / AddBindingSetItems:
+        - constant buffer with the LightClusterConstants structure (light_clusters_cb.h)
+        - StructuredBuffer<LightConstants> with all lights
+        - StructuredBuffer<ShadowConstants> with all shadow cascades and per-object shadows
+        - StructuredBuffer<LightCluster> with one record per cluster
+        - StructuredBuffer<uint> with the light indices referenced by the clusters
+
+    One instance of LightClusteringPass is needed per view rendered in a frame, because the buffers
+    are overwritten on every Update call.
+    */
+    class LightClusteringPass
+    {
+    public:
+        struct CreateParameters
+        {
+            // Size of the screen-space tiles, in pixels
+            uint32_t tileSize = 64;
+
+            // Number of depth slices between zNear and zFar
+            uint32_t numDepthSlices = 24;
+
+            // View-space depth range for the exponential slice distribution.
+            // The first slice starts at the camera, the last slice extends to infinity.
+            float zNear = 0.1f;
+            float zFar = 1000.f;
+        };
+
+    private:
+        nvrhi::DeviceHandle m_Device;
+        CreateParameters m_Params;
+
+        nvrhi::BufferHandle m_ConstantBuffer;
+        nvrhi::BufferHandle m_LightBuffer;
+        nvrhi::BufferHandle m_ShadowBuffer;
+        nvrhi::BufferHandle m_ClusterBuffer;
+        nvrhi::BufferHandle m_LightIndexBuffer;
+
+        nvrhi::ITexture* m_ShadowMapTexture = nullptr;
+        dm::float2 m_ShadowMapTextureSize = 0.f;
+
+        dm::uint3 m_GridSize = 0u;
+        uint32_t m_NumLights = 0;
+        uint32_t m_NumGlobalLights = 0;
+        uint32_t m_NumLightIndices = 0;
+
+        std::vector<dm::box3> m_ClusterBounds;
+        std::vector<uint32_t> m_ClusterCounts;
+        std::vector<dm::uint2> m_Assignments; // (cluster, light) pairs
+
+        void UpdateClusterBounds(const engine::IView& view);
+        void EnsureBufferCapacity(nvrhi::BufferHandle& buffer, size_t numElements, uint32_t stride, const char* debugName) const;
+
+    public:
+        LightClusteringPass(nvrhi::IDevice* device, const CreateParameters& params);
+
+        // Rebuilds the light clusters for the view and uploads the results.
+        // Returns false if the lights use different shadow map textures, which is not supported.
+        bool Update(
+            nvrhi::ICommandList* commandList,
+            const engine::IView& view,
+            const std::vector<std::shared_ptr<engine::Light>>& lights);
+
+        // Appends the bindings for the cluster resources: a constant buffer at 'constantBufferSlot'
+        // and four structured buffer SRVs starting at 'firstSrvSlot'.
+        static void AddBindingLayoutItems(nvrhi::BindingLayoutDesc& layoutDesc, uint32_t constantBufferSlot, uint32_t firstSrvSlot);
+        void AddBindingSetItems(nvrhi::BindingSetDesc& setDesc, uint32_t constantBufferSlot, uint32_t firstSrvSlot) const;
+
+        // Returns the shadow map texture shared by all shadow casting lights, or nullptr if there are none.
+        [[nodiscard]] nvrhi::ITexture* GetShadowMapTexture() const { return m_ShadowMapTexture; }
+        [[nodiscard]] dm::float2 GetShadowMapTextureSize() const { return m_ShadowMapTextureSize; }
+
+        [[nodiscard]] dm::uint3 GetGridSize() const { return m_GridSize; }
+        [[nodiscard]] uint32_t GetNumLights() const { return m_NumLights; }
+        [[nodiscard]] uint32_t GetNumGlobalLights() const { return m_NumGlobalLights; }
+        [[nodiscard]] uint32_t GetNumLightIndices() const { return m_NumLightIndices; }
+        [[nodiscard]] const CreateParameters& GetParameters() const { return m_Params; }
+    };
+}
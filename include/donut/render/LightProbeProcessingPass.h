@@ -24,6 +24,7 @@
 
 
 #include <donut/core/math/math.h>
+#include <donut/core/memory_tracking.h>
 #include <nvrhi/nvrhi.h>
 #include <memory>
 #include <unordered_map>
@@ -57,6 +58,7 @@ namespace donut::render
 
         nvrhi::TextureHandle m_EnvironmentBrdfTexture;
         uint32_t m_EnvironmentBrdfTextureSize;
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
 
         std::shared_ptr<engine::CommonRenderPasses> m_CommonPasses;
 
@@ -33,6 +33,8 @@ namespace donut::engine
 {
     class ShaderFactory;
     class CommonRenderPasses;
+    class AsyncComputeScheduler;
+    struct AsyncComputeJob;
 }
 
 // Compute reduction pass to generate mipmap levels
@@ -62,6 +64,13 @@ namespace donut::render
         // LOD 1 and up
         void Dispatch(nvrhi::ICommandList* commandList, int maxLOD=-1);
 
+        // Dispatches the reduction as a job on the async compute queue when
+        // the scheduler has it active, the texture is handed over as a UAV
+        engine::AsyncComputeJob ScheduleDispatch(
+            engine::AsyncComputeScheduler& scheduler,
+            nvrhi::ICommandList* commandList,
+            int maxLOD=-1);
+
         // debug : blits mip-map levels in spiral pattern to 'target'
         // (assumes 'target' texture resolution is high enough...)
         void Display(
@@ -23,8 +23,12 @@
 #pragma once
 
 #include <donut/core/math/math.h>
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
-#include <map>
+#include <mutex>
+#include <vector>
 #include <nvrhi/nvrhi.h>
 
 
@@ -38,17 +42,78 @@ namespace donut::engine
 
 namespace donut::render
 {
+    struct PixelReadbackResult
+    {
+        dm::uint2 origin = dm::uint2::zero();
+        dm::uint2 size = dm::uint2::zero();
+        // Raw texel bits in row-major order; empty if the request could not be served
+        std::vector<dm::uint4> values;
+
+        [[nodiscard]] bool IsValid() const { return !values.empty(); }
+        [[nodiscard]] dm::float4 GetFloats(uint32_t index = 0) const;
+        [[nodiscard]] dm::uint4 GetUInts(uint32_t index = 0) const;
+        [[nodiscard]] dm::int4 GetInts(uint32_t index = 0) const;
+    };
+
+    typedef std::function<void(const PixelReadbackResult&)> PixelReadbackCallback;
+
+    /*
+    PixelReadbackPass reads texels of a texture back to the CPU.
+
+    The pipelined path doesn't stall: Request() queues pixels or regions, Submit() records all queued
+    requests into one dispatch and a copy into the next of numReadbackBuffers readback buffers, and
+    Poll() completes the requests whose copies the GPU has finished, invoking the callbacks or
+    fulfilling the futures. Poll() must be called after the command list passed to Submit() has been
+    executed, typically once per frame before Submit(). Results arrive a frame or more later.
+
+    Capture() and the Read*() functions are the old synchronous path; reading waits for the GPU.
+    */
     class PixelReadbackPass
     {
     private:
+        struct ReadbackRequest
+        {
+            dm::uint2 origin;
+            dm::uint2 size;
+            uint32_t firstPixel = 0;
+            PixelReadbackCallback callback;
+        };
+
+        struct ReadbackSlot
+        {
+            nvrhi::BufferHandle buffer;
+            nvrhi::EventQueryHandle query;
+            std::vector<ReadbackRequest> requests;
+        };
+
+        struct CompletedRequest
+        {
+            PixelReadbackCallback callback;
+            PixelReadbackResult result;
+        };
+
         nvrhi::DeviceHandle m_Device;
         nvrhi::ShaderHandle m_Shader;
         nvrhi::ComputePipelineHandle m_Pipeline;
         nvrhi::BindingLayoutHandle m_BindingLayout;
         nvrhi::BindingSetHandle m_BindingSet;
         nvrhi::BufferHandle m_ConstantBuffer;
+        nvrhi::BufferHandle m_PositionBuffer;
         nvrhi::BufferHandle m_IntermediateBuffer;
         nvrhi::BufferHandle m_ReadbackBuffer;
+        uint32_t m_MaxPixelsPerBatch = 0;
+
+        std::vector<ReadbackSlot> m_Slots;
+        std::vector<uint32_t> m_FreeSlots;
+        std::vector<uint32_t> m_RecordedSlots;
+        std::deque<uint32_t> m_InFlightSlots;
+
+        std::mutex m_Mutex;
+        std::deque<ReadbackRequest> m_PendingRequests;
+        std::vector<dm::uint2> m_PositionScratch;
+
+        void RecordBatch(nvrhi::ICommandList* commandList, nvrhi::IBuffer* readbackBuffer);
+        void CompleteSlot(uint32_t slotIndex, std::vector<CompletedRequest>& completed);
 
     public:
         PixelReadbackPass(
@@ -57,12 +122,29 @@ namespace donut::render
             nvrhi::ITexture* inputTexture,
             nvrhi::Format format,
             uint32_t arraySlice = 0,
-            uint32_t mipLevel = 0);
+            uint32_t mipLevel = 0,
+            uint32_t numReadbackBuffers = 3,
+            uint32_t maxPixelsPerBatch = 256);
 
         void Capture(nvrhi::ICommandList* commandList, dm::uint2 pixelPosition);
 
         dm::float4 ReadFloats();
         dm::uint4 ReadUInts();
         dm::int4 ReadInts();
+
+        // Queues a readback of a region of size.x * size.y texels. Thread-safe, the callback is invoked
+        // from Poll(). Regions larger than one batch fail immediately with an empty result.
+        void Request(dm::uint2 origin, dm::uint2 size, PixelReadbackCallback callback);
+        std::future<PixelReadbackResult> Request(dm::uint2 origin, dm::uint2 size = dm::uint2(1));
+
+        // Records the queued requests that fit into one batch. Does nothing if all readback buffers
+        // are in flight, the requests stay queued until a buffer is released by Poll().
+        void Submit(nvrhi::ICommandList* commandList);
+
+        // Completes the requests whose readback has finished. With 'wait', blocks until all submitted
+        // requests are complete.
+        void Poll(bool wait = false);
+
+        [[nodiscard]] uint32_t GetNumPendingRequests();
     };
-}
\ No newline at end of file
+}
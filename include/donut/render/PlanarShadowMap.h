@@ -34,6 +34,8 @@ namespace donut::render
     {
     private:
         nvrhi::TextureHandle m_ShadowMapTexture;
+        // Only counts the texture when the shadow map created it
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
         std::shared_ptr<engine::PlanarView> m_View;
         bool m_IsLitOutOfBounds = false;
         dm::float2 m_FadeRangeTexels = 1.f;
@@ -65,8 +67,26 @@ namespace donut::render
             dm::float3 preViewTranslation = 0.f,
             float fadeRangeWorld = 0.f);
 
+        // Sets up a perspective projection from 'position' looking along 'direction',
+        // used for spot light shadows and the faces of point light shadows.
+        bool SetupPerspectiveLightView(
+            dm::float3 position,
+            dm::float3 direction,
+            float verticalFov,
+            float zNear,
+            float zFar);
+
         void SetupProxyView();
 
+        // Replaces the depth range of an orthographic light view, in view space units along the light direction.
+        bool SetOrthographicDepthRange(float zNear, float zFar);
+
+        // Returns the view space box covered by an orthographic light view.
+        [[nodiscard]] dm::box3 GetOrthographicViewBounds() const;
+
+        // Moves the shadow map to a different region of the texture, for use with atlases.
+        void SetViewport(const nvrhi::Viewport& viewport);
+
         void Clear(nvrhi::ICommandList* commandList);
 
         void SetLitOutOfBounds(bool litOutOfBounds);
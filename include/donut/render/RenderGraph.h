@@ -0,0 +1,211 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/memory_tracking.h>
+#include <nvrhi/nvrhi.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace donut::render
+{
+    class RenderGraph;
+
+    // Reference to a texture declared in a RenderGraph. Only valid until the next RenderGraph::Reset().
+    struct RenderGraphTexture
+    {
+        uint32_t index = ~0u;
+
+        [[nodiscard]] bool IsValid() const { return index != ~0u; }
+    };
+
+    struct RenderGraphStats
+    {
+        uint32_t numPasses = 0;
+        uint32_t numCulledPasses = 0;
+        uint32_t numTransientTextures = 0;
+        uint32_t numAllocatedTextures = 0;
+        // Placed textures that share heap memory with another transient
+        uint32_t numAliasedTextures = 0;
+        uint32_t numBarrierBatches = 0;
+        // Sum of the sizes of all live transient textures, i.e. the memory needed without aliasing
+        uint64_t transientMemoryRequired = 0;
+        // Size of the transient heap after aliasing, 0 when the device has no virtual resource support
+        uint64_t transientMemoryAllocated = 0;
+    };
+
+    // Interface given to the setup function of a pass to declare the resources it uses.
+    class RenderGraphBuilder
+    {
+    private:
+        friend class RenderGraph;
+
+        RenderGraph& m_Graph;
+        uint32_t m_PassIndex;
+
+        RenderGraphBuilder(RenderGraph& graph, uint32_t passIndex)
+            : m_Graph(graph)
+            , m_PassIndex(passIndex)
+        { }
+
+    public:
+        // Declares a new transient texture. The contents are undefined at the first use unless the desc
+        // has a clear value, in which case the graph clears the texture before the first pass that uses it.
+        // Placed textures that share heap memory with other transients are always cleared at the first use,
+        // to the clear value or to zero, because the graphics APIs require aliased render targets and UAVs
+        // to be initialized before use.
+        RenderGraphTexture CreateTexture(const nvrhi::TextureDesc& desc);
+
+        // A texture that a pass both reads and writes is in the write state for the whole pass, and the read
+        // state is ignored. The read must work in that state, e.g. UnorderedAccess for both.
+        void Read(RenderGraphTexture texture, nvrhi::ResourceStates state = nvrhi::ResourceStates::ShaderResource);
+        void Write(RenderGraphTexture texture, nvrhi::ResourceStates state = nvrhi::ResourceStates::RenderTarget);
+
+        // Prevents the pass from being culled even if none of its outputs are used.
+        void SetSideEffects();
+    };
+
+    // A frame graph of render passes operating on imported and transient textures.
+    // Usage, every frame:
+    //   - Reset() the graph;
+    //   - ImportTexture(...) any persistent textures such as the swap chain or history buffers;
+    //   - AddPass(...) the passes in submission order, declaring their resources in the setup function;
+    //   - Compile() to cull unused passes and allocate the transient textures;
+    //   - Execute(...) to record all live passes into a command list.
+    // Transient textures whose lifetimes do not overlap share memory: on devices that support virtual
+    // resources they are placed into a common heap, otherwise textures with identical descs are reused.
+    class RenderGraph
+    {
+    public:
+        typedef std::function<void(RenderGraphBuilder& builder)> SetupFunc;
+        typedef std::function<void(nvrhi::ICommandList* commandList, const RenderGraph& graph)> ExecuteFunc;
+
+    private:
+        friend class RenderGraphBuilder;
+
+        struct Access
+        {
+            uint32_t resource;
+            nvrhi::ResourceStates state;
+        };
+
+        struct Resource
+        {
+            std::string name;
+            nvrhi::TextureDesc desc;
+            nvrhi::TextureHandle texture;
+            nvrhi::ResourceStates finalState = nvrhi::ResourceStates::Unknown;
+            bool imported = false;
+            std::vector<uint32_t> producers;
+            uint32_t refCount = 0;
+            uint32_t firstPass = ~0u;
+            uint32_t lastPass = 0;
+            bool aliased = false;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            ExecuteFunc execute;
+            std::vector<Access> reads;
+            std::vector<Access> writes;
+            std::vector<uint32_t> firstUses;
+            bool sideEffects = false;
+            bool culled = false;
+            uint32_t refCount = 0;
+        };
+
+        // Transient texture that persists across frames so that it can be reused while the graph is unchanged
+        struct Allocation
+        {
+            nvrhi::TextureDesc desc;
+            nvrhi::TextureHandle texture;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t firstPass = 0;
+            uint32_t lastPass = 0;
+            bool aliased = false;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        bool m_AliasingEnabled = true;
+        bool m_UseHeap = false;
+        bool m_Compiled = false;
+
+        std::vector<Resource> m_Resources;
+        std::vector<Pass> m_Passes;
+        uint32_t m_CurrentPass = ~0u;
+
+        nvrhi::HeapHandle m_Heap;
+        uint64_t m_HeapCapacity = 0;
+        std::vector<Allocation> m_Allocations;
+        // The transient heap with placed resources, or the pooled textures otherwise
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
+        mutable std::map<std::vector<nvrhi::ITexture*>, nvrhi::FramebufferHandle> m_FramebufferCache;
+
+        RenderGraphStats m_Stats;
+
+        void CullPasses();
+        void ComputeLifetimes();
+        void AllocatePlaced(const std::vector<uint32_t>& transients);
+        void AllocatePooled(const std::vector<uint32_t>& transients);
+        [[nodiscard]] nvrhi::ResourceStates GetPassState(uint32_t passIndex, uint32_t resource) const;
+
+    public:
+        explicit RenderGraph(nvrhi::IDevice* device);
+
+        // Removes all passes and resources declared for the previous frame. Transient memory is kept.
+        void Reset();
+
+        // Makes an externally owned texture available to the graph. Passes writing imported textures are never culled.
+        // If finalState is not Unknown, the texture is transitioned into that state after the last pass using it.
+        RenderGraphTexture ImportTexture(nvrhi::ITexture* texture, const char* name = nullptr,
+            nvrhi::ResourceStates finalState = nvrhi::ResourceStates::Unknown);
+
+        RenderGraphTexture CreateTexture(const nvrhi::TextureDesc& desc);
+
+        void AddPass(const char* name, const SetupFunc& setup, ExecuteFunc execute);
+
+        bool Compile();
+        void Execute(nvrhi::ICommandList* commandList);
+
+        // Returns the texture backing a graph resource; only valid after Compile().
+        [[nodiscard]] nvrhi::ITexture* GetTexture(RenderGraphTexture texture) const;
+
+        // Returns a framebuffer for the given targets. When called from a pass that only reads the depth target,
+        // the depth attachment is bound as read-only.
+        nvrhi::IFramebuffer* GetFramebuffer(const std::vector<RenderGraphTexture>& colorTargets,
+            RenderGraphTexture depthTarget = RenderGraphTexture()) const;
+
+        // Aliasing can be disabled for debugging; takes effect on the next Compile().
+        void SetAliasingEnabled(bool enable) { m_AliasingEnabled = enable; }
+        [[nodiscard]] bool IsAliasingEnabled() const { return m_AliasingEnabled; }
+
+        [[nodiscard]] const RenderGraphStats& GetStats() const { return m_Stats; }
+
+        // Drops the transient heap, textures and cached framebuffers.
+        void ReleaseMemory();
+    };
+}
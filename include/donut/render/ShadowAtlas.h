@@ -0,0 +1,219 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/core/memory_tracking.h>
+#include <donut/engine/ShadowMap.h>
+#include <donut/engine/View.h>
+#include <nvrhi/nvrhi.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace donut::engine
+{
+    class CommonRenderPasses;
+    class FramebufferFactory;
+    class Light;
+    class SceneGraph;
+    class SceneGraphNode;
+}
+
+namespace donut::render
+{
+    class PlanarShadowMap;
+    class IDrawStrategy;
+    class IGeometryPass;
+    class GeometryPassContext;
+
+    // Allocates square, power-of-two sized tiles within a square region using a quadtree.
+    // Freed tiles are merged with their siblings back into larger tiles.
+    class QuadTreeAllocator
+    {
+    private:
+        int m_Size;
+        int m_MinTileSize;
+        // Free tile origins for each level, level 0 is the whole region
+        std::vector<std::vector<dm::int2>> m_FreeTiles;
+
+        [[nodiscard]] int GetLevel(int tileSize) const;
+
+    public:
+        QuadTreeAllocator(int size, int minTileSize);
+
+        // Rounds 'tileSize' up to a power of two no smaller than the minimum tile size.
+        [[nodiscard]] int GetTileSize(int tileSize) const;
+
+        // Returns false if there is no free tile of the requested size.
+        bool Allocate(int tileSize, dm::int2& origin);
+
+        // 'tileSize' must be the size returned by GetTileSize for the allocation.
+        void Free(dm::int2 origin, int tileSize);
+
+        void Reset();
+
+        [[nodiscard]] int GetSize() const { return m_Size; }
+        [[nodiscard]] int GetMinTileSize() const { return m_MinTileSize; }
+        [[nodiscard]] size_t GetFreeArea() const;
+    };
+
+    // Shadow map for a spot or point light that lives in a ShadowAtlas.
+    //
+    // Spot lights have one face, and the shadow map behaves like a single PlanarShadowMap.
+    //
+    // Point lights have 6 faces, one per cube direction (+X, -X, +Y, -Y, +Z, -Z), which are best
+    // accessed through GetNumberOfFaces and GetFace. The IShadowMap interface has no notion of faces,
+    // so the lighting code sees them through the cascade and per-object shadow slots instead:
+    //   - GetCascade(0..3) returns faces 0-3, GetPerObjectShadow(0..1) returns faces 4-5;
+    //   - the lighting shaders blend the cascade slots by coverage and treat uncovered points as lit
+    //     (IsLitOutOfBounds is true), which works because faces 0-3 only overlap in their fade regions;
+    //   - the per-object slots are multiplied in and are lit outside of their bounds, so faces 4-5
+    //     only shadow the points in their own directions;
+    //   - GetWorldToUvzwMatrix, GetUVRange and FillShadowConstants are only valid for spot lights.
+    // This matches how ForwardShadingPass and LightClusteringPass consume the slots, and any other
+    // consumer must combine all cascades and per-object shadows the same way.
+    class AtlasShadowMap : public engine::IShadowMap
+    {
+    private:
+        nvrhi::TextureHandle m_Texture;
+        std::vector<std::shared_ptr<PlanarShadowMap>> m_Faces;
+        engine::CompositeView m_CompositeView;
+        uint32_t m_NumFaces = 0;
+
+        friend class ShadowAtlas;
+
+    public:
+        AtlasShadowMap(nvrhi::IDevice* device, nvrhi::ITexture* texture, uint32_t arraySlice);
+
+        [[nodiscard]] uint32_t GetNumberOfFaces() const { return m_NumFaces; }
+        [[nodiscard]] std::shared_ptr<PlanarShadowMap> GetFace(uint32_t face) const;
+
+        virtual dm::float4x4 GetWorldToUvzwMatrix() const override;
+        virtual const engine::ICompositeView& GetView() const override;
+        virtual nvrhi::ITexture* GetTexture() const override;
+        virtual uint32_t GetNumberOfCascades() const override;
+        virtual const IShadowMap* GetCascade(uint32_t index) const override;
+        virtual uint32_t GetNumberOfPerObjectShadows() const override;
+        virtual const IShadowMap* GetPerObjectShadow(uint32_t index) const override;
+        virtual dm::int2 GetTextureSize() const override;
+        virtual dm::box2 GetUVRange() const override;
+        virtual dm::float2 GetFadeRangeInTexels() const override;
+        virtual bool IsLitOutOfBounds() const override;
+        virtual void FillShadowConstants(ShadowConstants& constants) const override;
+    };
+
+    // Manages the shadows of spot and point lights in a single depth texture.
+    // Each light gets tiles sized by its screen coverage and importance, and the tiles of lights
+    // that did not change and have no moving casters in range are not re-rendered.
+    // To use the atlas together with a CascadedShadowMap in the same lighting pass, create the
+    // atlas on a spare slice of the same texture array: the lighting passes bind one shadow texture.
+    class ShadowAtlas
+    {
+    public:
+        struct CreateParameters
+        {
+            int resolution = 8192;
+            int minTileSize = 64;
+            int maxTileSize = 2048;
+            nvrhi::Format format = nvrhi::Format::D32;
+            // Tile size for a light that covers the whole view height, before the importance factor
+            int fullScreenTileSize = 2048;
+            float nearPlane = 0.1f;
+            // Far plane for lights with infinite range
+            float defaultRange = 100.f;
+        };
+
+        // Optional callback that returns the importance of a light, which scales its tile size. Defaults to 1.
+        std::function<float(const engine::Light& light)> importanceCallback;
+
+    private:
+        struct LightEntry
+        {
+            std::shared_ptr<engine::Light> light;
+            std::shared_ptr<AtlasShadowMap> shadowMap;
+            std::vector<dm::int2> tiles;
+            int tileSize = 0;
+            int desiredTileSize = 0;
+            float priority = 0.f;
+            bool contentValid = false;
+            bool active = false;
+        };
+
+        nvrhi::DeviceHandle m_Device;
+        std::shared_ptr<engine::CommonRenderPasses> m_CommonPasses;
+        CreateParameters m_Params;
+        nvrhi::TextureHandle m_Texture;
+        uint32_t m_ArraySlice = 0;
+        // Only counts the texture when the atlas created it
+        memory::Tag m_MemoryTag = memory::Tag(memory::Category::GpuRenderTargets);
+        QuadTreeAllocator m_Allocator;
+        std::shared_ptr<engine::FramebufferFactory> m_FramebufferFactory;
+        nvrhi::GraphicsPipelineHandle m_ClearPso;
+        std::unordered_map<const engine::Light*, LightEntry> m_Lights;
+        uint32_t m_NumTilesRendered = 0;
+
+        void FreeTiles(LightEntry& entry);
+        void ClearTile(nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* framebuffer, const engine::IView& view);
+
+    public:
+        ShadowAtlas(
+            nvrhi::IDevice* device,
+            std::shared_ptr<engine::CommonRenderPasses> commonPasses,
+            const CreateParameters& params);
+
+        // Places the atlas on a slice of an existing texture array, which must be at least params.resolution wide and high.
+        ShadowAtlas(
+            nvrhi::IDevice* device,
+            std::shared_ptr<engine::CommonRenderPasses> commonPasses,
+            nvrhi::ITexture* texture,
+            uint32_t arraySlice,
+            const CreateParameters& params);
+
+        // Assigns atlas tiles to the spot and point lights from 'lights' that are visible in 'view' and sets up
+        // their shadow views. The light->shadowMap pointers of these lights are set to their atlas shadows,
+        // or reset if a light is not visible or did not fit into the atlas. Other light types are ignored.
+        // Tiles are allocated in the order of decreasing priority, and lights that don't fit get smaller tiles.
+        void Update(
+            const engine::IView& view,
+            const engine::SceneGraph& scene,
+            const std::vector<std::shared_ptr<engine::Light>>& lights);
+
+        // Renders the tiles whose contents are not valid anymore.
+        void RenderShadows(
+            nvrhi::ICommandList* commandList,
+            const std::shared_ptr<engine::SceneGraphNode>& rootNode,
+            IDrawStrategy& drawStrategy,
+            IGeometryPass& depthPass,
+            GeometryPassContext& passContext);
+
+        // Forces all tiles to be re-rendered, e.g. when the static geometry changes.
+        void InvalidateAll();
+
+        [[nodiscard]] nvrhi::ITexture* GetTexture() const { return m_Texture; }
+        [[nodiscard]] const QuadTreeAllocator& GetAllocator() const { return m_Allocator; }
+        [[nodiscard]] uint32_t GetNumShadowedLights() const;
+        [[nodiscard]] uint32_t GetNumTilesRendered() const { return m_NumTilesRendered; }
+        [[nodiscard]] const CreateParameters& GetParameters() const { return m_Params; }
+    };
+}
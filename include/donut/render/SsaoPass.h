@@ -33,6 +33,8 @@ namespace donut::engine
     class CommonRenderPasses;
     class FramebufferFactory;
     class ICompositeView;
+    class AsyncComputeScheduler;
+    struct AsyncComputeJob;
 }
 
 
@@ -64,6 +66,15 @@ namespace donut::render
         SubPass m_Compute;
         SubPass m_Blur;
 
+        // Textures of each binding set that the pass shares with the graphics work, used by ScheduleRender
+        struct BindingSetTextures
+        {
+            nvrhi::TextureHandle gbufferDepth;
+            nvrhi::TextureHandle gbufferNormals;
+            nvrhi::TextureHandle destinationTexture;
+        };
+        std::vector<BindingSetTextures> m_BindingSetTextures;
+
         nvrhi::DeviceHandle m_Device;
         nvrhi::BufferHandle m_ConstantBuffer;
 
@@ -108,5 +119,15 @@ namespace donut::render
             const SsaoParameters& params,
             const engine::ICompositeView& compositeView,
             int bindingSetIndex = 0);
+
+        // Renders the pass as a job on the async compute queue when the scheduler has it active.
+        // The depth and normals are handed over as shader resources and the destination as a UAV,
+        // see AsyncComputeScheduler for the states that the textures can keep.
+        engine::AsyncComputeJob ScheduleRender(
+            engine::AsyncComputeScheduler& scheduler,
+            nvrhi::ICommandList* commandList,
+            const SsaoParameters& params,
+            const engine::ICompositeView& compositeView,
+            int bindingSetIndex = 0);
     };
 }
\ No newline at end of file
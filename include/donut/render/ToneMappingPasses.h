@@ -32,6 +32,8 @@ namespace donut::engine
     class CommonRenderPasses;
     class FramebufferFactory;
     class ICompositeView;
+    class AsyncComputeScheduler;
+    struct AsyncComputeJob;
 }
 
 namespace donut::render
@@ -121,5 +123,14 @@ namespace donut::render
         void ResetHistogram(nvrhi::ICommandList* commandList);
         void AddFrameToHistogram(nvrhi::ICommandList* commandList, const engine::ICompositeView& compositeView, nvrhi::ITexture* sourceTexture);
         void ComputeExposure(nvrhi::ICommandList* commandList, const ToneMappingParameters& params);
+
+        // Builds the histogram and computes the exposure as a job on the async compute queue when the scheduler
+        // has it active. Render must only run after the scheduler waits for the job.
+        engine::AsyncComputeJob ScheduleExposureUpdate(
+            engine::AsyncComputeScheduler& scheduler,
+            nvrhi::ICommandList* commandList,
+            const ToneMappingParameters& params,
+            const engine::ICompositeView& compositeView,
+            nvrhi::ITexture* sourceTexture);
     };
 }
\ No newline at end of file
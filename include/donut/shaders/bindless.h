@@ -49,6 +49,7 @@ struct GeometryData
 };
 
 static const uint InstanceFlags_CurveDisjointOrthogonalTriangleStrips = 0x00000001u;
+static const uint InstanceFlags_HasPrevTransformDelta = 0x00000002u; // CompactInstanceData only
 
 struct InstanceData
 {
@@ -67,6 +68,29 @@ struct InstanceData
     bool IsCurveDOTS() { return (flags & InstanceFlags_CurveDisjointOrthogonalTriangleStrips) != 0; }
 };
 
+// Smaller version of InstanceData used by the raster passes when Scene::SetCompactInstanceData(true) is used.
+// The previous transform is only stored for instances that moved since the previous frame, as a delta
+// relative to the current transform, in a separate buffer of PrevTransformDelta structures.
+static const uint c_CompactInstanceFlagsShift = 24;
+static const uint c_CompactInstanceNumGeometriesMask = 0x00ffffffu;
+
+struct CompactInstanceData
+{
+    float3x4 transform;
+
+    uint firstGeometryInstanceIndex;
+    uint firstGeometryIndex;
+    uint flagsAndNumGeometries;      // flags in the high 8 bits, numGeometries in the low 24 bits
+    uint prevTransformDeltaIndex;    // valid if (flags & InstanceFlags_HasPrevTransformDelta) != 0
+};
+
+// (prevTransform - transform) stored as 12 half floats, row by row
+struct PrevTransformDelta
+{
+    uint4 packed0;
+    uint2 packed1;
+};
+
 #ifndef __cplusplus
 
 static const uint c_SizeOfTriangleIndices = 12;
@@ -80,6 +104,8 @@ static const uint c_SizeOfCurveRadius = 4;
 // Define the sizes of these structures because FXC doesn't support sizeof(x)
 static const uint c_SizeOfGeometryData = 4*16;
 static const uint c_SizeOfInstanceData = 7*16;
+static const uint c_SizeOfCompactInstanceData = 4*16;
+static const uint c_SizeOfPrevTransformDelta = 24;
 static const uint c_SizeOfMaterialConstants = 13*16;
 
 GeometryData LoadGeometryData(ByteAddressBuffer buffer, uint offset)
@@ -129,6 +155,55 @@ InstanceData LoadInstanceData(ByteAddressBuffer buffer, uint offset)
     return ret;
 }
 
+CompactInstanceData LoadCompactInstanceData(ByteAddressBuffer buffer, uint offset)
+{
+    uint4 a = buffer.Load4(offset + 16 * 0);
+    uint4 b = buffer.Load4(offset + 16 * 1);
+    uint4 c = buffer.Load4(offset + 16 * 2);
+    uint4 d = buffer.Load4(offset + 16 * 3);
+
+    CompactInstanceData ret;
+    ret.transform = float3x4(asfloat(a), asfloat(b), asfloat(c));
+    ret.firstGeometryInstanceIndex = d.x;
+    ret.firstGeometryIndex = d.y;
+    ret.flagsAndNumGeometries = d.z;
+    ret.prevTransformDeltaIndex = d.w;
+    return ret;
+}
+
+PrevTransformDelta LoadPrevTransformDelta(ByteAddressBuffer buffer, uint offset)
+{
+    PrevTransformDelta ret;
+    ret.packed0 = buffer.Load4(offset);
+    ret.packed1 = buffer.Load2(offset + 16);
+    return ret;
+}
+
+// Expands the compact instance data into the regular structure.
+// The previous transform is set to the current one, use ApplyPrevTransformDelta to reconstruct it if needed.
+InstanceData UnpackCompactInstanceData(CompactInstanceData compact)
+{
+    InstanceData ret;
+    ret.flags = compact.flagsAndNumGeometries >> c_CompactInstanceFlagsShift;
+    ret.firstGeometryInstanceIndex = compact.firstGeometryInstanceIndex;
+    ret.firstGeometryIndex = compact.firstGeometryIndex;
+    ret.numGeometries = compact.flagsAndNumGeometries & c_CompactInstanceNumGeometriesMask;
+    ret.transform = compact.transform;
+    ret.prevTransform = compact.transform;
+    return ret;
+}
+
+float3x4 ApplyPrevTransformDelta(float3x4 transform, PrevTransformDelta delta)
+{
+    uint4 a = delta.packed0;
+    uint2 b = delta.packed1;
+
+    return transform + float3x4(
+        f16tof32(a.x), f16tof32(a.x >> 16), f16tof32(a.y), f16tof32(a.y >> 16),
+        f16tof32(a.z), f16tof32(a.z >> 16), f16tof32(a.w), f16tof32(a.w >> 16),
+        f16tof32(b.x), f16tof32(b.x >> 16), f16tof32(b.y), f16tof32(b.y >> 16));
+}
+
 MaterialConstants LoadMaterialConstants(ByteAddressBuffer buffer, uint offset)
 {
     uint4 a = buffer.Load4(offset + 16 * 0);
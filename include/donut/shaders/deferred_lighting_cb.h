@@ -30,6 +30,25 @@
 #define DEFERRED_MAX_SHADOWS 16
 #define DEFERRED_MAX_LIGHT_PROBES 16
 
+// Values for the LIGHTING_MODE shader macro:
+// - constants: lights come from the DeferredLightingConstants structure, up to DEFERRED_MAX_LIGHTS
+// - clustered: lights come from a LightClusteringPass
+// - tiled: lights come from a structured buffer and are culled per tile in the shader
+#define DEFERRED_LIGHTING_MODE_CONSTANTS 0
+#define DEFERRED_LIGHTING_MODE_CLUSTERED 1
+#define DEFERRED_LIGHTING_MODE_TILED 2
+
+#define DEFERRED_TILE_SIZE 16
+#define DEFERRED_TILED_MAX_LIGHTS_PER_TILE 512
+
+// Clustered lighting resources, see LightClusteringPass
+#define DEFERRED_BINDING_LIGHT_CLUSTER_CONSTANTS 1
+#define DEFERRED_BINDING_CLUSTERED_LIGHTS 18
+
+// Tiled lighting resources
+#define DEFERRED_BINDING_TILED_LIGHTS 18
+#define DEFERRED_BINDING_TILED_SHADOWS 19
+
 struct DeferredLightingConstants
 {
     PlanarViewConstants view;
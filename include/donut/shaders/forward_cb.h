@@ -59,6 +59,14 @@
 #define FORWARD_BINDING_LIGHT_PROBE_SAMPLER 2
 #define FORWARD_BINDING_ENVIRONMENT_BRDF_SAMPLER 3
 
+// Clustered lighting resources, see LightClusteringPass
+#define FORWARD_SPACE_LIGHT_CLUSTERS 4
+#define FORWARD_BINDING_LIGHT_CLUSTER_CONSTANTS 4
+#define FORWARD_BINDING_CLUSTERED_LIGHTS 24
+#define FORWARD_BINDING_CLUSTERED_SHADOWS 25
+#define FORWARD_BINDING_LIGHT_CLUSTERS 26
+#define FORWARD_BINDING_LIGHT_CLUSTER_INDICES 27
+
 
 struct ForwardShadingViewConstants
 {
@@ -39,6 +39,7 @@
 #define GBUFFER_BINDING_PUSH_CONSTANTS 1
 #define GBUFFER_BINDING_INSTANCE_BUFFER 10
 #define GBUFFER_BINDING_VERTEX_BUFFER 11
+#define GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER 12
 
 #define GBUFFER_SPACE_VIEW 2
 #define GBUFFER_BINDING_VIEW_CONSTANTS 2
@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INSTANCE_CULLING_CB_H
+#define INSTANCE_CULLING_CB_H
+
+#define INSTANCE_CULLING_GROUP_SIZE 64
+
+#define INSTANCE_CULLING_FLAG_HIZ            0x01
+#define INSTANCE_CULLING_FLAG_REVERSE_DEPTH  0x02
+#define INSTANCE_CULLING_FLAG_COMPACT_INSTANCES 0x04
+
+#define DRAW_RECORD_FLAG_NEVER_CULL 0x01
+
+// One potential draw: a geometry of a mesh instance.
+// Records are grouped by bucket, i.e. by material, buffer group and cull mode.
+struct CullingDrawRecord
+{
+    float3 boundsMin;           // object space
+    uint instanceIndex;
+
+    float3 boundsMax;           // object space
+    uint bucketIndex;
+
+    uint indexCount;
+    uint startIndexLocation;
+    int baseVertexLocation;
+    uint firstDrawInBucket;     // index of the bucket's first DrawIndexedIndirectArguments in the argument buffer
+
+    uint flags;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+struct InstanceCullingConstants
+{
+    float4 frustumPlanes[6];    // xyz = outward normal, w = distance
+
+    float4x4 matWorldToClip;
+
+    float2 hizSize;
+    uint hizMipLevels;
+    uint numRecords;
+
+    uint flags;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+#endif // INSTANCE_CULLING_CB_H
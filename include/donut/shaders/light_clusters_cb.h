@@ -0,0 +1,50 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LIGHT_CLUSTERS_CB_H
+#define LIGHT_CLUSTERS_CB_H
+
+// Describes the froxel grid built by LightClusteringPass for one view.
+// The grid is made of screen-space tiles of 'tileSize' pixels and exponentially distributed depth slices.
+// The last depth slice extends to infinity.
+struct LightClusterConstants
+{
+    uint3       gridSize;
+    uint        numGlobalLights;    // lights [0, numGlobalLights) affect every cluster, e.g. directional lights
+
+    float2      viewportOrigin;
+    float       tileSizeInv;
+    float       depthSliceScale;    // slice = log2(viewDepth) * depthSliceScale + depthSliceBias
+
+    float       depthSliceBias;
+    uint        numLights;
+    uint2       padding;
+};
+
+// Cluster record: a range in the light index buffer
+struct LightCluster
+{
+    uint        offset;
+    uint        count;
+};
+
+#endif // LIGHT_CLUSTERS_CB_H
@@ -25,8 +25,10 @@
 
 struct PixelReadbackConstants
 {
-    int2    pixelPosition;
-    int2    dummy;
+    uint    pixelCount;
+    uint    dummy0;
+    uint    dummy1;
+    uint    dummy2;
 };
 
 #endif // PIXEL_READBACK_CB_H
\ No newline at end of file
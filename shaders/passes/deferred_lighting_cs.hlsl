@@ -55,6 +55,75 @@ Texture2D t_AmbientOcclusion : register(t17);
 
 RWTexture2D<float4> u_Output : register(u0);
 
+#if LIGHTING_MODE == DEFERRED_LIGHTING_MODE_CLUSTERED
+#include <donut/shaders/light_clusters.hlsli>
+
+cbuffer c_LightClusters : register(b1)
+{
+    LightClusterConstants g_LightClusters;
+};
+
+StructuredBuffer<LightConstants> t_ClusteredLights : register(t18);
+StructuredBuffer<ShadowConstants> t_ClusteredShadows : register(t19);
+StructuredBuffer<LightCluster> t_LightClusters : register(t20);
+StructuredBuffer<uint> t_LightClusterIndices : register(t21);
+
+ShadowConstants GetShadowConstants(int index)
+{
+    return t_ClusteredShadows[index];
+}
+#elif LIGHTING_MODE == DEFERRED_LIGHTING_MODE_TILED
+StructuredBuffer<LightConstants> t_Lights : register(t18);
+StructuredBuffer<ShadowConstants> t_Shadows : register(t19);
+
+ShadowConstants GetShadowConstants(int index)
+{
+    return t_Shadows[index];
+}
+
+groupshared uint s_TileMinDepth;
+groupshared uint s_TileMaxDepth;
+groupshared uint s_NumTileLights;
+groupshared uint s_TileLights[DEFERRED_TILED_MAX_LIGHTS_PER_TILE];
+
+// Maps floats to uints with the same ordering, including negative values
+uint FloatToOrderedUint(float value)
+{
+    uint bits = asuint(value);
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+float OrderedUintToFloat(uint value)
+{
+    return asfloat((value & 0x80000000) ? (value & 0x7fffffff) : ~value);
+}
+
+// Returns the view space point at 'viewDepth' on the line of sight through a pixel position
+float3 GetViewPositionAtDepth(float2 pixelPosition, float viewDepth)
+{
+    float3 a = ReconstructViewPosition(g_Deferred.view, pixelPosition, 0.5);
+    float3 b = ReconstructViewPosition(g_Deferred.view, pixelPosition, 1.0);
+    return lerp(a, b, (viewDepth - a.z) / (b.z - a.z));
+}
+
+bool IsLightInTile(LightConstants light, float3 tileMin, float3 tileMax)
+{
+    if (light.lightType == LightType_Directional || light.angularSizeOrInvRange <= 0)
+        return true;
+
+    float3 center = mul(float4(light.position, 1), g_Deferred.view.matWorldToView).xyz;
+    float radius = rcp(light.angularSizeOrInvRange) + light.radius;
+    float3 offset = clamp(center, tileMin, tileMax) - center;
+
+    return dot(offset, offset) <= radius * radius;
+}
+#else
+ShadowConstants GetShadowConstants(int index)
+{
+    return g_Deferred.shadows[index];
+}
+#endif
+
 float GetRandom(float2 pos)
 {
     int x = int(pos.x) & 3;
@@ -62,11 +131,81 @@ float GetRandom(float2 pos)
     return g_Deferred.noisePattern[y][x];
 }
 
-[numthreads(16, 16, 1)]
-void main(int2 i_globalIdx : SV_DispatchThreadID)
+void AccumulateLight(
+    LightConstants light,
+    MaterialSample surfaceMaterial,
+    float3 surfaceWorldPos,
+    float3 viewIncident,
+    int2 pixelPosition,
+    float2 sincos,
+    inout float3 diffuseTerm,
+    inout float3 specularTerm)
 {
-    if (any(i_globalIdx.xy >= int2(g_Deferred.view.viewportSize)))
+    float shadow = 1;
+
+    if ((light.shadowChannel.x & 0xfffffffc) == 0) // check that the channel is between 0 and 3
+    {
+        float4 channels = t_ShadowBuffer[pixelPosition];
+        shadow = channels[light.shadowChannel.x];
+    }
+
+    float2 combinedCascadeShadow = 0;
+
+    [loop]
+    for (int cascade = 0; cascade < 4; cascade++)
+    {
+        if (light.shadowCascades[cascade] >= 0)
+        {
+            float2 cascadeShadow = EvaluateShadowPoisson(t_ShadowMapArray, s_ShadowSamplerComparison, GetShadowConstants(light.shadowCascades[cascade]), surfaceWorldPos, sincos, 3.0);
+
+            combinedCascadeShadow = saturate(combinedCascadeShadow + cascadeShadow * (1.0001 - combinedCascadeShadow.y));
+
+            if (combinedCascadeShadow.y == 1)
+                break;
+        }
+        else
+            break;
+    }
+
+    combinedCascadeShadow.x += (1 - combinedCascadeShadow.y) * light.outOfBoundsShadow;
+
+    shadow *= combinedCascadeShadow.x;
+    
+    float objectShadow = 1;
+
+    [loop]
+    for (int object = 0; object < 4; object++)
+    {
+        if (light.perObjectShadows[object] >= 0)
+        {
+            float2 thisObjectShadow = EvaluateShadowPoisson(t_ShadowMapArray, s_ShadowSamplerComparison, GetShadowConstants(light.perObjectShadows[object]), surfaceWorldPos, sincos, 3.0);
+
+            objectShadow *= saturate(thisObjectShadow.x + (1 - thisObjectShadow.y));
+        }
+    }
+
+    shadow *= objectShadow;
+
+    float3 diffuseRadiance, specularRadiance;
+    ShadeSurface(light, surfaceMaterial, surfaceWorldPos, viewIncident, diffuseRadiance, specularRadiance);
+
+    diffuseTerm += (shadow.x * diffuseRadiance) * light.color;
+    specularTerm += (shadow.x * specularRadiance) * light.color;
+}
+
+[numthreads(DEFERRED_TILE_SIZE, DEFERRED_TILE_SIZE, 1)]
+void main(
+    int2 i_globalIdx : SV_DispatchThreadID,
+    int2 i_groupIdx : SV_GroupID,
+    uint i_threadIdx : SV_GroupIndex)
+{
+    bool isValidPixel = all(i_globalIdx.xy < int2(g_Deferred.view.viewportSize));
+
+#if LIGHTING_MODE != DEFERRED_LIGHTING_MODE_TILED
+    // The tiled version needs all threads of the group to reach the barriers
+    if (!isValidPixel)
         return;
+#endif
 
     int2 pixelPosition = i_globalIdx.xy + int2(g_Deferred.view.viewportOrigin);
 
@@ -86,62 +225,101 @@ void main(int2 i_globalIdx : SV_DispatchThreadID)
     float angle = GetRandom(i_globalIdx.xy + g_Deferred.randomOffset);
     float2 sincos = float2(sin(angle), cos(angle));
 
+#if LIGHTING_MODE == DEFERRED_LIGHTING_MODE_CLUSTERED
     [loop]
-    for (uint nLight = 0; nLight < g_Deferred.numLights; nLight++)
+    for (uint nLight = 0; nLight < g_LightClusters.numGlobalLights; nLight++)
     {
-        LightConstants light = g_Deferred.lights[nLight];
+        AccumulateLight(t_ClusteredLights[nLight], surfaceMaterial, surfaceWorldPos, viewIncident, pixelPosition, sincos, diffuseTerm, specularTerm);
+    }
 
-        float shadow = 1;
+    float viewDepth = mul(float4(surfaceWorldPos, 1), g_Deferred.view.matWorldToView).z;
+    LightCluster cluster = t_LightClusters[GetLightClusterIndex(g_LightClusters, float2(pixelPosition) + 0.5, viewDepth)];
 
-        if ((light.shadowChannel.x & 0xfffffffc) == 0) // check that the channel is between 0 and 3
-        {
-            float4 channels = t_ShadowBuffer[pixelPosition];
-            shadow = channels[light.shadowChannel.x];
-        }
+    [loop]
+    for (uint nClusterLight = 0; nClusterLight < cluster.count; nClusterLight++)
+    {
+        uint lightIndex = t_LightClusterIndices[cluster.offset + nClusterLight];
+        AccumulateLight(t_ClusteredLights[lightIndex], surfaceMaterial, surfaceWorldPos, viewIncident, pixelPosition, sincos, diffuseTerm, specularTerm);
+    }
+#elif LIGHTING_MODE == DEFERRED_LIGHTING_MODE_TILED
+    // Compute the view depth range of the tile
 
-        float2 combinedCascadeShadow = 0;
+    if (i_threadIdx == 0)
+    {
+        s_TileMinDepth = 0xffffffff;
+        s_TileMaxDepth = 0;
+        s_NumTileLights = 0;
+    }
 
-        [loop]
-        for (int cascade = 0; cascade < 4; cascade++)
-        {
-            if (light.shadowCascades[cascade] >= 0)
-            {
-                float2 cascadeShadow = EvaluateShadowPoisson(t_ShadowMapArray, s_ShadowSamplerComparison, g_Deferred.shadows[light.shadowCascades[cascade]], surfaceWorldPos, sincos, 3.0);
+    GroupMemoryBarrierWithGroupSync();
 
-                combinedCascadeShadow = saturate(combinedCascadeShadow + cascadeShadow * (1.0001 - combinedCascadeShadow.y));
+    float viewDepth = mul(float4(surfaceWorldPos, 1), g_Deferred.view.matWorldToView).z;
 
-                if (combinedCascadeShadow.y == 1)
-                    break;
-            }
-            else
-                break;
-        }
+    // Pixels at infinite depth (background with a reverse infinite projection) do not bound the tile
+    if (isValidPixel && !isinf(viewDepth) && !isnan(viewDepth))
+    {
+        uint orderedDepth = FloatToOrderedUint(viewDepth);
+        InterlockedMin(s_TileMinDepth, orderedDepth);
+        InterlockedMax(s_TileMaxDepth, orderedDepth);
+    }
 
-        combinedCascadeShadow.x += (1 - combinedCascadeShadow.y) * light.outOfBoundsShadow;
+    GroupMemoryBarrierWithGroupSync();
 
-        shadow *= combinedCascadeShadow.x;
-        
-        float objectShadow = 1;
+    // Cull the lights against the view space bounding box of the tile
+
+    if (s_TileMinDepth <= s_TileMaxDepth)
+    {
+        float tileMinDepth = OrderedUintToFloat(s_TileMinDepth);
+        float tileMaxDepth = OrderedUintToFloat(s_TileMaxDepth);
+
+        float2 tileOrigin = g_Deferred.view.viewportOrigin + float2(i_groupIdx * DEFERRED_TILE_SIZE);
+        float2 tileEnd = min(tileOrigin + DEFERRED_TILE_SIZE, g_Deferred.view.viewportOrigin + g_Deferred.view.viewportSize);
+
+        float3 tileMin = 1e30;
+        float3 tileMax = -1e30;
+
+        [unroll]
+        for (uint corner = 0; corner < 4; corner++)
+        {
+            float2 cornerPosition = float2((corner & 1) ? tileEnd.x : tileOrigin.x, (corner & 2) ? tileEnd.y : tileOrigin.y);
+            float3 nearPoint = GetViewPositionAtDepth(cornerPosition, tileMinDepth);
+            float3 farPoint = GetViewPositionAtDepth(cornerPosition, tileMaxDepth);
+            tileMin = min(tileMin, min(nearPoint, farPoint));
+            tileMax = max(tileMax, max(nearPoint, farPoint));
+        }
 
         [loop]
-        for (int object = 0; object < 4; object++)
+        for (uint nLight = i_threadIdx; nLight < g_Deferred.numLights; nLight += DEFERRED_TILE_SIZE * DEFERRED_TILE_SIZE)
         {
-            if (light.perObjectShadows[object] >= 0)
+            if (IsLightInTile(t_Lights[nLight], tileMin, tileMax))
             {
-                float2 thisObjectShadow = EvaluateShadowPoisson(t_ShadowMapArray, s_ShadowSamplerComparison, g_Deferred.shadows[light.perObjectShadows[object]], surfaceWorldPos, sincos, 3.0);
-
-                objectShadow *= saturate(thisObjectShadow.x + (1 - thisObjectShadow.y));
+                uint slot;
+                InterlockedAdd(s_NumTileLights, 1, slot);
+                if (slot < DEFERRED_TILED_MAX_LIGHTS_PER_TILE)
+                    s_TileLights[slot] = nLight;
             }
         }
+    }
 
-        shadow *= objectShadow;
+    GroupMemoryBarrierWithGroupSync();
 
-        float3 diffuseRadiance, specularRadiance;
-        ShadeSurface(light, surfaceMaterial, surfaceWorldPos, viewIncident, diffuseRadiance, specularRadiance);
+    if (!isValidPixel)
+        return;
+
+    uint numTileLights = min(s_NumTileLights, DEFERRED_TILED_MAX_LIGHTS_PER_TILE);
 
-        diffuseTerm += (shadow.x * diffuseRadiance) * light.color;
-        specularTerm += (shadow.x * specularRadiance) * light.color;
+    [loop]
+    for (uint nTileLight = 0; nTileLight < numTileLights; nTileLight++)
+    {
+        AccumulateLight(t_Lights[s_TileLights[nTileLight]], surfaceMaterial, surfaceWorldPos, viewIncident, pixelPosition, sincos, diffuseTerm, specularTerm);
+    }
+#else
+    [loop]
+    for (uint nLight = 0; nLight < g_Deferred.numLights; nLight++)
+    {
+        AccumulateLight(g_Deferred.lights[nLight], surfaceMaterial, surfaceWorldPos, viewIncident, pixelPosition, sincos, diffuseTerm, specularTerm);
     }
+#endif
 
     float ambientOcclusion = 1;
     if (g_Deferred.enableAmbientOcclusion != 0)
@@ -49,6 +49,8 @@ void input_assembler(
 // On DX12, using a structured buffer results in more optimal code being generated.
 #ifdef TARGET_D3D11
 ByteAddressBuffer t_Instances : REGISTER_SRV(DEPTH_BINDING_INSTANCE_BUFFER, DEPTH_SPACE_INPUT);
+#elif COMPACT_INSTANCE_DATA
+StructuredBuffer<CompactInstanceData> t_Instances : REGISTER_SRV(DEPTH_BINDING_INSTANCE_BUFFER, DEPTH_SPACE_INPUT);
 #else
 StructuredBuffer<InstanceData> t_Instances : REGISTER_SRV(DEPTH_BINDING_INSTANCE_BUFFER, DEPTH_SPACE_INPUT);
 #endif
@@ -68,7 +70,14 @@ void buffer_loads(
     i_instance += g_Push.startInstanceLocation;
     i_vertex += g_Push.startVertexLocation;
 
+#if COMPACT_INSTANCE_DATA
 #ifdef TARGET_D3D11
+    const CompactInstanceData compactInstance = LoadCompactInstanceData(t_Instances, i_instance * c_SizeOfCompactInstanceData);
+#else
+    const CompactInstanceData compactInstance = t_Instances[i_instance];
+#endif
+    const InstanceData instance = UnpackCompactInstanceData(compactInstance);
+#elif defined(TARGET_D3D11)
     const InstanceData instance = LoadInstanceData(t_Instances, i_instance * c_SizeOfInstanceData);
 #else
     const InstanceData instance = t_Instances[i_instance];
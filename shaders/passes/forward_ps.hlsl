@@ -59,6 +59,27 @@ SamplerState s_ShadowSampler          : REGISTER_SAMPLER(FORWARD_BINDING_SHADOW_
 SamplerState s_LightProbeSampler      : REGISTER_SAMPLER(FORWARD_BINDING_LIGHT_PROBE_SAMPLER,       FORWARD_SPACE_SHADING);
 SamplerState s_BrdfSampler            : REGISTER_SAMPLER(FORWARD_BINDING_ENVIRONMENT_BRDF_SAMPLER,  FORWARD_SPACE_SHADING);
 
+#if CLUSTERED_LIGHTING
+#include <donut/shaders/light_clusters.hlsli>
+
+DECLARE_CBUFFER(LightClusterConstants, g_LightClusters, FORWARD_BINDING_LIGHT_CLUSTER_CONSTANTS, FORWARD_SPACE_LIGHT_CLUSTERS);
+
+StructuredBuffer<LightConstants> t_ClusteredLights  : REGISTER_SRV(FORWARD_BINDING_CLUSTERED_LIGHTS,       FORWARD_SPACE_LIGHT_CLUSTERS);
+StructuredBuffer<ShadowConstants> t_ClusteredShadows: REGISTER_SRV(FORWARD_BINDING_CLUSTERED_SHADOWS,      FORWARD_SPACE_LIGHT_CLUSTERS);
+StructuredBuffer<LightCluster> t_LightClusters      : REGISTER_SRV(FORWARD_BINDING_LIGHT_CLUSTERS,         FORWARD_SPACE_LIGHT_CLUSTERS);
+StructuredBuffer<uint> t_LightClusterIndices        : REGISTER_SRV(FORWARD_BINDING_LIGHT_CLUSTER_INDICES,  FORWARD_SPACE_LIGHT_CLUSTERS);
+
+ShadowConstants GetShadowConstants(int index)
+{
+    return t_ClusteredShadows[index];
+}
+#else
+ShadowConstants GetShadowConstants(int index)
+{
+    return g_ForwardLight.shadows[index];
+}
+#endif
+
 float3 GetIncidentVector(float4 directionOrPosition, float3 surfacePos)
 {
     if (directionOrPosition.w > 0)
@@ -67,6 +88,53 @@ float3 GetIncidentVector(float4 directionOrPosition, float3 surfacePos)
         return directionOrPosition.xyz;
 }
 
+void AccumulateLight(
+    LightConstants light,
+    MaterialSample surfaceMaterial,
+    float3 surfaceWorldPos,
+    float3 viewIncident,
+    inout float3 diffuseTerm,
+    inout float3 specularTerm)
+{
+    float2 shadow = 0;
+    for (int cascade = 0; cascade < 4; cascade++)
+    {
+        if (light.shadowCascades[cascade] >= 0)
+        {
+            float2 cascadeShadow = EvaluateShadowGather16(t_ShadowMapArray, s_ShadowSampler, GetShadowConstants(light.shadowCascades[cascade]), surfaceWorldPos, g_ForwardLight.shadowMapTextureSize);
+
+            shadow = saturate(shadow + cascadeShadow * (1.0001 - shadow.y));
+
+            if (shadow.y == 1)
+                break;
+        }
+        else
+            break;
+    }
+
+    shadow.x += (1 - shadow.y) * light.outOfBoundsShadow;
+
+    float objectShadow = 1;
+
+    for (int object = 0; object < 4; object++)
+    {
+        if (light.perObjectShadows[object] >= 0)
+        {
+            float2 thisObjectShadow = EvaluateShadowGather16(t_ShadowMapArray, s_ShadowSampler, GetShadowConstants(light.perObjectShadows[object]), surfaceWorldPos, g_ForwardLight.shadowMapTextureSize);
+
+            objectShadow *= saturate(thisObjectShadow.x + (1 - thisObjectShadow.y));
+        }
+    }
+
+    shadow.x *= objectShadow;
+
+    float3 diffuseRadiance, specularRadiance;
+    ShadeSurface(light, surfaceMaterial, surfaceWorldPos, viewIncident, diffuseRadiance, specularRadiance);
+
+    diffuseTerm += (shadow.x * diffuseRadiance) * light.color;
+    specularTerm += (shadow.x * specularRadiance) * light.color;
+}
+
 void main(
     in float4 i_position : SV_Position,
     in SceneVertex i_vtx,
@@ -94,49 +162,29 @@ void main(
     float3 diffuseTerm = 0;
     float3 specularTerm = 0;
 
+#if CLUSTERED_LIGHTING
     [loop]
-    for(uint nLight = 0; nLight < g_ForwardLight.numLights; nLight++)
+    for (uint nLight = 0; nLight < g_LightClusters.numGlobalLights; nLight++)
     {
-        LightConstants light = g_ForwardLight.lights[nLight];
-
-        float2 shadow = 0;
-        for (int cascade = 0; cascade < 4; cascade++)
-        {
-            if (light.shadowCascades[cascade] >= 0)
-            {
-                float2 cascadeShadow = EvaluateShadowGather16(t_ShadowMapArray, s_ShadowSampler, g_ForwardLight.shadows[light.shadowCascades[cascade]], surfaceWorldPos, g_ForwardLight.shadowMapTextureSize);
-
-                shadow = saturate(shadow + cascadeShadow * (1.0001 - shadow.y));
-
-                if (shadow.y == 1)
-                    break;
-            }
-            else
-                break;
-        }
-
-        shadow.x += (1 - shadow.y) * light.outOfBoundsShadow;
-
-        float objectShadow = 1;
-
-        for (int object = 0; object < 4; object++)
-        {
-            if (light.perObjectShadows[object] >= 0)
-            {
-                float2 thisObjectShadow = EvaluateShadowGather16(t_ShadowMapArray, s_ShadowSampler, g_ForwardLight.shadows[light.perObjectShadows[object]], surfaceWorldPos, g_ForwardLight.shadowMapTextureSize);
-
-                objectShadow *= saturate(thisObjectShadow.x + (1 - thisObjectShadow.y));
-            }
-        }
-
-        shadow.x *= objectShadow;
+        AccumulateLight(t_ClusteredLights[nLight], surfaceMaterial, surfaceWorldPos, viewIncident, diffuseTerm, specularTerm);
+    }
 
-        float3 diffuseRadiance, specularRadiance;
-        ShadeSurface(light, surfaceMaterial, surfaceWorldPos, viewIncident, diffuseRadiance, specularRadiance);
+    float viewDepth = mul(float4(surfaceWorldPos, 1), g_ForwardView.view.matWorldToView).z;
+    LightCluster cluster = t_LightClusters[GetLightClusterIndex(g_LightClusters, i_position.xy, viewDepth)];
 
-        diffuseTerm += (shadow.x * diffuseRadiance) * light.color;
-        specularTerm += (shadow.x * specularRadiance) * light.color;
+    [loop]
+    for (uint nClusterLight = 0; nClusterLight < cluster.count; nClusterLight++)
+    {
+        uint lightIndex = t_LightClusterIndices[cluster.offset + nClusterLight];
+        AccumulateLight(t_ClusteredLights[lightIndex], surfaceMaterial, surfaceWorldPos, viewIncident, diffuseTerm, specularTerm);
+    }
+#else
+    [loop]
+    for(uint nLight = 0; nLight < g_ForwardLight.numLights; nLight++)
+    {
+        AccumulateLight(g_ForwardLight.lights[nLight], surfaceMaterial, surfaceWorldPos, viewIncident, diffuseTerm, specularTerm);
     }
+#endif
 
     float NdotV = saturate(-dot(surfaceMaterial.shadingNormal, viewIncident));
 
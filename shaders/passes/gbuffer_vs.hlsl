@@ -74,9 +74,18 @@ void input_assembler(
 // On DX12, using a structured buffer results in more optimal code being generated.
 #ifdef TARGET_D3D11
 ByteAddressBuffer t_Instances : REGISTER_SRV(GBUFFER_BINDING_INSTANCE_BUFFER, GBUFFER_SPACE_INPUT);
+#elif COMPACT_INSTANCE_DATA
+StructuredBuffer<CompactInstanceData> t_Instances : REGISTER_SRV(GBUFFER_BINDING_INSTANCE_BUFFER, GBUFFER_SPACE_INPUT);
 #else
 StructuredBuffer<InstanceData> t_Instances : REGISTER_SRV(GBUFFER_BINDING_INSTANCE_BUFFER, GBUFFER_SPACE_INPUT);
 #endif
+#if COMPACT_INSTANCE_DATA && MOTION_VECTORS
+#ifdef TARGET_D3D11
+ByteAddressBuffer t_PrevTransformDeltas : REGISTER_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER, GBUFFER_SPACE_INPUT);
+#else
+StructuredBuffer<PrevTransformDelta> t_PrevTransformDeltas : REGISTER_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER, GBUFFER_SPACE_INPUT);
+#endif
+#endif
 ByteAddressBuffer t_Vertices : REGISTER_SRV(GBUFFER_BINDING_VERTEX_BUFFER, GBUFFER_SPACE_INPUT);
 
 DECLARE_PUSH_CONSTANTS(GBufferPushConstants, g_Push, GBUFFER_BINDING_PUSH_CONSTANTS, GBUFFER_SPACE_INPUT);
@@ -98,7 +107,26 @@ void buffer_loads(
     i_instance += g_Push.startInstanceLocation;
     i_vertex += g_Push.startVertexLocation;
 
+#if COMPACT_INSTANCE_DATA
 #ifdef TARGET_D3D11
+    const CompactInstanceData compactInstance = LoadCompactInstanceData(t_Instances, i_instance * c_SizeOfCompactInstanceData);
+#else
+    const CompactInstanceData compactInstance = t_Instances[i_instance];
+#endif
+    InstanceData instance = UnpackCompactInstanceData(compactInstance);
+#if MOTION_VECTORS
+    if (instance.flags & InstanceFlags_HasPrevTransformDelta)
+    {
+#ifdef TARGET_D3D11
+        const PrevTransformDelta delta = LoadPrevTransformDelta(t_PrevTransformDeltas,
+            compactInstance.prevTransformDeltaIndex * c_SizeOfPrevTransformDelta);
+#else
+        const PrevTransformDelta delta = t_PrevTransformDeltas[compactInstance.prevTransformDeltaIndex];
+#endif
+        instance.prevTransform = ApplyPrevTransformDelta(instance.transform, delta);
+    }
+#endif
+#elif defined(TARGET_D3D11)
     const InstanceData instance = LoadInstanceData(t_Instances, i_instance * c_SizeOfInstanceData);
 #else
     const InstanceData instance = t_Instances[i_instance];
@@ -0,0 +1,158 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma pack_matrix(row_major)
+
+#include <donut/shaders/bindless.h>
+#include <donut/shaders/instance_culling_cb.h>
+
+cbuffer c_Culling : register(b0)
+{
+    InstanceCullingConstants g_Culling;
+};
+
+ByteAddressBuffer t_Instances : register(t0);
+StructuredBuffer<CullingDrawRecord> t_DrawRecords : register(t1);
+Texture2D<float> t_HiZ : register(t2);
+
+RWByteAddressBuffer u_DrawArguments : register(u0);
+RWByteAddressBuffer u_DrawCounts : register(u1);
+
+static const uint c_SizeOfDrawIndexedIndirectArguments = 20;
+
+float3x4 LoadInstanceTransform(uint instanceIndex)
+{
+    if (g_Culling.flags & INSTANCE_CULLING_FLAG_COMPACT_INSTANCES)
+        return LoadCompactInstanceData(t_Instances, instanceIndex * c_SizeOfCompactInstanceData).transform;
+
+    return LoadInstanceData(t_Instances, instanceIndex * c_SizeOfInstanceData).transform;
+}
+
+bool IsBoxInFrustum(float3 center, float3 extents)
+{
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        float4 plane = g_Culling.frustumPlanes[i];
+        if (dot(plane.xyz, center) - dot(abs(plane.xyz), extents) > plane.w)
+            return false;
+    }
+
+    return true;
+}
+
+bool IsBoxOccluded(float3 boxMin, float3 boxMax)
+{
+    bool reverseDepth = (g_Culling.flags & INSTANCE_CULLING_FLAG_REVERSE_DEPTH) != 0;
+
+    float2 uvMin = 1.0;
+    float2 uvMax = 0.0;
+    float nearestDepth = reverseDepth ? 0.0 : 1.0;
+
+    [unroll]
+    for (uint corner = 0; corner < 8; corner++)
+    {
+        float3 position = float3(
+            (corner & 1) ? boxMax.x : boxMin.x,
+            (corner & 2) ? boxMax.y : boxMin.y,
+            (corner & 4) ? boxMax.z : boxMin.z);
+
+        float4 clipPos = mul(float4(position, 1.0), g_Culling.matWorldToClip);
+
+        // The box crosses the near plane, treat it as visible
+        if (clipPos.w <= 0)
+            return false;
+
+        float3 ndc = clipPos.xyz / clipPos.w;
+        float2 uv = ndc.xy * float2(0.5, -0.5) + 0.5;
+
+        uvMin = min(uvMin, uv);
+        uvMax = max(uvMax, uv);
+        nearestDepth = reverseDepth ? max(nearestDepth, ndc.z) : min(nearestDepth, ndc.z);
+    }
+
+    uvMin = saturate(uvMin);
+    uvMax = saturate(uvMax);
+
+    // Pick the mip level where the projected rectangle covers at most 2x2 texels
+    float2 sizeInTexels = (uvMax - uvMin) * g_Culling.hizSize;
+    float mipLevel = ceil(log2(max(max(sizeInTexels.x, sizeInTexels.y), 1.0)));
+    uint mip = min(uint(mipLevel), g_Culling.hizMipLevels - 1);
+
+    float2 mipSize = max(floor(g_Culling.hizSize / float(1u << mip)), 1.0);
+    int2 texelMin = int2(uvMin * (mipSize - 1.0));
+    int2 texelMax = int2(uvMax * (mipSize - 1.0));
+
+    // The HiZ pyramid stores the farthest depth of each texel's footprint
+    float d0 = t_HiZ.Load(int3(texelMin.x, texelMin.y, mip));
+    float d1 = t_HiZ.Load(int3(texelMax.x, texelMin.y, mip));
+    float d2 = t_HiZ.Load(int3(texelMin.x, texelMax.y, mip));
+    float d3 = t_HiZ.Load(int3(texelMax.x, texelMax.y, mip));
+
+    if (reverseDepth)
+    {
+        float farthestOccluder = min(min(d0, d1), min(d2, d3));
+        return nearestDepth < farthestOccluder;
+    }
+    else
+    {
+        float farthestOccluder = max(max(d0, d1), max(d2, d3));
+        return nearestDepth > farthestOccluder;
+    }
+}
+
+[numthreads(INSTANCE_CULLING_GROUP_SIZE, 1, 1)]
+void main(in uint i_globalIdx : SV_DispatchThreadID)
+{
+    if (i_globalIdx >= g_Culling.numRecords)
+        return;
+
+    CullingDrawRecord record = t_DrawRecords[i_globalIdx];
+
+    if ((record.flags & DRAW_RECORD_FLAG_NEVER_CULL) == 0)
+    {
+        float3x4 transform = LoadInstanceTransform(record.instanceIndex);
+
+        float3 localCenter = (record.boundsMin + record.boundsMax) * 0.5;
+        float3 localExtents = (record.boundsMax - record.boundsMin) * 0.5;
+
+        float3 center = mul(transform, float4(localCenter, 1.0));
+        float3 extents = mul(abs((float3x3)transform), localExtents);
+
+        if (!IsBoxInFrustum(center, extents))
+            return;
+
+        if ((g_Culling.flags & INSTANCE_CULLING_FLAG_HIZ) && IsBoxOccluded(center - extents, center + extents))
+            return;
+    }
+
+    uint slot;
+    u_DrawCounts.InterlockedAdd(record.bucketIndex * 4, 1, slot);
+
+    uint offset = (record.firstDrawInBucket + slot) * c_SizeOfDrawIndexedIndirectArguments;
+    u_DrawArguments.Store4(offset, uint4(
+        record.indexCount,          // indexCount
+        1,                          // instanceCount
+        record.startIndexLocation,  // startIndexLocation
+        asuint(record.baseVertexLocation)));
+    u_DrawArguments.Store(offset + 16, record.instanceIndex); // startInstanceLocation
+}
@@ -32,10 +32,16 @@ Texture2DMS<TYPE> t_Source : register(t0);
 #else
 Texture2D<TYPE> t_Source : register(t0);
 #endif
+Buffer<uint2> t_Positions : register(t1);
 RWBuffer<TYPE> u_Dest : register(u0);
 
-[numthreads(1, 1, 1)]
-void main()
+#define GROUP_SIZE 64
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint i_globalIdx : SV_DispatchThreadID)
 {
-    u_Dest[0] = t_Source[g_PixelReadback.pixelPosition.xy];
+    if (i_globalIdx >= g_PixelReadback.pixelCount)
+        return;
+
+    u_Dest[i_globalIdx] = t_Source[t_Positions[i_globalIdx]];
 }
@@ -117,6 +117,10 @@ float3 BicubicSampleCatmullRom(Texture2D tex, SamplerState samp, float2 samplePo
 
 void Preload(int2 sharedID, int2 globalID)
 {
+	// The input view can be smaller than the texture, e.g. with dynamic resolution, so don't read
+	// the stale pixels outside of it
+	globalID = clamp(globalID, int2(g_TemporalAA.inputViewOrigin), int2(g_TemporalAA.inputViewOrigin + g_TemporalAA.inputViewSize) - 1);
+
 #if SAMPLE_COUNT == 1
 	float3 color = PQEncode(t_UnfilteredRT[globalID].rgb);
 	float2 motion = t_MotionVectors[globalID].rg;
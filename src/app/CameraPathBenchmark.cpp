@@ -0,0 +1,334 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/app/CameraPathBenchmark.h>
+#include <donut/app/Camera.h>
+#include <donut/engine/KeyframeAnimation.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/core/json.h>
+#include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+#include <cassert>
+
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::app;
+
+static const char* c_PositionTrack = "position";
+static const char* c_DirectionTrack = "direction";
+static const char* c_UpTrack = "up";
+
+CameraPath::CameraPath()
+{
+    CreateTracks();
+}
+
+void CameraPath::CreateTracks()
+{
+    m_Sequence = std::make_shared<animation::Sequence>();
+
+    auto createTrack = [this](const char* name)
+    {
+        auto track = std::make_shared<animation::Sampler>();
+        track->SetInterpolationMode(animation::InterpolationMode::CatmullRomSpline);
+        m_Sequence->AddTrack(name, track);
+        return track;
+    };
+
+    m_Position = createTrack(c_PositionTrack);
+    m_Direction = createTrack(c_DirectionTrack);
+    m_Up = createTrack(c_UpTrack);
+}
+
+void CameraPath::AddKeyframe(float time, const CameraPathSample& sample)
+{
+    animation::Keyframe keyframe;
+    keyframe.time = time;
+
+    keyframe.value = float4(sample.position, 0.f);
+    m_Position->AddKeyframe(keyframe);
+    keyframe.value = float4(sample.direction, 0.f);
+    m_Direction->AddKeyframe(keyframe);
+    keyframe.value = float4(sample.up, 0.f);
+    m_Up->AddKeyframe(keyframe);
+
+    m_Sequence->RecomputeDuration();
+}
+
+std::optional<CameraPathSample> CameraPath::Evaluate(float time) const
+{
+    std::optional<float4> position = m_Position->Evaluate(time, true);
+    std::optional<float4> direction = m_Direction->Evaluate(time, true);
+    std::optional<float4> up = m_Up->Evaluate(time, true);
+
+    if (!position.has_value() || !direction.has_value() || !up.has_value())
+        return std::nullopt;
+
+    CameraPathSample sample;
+    sample.position = position->xyz();
+    sample.direction = normalize(direction->xyz());
+    sample.up = normalize(up->xyz());
+    return sample;
+}
+
+float CameraPath::GetDuration() const
+{
+    return m_Sequence->GetDuration();
+}
+
+CameraPathSample CameraPath::GetCameraSample(const BaseCamera& camera)
+{
+    CameraPathSample sample;
+    sample.position = camera.GetPosition();
+    sample.direction = camera.GetDir();
+    sample.up = camera.GetUp();
+    return sample;
+}
+
+void CameraPath::BeginRecording(float keyframeInterval)
+{
+    CreateTracks();
+
+    m_Recording = true;
+    m_RecordingTime = 0.f;
+    m_LastKeyframeTime = 0.f;
+    m_KeyframeInterval = keyframeInterval;
+}
+
+void CameraPath::RecordCamera(float elapsedTime, const BaseCamera& camera)
+{
+    if (!m_Recording)
+        return;
+
+    bool firstKeyframe = m_Position->GetKeyframes().empty();
+    if (!firstKeyframe)
+        m_RecordingTime += elapsedTime;
+
+    m_LastRecordedSample = GetCameraSample(camera);
+
+    if (firstKeyframe || m_RecordingTime - m_LastKeyframeTime >= m_KeyframeInterval)
+    {
+        AddKeyframe(m_RecordingTime, m_LastRecordedSample);
+        m_LastKeyframeTime = m_RecordingTime;
+    }
+}
+
+void CameraPath::EndRecording()
+{
+    if (!m_Recording)
+        return;
+
+    // Keep the final pose even if it falls between keyframe intervals
+    if (!m_Position->GetKeyframes().empty() && m_RecordingTime > m_LastKeyframeTime)
+        AddKeyframe(m_RecordingTime, m_LastRecordedSample);
+
+    m_Recording = false;
+}
+
+bool CameraPath::Load(vfs::IFileSystem& fs, const std::filesystem::path& fileName)
+{
+    Json::Value root;
+    if (!json::LoadFromFile(fs, fileName, root))
+        return false;
+
+    auto sequence = std::make_shared<animation::Sequence>();
+    sequence->Load(root);
+
+    auto position = sequence->GetTrack(c_PositionTrack);
+    auto direction = sequence->GetTrack(c_DirectionTrack);
+    auto up = sequence->GetTrack(c_UpTrack);
+
+    if (!position || !direction || !up)
+    {
+        log::error("Camera path '%s' must contain the '%s', '%s' and '%s' tracks.",
+            fileName.generic_string().c_str(), c_PositionTrack, c_DirectionTrack, c_UpTrack);
+        return false;
+    }
+
+    m_Sequence = sequence;
+    m_Position = position;
+    m_Direction = direction;
+    m_Up = up;
+    m_Recording = false;
+
+    return true;
+}
+
+bool CameraPath::Save(const std::filesystem::path& fileName) const
+{
+    Json::Value root;
+    m_Sequence->Save(root);
+
+    vfs::NativeFileSystem fs;
+    return json::SaveToFile(fs, fileName, root);
+}
+
+void CameraPath::ApplyToCamera(const CameraPathSample& sample, FirstPersonCamera& camera)
+{
+    camera.LookTo(sample.position, sample.direction, sample.up);
+}
+
+void CameraPath::ApplyToSceneCamera(const CameraPathSample& sample, SceneCamera& camera)
+{
+    SceneGraphNode* node = camera.GetNode();
+    if (!node)
+        return;
+
+    // Same basis as BaseCamera::BaseLookAt
+    double3 dir = normalize(double3(sample.direction));
+    double3 right = normalize(cross(dir, double3(sample.up)));
+    double3 up = cross(right, dir);
+
+    // SceneCamera::GetViewToWorldMatrix flips Z on top of the node transform
+    daffine3 viewToWorld(right, up, dir, double3(sample.position));
+    daffine3 nodeToWorld = scaling(double3(1.0, 1.0, -1.0)) * viewToWorld;
+
+    daffine3 localTransform = nodeToWorld;
+    if (SceneGraphNode* parent = node->GetParent())
+        localTransform = nodeToWorld * inverse(parent->GetLocalToWorldTransform());
+
+    double3 translation;
+    dquat rotation;
+    decomposeAffine<double>(localTransform, &translation, &rotation, nullptr);
+    node->SetTransform(&translation, &rotation, nullptr);
+}
+
+CameraPathBenchmark::CameraPathBenchmark(nvrhi::IDevice* device, std::shared_ptr<CameraPath> path, const CameraPathBenchmarkParameters& params)
+    : m_Device(device)
+    , m_Path(std::move(path))
+    , m_Params(params)
+{
+    assert(m_Path);
+
+    m_Queries.resize(std::max(m_Params.maxFramesInFlight, 1u) + 1);
+    for (GpuQuery& query : m_Queries)
+        query.query = m_Device->createTimerQuery();
+}
+
+void CameraPathBenchmark::Start()
+{
+    Finish();
+
+    m_Results.Clear();
+    m_FrameCounter = 0;
+    m_Time = 0.0;
+    m_Running = true;
+    m_InFrame = false;
+}
+
+std::optional<CameraPathSample> CameraPathBenchmark::Advance()
+{
+    if (!m_Running)
+        return std::nullopt;
+
+    // The camera holds at the start of the path during warmup
+    if (!IsWarmingUp())
+    {
+        if (m_FrameCounter > m_Params.warmupFrames)
+            m_Time += m_Params.timeStep;
+
+        if (m_Time > double(m_Path->GetDuration()))
+        {
+            m_Running = false;
+            Finish();
+            return std::nullopt;
+        }
+    }
+
+    ++m_FrameCounter;
+
+    return m_Path->Evaluate(float(m_Time));
+}
+
+void CameraPathBenchmark::BeginFrame(nvrhi::ICommandList* commandList)
+{
+    m_CurrentQuery = nullptr;
+    m_InFrame = false;
+
+    // Advance() has already counted this frame, so the last warmup frame is excluded here
+    if (!m_Running || m_FrameCounter <= m_Params.warmupFrames)
+        return;
+
+    m_InFrame = true;
+    m_FrameStart = std::chrono::high_resolution_clock::now();
+
+    // Skip the GPU measurement rather than stall if the query from maxFramesInFlight frames ago is still pending
+    GpuQuery& query = m_Queries[m_NextQuery];
+    if (!query.pending)
+    {
+        m_NextQuery = (m_NextQuery + 1) % uint32_t(m_Queries.size());
+        m_Device->resetTimerQuery(query.query);
+        commandList->beginTimerQuery(query.query);
+        m_CurrentQuery = &query;
+    }
+}
+
+void CameraPathBenchmark::EndFrame(nvrhi::ICommandList* commandList)
+{
+    if (!m_InFrame)
+        return;
+
+    auto frameEnd = std::chrono::high_resolution_clock::now();
+
+    BenchmarkFrame frame;
+    frame.frameIndex = m_FrameCounter - m_Params.warmupFrames - 1;
+    frame.time = m_Time;
+    frame.cpuTimeMs = std::chrono::duration<double, std::milli>(frameEnd - m_FrameStart).count();
+    size_t resultIndex = m_Results.AddFrame(frame);
+
+    if (m_CurrentQuery)
+    {
+        commandList->endTimerQuery(m_CurrentQuery->query);
+        m_CurrentQuery->frameIndex = resultIndex;
+        m_CurrentQuery->pending = true;
+        m_CurrentQuery = nullptr;
+    }
+
+    m_InFrame = false;
+}
+
+void CameraPathBenchmark::ResolveQueries(bool wait)
+{
+    for (GpuQuery& query : m_Queries)
+    {
+        if (!query.pending)
+            continue;
+
+        if (!wait && !m_Device->pollTimerQuery(query.query))
+            continue;
+
+        // getTimerQueryTime waits for the query if it's not available yet
+        float seconds = m_Device->getTimerQueryTime(query.query);
+        m_Results.SetGpuTime(query.frameIndex, double(seconds) * 1000.0);
+        query.pending = false;
+    }
+}
+
+void CameraPathBenchmark::Poll()
+{
+    ResolveQueries(false);
+}
+
+void CameraPathBenchmark::Finish()
+{
+    ResolveQueries(true);
+}
@@ -49,9 +49,14 @@ freely, subject to the following restrictions:
 
 #include <donut/app/DeviceManager.h>
 #include <donut/core/math/math.h>
+#include <donut/core/json.h>
 #include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/engine/BenchmarkResults.h>
 #include <nvrhi/utils.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iomanip>
 #include <thread>
@@ -268,7 +273,55 @@ bool DeviceManager::CreateHeadlessDevice(const DeviceCreationParameters& params)
     if (!CreateInstance(m_DeviceParams))
         return false;
 
-    return CreateDevice();
+    if (!CreateDevice())
+        return false;
+
+    if (m_DeviceParams.headlessBackBuffers)
+    {
+        if (!CreateOffscreenBackBuffers())
+            return false;
+
+        BackBufferResized();
+    }
+
+    return true;
+}
+
+bool DeviceManager::CreateOffscreenBackBuffers()
+{
+    if (m_DeviceParams.backBufferWidth == 0 || m_DeviceParams.backBufferHeight == 0)
+    {
+        log::error("Cannot create headless back buffers of size %dx%d",
+            int(m_DeviceParams.backBufferWidth), int(m_DeviceParams.backBufferHeight));
+        return false;
+    }
+
+    nvrhi::TextureDesc desc;
+    desc.width = m_DeviceParams.backBufferWidth;
+    desc.height = m_DeviceParams.backBufferHeight;
+    desc.format = m_DeviceParams.swapChainFormat;
+    desc.sampleCount = m_DeviceParams.swapChainSampleCount;
+    desc.sampleQuality = m_DeviceParams.swapChainSampleQuality;
+    desc.isRenderTarget = true;
+    // Not the Present state: Vulkan devices without a swap chain have no present layout
+    desc.initialState = nvrhi::ResourceStates::ShaderResource;
+    desc.keepInitialState = true;
+
+    m_OffscreenBackBuffers.resize(std::max(m_DeviceParams.swapChainBufferCount, 1u));
+    for (uint32_t index = 0; index < uint32_t(m_OffscreenBackBuffers.size()); index++)
+    {
+        std::string debugName = "HeadlessBackBuffer[" + std::to_string(index) + "]";
+        desc.debugName = debugName;
+        m_OffscreenBackBuffers[index] = GetDevice()->createTexture(desc);
+        if (!m_OffscreenBackBuffers[index])
+        {
+            m_OffscreenBackBuffers.clear();
+            return false;
+        }
+    }
+
+    m_OffscreenBackBufferIndex = 0;
+    return true;
 }
 
 bool DeviceManager::CreateWindowDeviceAndSwapChain(const DeviceCreationParameters& params, const char *windowTitle)
@@ -529,6 +582,183 @@ void DeviceManager::RunMessageLoop()
 #endif
 }
 
+bool DeviceManager::RunHeadless(const HeadlessRunParameters& params)
+{
+    if (!m_DeviceParams.headlessDevice || m_OffscreenBackBuffers.empty())
+    {
+        log::error("RunHeadless requires a device created with CreateHeadlessDevice and headlessBackBuffers = true");
+        return false;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    auto toMilliseconds = [](Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+    nvrhi::IDevice* device = GetDevice();
+
+    // The frame's timer query starts and ends in separate command lists around the render passes,
+    // and the event query limits the number of frames in flight the way Present does.
+    struct FrameSlot
+    {
+        nvrhi::CommandListHandle beginCommandList;
+        nvrhi::CommandListHandle endCommandList;
+        nvrhi::TimerQueryHandle timerQuery;
+        nvrhi::EventQueryHandle eventQuery;
+        bool pending = false;
+        int64_t timingIndex = -1;
+    };
+
+    std::vector<FrameSlot> slots(std::max(m_DeviceParams.maxFramesInFlight, 1u));
+    for (FrameSlot& slot : slots)
+    {
+        slot.beginCommandList = device->createCommandList();
+        slot.endCommandList = device->createCommandList();
+        slot.timerQuery = device->createTimerQuery();
+        slot.eventQuery = device->createEventQuery();
+    }
+
+    auto retireSlot = [this, device](FrameSlot& slot)
+    {
+        if (!slot.pending)
+            return;
+
+        device->waitEventQuery(slot.eventQuery);
+        device->resetEventQuery(slot.eventQuery);
+
+        const double gpuTimeMs = double(device->getTimerQueryTime(slot.timerQuery)) * 1000.0;
+        device->resetTimerQuery(slot.timerQuery);
+
+        if (slot.timingIndex >= 0)
+            m_HeadlessFrameTimings[slot.timingIndex].gpuTimeMs = gpuTimeMs;
+
+        slot.pending = false;
+    };
+
+    m_HeadlessFrameTimings.clear();
+    m_HeadlessFrameTimings.reserve(params.numFrames);
+
+    const uint32_t totalFrames = params.warmupFrames + params.numFrames;
+    Clock::time_point previousFrameStart = Clock::now();
+
+    for (uint32_t frame = 0; frame < totalFrames; frame++)
+    {
+        const Clock::time_point frameStart = Clock::now();
+        if (!m_HeadlessFrameTimings.empty() && m_HeadlessFrameTimings.back().frameIndex + 1 == m_FrameIndex)
+            m_HeadlessFrameTimings.back().frameTimeMs = toMilliseconds(frameStart - previousFrameStart);
+        previousFrameStart = frameStart;
+
+        FrameSlot& slot = slots[frame % slots.size()];
+        const Clock::time_point waitStart = Clock::now();
+        retireSlot(slot);
+        const Clock::duration waitDuration = Clock::now() - waitStart;
+
+        if (m_callbacks.beforeFrame) m_callbacks.beforeFrame(*this, m_FrameIndex);
+
+        if (m_callbacks.beforeAnimate) m_callbacks.beforeAnimate(*this, m_FrameIndex);
+        Animate(params.timeStep);
+        if (m_callbacks.afterAnimate) m_callbacks.afterAnimate(*this, m_FrameIndex);
+
+        // Same frame numbering as AnimateRenderPresent
+        if (m_FrameIndex > 0 || !m_SkipRenderOnFirstFrame)
+        {
+            uint32_t frameIndex = m_FrameIndex;
+            if (m_SkipRenderOnFirstFrame)
+                frameIndex--;
+
+            slot.beginCommandList->open();
+            slot.beginCommandList->beginTimerQuery(slot.timerQuery);
+            slot.beginCommandList->close();
+            device->executeCommandList(slot.beginCommandList);
+
+            if (m_callbacks.beforeRender) m_callbacks.beforeRender(*this, frameIndex);
+            Render();
+            if (m_callbacks.afterRender) m_callbacks.afterRender(*this, frameIndex);
+
+            slot.endCommandList->open();
+            slot.endCommandList->endTimerQuery(slot.timerQuery);
+            slot.endCommandList->close();
+            device->executeCommandList(slot.endCommandList);
+            device->setEventQuery(slot.eventQuery, nvrhi::CommandQueue::Graphics);
+            slot.pending = true;
+
+            if (m_callbacks.beforePresent) m_callbacks.beforePresent(*this, frameIndex);
+            m_OffscreenBackBufferIndex = (m_OffscreenBackBufferIndex + 1) % uint32_t(m_OffscreenBackBuffers.size());
+            if (m_callbacks.afterPresent) m_callbacks.afterPresent(*this, frameIndex);
+        }
+
+        device->runGarbageCollection();
+
+        slot.timingIndex = -1;
+        if (frame >= params.warmupFrames)
+        {
+            HeadlessFrameTiming timing;
+            timing.frameIndex = m_FrameIndex;
+            timing.cpuTimeMs = toMilliseconds(Clock::now() - frameStart - waitDuration);
+            if (slot.pending)
+                slot.timingIndex = int64_t(m_HeadlessFrameTimings.size());
+            m_HeadlessFrameTimings.push_back(timing);
+        }
+
+        UpdateAverageFrameTime(toMilliseconds(Clock::now() - frameStart) * 1e-3);
+        ++m_FrameIndex;
+    }
+
+    if (!m_HeadlessFrameTimings.empty())
+        m_HeadlessFrameTimings.back().frameTimeMs = toMilliseconds(Clock::now() - previousFrameStart);
+
+    device->waitForIdle();
+    for (FrameSlot& slot : slots)
+        retireSlot(slot);
+
+    if (!params.resultsFileName.empty())
+        return WriteHeadlessResults(params);
+
+    return true;
+}
+
+bool DeviceManager::WriteHeadlessResults(const HeadlessRunParameters& params) const
+{
+    Json::Value root;
+    root["renderer"] = GetRendererString();
+    root["api"] = nvrhi::utils::GraphicsAPIToString(GetGraphicsAPI());
+    root["width"] = m_DeviceParams.backBufferWidth;
+    root["height"] = m_DeviceParams.backBufferHeight;
+    root["timeStep"] = params.timeStep;
+    root["warmupFrames"] = params.warmupFrames;
+
+    Json::Value& frames = root["frames"];
+    frames = Json::Value(Json::arrayValue);
+
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+    cpuTimes.reserve(m_HeadlessFrameTimings.size());
+    gpuTimes.reserve(m_HeadlessFrameTimings.size());
+
+    for (const HeadlessFrameTiming& timing : m_HeadlessFrameTimings)
+    {
+        Json::Value frame;
+        frame["frame"] = timing.frameIndex;
+        frame["cpuTimeMs"] = timing.cpuTimeMs;
+        frame["frameTimeMs"] = timing.frameTimeMs;
+        if (timing.gpuTimeMs >= 0.0)
+            frame["gpuTimeMs"] = timing.gpuTimeMs;
+        frames.append(frame);
+
+        cpuTimes.push_back(timing.cpuTimeMs);
+        if (timing.gpuTimeMs >= 0.0)
+            gpuTimes.push_back(timing.gpuTimeMs);
+    }
+
+    // Same statistics as the camera path benchmark results
+    if (!cpuTimes.empty())
+        engine::BenchmarkResults::WritePercentiles(root["summary"]["cpuTimeMs"], engine::BenchmarkResults::ComputePercentiles(std::move(cpuTimes)));
+
+    if (!gpuTimes.empty())
+        engine::BenchmarkResults::WritePercentiles(root["summary"]["gpuTimeMs"], engine::BenchmarkResults::ComputePercentiles(std::move(gpuTimes)));
+
+    vfs::NativeFileSystem fs;
+    return json::SaveToFile(fs, params.resultsFileName, root);
+}
+
 bool DeviceManager::AnimateRenderPresent()
 {
     double curTime = glfwGetTime();
@@ -863,6 +1093,7 @@ void DeviceManager::Shutdown()
 #endif
 
     m_SwapChainFramebuffers.clear();
+    m_OffscreenBackBuffers.clear();
 
     DestroyDeviceAndSwapChain();
 
@@ -896,7 +1127,8 @@ void DeviceManager::SetWindowTitle(const char* title)
     if (m_WindowTitle == title)
         return;
 
-    glfwSetWindowTitle(m_Window, title);
+    if (m_Window)
+        glfwSetWindowTitle(m_Window, title);
 
     m_WindowTitle = title;
 }
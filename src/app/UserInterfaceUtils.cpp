@@ -22,6 +22,8 @@
 
 #include <donut/app/UserInterfaceUtils.h>
 #include <donut/engine/SceneGraph.h>
+#include <donut/engine/Profiler.h>
+#include <donut/engine/MemoryReport.h>
 #include <donut/core/log.h>
 #include <donut/core/string_utils.h>
 
@@ -407,3 +409,137 @@ bool donut::app::AzimuthElevationSliders(math::double3& direction, bool negative
 
     return changed;
 }
+
+static void ProfilerScopeTable(const char* label, const std::vector<ProfilerScopeStats>& scopes)
+{
+    if (!ImGui::BeginTable(label, 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+        return;
+
+    ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Avg");
+    ImGui::TableSetupColumn("Min");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableSetupColumn("P95");
+    ImGui::TableSetupColumn("P99");
+    ImGui::TableHeadersRow();
+
+    for (const auto& scope : scopes)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Indent(float(scope.depth) * ImGui::GetStyle().IndentSpacing);
+        ImGui::TextUnformatted(scope.name.c_str());
+        ImGui::Unindent(float(scope.depth) * ImGui::GetStyle().IndentSpacing);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.avgMs);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.minMs);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.maxMs);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.p95Ms);
+        ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.p99Ms);
+    }
+
+    ImGui::EndTable();
+}
+
+void donut::app::ProfilerStats(engine::Profiler& profiler)
+{
+    bool enabled = profiler.IsEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled))
+        profiler.SetEnabled(enabled);
+
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+        profiler.ResetStats();
+
+    ImGui::SameLine();
+    if (profiler.IsCapturing())
+        ImGui::TextUnformatted("Capturing...");
+    else if (ImGui::Button("Capture 10 frames"))
+        profiler.BeginCapture(10, "profile.json");
+
+    if (ImGui::CollapsingHeader("GPU (ms)", ImGuiTreeNodeFlags_DefaultOpen))
+        ProfilerScopeTable("GPU", profiler.GetStats(true));
+
+    if (ImGui::CollapsingHeader("CPU (ms)", ImGuiTreeNodeFlags_DefaultOpen))
+        ProfilerScopeTable("CPU", profiler.GetStats(false));
+}
+
+void donut::app::MemoryStats(engine::MemoryReport& report)
+{
+    // Name of the snapshot to compare with, empty for none
+    static std::string diffSnapshotName;
+
+    if (ImGui::Button("Save snapshot"))
+    {
+        diffSnapshotName = "snapshot " + std::to_string(report.GetSnapshotNames().size() + 1);
+        report.SaveSnapshot(diffSnapshotName);
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Reset peaks"))
+        memory::ResetPeaks();
+
+    const std::vector<std::string> snapshotNames = report.GetSnapshotNames();
+    if (ImGui::BeginCombo("Compare with", diffSnapshotName.empty() ? "(none)" : diffSnapshotName.c_str()))
+    {
+        if (ImGui::Selectable("(none)", diffSnapshotName.empty()))
+            diffSnapshotName.clear();
+
+        for (const std::string& name : snapshotNames)
+        {
+            if (ImGui::Selectable(name.c_str(), name == diffSnapshotName))
+                diffSnapshotName = name;
+        }
+        ImGui::EndCombo();
+    }
+
+    const memory::Snapshot current = memory::GetSnapshot();
+    memory::Snapshot before;
+    const bool diff = !diffSnapshotName.empty() && report.GetSnapshot(diffSnapshotName, before);
+    const memory::Snapshot changes = memory::Diff(before, current);
+
+    if (!ImGui::BeginTable("Memory", diff ? 5 : 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit))
+        return;
+
+    ImGui::TableSetupColumn("Category", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Size");
+    ImGui::TableSetupColumn("Peak");
+    ImGui::TableSetupColumn("Allocs");
+    if (diff)
+        ImGui::TableSetupColumn("Change");
+    ImGui::TableHeadersRow();
+
+    for (bool gpu : { false, true })
+    {
+        for (size_t index = 0; index < memory::CategoryCount; index++)
+        {
+            const memory::Category category = memory::Category(index);
+            if (memory::IsGpuCategory(category) != gpu)
+                continue;
+
+            const memory::CategoryStats& stats = current[category];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(memory::GetCategoryName(category));
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(memory::FormatBytes(stats.bytes).c_str());
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(memory::FormatBytes(stats.peakBytes).c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)stats.allocations);
+            if (diff)
+            {
+                const int64_t change = changes[category].bytes;
+                ImGui::TableNextColumn(); ImGui::Text("%s%s", change > 0 ? "+" : "", memory::FormatBytes(change).c_str());
+            }
+        }
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(gpu ? "Total GPU" : "Total CPU");
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(memory::FormatBytes(current.GetTotalBytes(gpu)).c_str());
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+        if (diff)
+        {
+            const int64_t change = changes.GetTotalBytes(gpu);
+            ImGui::TableNextColumn(); ImGui::Text("%s%s", change > 0 ? "+" : "", memory::FormatBytes(change).c_str());
+        }
+    }
+
+    ImGui::EndTable();
+}
@@ -573,11 +573,17 @@ bool DeviceManager_DX12::BeginFrame()
 
 nvrhi::ITexture* DeviceManager_DX12::GetCurrentBackBuffer()
 {
+    if (!m_OffscreenBackBuffers.empty())
+        return m_OffscreenBackBuffers[m_OffscreenBackBufferIndex];
+
     return m_RhiSwapChainBuffers[m_SwapChain->GetCurrentBackBufferIndex()];
 }
 
 nvrhi::ITexture* DeviceManager_DX12::GetBackBuffer(uint32_t index)
 {
+    if (!m_OffscreenBackBuffers.empty())
+        return index < m_OffscreenBackBuffers.size() ? m_OffscreenBackBuffers[index].Get() : nullptr;
+
     if (index < m_RhiSwapChainBuffers.size())
         return m_RhiSwapChainBuffers[index];
     return nullptr;
@@ -585,11 +591,17 @@ nvrhi::ITexture* DeviceManager_DX12::GetBackBuffer(uint32_t index)
 
 uint32_t DeviceManager_DX12::GetCurrentBackBufferIndex()
 {
+    if (!m_OffscreenBackBuffers.empty())
+        return m_OffscreenBackBufferIndex;
+
     return m_SwapChain->GetCurrentBackBufferIndex();
 }
 
 uint32_t DeviceManager_DX12::GetBackBufferCount()
 {
+    if (!m_OffscreenBackBuffers.empty())
+        return uint32_t(m_OffscreenBackBuffers.size());
+
     return m_SwapChainDesc.BufferCount;
 }
 
@@ -38,6 +38,7 @@ this software is released into the Public Domain.
 #include <donut/core/vfs/VFS.h>
 #include <donut/core/log.h>
 #include <json/reader.h>
+#include <json/writer.h>
 
 using namespace donut::math;
 using namespace donut::vfs;
@@ -71,6 +72,22 @@ namespace donut::json
         return success;
     }
 
+    bool SaveToFile(IFileSystem& fs, const std::filesystem::path& jsonFileName, const Json::Value& documentRoot)
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        std::string text = Json::writeString(builder, documentRoot);
+        text += '\n';
+
+        if (!fs.writeFile(jsonFileName, text.data(), text.size()))
+        {
+            log::error("Couldn't write file %s", jsonFileName.generic_string().c_str());
+            return false;
+        }
+
+        return true;
+    }
+
     template<>
     std::string Read<std::string>(const Json::Value& node, const std::string& defaultValue)
     {
@@ -0,0 +1,262 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/core/memory_tracking.h>
+#include <atomic>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+namespace donut::memory
+{
+    struct CategoryCounters
+    {
+        std::atomic<int64_t> bytes = 0;
+        std::atomic<int64_t> peakBytes = 0;
+        std::atomic<int64_t> allocations = 0;
+    };
+
+    static std::array<CategoryCounters, CategoryCount> g_Counters;
+
+    static const char* const g_CategoryNames[] = {
+        "MeshData",
+        "TextureData",
+        "SceneGraph",
+        "FileBlobs",
+        "AnimationKeyframes",
+        "GpuMeshBuffers",
+        "GpuTextures",
+        "GpuRenderTargets",
+        "GpuSceneBuffers"
+    };
+
+    static_assert(std::size(g_CategoryNames) == CategoryCount, "Category names don't match the Category enum");
+
+    const char* GetCategoryName(Category category)
+    {
+        return size_t(category) < CategoryCount ? g_CategoryNames[size_t(category)] : "<invalid>";
+    }
+
+    bool IsGpuCategory(Category category)
+    {
+        return category >= Category::GpuMeshBuffers;
+    }
+
+    static void Add(Category category, int64_t bytes, int64_t allocations)
+    {
+        assert(size_t(category) < CategoryCount);
+        CategoryCounters& counters = g_Counters[size_t(category)];
+
+        const int64_t current = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        counters.allocations.fetch_add(allocations, std::memory_order_relaxed);
+
+        int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+            ;
+    }
+
+    void Allocate(Category category, size_t bytes)
+    {
+        Add(category, int64_t(bytes), 1);
+    }
+
+    void Free(Category category, size_t bytes)
+    {
+        Add(category, -int64_t(bytes), -1);
+    }
+
+    int64_t Snapshot::GetTotalBytes(bool gpu) const
+    {
+        int64_t total = 0;
+        for (size_t index = 0; index < CategoryCount; index++)
+        {
+            if (IsGpuCategory(Category(index)) == gpu)
+                total += categories[index].bytes;
+        }
+        return total;
+    }
+
+    Snapshot GetSnapshot()
+    {
+        Snapshot snapshot;
+        for (size_t index = 0; index < CategoryCount; index++)
+        {
+            CategoryStats& stats = snapshot.categories[index];
+            stats.bytes = g_Counters[index].bytes.load(std::memory_order_relaxed);
+            stats.peakBytes = g_Counters[index].peakBytes.load(std::memory_order_relaxed);
+            stats.allocations = g_Counters[index].allocations.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    void ResetPeaks()
+    {
+        for (CategoryCounters& counters : g_Counters)
+            counters.peakBytes.store(counters.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    Snapshot Diff(const Snapshot& before, const Snapshot& after)
+    {
+        Snapshot diff = after;
+        for (size_t index = 0; index < CategoryCount; index++)
+        {
+            diff.categories[index].bytes -= before.categories[index].bytes;
+            diff.categories[index].allocations -= before.categories[index].allocations;
+        }
+        return diff;
+    }
+
+    std::string FormatBytes(int64_t bytes)
+    {
+        static const char* const units[] = { "B", "KB", "MB", "GB", "TB" };
+
+        double value = double(bytes < 0 ? -bytes : bytes);
+        size_t unit = 0;
+        while (value >= 1024.0 && unit + 1 < std::size(units))
+        {
+            value /= 1024.0;
+            ++unit;
+        }
+
+        char buf[32];
+        if (unit == 0)
+            snprintf(buf, sizeof(buf), "%s%" PRId64 " B", bytes < 0 ? "-" : "", bytes < 0 ? -bytes : bytes);
+        else
+            snprintf(buf, sizeof(buf), "%s%.2f %s", bytes < 0 ? "-" : "", value, units[unit]);
+        return buf;
+    }
+
+    static std::string FormatTable(const Snapshot& snapshot, bool diff)
+    {
+        std::string result;
+        char buf[256];
+
+        snprintf(buf, sizeof(buf), "%-20s %14s %14s %12s\n", "Category", diff ? "Change" : "Size", "Peak", diff ? "Allocs +/-" : "Allocs");
+        result += buf;
+
+        for (bool gpu : { false, true })
+        {
+            for (size_t index = 0; index < CategoryCount; index++)
+            {
+                if (IsGpuCategory(Category(index)) != gpu)
+                    continue;
+
+                const CategoryStats& stats = snapshot.categories[index];
+                std::string bytes = FormatBytes(stats.bytes);
+                if (diff && stats.bytes > 0)
+                    bytes = "+" + bytes;
+
+                snprintf(buf, sizeof(buf), "%-20s %14s %14s %12" PRId64 "\n", g_CategoryNames[index],
+                    bytes.c_str(), FormatBytes(stats.peakBytes).c_str(), stats.allocations);
+                result += buf;
+            }
+
+            std::string total = FormatBytes(snapshot.GetTotalBytes(gpu));
+            if (diff && snapshot.GetTotalBytes(gpu) > 0)
+                total = "+" + total;
+
+            snprintf(buf, sizeof(buf), "%-20s %14s\n", gpu ? "Total GPU" : "Total CPU", total.c_str());
+            result += buf;
+        }
+
+        return result;
+    }
+
+    std::string FormatReport(const Snapshot& snapshot)
+    {
+        return FormatTable(snapshot, false);
+    }
+
+    std::string FormatDiff(const Snapshot& before, const Snapshot& after)
+    {
+        return FormatTable(Diff(before, after), true);
+    }
+
+    Tag::Tag(Category category, size_t bytes)
+        : m_Category(category)
+    {
+        Set(bytes);
+    }
+
+    Tag::Tag(const Tag& other)
+        : m_Category(other.m_Category)
+    {
+        Set(other.m_Bytes);
+    }
+
+    Tag::Tag(Tag&& other) noexcept
+        : m_Category(other.m_Category)
+        , m_Bytes(other.m_Bytes)
+    {
+        other.m_Bytes = 0;
+    }
+
+    Tag& Tag::operator=(const Tag& other)
+    {
+        if (this != &other)
+        {
+            Set(0);
+            m_Category = other.m_Category;
+            Set(other.m_Bytes);
+        }
+        return *this;
+    }
+
+    Tag& Tag::operator=(Tag&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Set(0);
+            m_Category = other.m_Category;
+            m_Bytes = other.m_Bytes;
+            other.m_Bytes = 0;
+        }
+        return *this;
+    }
+
+    Tag::~Tag()
+    {
+        Set(0);
+    }
+
+    void Tag::Set(size_t bytes)
+    {
+        if (bytes == m_Bytes)
+            return;
+
+        // A tag counts as one allocation while it has a non-zero size
+        const int64_t allocations = int64_t(bytes != 0) - int64_t(m_Bytes != 0);
+        Add(m_Category, int64_t(bytes) - int64_t(m_Bytes), allocations);
+        m_Bytes = bytes;
+    }
+
+    void Tag::SetCategory(Category category)
+    {
+        if (category == m_Category)
+            return;
+
+        const size_t bytes = m_Bytes;
+        Set(0);
+        m_Category = category;
+        Set(bytes);
+    }
+}
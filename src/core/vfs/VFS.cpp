@@ -39,9 +39,10 @@ extern "C" {
 
 using namespace donut::vfs;
 
-Blob::Blob(void* data, size_t size)
+Blob::Blob(void* data, size_t size, memory::Category category)
     : m_data(data)
     , m_size(size)
+    , m_MemoryTag(category, data ? size : 0)
 {
 
 }
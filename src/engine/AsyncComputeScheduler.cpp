@@ -0,0 +1,221 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/AsyncComputeScheduler.h>
+#include <donut/core/log.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace donut::engine;
+
+static bool IsComputeQueueState(nvrhi::ResourceStates state)
+{
+    const uint32_t graphicsOnlyStates = uint32_t(
+        nvrhi::ResourceStates::VertexBuffer |
+        nvrhi::ResourceStates::IndexBuffer |
+        nvrhi::ResourceStates::RenderTarget |
+        nvrhi::ResourceStates::DepthWrite |
+        nvrhi::ResourceStates::DepthRead |
+        nvrhi::ResourceStates::StreamOut |
+        nvrhi::ResourceStates::ResolveDest |
+        nvrhi::ResourceStates::ResolveSource |
+        nvrhi::ResourceStates::Present |
+        nvrhi::ResourceStates::ShadingRateSurface);
+
+    return state != nvrhi::ResourceStates::Unknown && (uint32_t(state) & graphicsOnlyStates) == 0;
+}
+
+AsyncComputeScheduler::AsyncComputeScheduler(nvrhi::IDevice* device, bool enableAsyncCompute)
+    : m_Device(device)
+    , m_Enabled(enableAsyncCompute)
+{
+    m_ComputeQueueSupported = m_Device->queryFeatureSupport(nvrhi::Feature::ComputeQueue);
+
+    if (enableAsyncCompute && !m_ComputeQueueSupported)
+        log::info("Async compute requested but the device has no compute queue, compute jobs will run on the graphics queue");
+}
+
+uint64_t AsyncComputeScheduler::SubmitGraphics(nvrhi::ICommandList* commandList)
+{
+    commandList->close();
+    const uint64_t instance = m_Device->executeCommandList(commandList, nvrhi::CommandQueue::Graphics);
+    commandList->open();
+
+    ++m_Stats.numGraphicsSubmissions;
+    return instance;
+}
+
+void AsyncComputeScheduler::RecordInline(nvrhi::ICommandList* commandList, const RecordFunc& record, const char* name)
+{
+    if (name)
+        commandList->beginMarker(name);
+
+    record(commandList);
+
+    if (name)
+        commandList->endMarker();
+
+    ++m_Stats.numInlineJobs;
+}
+
+AsyncComputeJob AsyncComputeScheduler::ScheduleCompute(nvrhi::ICommandList* commandList, const RecordFunc& record, const char* name,
+    const std::vector<AsyncComputeTextureHandoff>& sharedTextures, const std::vector<AsyncComputeBufferHandoff>& sharedBuffers)
+{
+    assert(commandList);
+
+    if (!IsAsyncComputeActive())
+    {
+        RecordInline(commandList, record, name);
+        return AsyncComputeJob();
+    }
+
+    // Every command list restores the kept initial states when it closes, so those resources cross the queues
+    // in their initial states, and the others in the listed states. Either must be valid on the compute queue.
+    PendingHandoff handoff;
+    std::vector<AsyncComputeTextureHandoff> textures;
+    std::vector<AsyncComputeBufferHandoff> buffers;
+
+    for (const AsyncComputeTextureHandoff& shared : sharedTextures)
+    {
+        const nvrhi::TextureDesc& desc = shared.texture->getDesc();
+        const nvrhi::ResourceStates state = desc.keepInitialState ? desc.initialState : shared.state;
+        if (!IsComputeQueueState(state))
+        {
+            log::error("Async compute job '%s' shares texture '%s' in a state that is not valid on the compute queue, "
+                "running the job on the graphics queue", name ? name : "", desc.debugName.c_str());
+            ++m_Stats.numRejectedJobs;
+            RecordInline(commandList, record, name);
+            return AsyncComputeJob();
+        }
+
+        textures.push_back({ shared.texture, state });
+        if (!desc.keepInitialState)
+            handoff.textures.push_back(textures.back());
+    }
+
+    for (const AsyncComputeBufferHandoff& shared : sharedBuffers)
+    {
+        const nvrhi::BufferDesc& desc = shared.buffer->getDesc();
+        const nvrhi::ResourceStates state = desc.keepInitialState ? desc.initialState : shared.state;
+        if (!IsComputeQueueState(state))
+        {
+            log::error("Async compute job '%s' shares buffer '%s' in a state that is not valid on the compute queue, "
+                "running the job on the graphics queue", name ? name : "", desc.debugName.c_str());
+            ++m_Stats.numRejectedJobs;
+            RecordInline(commandList, record, name);
+            return AsyncComputeJob();
+        }
+
+        buffers.push_back({ shared.buffer, state });
+        if (!desc.keepInitialState)
+            handoff.buffers.push_back(buffers.back());
+    }
+
+    if (!m_ComputeCommandList)
+    {
+        m_ComputeCommandList = m_Device->createCommandList(nvrhi::CommandListParameters()
+            .setEnableImmediateExecution(false)
+            .setQueueType(nvrhi::CommandQueue::Compute));
+    }
+
+    if (!textures.empty() || !buffers.empty())
+    {
+        for (const AsyncComputeTextureHandoff& shared : textures)
+            commandList->setTextureState(shared.texture, nvrhi::AllSubresources, shared.state);
+        for (const AsyncComputeBufferHandoff& shared : buffers)
+            commandList->setBufferState(shared.buffer, shared.state);
+        commandList->commitBarriers();
+    }
+
+    // The job reads the results of the graphics work recorded so far, so that work goes to the GPU first
+    const uint64_t graphicsInstance = SubmitGraphics(commandList);
+
+    m_ComputeCommandList->open();
+
+    for (const AsyncComputeTextureHandoff& shared : textures)
+        m_ComputeCommandList->beginTrackingTextureState(shared.texture, nvrhi::AllSubresources, shared.state);
+    for (const AsyncComputeBufferHandoff& shared : buffers)
+        m_ComputeCommandList->beginTrackingBufferState(shared.buffer, shared.state);
+
+    if (name)
+        m_ComputeCommandList->beginMarker(name);
+
+    record(m_ComputeCommandList);
+
+    if (name)
+        m_ComputeCommandList->endMarker();
+
+    // Leave the resources in the states that WaitForCompute tells the graphics command list about
+    if (!handoff.textures.empty() || !handoff.buffers.empty())
+    {
+        for (const AsyncComputeTextureHandoff& shared : handoff.textures)
+            m_ComputeCommandList->setTextureState(shared.texture, nvrhi::AllSubresources, shared.state);
+        for (const AsyncComputeBufferHandoff& shared : handoff.buffers)
+            m_ComputeCommandList->setBufferState(shared.buffer, shared.state);
+        m_ComputeCommandList->commitBarriers();
+    }
+
+    m_ComputeCommandList->close();
+
+    m_Device->queueWaitForCommandList(nvrhi::CommandQueue::Compute, nvrhi::CommandQueue::Graphics, graphicsInstance);
+
+    AsyncComputeJob job;
+    job.computeInstance = m_Device->executeCommandList(m_ComputeCommandList, nvrhi::CommandQueue::Compute);
+
+    if (!handoff.textures.empty() || !handoff.buffers.empty())
+    {
+        handoff.computeInstance = job.computeInstance;
+        m_PendingHandoffs.push_back(std::move(handoff));
+    }
+
+    ++m_Stats.numAsyncJobs;
+    return job;
+}
+
+void AsyncComputeScheduler::WaitForCompute(nvrhi::ICommandList* commandList, const AsyncComputeJob& job)
+{
+    // Instances increase monotonically on a queue, so waiting for a later job covers the earlier ones
+    if (!job.IsAsync() || job.computeInstance <= m_LastWaitedInstance)
+        return;
+
+    // Submit the graphics work recorded since the job was scheduled, it can overlap with the job
+    SubmitGraphics(commandList);
+
+    m_Device->queueWaitForCommandList(nvrhi::CommandQueue::Graphics, nvrhi::CommandQueue::Compute, job.computeInstance);
+    m_LastWaitedInstance = job.computeInstance;
+
+    // The reopened command list does not know the states that the covered jobs left their shared resources in
+    auto covered = std::stable_partition(m_PendingHandoffs.begin(), m_PendingHandoffs.end(),
+        [&job](const PendingHandoff& handoff) { return handoff.computeInstance > job.computeInstance; });
+
+    for (auto it = covered; it != m_PendingHandoffs.end(); ++it)
+    {
+        for (const AsyncComputeTextureHandoff& shared : it->textures)
+            commandList->beginTrackingTextureState(shared.texture, nvrhi::AllSubresources, shared.state);
+        for (const AsyncComputeBufferHandoff& shared : it->buffers)
+            commandList->beginTrackingBufferState(shared.buffer, shared.state);
+    }
+    m_PendingHandoffs.erase(covered, m_PendingHandoffs.end());
+
+    ++m_Stats.numCrossQueueWaits;
+}
@@ -0,0 +1,173 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/BenchmarkResults.h>
+#include <donut/core/json.h>
+#include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace donut::engine;
+
+size_t BenchmarkResults::AddFrame(const BenchmarkFrame& frame)
+{
+    m_Frames.push_back(frame);
+    return m_Frames.size() - 1;
+}
+
+void BenchmarkResults::SetGpuTime(size_t index, double gpuTimeMs)
+{
+    assert(index < m_Frames.size());
+    m_Frames[index].gpuTimeMs = gpuTimeMs;
+}
+
+BenchmarkPercentiles BenchmarkResults::ComputePercentiles(std::vector<double> values)
+{
+    BenchmarkPercentiles result;
+    if (values.empty())
+        return result;
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+
+    result.numSamples = uint32_t(values.size());
+    result.avg = sum / double(values.size());
+    result.min = values.front();
+    result.max = values.back();
+    result.p50 = GetSortedPercentile(values, 0.50);
+    result.p95 = GetSortedPercentile(values, 0.95);
+    result.p99 = GetSortedPercentile(values, 0.99);
+    return result;
+}
+
+static std::vector<BenchmarkHitch> FindHitches(const std::vector<BenchmarkFrame>& frames, bool gpu,
+    double medianMs, double threshold, uint32_t maxHitches)
+{
+    std::vector<BenchmarkHitch> hitches;
+    if (medianMs <= 0.0)
+        return hitches;
+
+    for (const BenchmarkFrame& frame : frames)
+    {
+        const double value = gpu ? frame.gpuTimeMs : frame.cpuTimeMs;
+        if (value < 0.0 || value < medianMs * threshold)
+            continue;
+
+        BenchmarkHitch& hitch = hitches.emplace_back();
+        hitch.frameIndex = frame.frameIndex;
+        hitch.time = frame.time;
+        hitch.valueMs = value;
+        hitch.ratio = value / medianMs;
+    }
+
+    std::sort(hitches.begin(), hitches.end(), [](const BenchmarkHitch& a, const BenchmarkHitch& b)
+    {
+        return a.valueMs > b.valueMs;
+    });
+
+    if (hitches.size() > maxHitches)
+        hitches.resize(maxHitches);
+
+    return hitches;
+}
+
+BenchmarkReport BenchmarkResults::Analyze() const
+{
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+    cpuTimes.reserve(m_Frames.size());
+    gpuTimes.reserve(m_Frames.size());
+
+    for (const BenchmarkFrame& frame : m_Frames)
+    {
+        cpuTimes.push_back(frame.cpuTimeMs);
+        if (frame.gpuTimeMs >= 0.0)
+            gpuTimes.push_back(frame.gpuTimeMs);
+    }
+
+    BenchmarkReport report;
+    report.cpu = ComputePercentiles(std::move(cpuTimes));
+    report.gpu = ComputePercentiles(std::move(gpuTimes));
+    report.cpuHitches = FindHitches(m_Frames, false, report.cpu.p50, hitchThreshold, maxHitches);
+    report.gpuHitches = FindHitches(m_Frames, true, report.gpu.p50, hitchThreshold, maxHitches);
+    return report;
+}
+
+void BenchmarkResults::WritePercentiles(Json::Value& node, const BenchmarkPercentiles& percentiles)
+{
+    node["samples"] = percentiles.numSamples;
+    node["avg"] = percentiles.avg;
+    node["min"] = percentiles.min;
+    node["max"] = percentiles.max;
+    node["p50"] = percentiles.p50;
+    node["p95"] = percentiles.p95;
+    node["p99"] = percentiles.p99;
+}
+
+static Json::Value HitchesToJson(const std::vector<BenchmarkHitch>& hitches)
+{
+    Json::Value node(Json::arrayValue);
+    for (const BenchmarkHitch& hitch : hitches)
+    {
+        Json::Value hitchNode;
+        hitchNode["frame"] = hitch.frameIndex;
+        hitchNode["time"] = hitch.time;
+        hitchNode["ms"] = hitch.valueMs;
+        hitchNode["ratio"] = hitch.ratio;
+        node.append(hitchNode);
+    }
+    return node;
+}
+
+bool BenchmarkResults::WriteJson(const std::filesystem::path& fileName, const std::string& name) const
+{
+    const BenchmarkReport report = Analyze();
+
+    Json::Value root;
+    root["name"] = name;
+    root["hitchThreshold"] = hitchThreshold;
+    WritePercentiles(root["cpuTimeMs"], report.cpu);
+    WritePercentiles(root["gpuTimeMs"], report.gpu);
+    root["cpuHitches"] = HitchesToJson(report.cpuHitches);
+    root["gpuHitches"] = HitchesToJson(report.gpuHitches);
+
+    Json::Value& framesNode = root["frames"];
+    framesNode = Json::Value(Json::arrayValue);
+    for (const BenchmarkFrame& frame : m_Frames)
+    {
+        Json::Value frameNode;
+        frameNode["frame"] = frame.frameIndex;
+        frameNode["time"] = frame.time;
+        frameNode["cpuTimeMs"] = frame.cpuTimeMs;
+        if (frame.gpuTimeMs >= 0.0)
+            frameNode["gpuTimeMs"] = frame.gpuTimeMs;
+        framesNode.append(frameNode);
+    }
+
+    vfs::NativeFileSystem fs;
+    return json::SaveToFile(fs, fileName, root);
+}
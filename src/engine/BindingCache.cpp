@@ -21,71 +21,171 @@
 */
 
 #include <donut/engine/BindingCache.h>
+#include <algorithm>
+#include <vector>
 
 using namespace donut::engine;
 
-nvrhi::BindingSetHandle BindingCache::GetCachedBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
+size_t BindingCache::GetHash(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
 {
     size_t hash = 0;
     nvrhi::hash_combine(hash, desc);
     nvrhi::hash_combine(hash, layout);
+    return hash;
+}
 
-    m_Mutex.lock_shared();
+nvrhi::IBindingSet* BindingCache::FindEntry(size_t hash, const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
+{
+    auto range = m_BindingSets.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry& entry = it->second;
+        if (entry.layout.Get() != layout)
+            continue;
+
+        const nvrhi::BindingSetDesc* entryDesc = entry.bindingSet->getDesc();
+        assert(entryDesc);
+        if (!entryDesc || !(*entryDesc == desc))
+            continue;
+
+        entry.lastUsedFrame.store(m_FrameIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        entry.lastUsedTick.store(m_UseTick.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        return entry.bindingSet;
+    }
+
+    return nullptr;
+}
 
-    nvrhi::BindingSetHandle result = nullptr;
-    auto it = m_BindingSets.find(hash);
-    if (it != m_BindingSets.end())
-        result = it->second;
+nvrhi::BindingSetHandle BindingCache::GetCachedBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
+{
+    size_t const hash = GetHash(desc, layout);
 
+    m_Mutex.lock_shared();
+    nvrhi::BindingSetHandle result = FindEntry(hash, desc, layout);
     m_Mutex.unlock_shared();
 
     if (result)
-    {
-        assert(result->getDesc());
-        assert(*result->getDesc() == desc);
-    }
+        m_Hits.fetch_add(1, std::memory_order_relaxed);
+    else
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
 
     return result;
 }
 
 nvrhi::BindingSetHandle BindingCache::GetOrCreateBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
 {
-    size_t hash = 0;
-    nvrhi::hash_combine(hash, desc);
-    nvrhi::hash_combine(hash, layout);
+    size_t const hash = GetHash(desc, layout);
 
     m_Mutex.lock_shared();
-
-    nvrhi::BindingSetHandle result;
-    auto it = m_BindingSets.find(hash);
-    if (it != m_BindingSets.end())
-        result = it->second;
-    
+    nvrhi::BindingSetHandle result = FindEntry(hash, desc, layout);
     m_Mutex.unlock_shared();
 
-    if (!result)
+    if (result)
     {
-        m_Mutex.lock();
+        m_Hits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    m_Mutex.lock();
 
-        nvrhi::BindingSetHandle& entry = m_BindingSets[hash];
-        if (!entry)
+    // Another thread may have created the same binding set while the lock was released
+    result = FindEntry(hash, desc, layout);
+    if (result)
+    {
+        m_Hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+
+        result = m_Device->createBindingSet(desc, layout);
+        if (result)
         {
-            result = m_Device->createBindingSet(desc, layout);
-            entry = result;
+            if (m_Capacity != 0 && m_BindingSets.size() >= m_Capacity)
+                EvictLeastRecentlyUsed();
+
+            m_BindingSets.emplace(std::piecewise_construct,
+                std::forward_as_tuple(hash),
+                std::forward_as_tuple(result, layout, m_FrameIndex.load(std::memory_order_relaxed),
+                    m_UseTick.fetch_add(1, std::memory_order_relaxed)));
         }
-        else
-            result = entry;
+    }
+
+    m_Mutex.unlock();
 
-        m_Mutex.unlock();
+    return result;
+}
+
+void BindingCache::EvictLeastRecentlyUsed()
+{
+    if (m_BindingSets.empty())
+        return;
+
+    // Evict a batch of entries at once to amortize the cost of finding the oldest ones
+    size_t const targetSize = m_Capacity - std::max<size_t>(m_Capacity / 8, 1);
+    if (m_BindingSets.size() <= targetSize)
+        return;
+    size_t const numToEvict = m_BindingSets.size() - targetSize;
+
+    std::vector<uint64_t> lastUsedTicks;
+    lastUsedTicks.reserve(m_BindingSets.size());
+    for (const auto& it : m_BindingSets)
+        lastUsedTicks.push_back(it.second.lastUsedTick.load(std::memory_order_relaxed));
+
+    // Find the use threshold such that at least numToEvict entries are not newer than it
+    std::nth_element(lastUsedTicks.begin(), lastUsedTicks.begin() + (numToEvict - 1), lastUsedTicks.end());
+    uint64_t const threshold = lastUsedTicks[numToEvict - 1];
+
+    size_t evicted = 0;
+    for (auto it = m_BindingSets.begin(); it != m_BindingSets.end() && evicted < numToEvict; )
+    {
+        if (it->second.lastUsedTick.load(std::memory_order_relaxed) <= threshold)
+        {
+            it = m_BindingSets.erase(it);
+            ++evicted;
+        }
+        else
+            ++it;
     }
 
-    if (result)
+    m_Evictions.fetch_add(evicted, std::memory_order_relaxed);
+}
+
+void BindingCache::SetCapacity(size_t maxEntries)
+{
+    m_Mutex.lock();
+
+    m_Capacity = maxEntries;
+    while (m_Capacity != 0 && m_BindingSets.size() > m_Capacity)
+        EvictLeastRecentlyUsed();
+
+    m_Mutex.unlock();
+}
+
+void BindingCache::BeginFrame()
+{
+    uint64_t const frameIndex = m_FrameIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (m_MaxUnusedFrames == 0)
+        return;
+
+    m_Mutex.lock();
+
+    size_t evicted = 0;
+    for (auto it = m_BindingSets.begin(); it != m_BindingSets.end(); )
     {
-        assert(result->getDesc());
-        assert(*result->getDesc() == desc);
+        if (it->second.lastUsedFrame.load(std::memory_order_relaxed) + m_MaxUnusedFrames < frameIndex)
+        {
+            it = m_BindingSets.erase(it);
+            ++evicted;
+        }
+        else
+            ++it;
     }
 
-    return result;
+    m_Mutex.unlock();
+
+    m_Evictions.fetch_add(evicted, std::memory_order_relaxed);
 }
 
 void BindingCache::Clear()
@@ -94,3 +194,24 @@ void BindingCache::Clear()
     m_BindingSets.clear();
     m_Mutex.unlock();
 }
+
+BindingCacheStats BindingCache::GetStats() const
+{
+    BindingCacheStats stats;
+    stats.hits = m_Hits.load(std::memory_order_relaxed);
+    stats.misses = m_Misses.load(std::memory_order_relaxed);
+    stats.evictions = m_Evictions.load(std::memory_order_relaxed);
+
+    m_Mutex.lock_shared();
+    stats.size = m_BindingSets.size();
+    m_Mutex.unlock_shared();
+
+    return stats;
+}
+
+void BindingCache::ResetStats()
+{
+    m_Hits = 0;
+    m_Misses = 0;
+    m_Evictions = 0;
+}
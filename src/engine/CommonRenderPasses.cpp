@@ -188,6 +188,48 @@ static bool IsTextureArray(nvrhi::TextureDimension dimension)
         || dimension == nvrhi::TextureDimension::TextureCubeArray;
 }
 
+nvrhi::IShader* CommonRenderPasses::GetBlitShader(BlitSampler sampler, bool textureArray) const
+{
+    switch(sampler)
+    {
+    case BlitSampler::Point:
+    case BlitSampler::Linear: return textureArray ? m_BlitArrayPS : m_BlitPS;
+    case BlitSampler::Sharpen: return textureArray ? m_SharpenArrayPS : m_SharpenPS;
+    default: assert(false); return nullptr;
+    }
+}
+
+nvrhi::IGraphicsPipeline* CommonRenderPasses::GetOrCreateBlitPipeline(nvrhi::IFramebuffer* targetFramebuffer, nvrhi::IShader* shader,
+    const nvrhi::BlendState::RenderTarget& blendState)
+{
+    std::lock_guard<std::mutex> lockGuard(m_BlitPsoMutex);
+
+    nvrhi::GraphicsPipelineHandle& pso = m_BlitPsoCache[PsoCacheKey{ targetFramebuffer->getFramebufferInfo(), shader, blendState }];
+    if (!pso)
+    {
+        nvrhi::GraphicsPipelineDesc psoDesc;
+        psoDesc.bindingLayouts = { m_BlitBindingLayout };
+        psoDesc.VS = m_RectVS;
+        psoDesc.PS = shader;
+        psoDesc.primType = nvrhi::PrimitiveType::TriangleStrip;
+        psoDesc.renderState.rasterState.setCullNone();
+        psoDesc.renderState.depthStencilState.depthTestEnable = false;
+        psoDesc.renderState.depthStencilState.stencilEnable = false;
+        psoDesc.renderState.blendState.targets[0] = blendState;
+
+        pso = m_Device->createGraphicsPipeline(psoDesc, targetFramebuffer);
+    }
+
+    return pso;
+}
+
+void CommonRenderPasses::PrecreateBlitPipeline(nvrhi::IFramebuffer* targetFramebuffer, BlitSampler sampler,
+    bool sourceIsTextureArray, const nvrhi::BlendState::RenderTarget& blendState)
+{
+    assert(targetFramebuffer);
+    GetOrCreateBlitPipeline(targetFramebuffer, GetBlitShader(sampler, sourceIsTextureArray), blendState);
+}
+
 void CommonRenderPasses::BlitTexture(nvrhi::ICommandList* commandList, const BlitParameters& params, BindingCache* bindingCache)
 {
     assert(commandList);
@@ -212,30 +254,8 @@ void CommonRenderPasses::BlitTexture(nvrhi::ICommandList* commandList, const Bli
         targetViewport = nvrhi::Viewport(float(fbinfo.width), float(fbinfo.height));
     }
 
-    nvrhi::IShader* shader = nullptr;
-    switch(params.sampler)
-    {
-    case BlitSampler::Point:
-    case BlitSampler::Linear: shader = isTextureArray ? m_BlitArrayPS : m_BlitPS; break;
-    case BlitSampler::Sharpen: shader = isTextureArray ? m_SharpenArrayPS : m_SharpenPS; break;
-    default: assert(false);
-    }
-    
-    nvrhi::GraphicsPipelineHandle& pso = m_BlitPsoCache[PsoCacheKey{ fbinfo, shader, params.blendState }];
-    if (!pso)
-    {
-        nvrhi::GraphicsPipelineDesc psoDesc;
-        psoDesc.bindingLayouts = { m_BlitBindingLayout };
-        psoDesc.VS = m_RectVS;
-        psoDesc.PS = shader;
-        psoDesc.primType = nvrhi::PrimitiveType::TriangleStrip;
-        psoDesc.renderState.rasterState.setCullNone();
-        psoDesc.renderState.depthStencilState.depthTestEnable = false;
-        psoDesc.renderState.depthStencilState.stencilEnable = false;
-        psoDesc.renderState.blendState.targets[0] = params.blendState;
-
-        pso = m_Device->createGraphicsPipeline(psoDesc, params.targetFramebuffer);
-    }
+    nvrhi::IShader* shader = GetBlitShader(params.sampler, isTextureArray);
+    nvrhi::IGraphicsPipeline* pso = GetOrCreateBlitPipeline(params.targetFramebuffer, shader, params.blendState);
     
     nvrhi::BindingSetDesc bindingSetDesc;
     {
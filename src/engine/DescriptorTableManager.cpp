@@ -63,49 +63,70 @@ donut::engine::DescriptorTableManager::DescriptorTableManager(nvrhi::IDevice* de
     m_DescriptorTable = m_Device->createDescriptorTable(layout);
 
     size_t capacity = m_DescriptorTable->getCapacity();
-    m_AllocatedDescriptors.resize(capacity);
+    m_ReferenceCounts.resize(capacity, 0);
+    m_WritePending.resize(capacity, false);
     m_Descriptors.resize(capacity);
     memset(m_Descriptors.data(), 0, sizeof(nvrhi::BindingSetItem) * capacity);
+
+    // Push the slots in reverse order so that the lowest indices are allocated first
+    m_FreeList.reserve(capacity);
+    for (size_t index = capacity; index > 0; index--)
+        m_FreeList.push_back(DescriptorIndex(index - 1));
 }
 
-donut::engine::DescriptorIndex donut::engine::DescriptorTableManager::CreateDescriptor(nvrhi::BindingSetItem item)
+void donut::engine::DescriptorTableManager::Grow()
 {
-    const auto& found = m_DescriptorIndexMap.find(item);
-    if (found != m_DescriptorIndexMap.end())
-        return found->second;
-
     uint32_t capacity = m_DescriptorTable->getCapacity();
-    bool foundFreeSlot = false;
-    uint32_t index = 0;
-    for (index = m_SearchStart; index < capacity; index++)
+    uint32_t newCapacity = std::max(64u, capacity * 2); // handle the initial case when capacity == 0
+    m_Device->resizeDescriptorTable(m_DescriptorTable, newCapacity);
+    m_ReferenceCounts.resize(newCapacity, 0);
+    m_WritePending.resize(newCapacity, false);
+    m_Descriptors.resize(newCapacity);
+
+    // zero-fill the new descriptors
+    memset(&m_Descriptors[capacity], 0, sizeof(nvrhi::BindingSetItem) * (newCapacity - capacity));
+
+    for (uint32_t index = newCapacity; index > capacity; index--)
+        m_FreeList.push_back(DescriptorIndex(index - 1));
+}
+
+void donut::engine::DescriptorTableManager::WriteDescriptor(DescriptorIndex index)
+{
+    if (!m_BatchedWrites)
     {
-        if (!m_AllocatedDescriptors[index])
-        {
-            foundFreeSlot = true;
-            break;
-        }
+        m_Device->writeDescriptorTable(m_DescriptorTable, m_Descriptors[index]);
+        return;
     }
 
-    if (!foundFreeSlot)
+    if (!m_WritePending[index])
     {
-        uint32_t newCapacity = std::max(64u, capacity * 2); // handle the initial case when capacity == 0
-        m_Device->resizeDescriptorTable(m_DescriptorTable, newCapacity);
-        m_AllocatedDescriptors.resize(newCapacity);
-        m_Descriptors.resize(newCapacity);
-
-        // zero-fill the new descriptors
-        memset(&m_Descriptors[capacity], 0, sizeof(nvrhi::BindingSetItem) * (newCapacity - capacity));
-        
-        index = capacity;
-        capacity = newCapacity;
+        m_WritePending[index] = true;
+        m_PendingWrites.push_back(index);
     }
+}
+
+donut::engine::DescriptorIndex donut::engine::DescriptorTableManager::CreateDescriptor(nvrhi::BindingSetItem item)
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    const auto& found = m_DescriptorIndexMap.find(item);
+    if (found != m_DescriptorIndexMap.end())
+    {
+        ++m_ReferenceCounts[found->second];
+        return found->second;
+    }
+
+    if (m_FreeList.empty())
+        Grow();
+
+    DescriptorIndex index = m_FreeList.back();
+    m_FreeList.pop_back();
 
     item.slot = index;
-    m_SearchStart = index + 1;
-    m_AllocatedDescriptors[index] = true;
+    m_ReferenceCounts[index] = 1;
     m_Descriptors[index] = item;
     m_DescriptorIndexMap[item] = index;
-    m_Device->writeDescriptorTable(m_DescriptorTable, item);
+    WriteDescriptor(index);
 
     if (item.resourceHandle)
         item.resourceHandle->AddRef();
@@ -121,6 +142,8 @@ donut::engine::DescriptorHandle donut::engine::DescriptorTableManager::CreateDes
 
 nvrhi::BindingSetItem donut::engine::DescriptorTableManager::GetDescriptor(DescriptorIndex index)
 {
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
     if (size_t(index) >= m_Descriptors.size())
         return nvrhi::BindingSetItem::None(0);
 
@@ -129,6 +152,13 @@ nvrhi::BindingSetItem donut::engine::DescriptorTableManager::GetDescriptor(Descr
 
 void donut::engine::DescriptorTableManager::ReleaseDescriptor(DescriptorIndex index)
 {
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    assert(size_t(index) < m_ReferenceCounts.size());
+    assert(m_ReferenceCounts[index] > 0);
+    if (m_ReferenceCounts[index] == 0 || --m_ReferenceCounts[index] > 0)
+        return;
+
     nvrhi::BindingSetItem& descriptor = m_Descriptors[index];
 
     if (descriptor.resourceHandle)
@@ -140,11 +170,37 @@ void donut::engine::DescriptorTableManager::ReleaseDescriptor(DescriptorIndex in
         m_DescriptorIndexMap.erase(indexMapEntry);
 
     descriptor = nvrhi::BindingSetItem::None(index);
+    WriteDescriptor(index);
+
+    m_FreeList.push_back(index);
+}
+
+void donut::engine::DescriptorTableManager::SetBatchedWrites(bool enable)
+{
+    // Flush under the same lock that changes the mode so that no write can be queued in between
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (!enable)
+        FlushPendingWritesLocked();
+
+    m_BatchedWrites = enable;
+}
+
+void donut::engine::DescriptorTableManager::FlushPendingWrites()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    FlushPendingWritesLocked();
+}
 
-    m_Device->writeDescriptorTable(m_DescriptorTable, descriptor);
+void donut::engine::DescriptorTableManager::FlushPendingWritesLocked()
+{
+    for (DescriptorIndex index : m_PendingWrites)
+    {
+        m_Device->writeDescriptorTable(m_DescriptorTable, m_Descriptors[index]);
+        m_WritePending[index] = false;
+    }
 
-    m_AllocatedDescriptors[index] = false;
-    m_SearchStart = std::min(m_SearchStart, index);
+    m_PendingWrites.clear();
 }
 
 donut::engine::DescriptorTableManager::~DescriptorTableManager()
@@ -0,0 +1,522 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/FrameCapture.h>
+#include <donut/engine/BindingCache.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/core/math/math.h>
+#include <donut/core/log.h>
+#include <donut/core/string_utils.h>
+
+#include <stb_image_write.h>
+
+#ifdef DONUT_WITH_TINYEXR
+#include <tinyexr.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+using namespace donut::math;
+using namespace donut::engine;
+
+FrameCapture::FrameCapture(nvrhi::IDevice* device, std::shared_ptr<CommonRenderPasses> commonPasses, const CreateParameters& params)
+    : m_Device(device)
+    , m_CommonPasses(std::move(commonPasses))
+    , m_BindingCache(std::make_unique<BindingCache>(device))
+    , m_Params(params)
+{
+    if (m_Params.numEncoderThreads == 0)
+        m_Params.numEncoderThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    if (m_Params.numStagingTextures == 0)
+        m_Params.numStagingTextures = m_Params.numEncoderThreads + 3;
+
+    m_Slots.resize(m_Params.numStagingTextures);
+    for (StagingSlot& slot : m_Slots)
+        slot.query = m_Device->createEventQuery();
+
+    for (uint32_t threadIndex = 0; threadIndex < m_Params.numEncoderThreads; threadIndex++)
+        m_Threads.emplace_back(&FrameCapture::WorkerThread, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    Flush();
+
+    {
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        m_Terminate = true;
+    }
+    m_EncodeCondition.notify_all();
+
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+bool FrameCapture::GetFileFormat(const std::string& fileName, FileFormat& outFormat)
+{
+    std::string extension = std::filesystem::path(fileName).extension().generic_string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return char(tolower(c)); });
+
+    if (extension == ".bmp")
+        outFormat = FileFormat::BMP;
+    else if (extension == ".png")
+        outFormat = FileFormat::PNG;
+    else if (extension == ".jpg" || extension == ".jpeg")
+        outFormat = FileFormat::JPG;
+    else if (extension == ".tga")
+        outFormat = FileFormat::TGA;
+#ifdef DONUT_WITH_TINYEXR
+    else if (extension == ".exr")
+        outFormat = FileFormat::EXR;
+#endif
+    else if (extension == ".raw")
+        outFormat = FileFormat::RAW;
+    else
+        return false;
+
+    return true;
+}
+
+void FrameCapture::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_EncodeCondition.wait(lock, [this]() { return m_Terminate || !m_EncodeQueue.empty(); });
+
+        if (m_EncodeQueue.empty())
+            return;
+
+        StagingSlot& slot = m_Slots[m_EncodeQueue.front()];
+        m_EncodeQueue.pop_front();
+
+        lock.unlock();
+        const bool success = EncodeSlot(slot);
+        if (m_Params.onFileWritten)
+            m_Params.onFileWritten(slot.fileName, success);
+        lock.lock();
+
+        slot.success = success;
+        slot.state = SlotState::Encoded;
+        m_EncodedCondition.notify_all();
+    }
+}
+
+bool FrameCapture::EncodeSlot(const StagingSlot& slot)
+{
+    const nvrhi::TextureDesc& desc = slot.stagingTexture->getDesc();
+    const int width = int(desc.width);
+    const int height = int(desc.height);
+    const char* fileName = slot.fileName.c_str();
+
+    if (slot.fileFormat == FileFormat::RAW)
+    {
+        const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(desc.format);
+        const size_t rowSize = size_t(div_ceil(desc.width, uint32_t(formatInfo.blockSize))) * formatInfo.bytesPerBlock;
+        const uint32_t numRows = div_ceil(desc.height, uint32_t(formatInfo.blockSize));
+
+        std::ofstream file(slot.fileName, std::ios::binary);
+        if (!file.is_open())
+        {
+            log::error("FrameCapture: cannot open '%s' for writing", fileName);
+            return false;
+        }
+
+        for (uint32_t row = 0; row < numRows; row++)
+            file.write(reinterpret_cast<const char*>(slot.mappedData + row * slot.rowPitch), std::streamsize(rowSize));
+
+        return file.good();
+    }
+
+    const int channels = (m_Params.saveAlphaChannel && slot.fileFormat != FileFormat::JPG) ? 4 : 3;
+
+#ifdef DONUT_WITH_TINYEXR
+    if (slot.fileFormat == FileFormat::EXR)
+    {
+        assert(desc.format == nvrhi::Format::RGBA32_FLOAT);
+
+        std::vector<float> pixels(size_t(width) * size_t(height) * channels);
+        for (int row = 0; row < height; row++)
+        {
+            const float* srcRow = reinterpret_cast<const float*>(slot.mappedData + row * slot.rowPitch);
+            float* dstRow = pixels.data() + size_t(row) * width * channels;
+            for (int col = 0; col < width; col++)
+                for (int channel = 0; channel < channels; channel++)
+                    dstRow[col * channels + channel] = srcRow[col * 4 + channel];
+        }
+
+        const char* error = nullptr;
+        if (SaveEXR(pixels.data(), width, height, channels, m_Params.exrHalfFloat ? 1 : 0, fileName, &error) < 0)
+        {
+            log::error("FrameCapture: cannot write '%s': %s", fileName, error ? error : "unknown error");
+            FreeEXRErrorMessage(error);
+            return false;
+        }
+
+        return true;
+    }
+#endif
+
+    // 8-bit formats, the data is RGBA8 or SRGBA8
+    const uint8_t* pixels = slot.mappedData;
+    int stride = int(slot.rowPitch);
+    std::vector<uint8_t> packed;
+
+    // stb only takes a stride for PNG, other formats need tightly packed rows
+    if (channels != 4 || (slot.fileFormat != FileFormat::PNG && slot.rowPitch != size_t(width) * 4))
+    {
+        packed.resize(size_t(width) * size_t(height) * channels);
+        for (int row = 0; row < height; row++)
+        {
+            const uint8_t* srcRow = slot.mappedData + row * slot.rowPitch;
+            uint8_t* dstRow = packed.data() + size_t(row) * width * channels;
+            if (channels == 4)
+            {
+                memcpy(dstRow, srcRow, size_t(width) * 4);
+            }
+            else
+            {
+                for (int col = 0; col < width; col++)
+                {
+                    dstRow[col * 3 + 0] = srcRow[col * 4 + 0];
+                    dstRow[col * 3 + 1] = srcRow[col * 4 + 1];
+                    dstRow[col * 3 + 2] = srcRow[col * 4 + 2];
+                }
+            }
+        }
+
+        pixels = packed.data();
+        stride = width * channels;
+    }
+
+    bool success = false;
+    switch (slot.fileFormat)
+    {
+    case FileFormat::BMP:
+        success = stbi_write_bmp(fileName, width, height, channels, pixels) != 0;
+        break;
+    case FileFormat::PNG:
+        success = stbi_write_png(fileName, width, height, channels, pixels, stride) != 0;
+        break;
+    case FileFormat::JPG:
+        success = stbi_write_jpg(fileName, width, height, channels, pixels, m_Params.jpegQuality) != 0;
+        break;
+    case FileFormat::TGA:
+        success = stbi_write_tga(fileName, width, height, channels, pixels) != 0;
+        break;
+    default:
+        break;
+    }
+
+    if (!success)
+        log::error("FrameCapture: cannot write '%s'", fileName);
+
+    return success;
+}
+
+void FrameCapture::ProcessSlots(bool waitForOldest)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (!m_InFlightSlots.empty())
+    {
+        const uint32_t slotIndex = m_InFlightSlots.front();
+        StagingSlot& slot = m_Slots[slotIndex];
+
+        if (!m_Device->pollEventQuery(slot.query))
+        {
+            if (!waitForOldest)
+                break;
+
+            lock.unlock();
+            m_Device->waitEventQuery(slot.query);
+            lock.lock();
+        }
+        waitForOldest = false;
+
+        m_InFlightSlots.pop_front();
+
+        slot.mappedData = static_cast<const uint8_t*>(m_Device->mapStagingTexture(
+            slot.stagingTexture, nvrhi::TextureSlice(), nvrhi::CpuAccessMode::Read, &slot.rowPitch));
+
+        if (slot.mappedData)
+        {
+            slot.state = SlotState::Encoding;
+            m_EncodeQueue.push_back(slotIndex);
+            m_EncodeCondition.notify_one();
+        }
+        else
+        {
+            log::error("FrameCapture: cannot map the staging texture for '%s'", slot.fileName.c_str());
+            slot.success = false;
+            slot.state = SlotState::Encoded;
+        }
+    }
+}
+
+void FrameCapture::ReleaseEncodedSlots()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    for (StagingSlot& slot : m_Slots)
+    {
+        if (slot.state != SlotState::Encoded)
+            continue;
+
+        if (slot.mappedData)
+        {
+            m_Device->unmapStagingTexture(slot.stagingTexture);
+            slot.mappedData = nullptr;
+        }
+
+        if (slot.success)
+            ++m_Stats.written;
+        else
+            ++m_Stats.failed;
+
+        slot.fileName.clear();
+        slot.state = SlotState::Free;
+    }
+}
+
+bool FrameCapture::AcquireSlot(uint32_t& outSlotIndex)
+{
+    bool stalled = false;
+
+    while (true)
+    {
+        ReleaseEncodedSlots();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        for (uint32_t slotIndex = 0; slotIndex < uint32_t(m_Slots.size()); slotIndex++)
+        {
+            if (m_Slots[slotIndex].state == SlotState::Free)
+            {
+                outSlotIndex = slotIndex;
+                return true;
+            }
+        }
+
+        if (m_Params.backpressure == FrameCaptureBackpressure::DropFrames)
+            return false;
+
+        if (!stalled)
+        {
+            ++m_Stats.stalls;
+            stalled = true;
+        }
+
+        if (!m_InFlightSlots.empty())
+        {
+            lock.unlock();
+            ProcessSlots(true);
+            continue;
+        }
+
+        const bool anyEncoding = std::any_of(m_Slots.begin(), m_Slots.end(), [](const StagingSlot& slot) {
+            return slot.state == SlotState::Encoding || slot.state == SlotState::Encoded; });
+
+        if (!anyEncoding)
+        {
+            // Waiting is impossible here, the copies have been recorded but not submitted
+            log::warning("FrameCapture: all staging textures hold unsubmitted captures, "
+                "call Poll() after executing the command list");
+            return false;
+        }
+
+        m_EncodedCondition.wait(lock, [this]() {
+            return std::any_of(m_Slots.begin(), m_Slots.end(), [](const StagingSlot& slot) {
+                return slot.state == SlotState::Encoded; });
+        });
+    }
+}
+
+bool FrameCapture::Capture(nvrhi::ICommandList* commandList, nvrhi::ITexture* texture, const std::string& fileName)
+{
+    FileFormat fileFormat;
+    if (!GetFileFormat(fileName, fileFormat))
+    {
+        log::error("FrameCapture: unsupported file format for '%s'", fileName.c_str());
+        return false;
+    }
+
+    uint32_t slotIndex = 0;
+    if (!AcquireSlot(slotIndex))
+    {
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        ++m_Stats.dropped;
+        return false;
+    }
+
+    StagingSlot& slot = m_Slots[slotIndex];
+    const nvrhi::TextureDesc& sourceDesc = texture->getDesc();
+
+    nvrhi::Format copyFormat;
+    switch (fileFormat)
+    {
+    case FileFormat::RAW:
+        copyFormat = sourceDesc.format;
+        break;
+    case FileFormat::EXR:
+        copyFormat = nvrhi::Format::RGBA32_FLOAT;
+        break;
+    default:
+        copyFormat = (sourceDesc.format == nvrhi::Format::RGBA8_UNORM || sourceDesc.format == nvrhi::Format::SRGBA8_UNORM)
+            ? sourceDesc.format
+            : nvrhi::Format::SRGBA8_UNORM;
+        break;
+    }
+
+    nvrhi::TextureDesc copyDesc;
+    copyDesc.width = sourceDesc.width;
+    copyDesc.height = sourceDesc.height;
+    copyDesc.format = copyFormat;
+    copyDesc.dimension = nvrhi::TextureDimension::Texture2D;
+
+    nvrhi::ITexture* copySource = texture;
+    if (copyFormat != sourceDesc.format)
+    {
+        if (!slot.conversionTexture
+            || slot.conversionTexture->getDesc().width != copyDesc.width
+            || slot.conversionTexture->getDesc().height != copyDesc.height
+            || slot.conversionTexture->getDesc().format != copyDesc.format)
+        {
+            nvrhi::TextureDesc conversionDesc = copyDesc;
+            conversionDesc.isRenderTarget = true;
+            conversionDesc.initialState = nvrhi::ResourceStates::RenderTarget;
+            conversionDesc.keepInitialState = true;
+            conversionDesc.debugName = "FrameCapture/Conversion";
+            slot.conversionTexture = m_Device->createTexture(conversionDesc);
+            slot.conversionFramebuffer = m_Device->createFramebuffer(nvrhi::FramebufferDesc().addColorAttachment(slot.conversionTexture));
+        }
+
+        m_CommonPasses->BlitTexture(commandList, slot.conversionFramebuffer, texture, m_BindingCache.get());
+        copySource = slot.conversionTexture;
+    }
+
+    if (!slot.stagingTexture
+        || slot.stagingTexture->getDesc().width != copyDesc.width
+        || slot.stagingTexture->getDesc().height != copyDesc.height
+        || slot.stagingTexture->getDesc().format != copyDesc.format)
+    {
+        copyDesc.debugName = "FrameCapture/Staging";
+        slot.stagingTexture = m_Device->createStagingTexture(copyDesc, nvrhi::CpuAccessMode::Read);
+    }
+
+    commandList->copyTexture(slot.stagingTexture, nvrhi::TextureSlice(), copySource, nvrhi::TextureSlice());
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    slot.fileName = fileName;
+    slot.fileFormat = fileFormat;
+    slot.state = SlotState::Recorded;
+    m_RecordedSlots.push_back(slotIndex);
+    ++m_Stats.captured;
+
+    return true;
+}
+
+void FrameCapture::BeginSequence(const std::filesystem::path& directory, const std::string& extension)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        log::warning("FrameCapture: cannot create directory '%s': %s", directory.generic_string().c_str(), error.message().c_str());
+
+    m_SequenceDirectory = directory;
+    m_SequenceExtension = extension;
+    m_SequenceFrame = 0;
+    m_SequenceActive = true;
+}
+
+void FrameCapture::EndSequence()
+{
+    m_SequenceActive = false;
+}
+
+bool FrameCapture::CaptureSequenceFrame(nvrhi::ICommandList* commandList, nvrhi::ITexture* texture)
+{
+    if (!m_SequenceActive)
+        return false;
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "frame_%05u.%s", m_SequenceFrame, m_SequenceExtension.c_str());
+    ++m_SequenceFrame;
+
+    return Capture(commandList, texture, (m_SequenceDirectory / fileName).generic_string());
+}
+
+void FrameCapture::Poll()
+{
+    {
+        // The command lists with the recorded copies have been executed by now, fence them.
+        // Slots are reused out of order, so keep the order of the Capture() calls for encoding.
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        for (uint32_t slotIndex : m_RecordedSlots)
+        {
+            StagingSlot& slot = m_Slots[slotIndex];
+            assert(slot.state == SlotState::Recorded);
+
+            m_Device->resetEventQuery(slot.query);
+            m_Device->setEventQuery(slot.query, nvrhi::CommandQueue::Graphics);
+            slot.state = SlotState::InFlight;
+            m_InFlightSlots.push_back(slotIndex);
+        }
+        m_RecordedSlots.clear();
+    }
+
+    ProcessSlots(false);
+    ReleaseEncodedSlots();
+}
+
+void FrameCapture::Flush()
+{
+    Poll();
+
+    while (true)
+    {
+        ProcessSlots(true);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_InFlightSlots.empty())
+        {
+            m_EncodedCondition.wait(lock, [this]() {
+                return std::none_of(m_Slots.begin(), m_Slots.end(), [](const StagingSlot& slot) {
+                    return slot.state == SlotState::Encoding; });
+            });
+            break;
+        }
+    }
+
+    ReleaseEncodedSlots();
+}
+
+FrameCaptureStats FrameCapture::GetStats()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    return m_Stats;
+}
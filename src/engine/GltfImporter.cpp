@@ -1360,6 +1360,8 @@ bool GltfImporter::Load(
         }
     }
 
+    buffers->updateCpuMemory();
+
     std::unordered_map<const cgltf_camera*, std::shared_ptr<SceneCamera>> cameraMap;
     for (size_t camera_idx = 0; camera_idx < objects->cameras_count; camera_idx++)
     {
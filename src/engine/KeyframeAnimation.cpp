@@ -155,6 +155,7 @@ std::optional<dm::float4> Sampler::Evaluate(float time, bool extrapolateLastValu
 void Sampler::AddKeyframe(const Keyframe keyframe)
 {
     m_Keyframes.push_back(keyframe);
+    m_MemoryTag.Set(m_Keyframes.capacity() * sizeof(Keyframe));
 }
 
 float Sampler::GetStartTime() const
@@ -173,6 +174,23 @@ float Sampler::GetEndTime() const
     return 0.f;
 }
 
+static float4 ReadKeyframeValue(const Json::Value& node)
+{
+    float4 value = 0.f;
+    if (node.isNumeric())
+    {
+        value.x = node.asFloat();
+    }
+    else if (node.isArray())
+    {
+        if (node.size() >= 1) value.x = node[0].asFloat();  // NOLINT(readability-container-size-empty)
+        if (node.size() >= 2) value.y = node[1].asFloat();
+        if (node.size() >= 3) value.z = node[2].asFloat();
+        if (node.size() >= 4) value.w = node[3].asFloat();
+    }
+    return value;
+}
+
 void Sampler::Load(Json::Value& node)
 {
     if (node["mode"].isString())
@@ -182,8 +200,12 @@ void Sampler::Load(Json::Value& node)
             SetInterpolationMode(InterpolationMode::Step);
         else if (mode == "linear")
             SetInterpolationMode(InterpolationMode::Linear);
-        if (mode == "spline")
+        else if (mode == "slerp")
+            SetInterpolationMode(InterpolationMode::Slerp);
+        else if (mode == "spline")
             SetInterpolationMode(InterpolationMode::CatmullRomSpline);
+        else if (mode == "hermite")
+            SetInterpolationMode(InterpolationMode::HermiteSpline);
     }
 
     bool warningPrinted = false;
@@ -192,23 +214,33 @@ void Sampler::Load(Json::Value& node)
     {
         for (Json::Value& valueNode : valuesNode)
         {
-            Keyframe keyframe;
-            keyframe.time = valueNode["time"].asFloat();
-            if (valueNode.isNumeric())
+            if (!valueNode.isObject())
             {
-                keyframe.value.x = valueNode.asFloat();
+                if (!warningPrinted)
+                {
+                    log::warning("Animation keyframes must be objects with 'time' and 'value' members.");
+                    warningPrinted = true;
+                }
+                continue;
             }
-            else if (valueNode.isArray())
+
+            Keyframe keyframe;
+            keyframe.time = valueNode["time"].asFloat();
+            keyframe.inTangent = ReadKeyframeValue(valueNode["inTangent"]);
+            keyframe.outTangent = ReadKeyframeValue(valueNode["outTangent"]);
+
+            Json::Value& dataNode = valueNode["value"];
+            if (dataNode.isNumeric() || dataNode.isArray())
             {
-                if (valueNode.size() >= 1) keyframe.value.x = valueNode[0].asFloat();  // NOLINT(readability-container-size-empty)
-                if (valueNode.size() >= 2) keyframe.value.y = valueNode[1].asFloat();
-                if (valueNode.size() >= 3) keyframe.value.z = valueNode[2].asFloat();
-                if (valueNode.size() >= 4) keyframe.value.w = valueNode[3].asFloat();
+                keyframe.value = ReadKeyframeValue(dataNode);
             }
-            else if ((valueNode.isObject() || valueNode.isString()) && !warningPrinted)
+            else if (dataNode.isObject() || dataNode.isString())
             {
-                log::warning("Objects and strings are not supported as animation keyframe values.");
-                warningPrinted = true;
+                if (!warningPrinted)
+                {
+                    log::warning("Objects and strings are not supported as animation keyframe values.");
+                    warningPrinted = true;
+                }
                 continue;
             }
 
@@ -220,6 +252,33 @@ void Sampler::Load(Json::Value& node)
     }
 }
 
+void Sampler::Save(Json::Value& node) const
+{
+    switch (m_Mode)
+    {
+    case InterpolationMode::Step: node["mode"] = "step"; break;
+    case InterpolationMode::Linear: node["mode"] = "linear"; break;
+    case InterpolationMode::Slerp: node["mode"] = "slerp"; break;
+    case InterpolationMode::CatmullRomSpline: node["mode"] = "spline"; break;
+    case InterpolationMode::HermiteSpline: node["mode"] = "hermite"; break;
+    }
+
+    Json::Value& valuesNode = node["values"];
+    valuesNode = Json::Value(Json::arrayValue);
+    for (const Keyframe& keyframe : m_Keyframes)
+    {
+        Json::Value valueNode;
+        valueNode["time"] = keyframe.time;
+        json::Write<float4>(valueNode["value"], keyframe.value);
+        if (m_Mode == InterpolationMode::HermiteSpline)
+        {
+            json::Write<float4>(valueNode["inTangent"], keyframe.inTangent);
+            json::Write<float4>(valueNode["outTangent"], keyframe.outTangent);
+        }
+        valuesNode.append(valueNode);
+    }
+}
+
 std::optional<dm::float4> Sequence::Evaluate(const std::string& name, float time, bool extrapolateLastValues)
 {
     std::shared_ptr<Sampler> track = GetTrack(name);
@@ -235,6 +294,16 @@ void Sequence::AddTrack(const std::string& name, const std::shared_ptr<Sampler>&
     m_Duration = std::max(m_Duration, track->GetEndTime());
 }
 
+void Sequence::RecomputeDuration()
+{
+    m_Duration = 0.f;
+    for (const auto& [name, track] : m_Tracks)
+    {
+        if (track)
+            m_Duration = std::max(m_Duration, track->GetEndTime());
+    }
+}
+
 void Sequence::Load(Json::Value& node)
 {
     for (auto& trackNode : node)
@@ -245,4 +314,19 @@ void Sequence::Load(Json::Value& node)
         std::string name = trackNode["name"].asString();
         AddTrack(name, track);
     }
-}
\ No newline at end of file
+}
+
+void Sequence::Save(Json::Value& node) const
+{
+    node = Json::Value(Json::arrayValue);
+    for (const auto& [name, track] : m_Tracks)
+    {
+        if (!track)
+            continue;
+
+        Json::Value trackNode;
+        trackNode["name"] = name;
+        track->Save(trackNode);
+        node.append(trackNode);
+    }
+}
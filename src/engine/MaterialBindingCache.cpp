@@ -25,6 +25,73 @@
 
 using namespace donut::engine;
 
+struct MaterialBindingCache::Entry
+{
+    uint64_t cacheEpoch;
+    uint32_t materialVersion;
+    nvrhi::BindingSetHandle bindingSet;
+};
+
+struct MaterialBindingSlots::Storage
+{
+    std::atomic<MaterialBindingCache::Entry*> entries[MaterialBindingCache::MaxSlots];
+    std::atomic<uint32_t> version = 0;
+
+    Storage()
+    {
+        for (auto& entry : entries)
+            entry.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~Storage()
+    {
+        for (auto& entry : entries)
+            delete entry.load(std::memory_order_relaxed);
+    }
+};
+
+// Allocation of the cache slots in MaterialBindingSlots
+static std::mutex g_SlotMutex;
+static uint32_t g_AllocatedSlots = 0;
+
+// Epochs identify the binding sets created by a particular cache instance between Clear() calls,
+// so that the entries left in materials by destroyed or cleared caches are never returned.
+static std::atomic<uint64_t> g_NextEpoch = 1;
+
+static uint32_t AllocateSlot()
+{
+    std::lock_guard<std::mutex> lockGuard(g_SlotMutex);
+
+    for (uint32_t slot = 0; slot < MaterialBindingCache::MaxSlots; slot++)
+    {
+        if ((g_AllocatedSlots & (1u << slot)) == 0)
+        {
+            g_AllocatedSlots |= 1u << slot;
+            return slot;
+        }
+    }
+
+    return ~0u;
+}
+
+static void ReleaseSlot(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lockGuard(g_SlotMutex);
+    g_AllocatedSlots &= ~(1u << slot);
+}
+
+MaterialBindingSlots::MaterialBindingSlots()
+    : m_Storage(std::make_shared<Storage>())
+{
+}
+
+MaterialBindingSlots::~MaterialBindingSlots() = default;
+
+void MaterialBindingSlots::Invalidate()
+{
+    m_Storage->version.fetch_add(1, std::memory_order_release);
+}
+
 MaterialBindingCache::MaterialBindingCache(
     nvrhi::IDevice* device, 
     nvrhi::ShaderType shaderType, 
@@ -39,7 +106,12 @@ MaterialBindingCache::MaterialBindingCache(
     , m_FallbackTexture(fallbackTexture)
     , m_Sampler(sampler)
     , m_TrackLiveness(trackLiveness)
+    , m_Epoch(g_NextEpoch.fetch_add(1))
 {
+    m_SlotIndex = AllocateSlot();
+    if (m_SlotIndex == ~0u)
+        log::warning("MaterialBindingCache: more than %d caches exist, lookups will use a locked map", MaxSlots);
+
     nvrhi::BindingLayoutDesc layoutDesc;
     layoutDesc.visibility = shaderType;
     layoutDesc.registerSpace = registerSpace;
@@ -78,6 +150,18 @@ MaterialBindingCache::MaterialBindingCache(
     m_BindingLayout = m_Device->createBindingLayout(layoutDesc);
 }
 
+MaterialBindingCache::~MaterialBindingCache()
+{
+    if (m_SlotIndex != ~0u)
+    {
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        RemoveEntriesFromMaterials();
+
+        // Release the slot only after the entries are gone, so that a new cache never sees them
+        ReleaseSlot(m_SlotIndex);
+    }
+}
+
 nvrhi::IBindingLayout* donut::engine::MaterialBindingCache::GetLayout() const
 {
     return m_BindingLayout;
@@ -85,16 +169,57 @@ nvrhi::IBindingLayout* donut::engine::MaterialBindingCache::GetLayout() const
 
 nvrhi::IBindingSet* donut::engine::MaterialBindingCache::GetMaterialBindingSet(const Material* material)
 {
+    if (m_SlotIndex == ~0u)
+    {
+        uint32_t const version = material->bindingSlots.m_Storage->version.load(std::memory_order_acquire);
+
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+        FallbackEntry& entry = m_BindingSets[material];
+
+        if (entry.bindingSet && entry.materialVersion == version)
+            return entry.bindingSet;
+
+        // Other threads may still be using the stale binding set, keep it alive like the replaced slot entries
+        if (entry.bindingSet)
+            m_RetiredEntries.push_back(std::make_unique<Entry>(Entry{ 0, entry.materialVersion, std::move(entry.bindingSet) }));
+
+        entry.materialVersion = version;
+        entry.bindingSet = CreateMaterialBindingSet(material);
+
+        return entry.bindingSet;
+    }
+
+    const std::shared_ptr<MaterialBindingSlots::Storage>& storage = material->bindingSlots.m_Storage;
+    std::atomic<Entry*>& slot = storage->entries[m_SlotIndex];
+
+    uint64_t const epoch = m_Epoch.load(std::memory_order_relaxed);
+    uint32_t const version = storage->version.load(std::memory_order_acquire);
+
+    Entry* entry = slot.load(std::memory_order_acquire);
+    if (entry && entry->cacheEpoch == epoch && entry->materialVersion == version)
+        return entry->bindingSet;
+
     std::lock_guard<std::mutex> lockGuard(m_Mutex);
 
-    nvrhi::BindingSetHandle& bindingSet = m_BindingSets[material];
+    // Another thread may have created the binding set while this one was waiting for the lock
+    entry = slot.load(std::memory_order_acquire);
+    if (entry && entry->cacheEpoch == epoch && entry->materialVersion == version)
+        return entry->bindingSet;
 
-    if (bindingSet)
-        return bindingSet;
+    auto newEntry = new Entry{ epoch, version, CreateMaterialBindingSet(material) };
+    Entry* oldEntry = slot.exchange(newEntry, std::memory_order_acq_rel);
 
-    bindingSet = CreateMaterialBindingSet(material);
+    // Remember the materials that hold entries of the current epoch, an entry of the same epoch
+    // means that the material is already on the list
+    if (!oldEntry || oldEntry->cacheEpoch != epoch)
+        m_FilledSlots.push_back(storage);
 
-    return bindingSet;
+    // Other threads may still be reading the old entry, so keep it alive until Clear() or destruction
+    if (oldEntry)
+        m_RetiredEntries.emplace_back(oldEntry);
+
+    return newEntry->bindingSet;
 }
 
 void donut::engine::MaterialBindingCache::Clear()
@@ -102,6 +227,34 @@ void donut::engine::MaterialBindingCache::Clear()
     std::lock_guard<std::mutex> lockGuard(m_Mutex);
 
     m_BindingSets.clear();
+
+    if (m_SlotIndex != ~0u)
+        RemoveEntriesFromMaterials();
+    else
+        m_RetiredEntries.clear();
+
+    // Entries that were created concurrently with Clear() become stale and are replaced on the next lookup
+    m_Epoch.store(g_NextEpoch.fetch_add(1), std::memory_order_relaxed);
+}
+
+void MaterialBindingCache::RemoveEntriesFromMaterials()
+{
+    uint64_t const epoch = m_Epoch.load(std::memory_order_relaxed);
+
+    for (const auto& weakStorage : m_FilledSlots)
+    {
+        std::shared_ptr<MaterialBindingSlots::Storage> storage = weakStorage.lock();
+        if (!storage)
+            continue;
+
+        std::atomic<Entry*>& slot = storage->entries[m_SlotIndex];
+        Entry* entry = slot.load(std::memory_order_acquire);
+        if (entry && entry->cacheEpoch == epoch && slot.compare_exchange_strong(entry, nullptr, std::memory_order_acq_rel))
+            delete entry;
+    }
+
+    m_FilledSlots.clear();
+    m_RetiredEntries.clear();
 }
 
 nvrhi::BindingSetItem MaterialBindingCache::GetTextureBindingSetItem(uint32_t slot, const std::shared_ptr<LoadedTexture>& texture) const
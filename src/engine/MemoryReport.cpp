@@ -0,0 +1,160 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/MemoryReport.h>
+#include <donut/engine/ConsoleObjects.h>
+
+#include <algorithm>
+
+using namespace donut::engine;
+
+uint64_t donut::engine::GetGpuMemorySize(const nvrhi::TextureDesc& desc)
+{
+    const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(desc.format);
+    const uint32_t blockSize = std::max(uint32_t(formatInfo.blockSize), 1u);
+    const uint32_t depth = desc.dimension == nvrhi::TextureDimension::Texture3D ? desc.depth : 1u;
+
+    uint64_t size = 0;
+    for (uint32_t mipLevel = 0; mipLevel < desc.mipLevels; mipLevel++)
+    {
+        const uint32_t width = std::max(desc.width >> mipLevel, 1u);
+        const uint32_t height = std::max(desc.height >> mipLevel, 1u);
+        const uint32_t mipDepth = std::max(depth >> mipLevel, 1u);
+
+        size += uint64_t((width + blockSize - 1) / blockSize) * uint64_t((height + blockSize - 1) / blockSize)
+            * mipDepth * formatInfo.bytesPerBlock;
+    }
+
+    return size * std::max(desc.arraySize, 1u) * std::max(desc.sampleCount, 1u);
+}
+
+uint64_t donut::engine::GetGpuMemorySize(nvrhi::ITexture* texture)
+{
+    return texture ? GetGpuMemorySize(texture->getDesc()) : 0;
+}
+
+uint64_t donut::engine::GetGpuMemorySize(nvrhi::IBuffer* buffer)
+{
+    return buffer ? buffer->getDesc().byteSize : 0;
+}
+
+void MemoryReport::SaveSnapshot(const std::string& name)
+{
+    memory::Snapshot snapshot = memory::GetSnapshot();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Snapshots[name] = snapshot;
+}
+
+void MemoryReport::DeleteSnapshot(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Snapshots.erase(name);
+}
+
+bool MemoryReport::GetSnapshot(const std::string& name, memory::Snapshot& outSnapshot) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Snapshots.find(name);
+    if (it == m_Snapshots.end())
+        return false;
+
+    outSnapshot = it->second;
+    return true;
+}
+
+std::vector<std::string> MemoryReport::GetSnapshotNames() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::vector<std::string> names;
+    for (const auto& [name, snapshot] : m_Snapshots)
+        names.push_back(name);
+    return names;
+}
+
+bool MemoryReport::RegisterConsoleCommands()
+{
+    static char const* usage =
+        "usage: \n"
+        "  memory report\n"
+        "    prints the current memory usage by category.\n"
+        "  memory snapshot <name>\n"
+        "    saves the current counters under the name.\n"
+        "  memory diff <name> [<name2>]\n"
+        "    prints the changes from snapshot <name> to snapshot <name2>, or to now.\n"
+        "  memory list\n"
+        "    lists the saved snapshots.\n"
+        "  memory reset_peaks\n"
+        "    sets the peak values to the current usage.\n";
+
+    using namespace console;
+
+    CommandDesc cmdDesc = {
+        "memory",
+        usage,
+        [this](Command::Args const& args) -> Command::Result {
+
+            if (args.size() >= 2 && args[1] == "report")
+                return { true, memory::FormatReport(memory::GetSnapshot()) };
+
+            if (args.size() >= 3 && args[1] == "snapshot")
+            {
+                SaveSnapshot(args[2]);
+                return { true, "saved snapshot " + args[2] + "\n" };
+            }
+
+            if (args.size() >= 3 && args[1] == "diff")
+            {
+                memory::Snapshot before;
+                if (!GetSnapshot(args[2], before))
+                    return { false, "unknown snapshot " + args[2] + "\n" };
+
+                memory::Snapshot after = memory::GetSnapshot();
+                if (args.size() >= 4 && !GetSnapshot(args[3], after))
+                    return { false, "unknown snapshot " + args[3] + "\n" };
+
+                return { true, memory::FormatDiff(before, after) };
+            }
+
+            if (args.size() >= 2 && args[1] == "list")
+            {
+                Command::Result r;
+                for (const std::string& name : GetSnapshotNames())
+                    r.output += name + "\n";
+                r.status = true;
+                return r;
+            }
+
+            if (args.size() >= 2 && args[1] == "reset_peaks")
+            {
+                memory::ResetPeaks();
+                return { true };
+            }
+
+            return { true, usage };
+        }
+    };
+
+    return RegisterCommand(cmdDesc);
+}
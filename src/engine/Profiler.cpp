@@ -0,0 +1,662 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/Profiler.h>
+#include <donut/engine/BenchmarkResults.h>
+#include <donut/engine/ConsoleObjects.h>
+#include <donut/core/log.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+using namespace donut::engine;
+
+std::atomic<Profiler*> Profiler::s_ActiveProfiler = nullptr;
+std::atomic<uint64_t> Profiler::s_NextInstanceId = 1;
+
+// Scope buffer of this thread for the profiler identified by s_ThreadBufferOwner
+thread_local uint64_t Profiler::s_ThreadBufferOwner = 0;
+thread_local Profiler::ThreadBuffer* Profiler::s_ThreadBuffer = nullptr;
+
+// Token of the innermost open CPU scope on this thread, used to build the hierarchy
+static thread_local uint64_t t_CurrentCpuScope = 0;
+
+static uint64_t MakeToken(uint32_t frameSerial, uint32_t eventIndex)
+{
+    return (uint64_t(frameSerial) << 32) | eventIndex;
+}
+
+static uint32_t GetTokenFrame(uint64_t token)
+{
+    return uint32_t(token >> 32);
+}
+
+static uint32_t GetTokenEvent(uint64_t token)
+{
+    return uint32_t(token);
+}
+
+static void AppendEscaped(std::string& output, const std::string& text)
+{
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            output += '\\';
+        if (uint8_t(c) >= 0x20)
+            output += c;
+    }
+}
+
+static void AppendTraceEvent(std::string& output, const std::string& name, const char* category,
+    int pid, uint32_t tid, double beginUs, double durationUs)
+{
+    char buf[128];
+
+    output += "{\"name\":\"";
+    AppendEscaped(output, name);
+    snprintf(buf, sizeof(buf), "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+        category, pid, tid, beginUs, durationUs);
+    output += buf;
+}
+
+Profiler::Profiler(nvrhi::IDevice* device, const CreateParameters& params)
+    : m_Device(device)
+    , m_Params(params)
+    , m_InstanceId(s_NextInstanceId.fetch_add(1))
+    , m_Epoch(std::chrono::steady_clock::now())
+{
+    m_Params.historyFrames = std::max(m_Params.historyFrames, 1u);
+    m_Params.maxFramesInFlight = std::max(m_Params.maxFramesInFlight, 1u);
+}
+
+Profiler::~Profiler()
+{
+    Profiler* self = this;
+    s_ActiveProfiler.compare_exchange_strong(self, nullptr);
+}
+
+void Profiler::SetActive(Profiler* profiler)
+{
+    s_ActiveProfiler.store(profiler, std::memory_order_release);
+}
+
+double Profiler::GetTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Epoch).count();
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+    if (s_ThreadBufferOwner == m_InstanceId)
+        return *s_ThreadBuffer;
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    // The thread may have recorded into another profiler since it last used this one
+    const std::thread::id threadId = std::this_thread::get_id();
+    ThreadBuffer* buffer = nullptr;
+    for (const auto& threadBuffer : m_ThreadBuffers)
+    {
+        if (threadBuffer->threadId == threadId)
+        {
+            buffer = threadBuffer.get();
+            break;
+        }
+    }
+
+    if (!buffer)
+    {
+        m_ThreadBuffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_ThreadBuffers.back().get();
+        buffer->threadId = threadId;
+        // Index 0 is the frame track in the traces
+        buffer->threadIndex = uint32_t(m_ThreadBuffers.size());
+    }
+
+    s_ThreadBufferOwner = m_InstanceId;
+    s_ThreadBuffer = buffer;
+    return *buffer;
+}
+
+void Profiler::MergeThreadBuffers()
+{
+    for (const auto& buffer : m_ThreadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+        if (buffer->frameSerial == m_CurrentFrame.serial)
+        {
+            // Parents are recorded by the same thread, so their indices only move by the buffer's offset
+            const uint32_t offset = uint32_t(m_CurrentFrame.cpuEvents.size());
+            for (Event& event : buffer->events)
+            {
+                if (event.parent != ~0u)
+                    event.parent += offset;
+                m_CurrentFrame.cpuEvents.push_back(std::move(event));
+            }
+        }
+
+        // Keep the capacity, so that recording does not allocate in the steady state
+        buffer->events.clear();
+    }
+}
+
+Profiler::Event* Profiler::FindGpuEvent(uint64_t token)
+{
+    // Scopes normally close in the frame they were opened in, but tolerate scopes that span EndFrame()
+    Frame* frame = nullptr;
+    const uint32_t serial = GetTokenFrame(token);
+
+    if (m_InFrame && m_CurrentFrame.serial == serial)
+        frame = &m_CurrentFrame;
+    else
+    {
+        for (auto& pendingFrame : m_PendingFrames)
+        {
+            if (pendingFrame.serial == serial)
+            {
+                frame = &pendingFrame;
+                break;
+            }
+        }
+    }
+
+    if (!frame)
+        return nullptr;
+
+    std::vector<Event>& events = frame->gpuEvents;
+    const uint32_t index = GetTokenEvent(token);
+    return index < events.size() ? &events[index] : nullptr;
+}
+
+uint64_t Profiler::BeginCpuScope(const char* name)
+{
+    if (!m_Enabled)
+        return 0;
+
+    const uint32_t serial = m_CpuFrameSerial.load(std::memory_order_acquire);
+    if (serial == 0)
+        return 0;
+
+    const double time = GetTime();
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lockGuard(buffer.mutex);
+
+    // Events left over from a frame that ended while this thread was starting a scope are dropped
+    if (buffer.frameSerial != serial)
+    {
+        buffer.events.clear();
+        buffer.frameSerial = serial;
+    }
+
+    const uint64_t parentToken = t_CurrentCpuScope;
+    const uint32_t index = uint32_t(buffer.events.size());
+
+    Event& event = buffer.events.emplace_back();
+    event.name = name;
+    event.threadIndex = buffer.threadIndex;
+    event.beginTime = time;
+    if (parentToken && GetTokenFrame(parentToken) == serial)
+        event.parent = GetTokenEvent(parentToken);
+
+    const uint64_t token = MakeToken(serial, index);
+    t_CurrentCpuScope = token;
+    return token;
+}
+
+void Profiler::EndCpuScope(uint64_t token)
+{
+    if (!token)
+        return;
+
+    const double time = GetTime();
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lockGuard(buffer.mutex);
+
+    // The buffer is emptied at EndFrame(), which drops the scopes that were still open
+    const uint32_t index = GetTokenEvent(token);
+    if (buffer.frameSerial != GetTokenFrame(token) || index >= buffer.events.size())
+    {
+        t_CurrentCpuScope = 0;
+        return;
+    }
+
+    Event& event = buffer.events[index];
+    event.endTime = time;
+    event.ended = true;
+    t_CurrentCpuScope = event.parent != ~0u ? MakeToken(GetTokenFrame(token), event.parent) : 0;
+}
+
+uint64_t Profiler::BeginGpuScope(nvrhi::ICommandList* commandList, const char* name)
+{
+    if (!m_Enabled || !commandList)
+        return 0;
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (!m_InFrame)
+        return 0;
+
+    nvrhi::TimerQueryHandle query;
+    if (!m_QueryPool.empty())
+    {
+        query = std::move(m_QueryPool.back());
+        m_QueryPool.pop_back();
+    }
+    else
+    {
+        query = m_Device->createTimerQuery();
+        if (!query)
+            return 0;
+    }
+
+    commandList->beginTimerQuery(query);
+
+    // GPU scopes nest per command list, independently of the CPU thread that records them
+    std::vector<uint32_t>& stack = m_GpuScopeStacks[commandList];
+    const uint32_t index = uint32_t(m_CurrentFrame.gpuEvents.size());
+
+    Event& event = m_CurrentFrame.gpuEvents.emplace_back();
+    event.name = name;
+    event.query = std::move(query);
+    if (!stack.empty())
+        event.parent = stack.back();
+
+    stack.push_back(index);
+    return MakeToken(m_CurrentFrame.serial, index);
+}
+
+void Profiler::EndGpuScope(nvrhi::ICommandList* commandList, uint64_t token)
+{
+    if (!token)
+        return;
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    Event* event = FindGpuEvent(token);
+    if (!event)
+        return;
+
+    commandList->endTimerQuery(event->query);
+    event->ended = true;
+
+    if (m_InFrame && GetTokenFrame(token) == m_CurrentFrame.serial)
+    {
+        std::vector<uint32_t>& stack = m_GpuScopeStacks[commandList];
+        if (!stack.empty() && stack.back() == GetTokenEvent(token))
+            stack.pop_back();
+    }
+}
+
+void Profiler::BeginFrame()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    while (!m_PendingFrames.empty())
+    {
+        const bool wait = m_PendingFrames.size() >= m_Params.maxFramesInFlight;
+        if (!ResolveFrame(m_PendingFrames.front(), wait))
+            break;
+
+        m_PendingFrames.pop_front();
+    }
+
+    m_CurrentFrame = Frame();
+    m_CurrentFrame.serial = m_NextFrameSerial++;
+    m_CurrentFrame.beginTime = GetTime();
+    m_GpuScopeStacks.clear();
+    m_InFrame = true;
+    m_CpuFrameSerial.store(m_CurrentFrame.serial, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (!m_InFrame)
+        return;
+
+    m_CpuFrameSerial.store(0, std::memory_order_release);
+    m_CurrentFrame.endTime = GetTime();
+    MergeThreadBuffers();
+    m_PendingFrames.push_back(std::move(m_CurrentFrame));
+    m_InFrame = false;
+}
+
+bool Profiler::ResolveFrame(Frame& frame, bool wait)
+{
+    if (!wait)
+    {
+        for (const auto& event : frame.gpuEvents)
+        {
+            if (event.ended && !m_Device->pollTimerQuery(event.query))
+                return false;
+        }
+    }
+
+    struct FrameSample
+    {
+        std::string name;
+        uint32_t depth;
+        uint32_t order;
+        double timeMs;
+    };
+
+    auto accumulate = [this, &frame](const std::vector<Event>& events, const std::vector<double>& timesMs, bool gpu)
+    {
+        std::vector<std::string> keys(events.size());
+        std::vector<uint32_t> depths(events.size(), 0);
+        std::unordered_map<std::string, FrameSample> samples;
+
+        // Parents always precede their children, so their keys are known when the children are visited
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const Event& event = events[i];
+            if (!event.ended)
+                continue;
+
+            if (event.parent != ~0u && !keys[event.parent].empty())
+            {
+                keys[i] = keys[event.parent] + "/" + event.name;
+                depths[i] = depths[event.parent] + 1;
+            }
+            else
+                keys[i] = event.name;
+
+            auto [it, inserted] = samples.try_emplace(keys[i], FrameSample{ event.name, depths[i], uint32_t(i), 0.0 });
+            it->second.timeMs += timesMs[i];
+        }
+
+        for (const auto& [key, sample] : samples)
+            AddSample((gpu ? "gpu:" : "cpu:") + key, sample.name, sample.depth, gpu, sample.order, frame.serial, sample.timeMs);
+    };
+
+    std::vector<double> cpuTimes(frame.cpuEvents.size(), 0.0);
+    for (size_t i = 0; i < frame.cpuEvents.size(); i++)
+    {
+        const Event& event = frame.cpuEvents[i];
+        if (event.ended)
+            cpuTimes[i] = (event.endTime - event.beginTime) * 1000.0;
+    }
+
+    std::vector<double> gpuTimes(frame.gpuEvents.size(), 0.0);
+    for (size_t i = 0; i < frame.gpuEvents.size(); i++)
+    {
+        Event& event = frame.gpuEvents[i];
+        if (!event.ended)
+            continue;
+
+        // getTimerQueryTime blocks until the result is available, which only happens when 'wait' is set
+        gpuTimes[i] = double(m_Device->getTimerQueryTime(event.query)) * 1000.0;
+
+        m_Device->resetTimerQuery(event.query);
+        m_QueryPool.push_back(std::move(event.query));
+    }
+
+    accumulate(frame.cpuEvents, cpuTimes, false);
+    accumulate(frame.gpuEvents, gpuTimes, true);
+    m_LastResolvedFrame = frame.serial;
+
+    if (m_CaptureFramesRemaining > 0)
+    {
+        AppendCaptureEvents(frame, gpuTimes);
+
+        if (--m_CaptureFramesRemaining == 0)
+            WriteCapture();
+    }
+
+    return true;
+}
+
+void Profiler::AddSample(const std::string& key, const std::string& name, uint32_t depth, bool gpu, uint32_t order, uint32_t frameSerial, double timeMs)
+{
+    ScopeHistory& history = m_Scopes[key];
+    if (history.samples.empty())
+    {
+        history.name = name;
+        history.depth = depth;
+        history.gpu = gpu;
+        history.samples.reserve(m_Params.historyFrames);
+    }
+
+    history.order = order;
+    history.lastFrame = frameSerial;
+
+    if (history.samples.size() < m_Params.historyFrames)
+        history.samples.push_back(float(timeMs));
+    else
+        history.samples[history.nextSample] = float(timeMs);
+
+    history.nextSample = (history.nextSample + 1) % m_Params.historyFrames;
+}
+
+std::vector<ProfilerScopeStats> Profiler::GetStats(bool gpu) const
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    std::vector<const ScopeHistory*> scopes;
+    for (const auto& [key, history] : m_Scopes)
+    {
+        // Scopes that have not been seen for a whole history window are stale
+        if (history.gpu == gpu && history.lastFrame + m_Params.historyFrames > m_LastResolvedFrame)
+            scopes.push_back(&history);
+    }
+
+    // Latest frame's scopes first, in recording order, then the scopes that were skipped in that frame
+    std::sort(scopes.begin(), scopes.end(), [this](const ScopeHistory* a, const ScopeHistory* b)
+    {
+        const bool aLatest = a->lastFrame == m_LastResolvedFrame;
+        const bool bLatest = b->lastFrame == m_LastResolvedFrame;
+        if (aLatest != bLatest)
+            return aLatest;
+        return a->order < b->order;
+    });
+
+    std::vector<ProfilerScopeStats> result;
+    result.reserve(scopes.size());
+
+    std::vector<float> sorted;
+    for (const ScopeHistory* history : scopes)
+    {
+        sorted = history->samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (float sample : sorted)
+            sum += sample;
+
+        ProfilerScopeStats& stats = result.emplace_back();
+        stats.name = history->name;
+        stats.depth = history->depth;
+        stats.gpu = history->gpu;
+        stats.numSamples = uint32_t(sorted.size());
+        stats.minMs = sorted.front();
+        stats.maxMs = sorted.back();
+        stats.avgMs = sum / double(sorted.size());
+        stats.p50Ms = GetSortedPercentile(sorted, 0.50);
+        stats.p95Ms = GetSortedPercentile(sorted, 0.95);
+        stats.p99Ms = GetSortedPercentile(sorted, 0.99);
+    }
+
+    return result;
+}
+
+void Profiler::ResetStats()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    m_Scopes.clear();
+}
+
+bool Profiler::BeginCapture(uint32_t numFrames, const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (m_CaptureFramesRemaining > 0)
+    {
+        log::warning("Profiler: a capture into '%s' is already in progress", m_CaptureFileName.c_str());
+        return false;
+    }
+
+    if (numFrames == 0 || fileName.empty())
+        return false;
+
+    m_CaptureFramesRemaining = numFrames;
+    m_CaptureFileName = fileName;
+    m_CaptureEvents.clear();
+    return true;
+}
+
+bool Profiler::IsCapturing() const
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    return m_CaptureFramesRemaining > 0;
+}
+
+void Profiler::AppendCaptureEvents(const Frame& frame, const std::vector<double>& gpuTimesMs)
+{
+    if (m_CaptureEvents.empty())
+        m_CaptureStartTime = frame.beginTime;
+
+    auto toUs = [this](double time) { return (time - m_CaptureStartTime) * 1e6; };
+
+    AppendTraceEvent(m_CaptureEvents, "Frame " + std::to_string(frame.serial), "frame", 0, 0,
+        toUs(frame.beginTime), (frame.endTime - frame.beginTime) * 1e6);
+
+    for (const auto& event : frame.cpuEvents)
+    {
+        if (event.ended)
+            AppendTraceEvent(m_CaptureEvents, event.name, "cpu", 0, event.threadIndex,
+                toUs(event.beginTime), (event.endTime - event.beginTime) * 1e6);
+    }
+
+    // Only GPU durations are known: children start at their parent's start, siblings follow each other
+    std::vector<double> cursors(frame.gpuEvents.size(), 0.0);
+    double rootCursor = toUs(frame.beginTime);
+
+    for (size_t i = 0; i < frame.gpuEvents.size(); i++)
+    {
+        const Event& event = frame.gpuEvents[i];
+        if (!event.ended)
+            continue;
+
+        double& cursor = event.parent != ~0u ? cursors[event.parent] : rootCursor;
+        const double durationUs = gpuTimesMs[i] * 1e3;
+
+        AppendTraceEvent(m_CaptureEvents, event.name, "gpu", 1, 0, cursor, durationUs);
+        cursors[i] = cursor;
+        cursor += durationUs;
+    }
+}
+
+void Profiler::WriteCapture()
+{
+    std::ofstream file(m_CaptureFileName);
+    if (!file.is_open())
+    {
+        log::error("Profiler: cannot open '%s' for writing", m_CaptureFileName.c_str());
+        m_CaptureEvents.clear();
+        return;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frames\"}},\n";
+    for (const auto& buffer : m_ThreadBuffers)
+    {
+        const uint32_t index = buffer->threadIndex;
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << index << ",\"args\":{\"name\":\"Thread " << index << "\"}},\n";
+    }
+
+    // The event list ends with ",\n" which JSON does not allow before the closing bracket
+    if (m_CaptureEvents.size() >= 2)
+        m_CaptureEvents.resize(m_CaptureEvents.size() - 2);
+    file << m_CaptureEvents << "\n]}\n";
+
+    log::info("Profiler: trace written to '%s'", m_CaptureFileName.c_str());
+    m_CaptureEvents.clear();
+}
+
+bool Profiler::RegisterConsoleCommands()
+{
+    static char const* usage =
+        "usage: \n"
+        "  profiler capture <frames> <file.json>\n"
+        "    records the next frames into a Chrome trace file.\n"
+        "  profiler stats\n"
+        "    prints the CPU and GPU scope timings in milliseconds.\n"
+        "  profiler reset\n"
+        "    clears the accumulated statistics.\n";
+
+    using namespace console;
+
+    CommandDesc cmdDesc = {
+        "profiler",
+        usage,
+        [this](Command::Args const& args) -> Command::Result {
+
+            if (args.size() >= 4 && args[1] == "capture")
+            {
+                int numFrames = std::atoi(args[2].c_str());
+                if (numFrames <= 0 || !BeginCapture(uint32_t(numFrames), args[3]))
+                    return { false, "cannot start the capture\n" };
+
+                return { true, "capturing " + std::to_string(numFrames) + " frames into " + args[3] + "\n" };
+            }
+
+            if (args.size() >= 2 && args[1] == "stats")
+            {
+                Command::Result r;
+                char buf[256];
+                for (bool gpu : { false, true })
+                {
+                    r.output += gpu ? "GPU:\n" : "CPU:\n";
+                    for (const auto& stats : GetStats(gpu))
+                    {
+                        snprintf(buf, sizeof(buf), "%*s%-*s avg %7.3f  min %7.3f  max %7.3f  p95 %7.3f  p99 %7.3f\n",
+                            int(stats.depth * 2), "", int(40 - std::min(stats.depth * 2, 30u)), stats.name.c_str(),
+                            stats.avgMs, stats.minMs, stats.maxMs, stats.p95Ms, stats.p99Ms);
+                        r.output += buf;
+                    }
+                }
+                r.status = true;
+                return r;
+            }
+
+            if (args.size() >= 2 && args[1] == "reset")
+            {
+                ResetStats();
+                return { true };
+            }
+
+            return { true, usage };
+        }
+    };
+
+    return RegisterCommand(cmdDesc);
+}
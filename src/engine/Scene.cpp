@@ -36,11 +36,15 @@ this software is released into the Public Domain.
 
 #include <donut/engine/Scene.h>
 #include <donut/engine/GltfImporter.h>
+#include <donut/engine/MemoryReport.h>
+#include <donut/engine/Profiler.h>
+#include <donut/engine/UploadAllocator.h>
 #include <donut/core/json.h>
 #include <donut/core/log.h>
 #include <donut/core/string_utils.h>
 #include <nvrhi/common/misc.h>
 #include <json/value.h>
+#include <cstring>
 
 #include "donut/engine/ShaderFactory.h"
 
@@ -81,8 +85,48 @@ struct Scene::Resources
     std::vector<MaterialConstants> materialData;
     std::vector<GeometryData> geometryData;
     std::vector<InstanceData> instanceData;
+    std::vector<CompactInstanceData> compactInstanceData;
+    std::vector<PrevTransformDelta> prevTransformDeltas;
 };
 
+// Converts a float to IEEE half precision with round-to-nearest-even, flushing half denormals to zero.
+// Values that are too large for half precision become infinity, NaNs stay NaNs.
+static uint32_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t const sign = (bits >> 16) & 0x8000u;
+    int32_t const exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t const mantissa = bits & 0x007fffffu;
+
+    if (((bits >> 23) & 0xff) == 0xff)
+    {
+        // Keep the top mantissa bits of NaNs and make sure that they don't turn into infinity
+        return mantissa ? (sign | 0x7e00u | (mantissa >> 13)) : (sign | 0x7c00u);
+    }
+
+    if (exponent <= 0)
+        return sign;
+
+    if (exponent >= 31)
+        return sign | 0x7c00u;
+
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+
+    // Rounding may carry into the exponent, which produces the correct result including overflow to infinity
+    uint32_t const remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+        ++half;
+
+    return half;
+}
+
+static bool IsHalfFinite(uint32_t half)
+{
+    return (half & 0x7c00u) != 0x7c00u;
+}
+
 Scene::Scene(
     nvrhi::IDevice* device,
     ShaderFactory& shaderFactory,
@@ -620,6 +664,24 @@ bool Scene::LoadCustomData(Json::Value& rootNode, tf::Executor* executor)
     return true;
 }
 
+void Scene::SetCompactInstanceData(bool enable)
+{
+    if (m_InstanceBuffer)
+    {
+        log::error("Scene::SetCompactInstanceData must be called before the scene buffers are created.");
+        return;
+    }
+
+    // Bindless consumers of the instance buffer, such as ray tracing shaders, only understand the full layout
+    if (enable && m_EnableBindlessResources)
+    {
+        log::error("Scene::SetCompactInstanceData is not supported when the scene uses bindless resources.");
+        return;
+    }
+
+    m_CompactInstanceData = enable;
+}
+
 void Scene::FinishedLoading(uint32_t frameIndex)
 {
     nvrhi::CommandListHandle commandList = m_Device->createCommandList();
@@ -634,6 +696,8 @@ void Scene::FinishedLoading(uint32_t frameIndex)
 
 void Scene::RefreshSceneGraph(uint32_t frameIndex)
 {
+    DONUT_PROFILE_CPU_SCOPE("Scene::RefreshSceneGraph");
+
     m_SceneStructureChanged = m_SceneGraph->HasPendingStructureChanges();
     m_SceneTransformsChanged = m_SceneGraph->HasPendingTransformChanges();
     m_SceneGraph->Refresh(frameIndex);
@@ -641,6 +705,8 @@ void Scene::RefreshSceneGraph(uint32_t frameIndex)
 
 void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Scene::RefreshBuffers");
+
     bool materialsChanged = false;
 
     if (m_SceneStructureChanged)
@@ -648,27 +714,48 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
 
     const size_t allocationGranularity = 1024;
     bool arraysAllocated = false;
+    bool buffersCreated = false;
 
     if (m_EnableBindlessResources && m_SceneGraph->GetGeometryCount() > m_Resources->geometryData.size())
     {
         m_Resources->geometryData.resize(nvrhi::align<size_t>(m_SceneGraph->GetGeometryCount(), allocationGranularity));
         m_GeometryBuffer = CreateGeometryBuffer();
         arraysAllocated = true;
+        buffersCreated = true;
     }
 
     if (m_SceneGraph->GetMaterials().size() > m_Resources->materialData.size())
     {
         m_Resources->materialData.resize(nvrhi::align<size_t>(m_SceneGraph->GetMaterials().size(), allocationGranularity));
         if (m_EnableBindlessResources)
+        {
             m_MaterialBuffer = CreateMaterialBuffer();
+            buffersCreated = true;
+        }
         arraysAllocated = true;
     }
 
-    if (m_SceneGraph->GetMeshInstances().size() > m_Resources->instanceData.size())
+    const size_t instanceCapacity = m_CompactInstanceData
+        ? m_Resources->compactInstanceData.size()
+        : m_Resources->instanceData.size();
+
+    if (m_SceneGraph->GetMeshInstances().size() > instanceCapacity)
     {
-        m_Resources->instanceData.resize(nvrhi::align<size_t>(m_SceneGraph->GetMeshInstances().size(), allocationGranularity));
+        const size_t newCapacity = nvrhi::align<size_t>(m_SceneGraph->GetMeshInstances().size(), allocationGranularity);
+
+        if (m_CompactInstanceData)
+        {
+            // Every instance has at most one delta, so the delta buffer never needs to grow on its own
+            m_Resources->compactInstanceData.resize(newCapacity);
+            m_Resources->prevTransformDeltas.reserve(newCapacity);
+            m_PrevTransformDeltaBuffer = CreatePrevTransformDeltaBuffer();
+        }
+        else
+            m_Resources->instanceData.resize(newCapacity);
+
         m_InstanceBuffer = CreateInstanceBuffer();
         arraysAllocated = true;
+        buffersCreated = true;
     }
 
     for (const auto& material : m_SceneGraph->GetMaterials())
@@ -680,11 +767,12 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
         {
             material->materialConstants = CreateMaterialConstantBuffer(material->name);
             material->dirty = true;
+            buffersCreated = true;
         }
 
         if (material->dirty)
         {
-            commandList->writeBuffer(material->materialConstants,
+            WriteBuffer(commandList, material->materialConstants,
                 &m_Resources->materialData[material->materialID],
                 sizeof(MaterialConstants));
 
@@ -693,6 +781,9 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
         }
     }
 
+    if (buffersCreated)
+        UpdateSceneBufferMemory();
+
     if (!m_Resources->geometryData.empty())
     {
         uint32_t geometryResourceIndex = 0;
@@ -720,6 +811,7 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
         for (const auto& mesh : m_SceneGraph->GetMeshes())
         {
             mesh->buffers->instanceBuffer = m_InstanceBuffer;
+            mesh->buffers->prevTransformDeltaBuffer = m_PrevTransformDeltaBuffer;
 
             if (m_EnableBindlessResources)
                 UpdateGeometry(mesh);
@@ -731,6 +823,8 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
 
     if (m_SceneStructureChanged || m_SceneTransformsChanged || arraysAllocated)
     {
+        m_Resources->prevTransformDeltas.clear();
+
         for (const auto& instance : m_SceneGraph->GetMeshInstances())
         {
             UpdateInstance(instance);
@@ -745,6 +839,28 @@ void Scene::RefreshBuffers(nvrhi::ICommandList* commandList, uint32_t frameIndex
     }
 
     UpdateSkinnedMeshes(commandList, frameIndex);
+
+    if (m_UploadAllocator)
+        m_UploadAllocator->Flush(commandList);
+
+    // Apply the descriptors created for the new textures and buffers, if the table batches its writes
+    if (m_DescriptorTable)
+        m_DescriptorTable->FlushPendingWrites();
+}
+
+static void FillJointMatrices(const SkinnedMeshInstance& skinnedInstance, std::vector<dm::float4x4>& jointMatrices)
+{
+    jointMatrices.resize(skinnedInstance.joints.size());
+    dm::daffine3 worldToRoot = inverse(skinnedInstance.GetNode()->GetLocalToWorldTransform());
+
+    for (size_t i = 0; i < skinnedInstance.joints.size(); i++)
+    {
+        auto jointNode = skinnedInstance.joints[i].node.lock();
+
+        dm::float4x4 jointMatrix = dm::affineToHomogeneous(dm::affine3(jointNode->GetLocalToWorldTransform() * worldToRoot));
+        jointMatrix = skinnedInstance.joints[i].inverseBindMatrix * jointMatrix;
+        jointMatrices[i] = jointMatrix;
+    }
 }
 
 void Scene::UpdateSkinnedMeshes(nvrhi::ICommandList* commandList, uint32_t frameIndex)
@@ -752,6 +868,26 @@ void Scene::UpdateSkinnedMeshes(nvrhi::ICommandList* commandList, uint32_t frame
     bool skinningMarkerPlaced = false;
 
     std::vector<dm::float4x4> jointMatrices;
+
+    // With an upload allocator, the joint matrices of all instances are staged first and copied in one batch
+    // ahead of the skinning dispatches, instead of one upload per instance.
+    bool jointsUploaded = false;
+    if (m_UploadAllocator)
+    {
+        jointsUploaded = true;
+        for (const auto& skinnedInstance : m_SceneGraph->GetSkinnedMeshInstances())
+        {
+            if (skinnedInstance->GetLastUpdateFrameIndex() + 1 < frameIndex)
+                continue;
+
+            FillJointMatrices(*skinnedInstance, jointMatrices);
+            if (!m_UploadAllocator->Write(skinnedInstance->jointBuffer, jointMatrices.data(), jointMatrices.size() * sizeof(float4x4)))
+                jointsUploaded = false;
+        }
+
+        m_UploadAllocator->Flush(commandList);
+    }
+
     for (const auto& skinnedInstance : m_SceneGraph->GetSkinnedMeshInstances())
     {
         // Only process the groups that were updated on this or previous frame.
@@ -769,20 +905,12 @@ void Scene::UpdateSkinnedMeshes(nvrhi::ICommandList* commandList, uint32_t frame
         if (!groupName.empty())
             commandList->beginMarker(groupName.c_str());
 
-        jointMatrices.resize(skinnedInstance->joints.size());
-        dm::daffine3 worldToRoot = inverse(skinnedInstance->GetNode()->GetLocalToWorldTransform());
-
-        for (size_t i = 0; i < skinnedInstance->joints.size(); i++)
+        if (!jointsUploaded)
         {
-            auto jointNode = skinnedInstance->joints[i].node.lock();
-
-            dm::float4x4 jointMatrix = dm::affineToHomogeneous(dm::affine3(jointNode->GetLocalToWorldTransform() * worldToRoot));
-            jointMatrix = skinnedInstance->joints[i].inverseBindMatrix * jointMatrix;
-            jointMatrices[i] = jointMatrix;
+            FillJointMatrices(*skinnedInstance, jointMatrices);
+            commandList->writeBuffer(skinnedInstance->jointBuffer, jointMatrices.data(), jointMatrices.size() * sizeof(float4x4));
         }
 
-        commandList->writeBuffer(skinnedInstance->jointBuffer, jointMatrices.data(), jointMatrices.size() * sizeof(float4x4));
-
         nvrhi::ComputeState state;
         state.pipeline = m_SkinningPipeline;
         state.bindings = { skinnedInstance->skinningBindingSet };
@@ -832,6 +960,8 @@ void Scene::UpdateSkinnedMeshes(nvrhi::ICommandList* commandList, uint32_t frame
 
 void Scene::Refresh(nvrhi::ICommandList* commandList, uint32_t frameIndex)
 {
+    DONUT_PROFILE_CPU_SCOPE("Scene::Refresh");
+
     RefreshSceneGraph(frameIndex);
     RefreshBuffers(commandList, frameIndex);
 }
@@ -886,6 +1016,7 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             bufferDesc.isAccelStructBuildInput = m_RayTracingSupported;
 
             buffers->indexBuffer = m_Device->createBuffer(bufferDesc);
+            buffers->gpuMemory.Set(buffers->gpuMemory.GetBytes() + GetGpuMemorySize(buffers->indexBuffer));
 
             if (m_DescriptorTable)
             {
@@ -966,6 +1097,7 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             }
 
             buffers->vertexBuffer = m_Device->createBuffer(bufferDesc);
+            buffers->gpuMemory.Set(buffers->gpuMemory.GetBytes() + GetGpuMemorySize(buffers->vertexBuffer));
             if (m_DescriptorTable)
             {
                 buffers->vertexBufferDescriptor = std::make_shared<DescriptorHandle>(
@@ -1038,8 +1170,11 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             commandList->setPermanentBufferState(buffers->vertexBuffer, state);
             commandList->commitBarriers();
         }
+
+        buffers->updateCpuMemory();
     }
 
+    bool jointBuffersCreated = false;
     for (const auto& skinnedInstance : m_SceneGraph->GetSkinnedMeshInstances())
     {
         const auto& skinnedMesh = skinnedInstance->GetMesh();
@@ -1100,7 +1235,9 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             bufferDesc.keepInitialState = true;
             bufferDesc.initialState = nvrhi::ResourceStates::VertexBuffer;
 
+            // The index buffer belongs to the prototype mesh, so only the vertex buffer is counted here
             skinnedBuffers->vertexBuffer = m_Device->createBuffer(bufferDesc);
+            skinnedBuffers->gpuMemory.Set(GetGpuMemorySize(skinnedBuffers->vertexBuffer));
 
             if (m_DescriptorTable)
             {
@@ -1118,6 +1255,7 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             jointBufferDesc.canHaveRawViews = true;
             jointBufferDesc.byteSize = sizeof(dm::float4x4) * skinnedInstance->joints.size();
             skinnedInstance->jointBuffer = m_Device->createBuffer(jointBufferDesc);
+            jointBuffersCreated = true;
         }
 
         if (!skinnedInstance->skinningBindingSet)
@@ -1136,6 +1274,23 @@ void Scene::CreateMeshBuffers(nvrhi::ICommandList* commandList)
             skinnedInstance->skinningBindingSet = m_Device->createBindingSet(setDesc, m_SkinningBindingLayout);
         }
     }
+
+    if (jointBuffersCreated)
+        UpdateSceneBufferMemory();
+}
+
+void Scene::UpdateSceneBufferMemory()
+{
+    uint64_t size = GetGpuMemorySize(m_MaterialBuffer) + GetGpuMemorySize(m_GeometryBuffer)
+        + GetGpuMemorySize(m_InstanceBuffer) + GetGpuMemorySize(m_PrevTransformDeltaBuffer);
+
+    for (const auto& material : m_SceneGraph->GetMaterials())
+        size += GetGpuMemorySize(material->materialConstants);
+
+    for (const auto& skinnedInstance : m_SceneGraph->GetSkinnedMeshInstances())
+        size += GetGpuMemorySize(skinnedInstance->jointBuffer);
+
+    m_SceneBufferMemory.Set(size_t(size));
 }
 
 nvrhi::BufferHandle Scene::CreateMaterialBuffer()
@@ -1172,10 +1327,15 @@ nvrhi::BufferHandle Scene::CreateInstanceBuffer()
     // On other APIs, a structured instance buffer can be used for rasterization.
     bool const needStructuredBuffer = m_Device->getGraphicsAPI() != nvrhi::GraphicsAPI::D3D11;
 
+    size_t const instanceSize = m_CompactInstanceData ? sizeof(CompactInstanceData) : sizeof(InstanceData);
+    size_t const instanceCount = m_CompactInstanceData
+        ? m_Resources->compactInstanceData.size()
+        : m_Resources->instanceData.size();
+
     nvrhi::BufferDesc bufferDesc;
-    bufferDesc.byteSize = sizeof(InstanceData) * m_Resources->instanceData.size();
+    bufferDesc.byteSize = instanceSize * instanceCount;
     bufferDesc.debugName = "Instances";
-    bufferDesc.structStride = needStructuredBuffer ? sizeof(InstanceData) : 0;
+    bufferDesc.structStride = needStructuredBuffer ? uint32_t(instanceSize) : 0;
     bufferDesc.canHaveRawViews = true;
     bufferDesc.canHaveUAVs = true;
     bufferDesc.isVertexBuffer = true;
@@ -1185,6 +1345,21 @@ nvrhi::BufferHandle Scene::CreateInstanceBuffer()
     return m_Device->createBuffer(bufferDesc);
 }
 
+nvrhi::BufferHandle Scene::CreatePrevTransformDeltaBuffer()
+{
+    bool const needStructuredBuffer = m_Device->getGraphicsAPI() != nvrhi::GraphicsAPI::D3D11;
+
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = sizeof(PrevTransformDelta) * m_Resources->compactInstanceData.size();
+    bufferDesc.debugName = "PrevTransformDeltas";
+    bufferDesc.structStride = needStructuredBuffer ? sizeof(PrevTransformDelta) : 0;
+    bufferDesc.canHaveRawViews = true;
+    bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+    bufferDesc.keepInitialState = true;
+
+    return m_Device->createBuffer(bufferDesc);
+}
+
 nvrhi::BufferHandle Scene::CreateMaterialConstantBuffer(const std::string& debugName)
 {
     nvrhi::BufferDesc bufferDesc;
@@ -1197,21 +1372,43 @@ nvrhi::BufferHandle Scene::CreateMaterialConstantBuffer(const std::string& debug
     return m_Device->createBuffer(bufferDesc);
 }
 
+void Scene::WriteBuffer(nvrhi::ICommandList* commandList, nvrhi::IBuffer* buffer, const void* data, size_t size) const
+{
+    if (m_UploadAllocator && m_UploadAllocator->Write(buffer, data, size))
+        return;
+
+    commandList->writeBuffer(buffer, data, size);
+}
+
 void Scene::WriteMaterialBuffer(nvrhi::ICommandList* commandList) const
 {
-    commandList->writeBuffer(m_MaterialBuffer, m_Resources->materialData.data(),
+    WriteBuffer(commandList, m_MaterialBuffer, m_Resources->materialData.data(),
         m_Resources->materialData.size() * sizeof(MaterialConstants));
 }
 
 void Scene::WriteGeometryBuffer(nvrhi::ICommandList* commandList) const
 {
-    commandList->writeBuffer(m_GeometryBuffer, m_Resources->geometryData.data(),
+    WriteBuffer(commandList, m_GeometryBuffer, m_Resources->geometryData.data(),
         m_Resources->geometryData.size() * sizeof(GeometryData));
 }
 
 void Scene::WriteInstanceBuffer(nvrhi::ICommandList* commandList) const
 {
-    commandList->writeBuffer(m_InstanceBuffer, m_Resources->instanceData.data(), 
+    if (m_CompactInstanceData)
+    {
+        WriteBuffer(commandList, m_InstanceBuffer, m_Resources->compactInstanceData.data(),
+            m_Resources->compactInstanceData.size() * sizeof(CompactInstanceData));
+
+        // Only the deltas for instances that moved are uploaded
+        if (!m_Resources->prevTransformDeltas.empty())
+        {
+            WriteBuffer(commandList, m_PrevTransformDeltaBuffer, m_Resources->prevTransformDeltas.data(),
+                m_Resources->prevTransformDeltas.size() * sizeof(PrevTransformDelta));
+        }
+        return;
+    }
+
+    WriteBuffer(commandList, m_InstanceBuffer, m_Resources->instanceData.data(),
         m_Resources->instanceData.size() * sizeof(InstanceData));
 }
 
@@ -1258,6 +1455,12 @@ void Scene::UpdateInstance(const std::shared_ptr<MeshInstance>& instance)
     if (!node)
         return;
 
+    if (m_CompactInstanceData)
+    {
+        UpdateCompactInstance(instance);
+        return;
+    }
+
     InstanceData& idata = m_Resources->instanceData[instance->GetInstanceIndex()];
     affineToColumnMajor(node->GetLocalToWorldTransformFloat(), idata.transform);
     affineToColumnMajor(node->GetPrevLocalToWorldTransformFloat(), idata.prevTransform);
@@ -1273,3 +1476,62 @@ void Scene::UpdateInstance(const std::shared_ptr<MeshInstance>& instance)
         idata.flags |= InstanceFlags_CurveDisjointOrthogonalTriangleStrips;
     }
 }
+
+void Scene::UpdateCompactInstance(const std::shared_ptr<MeshInstance>& instance)
+{
+    SceneGraphNode* node = instance->GetNode();
+    const auto& mesh = instance->GetMesh();
+
+    CompactInstanceData& cdata = m_Resources->compactInstanceData[instance->GetInstanceIndex()];
+    affineToColumnMajor(node->GetLocalToWorldTransformFloat(), cdata.transform);
+    cdata.firstGeometryInstanceIndex = instance->GetGeometryInstanceIndex();
+    cdata.firstGeometryIndex = mesh->geometries[0]->globalGeometryIndex;
+    cdata.prevTransformDeltaIndex = 0;
+
+    uint32_t flags = 0u;
+
+    if (mesh->type == MeshType::CurveDisjointOrthogonalTriangleStrips)
+    {
+        flags |= InstanceFlags_CurveDisjointOrthogonalTriangleStrips;
+    }
+
+    const affine3& transform = node->GetLocalToWorldTransformFloat();
+    const affine3& prevTransform = node->GetPrevLocalToWorldTransformFloat();
+
+    if (prevTransform != transform)
+    {
+        float current[12];
+        float prev[12];
+        affineToColumnMajor(transform, current);
+        affineToColumnMajor(prevTransform, prev);
+
+        uint32_t halves[12];
+        bool finite = true;
+        for (int i = 0; i < 12; i++)
+        {
+            halves[i] = FloatToHalf(prev[i] - current[i]);
+            finite = finite && IsHalfFinite(halves[i]);
+        }
+
+        // Deltas that don't fit into half precision, such as teleports, are dropped:
+        // the instance is drawn as if it didn't move, which is better than infinite motion vectors.
+        if (finite)
+        {
+            uint32_t packed[6];
+            for (int i = 0; i < 6; i++)
+                packed[i] = halves[i * 2] | (halves[i * 2 + 1] << 16);
+
+            PrevTransformDelta delta;
+            delta.packed0 = uint4(packed[0], packed[1], packed[2], packed[3]);
+            delta.packed1 = uint2(packed[4], packed[5]);
+
+            cdata.prevTransformDeltaIndex = uint32_t(m_Resources->prevTransformDeltas.size());
+            m_Resources->prevTransformDeltas.push_back(delta);
+            flags |= InstanceFlags_HasPrevTransformDelta;
+        }
+    }
+
+    assert(mesh->geometries.size() <= c_CompactInstanceNumGeometriesMask);
+    cdata.flagsAndNumGeometries = (flags << c_CompactInstanceFlagsShift)
+        | (uint32_t(mesh->geometries.size()) & c_CompactInstanceNumGeometriesMask);
+}
@@ -0,0 +1,854 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/SceneGenerator.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/KeyframeAnimation.h>
+#include <donut/core/json.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/core/log.h>
+#include <json/writer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+using namespace donut::math;
+using namespace donut::engine;
+
+// The standard distributions are implementation defined, so derive everything from the raw
+// mt19937 output to generate the same scene on every platform
+static float RandomFloat(std::mt19937& rng)
+{
+    return float(rng() >> 8) * (1.f / 16777216.f);
+}
+
+static float RandomFloat(std::mt19937& rng, float minValue, float maxValue)
+{
+    return minValue + (maxValue - minValue) * RandomFloat(rng);
+}
+
+// Separate statements, the evaluation order of function arguments is unspecified
+static float3 RandomFloat3(std::mt19937& rng, float minValue, float maxValue)
+{
+    float3 result;
+    result.x = RandomFloat(rng, minValue, maxValue);
+    result.y = RandomFloat(rng, minValue, maxValue);
+    result.z = RandomFloat(rng, minValue, maxValue);
+    return result;
+}
+
+static uint32_t RandomIndex(std::mt19937& rng, uint32_t count)
+{
+    return uint32_t((uint64_t(rng()) * count) >> 32);
+}
+
+static uint32_t RatioToCount(float ratio, uint32_t total)
+{
+    return std::min(uint32_t(std::max(ratio, 0.f) * float(total) + 0.5f), total);
+}
+
+SceneGenerator::SceneGenerator(std::shared_ptr<SceneTypeFactory> sceneTypeFactory)
+    : m_SceneTypeFactory(std::move(sceneTypeFactory))
+{
+    if (!m_SceneTypeFactory)
+        m_SceneTypeFactory = std::make_shared<SceneTypeFactory>();
+}
+
+std::vector<std::shared_ptr<Material>> SceneGenerator::CreateMaterials(const SceneGeneratorParameters& params, std::mt19937& rng) const
+{
+    const uint32_t materialCount = std::max(params.materialCount, 1u);
+    const uint32_t alphaTestedCount = RatioToCount(params.alphaTestedMaterialRatio, materialCount);
+    const uint32_t alphaBlendedCount = RatioToCount(params.alphaBlendedMaterialRatio, materialCount - alphaTestedCount);
+
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.reserve(materialCount);
+
+    for (uint32_t index = 0; index < materialCount; index++)
+    {
+        auto material = m_SceneTypeFactory->CreateMaterial();
+        material->name = "Material" + std::to_string(index);
+        material->materialIndexInModel = int(index);
+        material->baseOrDiffuseColor = RandomFloat3(rng, 0.1f, 1.f);
+        material->roughness = RandomFloat(rng, 0.1f, 1.f);
+        material->metalness = RandomFloat(rng) < 0.25f ? 1.f : 0.f;
+
+        if (index < alphaTestedCount)
+        {
+            material->domain = MaterialDomain::AlphaTested;
+        }
+        else if (index < alphaTestedCount + alphaBlendedCount)
+        {
+            material->domain = MaterialDomain::AlphaBlended;
+            material->opacity = 0.5f;
+        }
+
+        materials.push_back(material);
+    }
+
+    return materials;
+}
+
+std::shared_ptr<MeshInfo> SceneGenerator::CreateMesh(const SceneGeneratorParameters& params, uint32_t meshIndex,
+    const std::vector<std::shared_ptr<Material>>& materials, BufferGroup& buffers, std::mt19937& rng) const
+{
+    const uint32_t slices = std::max(params.meshSegments, 3u);
+    const uint32_t stacks = std::max(slices / 2, 2u);
+    const uint32_t geometryCount = std::max(params.geometriesPerMesh, 1u);
+
+    auto mesh = m_SceneTypeFactory->CreateMesh();
+    mesh->name = "Mesh" + std::to_string(meshIndex);
+    mesh->indexOffset = uint32_t(buffers.indexData.size());
+    mesh->vertexOffset = uint32_t(buffers.positionData.size());
+    mesh->objectSpaceBounds = box3::empty();
+
+    // Each mesh has its own proportions so that the meshes are not all the same
+    const float3 radius = RandomFloat3(rng, 0.25f, 0.75f);
+
+    for (uint32_t geometryIndex = 0; geometryIndex < geometryCount; geometryIndex++)
+    {
+        // The geometries are lined up along X
+        const float3 center = float3((float(geometryIndex) - float(geometryCount - 1) * 0.5f) * 2.f * radius.x, 0.f, 0.f);
+
+        auto geometry = m_SceneTypeFactory->CreateMeshGeometry();
+        geometry->material = materials[(meshIndex * geometryCount + geometryIndex) % materials.size()];
+        geometry->indexOffsetInMesh = mesh->totalIndices;
+        geometry->vertexOffsetInMesh = mesh->totalVertices;
+        geometry->objectSpaceBounds = box3(center - radius, center + radius);
+        geometry->type = MeshGeometryPrimitiveType::Triangles;
+
+        for (uint32_t stack = 0; stack <= stacks; stack++)
+        {
+            const float theta = PI_f * float(stack) / float(stacks);
+
+            for (uint32_t slice = 0; slice <= slices; slice++)
+            {
+                const float phi = 2.f * PI_f * float(slice) / float(slices);
+                const float3 normal = float3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+                const float4 tangent = float4(-sinf(phi), 0.f, cosf(phi), 1.f);
+
+                buffers.positionData.push_back(center + normal * radius);
+                buffers.normalData.push_back(vectorToSnorm8(normal));
+                buffers.tangentData.push_back(vectorToSnorm8(tangent));
+                buffers.texcoord1Data.push_back(float2(float(slice) / float(slices), float(stack) / float(stacks)));
+            }
+        }
+
+        // Indices are relative to the first vertex of the geometry, like in the glTF importer
+        for (uint32_t stack = 0; stack < stacks; stack++)
+        {
+            for (uint32_t slice = 0; slice < slices; slice++)
+            {
+                const uint32_t a = stack * (slices + 1) + slice;
+                const uint32_t b = a + slices + 1;
+
+                buffers.indexData.insert(buffers.indexData.end(), { a, a + 1, b, b, a + 1, b + 1 });
+            }
+        }
+
+        geometry->numVertices = (stacks + 1) * (slices + 1);
+        geometry->numIndices = stacks * slices * 6;
+
+        mesh->objectSpaceBounds |= geometry->objectSpaceBounds;
+        mesh->totalIndices += geometry->numIndices;
+        mesh->totalVertices += geometry->numVertices;
+        mesh->geometries.push_back(geometry);
+    }
+
+    return mesh;
+}
+
+std::shared_ptr<SceneGraph> SceneGenerator::Generate(const SceneGeneratorParameters& params)
+{
+    std::mt19937 rng(params.seed);
+    m_Stats = SceneGeneratorStats();
+
+    const uint32_t nodeCount = std::max(params.nodeCount, 1u);
+    const uint32_t maxDepth = std::max(params.maxDepth, 1u);
+    const uint32_t fanOut = std::max(params.fanOut, 1u);
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    root->SetName("GeneratedScene");
+    sceneGraph->SetRootNode(root);
+
+    std::vector<std::shared_ptr<SceneGraphNode>> nodes;
+    std::vector<uint32_t> depths;
+    std::vector<uint32_t> childCounts;
+    nodes.reserve(nodeCount);
+    depths.reserve(nodeCount);
+    childCounts.reserve(nodeCount);
+    nodes.push_back(root);
+    depths.push_back(0);
+    childCounts.push_back(0);
+
+    // Nodes that can still take children within the fan-out, in breadth-first order,
+    // and the nodes above the deepest level, which take the rest when the tree is full
+    std::deque<uint32_t> openNodes = { 0 };
+    std::vector<uint32_t> deepestParents;
+    if (maxDepth == 1)
+        deepestParents.push_back(0);
+
+    // The children are placed around their parent within a radius that shrinks with every level,
+    // so that the whole tree fits into the scene extent
+    const double spreadFalloff = std::pow(double(std::max(fanOut, 2u)), -1.0 / 3.0);
+    const double baseSpread = double(params.sceneExtent) * 0.5 * (1.0 - spreadFalloff);
+
+    for (uint32_t index = 1; index < nodeCount; index++)
+    {
+        uint32_t parentIndex;
+        if (!openNodes.empty())
+        {
+            parentIndex = openNodes.front();
+            if (++childCounts[parentIndex] >= fanOut)
+                openNodes.pop_front();
+        }
+        else
+        {
+            parentIndex = deepestParents[index % deepestParents.size()];
+        }
+
+        const uint32_t depth = depths[parentIndex] + 1;
+        const double spread = baseSpread * std::pow(spreadFalloff, double(depth - 1));
+
+        auto node = std::make_shared<SceneGraphNode>();
+        node->SetTranslation(double3(RandomFloat3(rng, -1.f, 1.f)) * spread);
+        node->SetRotation(rotationQuat(double3(0.0, 1.0, 0.0), double(RandomFloat(rng, 0.f, 2.f * PI_f))));
+        sceneGraph->Attach(nodes[parentIndex], node);
+
+        nodes.push_back(node);
+        depths.push_back(depth);
+        childCounts.push_back(0);
+
+        if (depth < maxDepth)
+            openNodes.push_back(index);
+        if (depth == maxDepth - 1)
+            deepestParents.push_back(index);
+
+        m_Stats.maxDepth = std::max(m_Stats.maxDepth, depth);
+    }
+
+    m_Stats.nodes = nodeCount;
+
+    // Distribute the leaves over the non-root nodes in random order: lights first, then mesh instances.
+    // The animated nodes are taken from the other end of the order, so some of them carry instances.
+    std::vector<uint32_t> order(nodeCount - 1);
+    for (uint32_t index = 0; index < nodeCount - 1; index++)
+        order[index] = index + 1;
+    for (uint32_t index = uint32_t(order.size()); index > 1; index--)
+        std::swap(order[index - 1], order[RandomIndex(rng, index)]);
+
+    const uint32_t lightCount = std::min(params.lightCount, uint32_t(order.size()));
+    const uint32_t instanceCount = std::min(RatioToCount(params.instanceRatio, uint32_t(order.size())), uint32_t(order.size()) - lightCount);
+    const uint32_t animatedCount = RatioToCount(params.animatedNodeRatio, uint32_t(order.size()));
+
+    // Lights
+    for (uint32_t lightIndex = 0; lightIndex < lightCount; lightIndex++)
+    {
+        const auto& node = nodes[order[lightIndex]];
+        const float3 color = RandomFloat3(rng, 0.5f, 1.f);
+
+        const char* lightType = (lightIndex == 0) ? "DirectionalLight" : (lightIndex % 2) ? "PointLight" : "SpotLight";
+        auto light = std::dynamic_pointer_cast<Light>(m_SceneTypeFactory->CreateLeaf(lightType));
+
+        if (auto directional = std::dynamic_pointer_cast<DirectionalLight>(light))
+        {
+            directional->irradiance = 2.f;
+            directional->angularSize = 0.53f;
+        }
+        else if (auto point = std::dynamic_pointer_cast<PointLight>(light))
+        {
+            point->intensity = RandomFloat(rng, 10.f, 100.f);
+            point->radius = 0.1f;
+            point->range = params.sceneExtent * 0.1f;
+        }
+        else if (auto spot = std::dynamic_pointer_cast<SpotLight>(light))
+        {
+            spot->intensity = RandomFloat(rng, 10.f, 100.f);
+            spot->radius = 0.1f;
+            spot->range = params.sceneExtent * 0.1f;
+            spot->innerAngle = 30.f;
+            spot->outerAngle = 60.f;
+        }
+
+        if (!light)
+            continue;
+
+        light->color = color;
+        node->SetLeaf(light);
+        node->SetName("Light" + std::to_string(lightIndex));
+
+        // Lights shine along -Z. The parents only rotate around Y, so a negative rotation around X
+        // makes the light point downwards.
+        const double heading = double(RandomFloat(rng, 0.f, 2.f * PI_f));
+        const double tilt = -double(radians(RandomFloat(rng, 30.f, 80.f)));
+        node->SetRotation(rotationQuat(double3(0.0, 1.0, 0.0), heading) * rotationQuat(double3(1.0, 0.0, 0.0), tilt));
+
+        ++m_Stats.lights;
+    }
+
+    // Meshes and instances
+    if (instanceCount > 0)
+    {
+        const auto materials = CreateMaterials(params, rng);
+        const uint32_t meshCount = std::max(instanceCount - RatioToCount(params.meshReuseRatio, instanceCount), 1u);
+        auto buffers = std::make_shared<BufferGroup>();
+
+        std::vector<std::shared_ptr<MeshInfo>> meshes;
+        meshes.reserve(meshCount);
+        for (uint32_t meshIndex = 0; meshIndex < meshCount; meshIndex++)
+        {
+            auto mesh = CreateMesh(params, meshIndex, materials, *buffers, rng);
+            mesh->buffers = buffers;
+            meshes.push_back(mesh);
+        }
+        buffers->updateCpuMemory();
+
+        for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++)
+        {
+            const auto& node = nodes[order[lightCount + instanceIndex]];
+            node->SetLeaf(m_SceneTypeFactory->CreateMeshInstance(meshes[instanceIndex % meshCount]));
+        }
+
+        m_Stats.meshInstances = instanceCount;
+        m_Stats.meshes = meshCount;
+        m_Stats.materials = uint32_t(materials.size());
+        m_Stats.vertices = buffers->positionData.size();
+        m_Stats.indices = buffers->indexData.size();
+    }
+
+    // One animation with a rotation channel for every animated node, all sharing the same sampler
+    if (animatedCount > 0)
+    {
+        auto sampler = std::make_shared<animation::Sampler>();
+        sampler->SetInterpolationMode(animation::InterpolationMode::Slerp);
+
+        const int keyframeCount = 4;
+        const float duration = std::max(params.animationDuration, 0.01f);
+        for (int keyframeIndex = 0; keyframeIndex <= keyframeCount; keyframeIndex++)
+        {
+            animation::Keyframe keyframe;
+            keyframe.time = duration * float(keyframeIndex) / float(keyframeCount);
+            keyframe.value = rotationQuat(float3(0.f, 1.f, 0.f), 2.f * PI_f * float(keyframeIndex) / float(keyframeCount)).toXYZW();
+            sampler->AddKeyframe(keyframe);
+        }
+
+        auto animation = std::make_shared<SceneGraphAnimation>();
+        for (uint32_t animatedIndex = 0; animatedIndex < animatedCount; animatedIndex++)
+        {
+            const auto& node = nodes[order[order.size() - 1 - animatedIndex]];
+            animation->AddChannel(std::make_shared<SceneGraphAnimationChannel>(sampler, node, AnimationAttribute::Rotation));
+        }
+
+        // Leaves take the name of their node, so the animation is called like the scene root
+        root->SetLeaf(animation);
+
+        m_Stats.animatedNodes = animatedCount;
+    }
+
+    return sceneGraph;
+}
+
+namespace
+{
+    // glTF component types and buffer view targets
+    constexpr int c_ComponentFloat = 5126;
+    constexpr int c_ComponentUint32 = 5125;
+    constexpr int c_TargetArrayBuffer = 34962;
+    constexpr int c_TargetElementArrayBuffer = 34963;
+
+    class GltfWriter
+    {
+    private:
+        std::vector<uint8_t> m_Binary;
+
+    public:
+        Json::Value root;
+
+        // Appends the data to the binary buffer as a new buffer view and returns the view index
+        int AddBufferView(const void* data, size_t size, int target)
+        {
+            const size_t offset = (m_Binary.size() + 3) & ~size_t(3);
+            m_Binary.resize(offset + size);
+            if (size)
+                memcpy(m_Binary.data() + offset, data, size);
+
+            Json::Value view;
+            view["buffer"] = 0;
+            view["byteOffset"] = Json::UInt64(offset);
+            view["byteLength"] = Json::UInt64(size);
+            if (target)
+                view["target"] = target;
+
+            Json::Value& views = root["bufferViews"];
+            views.append(view);
+            return int(views.size()) - 1;
+        }
+
+        int AddAccessor(int bufferView, size_t byteOffset, int componentType, size_t count, const char* type)
+        {
+            Json::Value accessor;
+            accessor["bufferView"] = bufferView;
+            accessor["byteOffset"] = Json::UInt64(byteOffset);
+            accessor["componentType"] = componentType;
+            accessor["count"] = Json::UInt64(count);
+            accessor["type"] = type;
+
+            Json::Value& accessors = root["accessors"];
+            accessors.append(accessor);
+            return int(accessors.size()) - 1;
+        }
+
+        Json::Value& GetAccessor(int index)
+        {
+            return root["accessors"][index];
+        }
+
+        std::vector<uint8_t>& GetBinary() { return m_Binary; }
+    };
+
+    Json::Value ToJson(const float3& v)
+    {
+        Json::Value node(Json::arrayValue);
+        node.append(v.x);
+        node.append(v.y);
+        node.append(v.z);
+        return node;
+    }
+
+    Json::Value ToJson(const float4& v)
+    {
+        Json::Value node(Json::arrayValue);
+        node.append(v.x);
+        node.append(v.y);
+        node.append(v.z);
+        node.append(v.w);
+        return node;
+    }
+
+    const char* GetAnimationPath(AnimationAttribute attribute)
+    {
+        switch (attribute)
+        {
+        case AnimationAttribute::Translation: return "translation";
+        case AnimationAttribute::Rotation: return "rotation";
+        case AnimationAttribute::Scaling: return "scale";
+        default: return nullptr;
+        }
+    }
+}
+
+bool SceneGenerator::WriteGltf(const SceneGraph& sceneGraph, vfs::IFileSystem& fs, const std::filesystem::path& fileName)
+{
+    if (!sceneGraph.GetRootNode())
+    {
+        log::error("Cannot write '%s': the scene graph is empty", fileName.generic_string().c_str());
+        return false;
+    }
+
+    const bool binary = fileName.extension() == ".glb";
+
+    GltfWriter writer;
+    Json::Value& root = writer.root;
+    root["asset"]["version"] = "2.0";
+    root["asset"]["generator"] = "Donut SceneGenerator";
+
+    std::unordered_map<const SceneGraphNode*, int> nodeIndices;
+    std::unordered_map<const MeshInfo*, int> meshIndices;
+    std::unordered_map<const Material*, int> materialIndices;
+    std::vector<const SceneGraphNode*> nodes;
+    std::vector<const MeshInfo*> meshes;
+    std::vector<const Light*> lights;
+
+    // Number the nodes, meshes and materials in the order of appearance
+    for (SceneGraphWalker walker(sceneGraph.GetRootNode().get()); walker; walker.Next(true))
+    {
+        nodeIndices[walker.Get()] = int(nodes.size());
+        nodes.push_back(walker.Get());
+
+        if (auto meshInstance = dynamic_cast<const MeshInstance*>(walker->GetLeaf().get()))
+        {
+            const MeshInfo* mesh = meshInstance->GetMesh().get();
+            if (mesh && !mesh->buffers)
+            {
+                log::error("Cannot write '%s': mesh '%s' has no buffers", fileName.generic_string().c_str(), mesh->name.c_str());
+                return false;
+            }
+
+            if (mesh && meshIndices.emplace(mesh, int(meshes.size())).second)
+            {
+                meshes.push_back(mesh);
+
+                for (const auto& geometry : mesh->geometries)
+                {
+                    const Material* material = geometry->material.get();
+                    if (material && !materialIndices.count(material))
+                        materialIndices.emplace(material, int(materialIndices.size()));
+                }
+            }
+        }
+    }
+
+    // Materials, metal-rough model only
+    root["materials"] = Json::Value(Json::arrayValue);
+    root["materials"].resize(Json::ArrayIndex(materialIndices.size()));
+    for (const auto& [material, materialIndex] : materialIndices)
+    {
+        Json::Value& node = root["materials"][materialIndex];
+        node["name"] = material->name;
+        node["pbrMetallicRoughness"]["baseColorFactor"] = ToJson(float4(material->baseOrDiffuseColor, material->opacity));
+        node["pbrMetallicRoughness"]["metallicFactor"] = material->metalness;
+        node["pbrMetallicRoughness"]["roughnessFactor"] = material->roughness;
+        if (any(material->emissiveColor != float3(0.f)))
+            node["emissiveFactor"] = ToJson(material->emissiveColor * material->emissiveIntensity);
+
+        switch (material->domain)
+        {
+        case MaterialDomain::AlphaTested:
+        case MaterialDomain::TransmissiveAlphaTested:
+            node["alphaMode"] = "MASK";
+            node["alphaCutoff"] = material->alphaCutoff;
+            break;
+        case MaterialDomain::AlphaBlended:
+        case MaterialDomain::TransmissiveAlphaBlended:
+            node["alphaMode"] = "BLEND";
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Vertex and index data of all geometries, one buffer view per attribute
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float4> tangents;
+    std::vector<float2> texcoords;
+    std::vector<uint32_t> indices;
+
+    struct GeometryRanges
+    {
+        size_t firstVertex = 0;
+        size_t firstTangent = 0;
+        size_t firstTexcoord = 0;
+        size_t firstIndex = 0;
+        bool hasTangents = false;
+        bool hasTexcoords = false;
+    };
+    std::vector<GeometryRanges> geometryRanges;
+
+    for (const MeshInfo* mesh : meshes)
+    {
+        const BufferGroup& buffers = *mesh->buffers;
+
+        for (const auto& geometry : mesh->geometries)
+        {
+            const size_t vertexOffset = mesh->vertexOffset + geometry->vertexOffsetInMesh;
+            const size_t indexOffset = mesh->indexOffset + geometry->indexOffsetInMesh;
+
+            if (vertexOffset + geometry->numVertices > buffers.positionData.size() ||
+                indexOffset + geometry->numIndices > buffers.indexData.size())
+            {
+                log::error("Cannot write '%s': the vertex or index data of mesh '%s' is missing, "
+                    "it may have been released after uploading to the GPU", fileName.generic_string().c_str(), mesh->name.c_str());
+                return false;
+            }
+
+            GeometryRanges ranges;
+            ranges.firstVertex = positions.size();
+            ranges.firstTangent = tangents.size();
+            ranges.firstTexcoord = texcoords.size();
+            ranges.firstIndex = indices.size();
+            ranges.hasTangents = vertexOffset + geometry->numVertices <= buffers.tangentData.size();
+            ranges.hasTexcoords = vertexOffset + geometry->numVertices <= buffers.texcoord1Data.size();
+            const bool hasNormals = vertexOffset + geometry->numVertices <= buffers.normalData.size();
+
+            for (size_t vertex = vertexOffset; vertex < vertexOffset + geometry->numVertices; vertex++)
+            {
+                positions.push_back(buffers.positionData[vertex]);
+                normals.push_back(hasNormals ? normalize(snorm8ToVector<3>(buffers.normalData[vertex])) : float3(0.f, 1.f, 0.f));
+                if (ranges.hasTangents)
+                {
+                    const float4 tangent = snorm8ToVector<4>(buffers.tangentData[vertex]);
+                    tangents.push_back(float4(normalize(tangent.xyz()), tangent.w < 0.f ? -1.f : 1.f));
+                }
+                if (ranges.hasTexcoords)
+                    texcoords.push_back(buffers.texcoord1Data[vertex]);
+            }
+
+            indices.insert(indices.end(), buffers.indexData.begin() + indexOffset, buffers.indexData.begin() + indexOffset + geometry->numIndices);
+            geometryRanges.push_back(ranges);
+        }
+    }
+
+    const int positionView = writer.AddBufferView(positions.data(), positions.size() * sizeof(float3), c_TargetArrayBuffer);
+    const int normalView = writer.AddBufferView(normals.data(), normals.size() * sizeof(float3), c_TargetArrayBuffer);
+    const int tangentView = tangents.empty() ? -1 : writer.AddBufferView(tangents.data(), tangents.size() * sizeof(float4), c_TargetArrayBuffer);
+    const int texcoordView = texcoords.empty() ? -1 : writer.AddBufferView(texcoords.data(), texcoords.size() * sizeof(float2), c_TargetArrayBuffer);
+    const int indexView = writer.AddBufferView(indices.data(), indices.size() * sizeof(uint32_t), c_TargetElementArrayBuffer);
+
+    // Meshes
+    root["meshes"] = Json::Value(Json::arrayValue);
+    size_t geometryIndex = 0;
+    for (const MeshInfo* mesh : meshes)
+    {
+        Json::Value meshNode;
+        meshNode["name"] = mesh->name;
+        Json::Value& primitives = meshNode["primitives"];
+        primitives = Json::Value(Json::arrayValue);
+
+        for (const auto& geometry : mesh->geometries)
+        {
+            const GeometryRanges& ranges = geometryRanges[geometryIndex++];
+            Json::Value primitive;
+
+            const int position = writer.AddAccessor(positionView, ranges.firstVertex * sizeof(float3), c_ComponentFloat, geometry->numVertices, "VEC3");
+            box3 bounds = box3::empty();
+            for (size_t vertex = 0; vertex < geometry->numVertices; vertex++)
+                bounds |= positions[ranges.firstVertex + vertex];
+            writer.GetAccessor(position)["min"] = ToJson(bounds.m_mins);
+            writer.GetAccessor(position)["max"] = ToJson(bounds.m_maxs);
+            primitive["attributes"]["POSITION"] = position;
+
+            primitive["attributes"]["NORMAL"] = writer.AddAccessor(normalView, ranges.firstVertex * sizeof(float3), c_ComponentFloat, geometry->numVertices, "VEC3");
+            if (ranges.hasTangents)
+                primitive["attributes"]["TANGENT"] = writer.AddAccessor(tangentView, ranges.firstTangent * sizeof(float4), c_ComponentFloat, geometry->numVertices, "VEC4");
+            if (ranges.hasTexcoords)
+                primitive["attributes"]["TEXCOORD_0"] = writer.AddAccessor(texcoordView, ranges.firstTexcoord * sizeof(float2), c_ComponentFloat, geometry->numVertices, "VEC2");
+
+            primitive["indices"] = writer.AddAccessor(indexView, ranges.firstIndex * sizeof(uint32_t), c_ComponentUint32, geometry->numIndices, "SCALAR");
+
+            auto material = materialIndices.find(geometry->material.get());
+            if (material != materialIndices.end())
+                primitive["material"] = material->second;
+
+            primitives.append(primitive);
+        }
+
+        root["meshes"].append(meshNode);
+    }
+
+    // Nodes
+    root["nodes"] = Json::Value(Json::arrayValue);
+    for (const SceneGraphNode* node : nodes)
+    {
+        Json::Value nodeJson;
+        if (!node->GetName().empty())
+            nodeJson["name"] = node->GetName();
+
+        if (any(node->GetTranslation() != double3(0.0)))
+            nodeJson["translation"] = ToJson(float3(node->GetTranslation()));
+        if (any(node->GetRotation() != dquat::identity()))
+            nodeJson["rotation"] = ToJson(float4(quat(node->GetRotation()).toXYZW()));
+        if (any(node->GetScaling() != double3(1.0)))
+            nodeJson["scale"] = ToJson(float3(node->GetScaling()));
+
+        for (size_t childIndex = 0; childIndex < node->GetNumChildren(); childIndex++)
+            nodeJson["children"].append(nodeIndices[node->GetChild(childIndex)]);
+
+        const SceneGraphLeaf* leaf = node->GetLeaf().get();
+        if (auto meshInstance = dynamic_cast<const MeshInstance*>(leaf))
+        {
+            auto mesh = meshIndices.find(meshInstance->GetMesh().get());
+            if (mesh != meshIndices.end())
+                nodeJson["mesh"] = mesh->second;
+        }
+        else if (auto light = dynamic_cast<const Light*>(leaf))
+        {
+            nodeJson["extensions"]["KHR_lights_punctual"]["light"] = int(lights.size());
+            lights.push_back(light);
+        }
+
+        root["nodes"].append(nodeJson);
+    }
+
+    root["scene"] = 0;
+    root["scenes"][0]["nodes"].append(0);
+
+    // Lights, see KHR_lights_punctual. The spot light angles are stored as apex angles in degrees.
+    if (!lights.empty())
+    {
+        root["extensionsUsed"].append("KHR_lights_punctual");
+        Json::Value& lightsJson = root["extensions"]["KHR_lights_punctual"]["lights"];
+
+        for (const Light* light : lights)
+        {
+            Json::Value lightJson;
+            if (!light->GetName().empty())
+                lightJson["name"] = light->GetName();
+            lightJson["color"] = ToJson(light->color);
+
+            if (auto directional = dynamic_cast<const DirectionalLight*>(light))
+            {
+                lightJson["type"] = "directional";
+                lightJson["intensity"] = directional->irradiance;
+            }
+            else if (auto point = dynamic_cast<const PointLight*>(light))
+            {
+                lightJson["type"] = "point";
+                lightJson["intensity"] = point->intensity;
+                if (point->range > 0.f)
+                    lightJson["range"] = point->range;
+            }
+            else if (auto spot = dynamic_cast<const SpotLight*>(light))
+            {
+                lightJson["type"] = "spot";
+                lightJson["intensity"] = spot->intensity;
+                if (spot->range > 0.f)
+                    lightJson["range"] = spot->range;
+                lightJson["spot"]["innerConeAngle"] = radians(spot->innerAngle);
+                lightJson["spot"]["outerConeAngle"] = radians(spot->outerAngle);
+            }
+
+            lightsJson.append(lightJson);
+        }
+    }
+
+    // Node animations. Channels that share a sampler share the glTF sampler too.
+    for (const auto& animation : sceneGraph.GetAnimations())
+    {
+        Json::Value animationJson;
+        if (!animation->GetName().empty())
+            animationJson["name"] = animation->GetName();
+
+        std::unordered_map<const animation::Sampler*, int> samplerIndices;
+
+        for (const auto& channel : animation->GetChannels())
+        {
+            const char* path = GetAnimationPath(channel->GetAttribute());
+            auto targetNode = channel->GetTargetNode();
+            auto target = nodeIndices.find(targetNode.get());
+            if (!path || target == nodeIndices.end())
+                continue;
+
+            const animation::Sampler* sampler = channel->GetSampler().get();
+            auto samplerIndex = samplerIndices.find(sampler);
+            if (samplerIndex == samplerIndices.end())
+            {
+                const auto& keyframes = const_cast<animation::Sampler*>(sampler)->GetKeyframes();
+                if (keyframes.empty())
+                    continue;
+
+                const char* interpolation = "LINEAR";
+                switch (sampler->GetMode())
+                {
+                case animation::InterpolationMode::Step: interpolation = "STEP"; break;
+                case animation::InterpolationMode::HermiteSpline: interpolation = "CUBICSPLINE"; break;
+                case animation::InterpolationMode::CatmullRomSpline:
+                    log::warning("glTF has no Catmull-Rom interpolation, writing animation '%s' as linear", animation->GetName().c_str());
+                    break;
+                default: break;
+                }
+                const bool cubic = sampler->GetMode() == animation::InterpolationMode::HermiteSpline;
+                const bool rotation = channel->GetAttribute() == AnimationAttribute::Rotation;
+
+                std::vector<float> times;
+                std::vector<float> values;
+                for (const auto& keyframe : keyframes)
+                {
+                    times.push_back(keyframe.time);
+
+                    const int components = rotation ? 4 : 3;
+                    if (cubic)
+                        values.insert(values.end(), &keyframe.inTangent.x, &keyframe.inTangent.x + components);
+                    values.insert(values.end(), &keyframe.value.x, &keyframe.value.x + components);
+                    if (cubic)
+                        values.insert(values.end(), &keyframe.outTangent.x, &keyframe.outTangent.x + components);
+                }
+
+                const int timeAccessor = writer.AddAccessor(writer.AddBufferView(times.data(), times.size() * sizeof(float), 0),
+                    0, c_ComponentFloat, times.size(), "SCALAR");
+                writer.GetAccessor(timeAccessor)["min"].append(times.front());
+                writer.GetAccessor(timeAccessor)["max"].append(times.back());
+
+                const int valueAccessor = writer.AddAccessor(writer.AddBufferView(values.data(), values.size() * sizeof(float), 0),
+                    0, c_ComponentFloat, values.size() / (rotation ? 4 : 3), rotation ? "VEC4" : "VEC3");
+
+                Json::Value samplerJson;
+                samplerJson["input"] = timeAccessor;
+                samplerJson["output"] = valueAccessor;
+                samplerJson["interpolation"] = interpolation;
+
+                animationJson["samplers"].append(samplerJson);
+                samplerIndex = samplerIndices.emplace(sampler, int(animationJson["samplers"].size()) - 1).first;
+            }
+
+            Json::Value channelJson;
+            channelJson["sampler"] = samplerIndex->second;
+            channelJson["target"]["node"] = target->second;
+            channelJson["target"]["path"] = path;
+            animationJson["channels"].append(channelJson);
+        }
+
+        if (!animationJson["channels"].empty())
+            root["animations"].append(animationJson);
+    }
+
+    // Buffer and file output
+    std::vector<uint8_t>& binaryData = writer.GetBinary();
+    binaryData.resize((binaryData.size() + 3) & ~size_t(3));
+
+    Json::Value& buffer = root["buffers"][0];
+    buffer["byteLength"] = Json::UInt64(binaryData.size());
+
+    std::filesystem::path binaryFileName = fileName;
+    binaryFileName.replace_extension(".bin");
+    if (!binary)
+        buffer["uri"] = binaryFileName.filename().generic_string();
+
+    if (!binary)
+    {
+        if (!fs.writeFile(binaryFileName, binaryData.data(), binaryData.size()))
+        {
+            log::error("Cannot write '%s'", binaryFileName.generic_string().c_str());
+            return false;
+        }
+        return json::SaveToFile(fs, fileName, root);
+    }
+
+    // GLB container: header, JSON chunk padded with spaces, BIN chunk
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string json = Json::writeString(builder, root);
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+    const uint32_t header[3] = { 0x46546C67, 2, uint32_t(12 + 8 + json.size() + 8 + binaryData.size()) };
+    const uint32_t jsonChunk[2] = { uint32_t(json.size()), 0x4E4F534A };
+    const uint32_t binaryChunk[2] = { uint32_t(binaryData.size()), 0x004E4942 };
+
+    std::vector<uint8_t> glb(header[2]);
+    uint8_t* dst = glb.data();
+    auto append = [&dst](const void* data, size_t size) { memcpy(dst, data, size); dst += size; };
+    append(header, sizeof(header));
+    append(jsonChunk, sizeof(jsonChunk));
+    append(json.data(), json.size());
+    append(binaryChunk, sizeof(binaryChunk));
+    append(binaryData.data(), binaryData.size());
+
+    if (!fs.writeFile(fileName, glb.data(), glb.size()))
+    {
+        log::error("Cannot write '%s'", fileName.generic_string().c_str());
+        return false;
+    }
+
+    return true;
+}
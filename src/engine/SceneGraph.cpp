@@ -871,7 +871,7 @@ std::shared_ptr<SceneGraphNode> SceneGraph::Detach(const std::shared_ptr<SceneGr
     // remove the node from its parent
     if (node->m_Parent)
     {
-        std::vector<std::shared_ptr<SceneGraphNode>>& siblings = node->m_Parent->m_Children;
+        auto& siblings = node->m_Parent->m_Children;
 
         node->m_Parent->PropagateDirtyFlags(SceneGraphNode::DirtyFlags::SubgraphStructure);
 
@@ -361,6 +361,26 @@ nvrhi::VertexAttributeDesc donut::engine::GetVertexAttributeDesc(VertexAttribute
     return result;
 }
 
+template<typename T>
+static size_t GetCapacityBytes(const std::vector<T>& data)
+{
+    return data.capacity() * sizeof(T);
+}
+
+size_t BufferGroup::getCpuDataSize() const
+{
+    return GetCapacityBytes(indexData)
+        + GetCapacityBytes(positionData)
+        + GetCapacityBytes(texcoord1Data)
+        + GetCapacityBytes(texcoord2Data)
+        + GetCapacityBytes(normalData)
+        + GetCapacityBytes(tangentData)
+        + GetCapacityBytes(jointData)
+        + GetCapacityBytes(weightData)
+        + GetCapacityBytes(radiusData)
+        + GetCapacityBytes(morphTargetData);
+}
+
 const char* donut::engine::MaterialDomainToString(MaterialDomain domain)
 {
     switch (domain)
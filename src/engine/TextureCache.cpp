@@ -50,6 +50,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/ConsoleObjects.h>
 #include <donut/engine/DDSFile.h>
+#include <donut/engine/MemoryReport.h>
 #include <donut/core/vfs/VFS.h>
 #include <donut/core/log.h>
 
@@ -100,9 +101,14 @@ class StbImageBlob : public IBlob
 {
 private:
     unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    donut::memory::Tag m_MemoryTag;
 
 public:
-    StbImageBlob(unsigned char* _data) : m_data(_data) 
+    StbImageBlob(unsigned char* _data, size_t _size)
+        : m_data(_data)
+        , m_size(_size)
+        , m_MemoryTag(donut::memory::Category::TextureData, _size)
     {
     }
 
@@ -122,7 +128,7 @@ public:
 
     virtual size_t size() const override
     {
-        return 0; // nobody cares
+        return m_size;
     }
 };
 
@@ -211,6 +217,10 @@ bool TextureCache::FillTextureData(
             log::message(m_ErrorLogSeverity, "Couldn't load DDS texture '%s'", texture->path.c_str());
             return false;
         }
+
+        // The file contents are the texture data now
+        if (auto blob = std::dynamic_pointer_cast<Blob>(fileData))
+            blob->SetMemoryCategory(memory::Category::TextureData);
     }
 #ifdef DONUT_WITH_TINYEXR
     else if (extension == ".exr" || extension == ".EXR" || mimeType == "image/aces")
@@ -226,7 +236,7 @@ bool TextureCache::FillTextureData(
             uint32_t channels = 4;
             uint32_t bytesPerPixel = channels * 4;
 
-            texture->data = std::make_shared<Blob>(data, bytesPerPixel * width * height);
+            texture->data = std::make_shared<Blob>(data, bytesPerPixel * width * height, memory::Category::TextureData);
             texture->width = static_cast<uint32_t>(width);
             texture->height = static_cast<uint32_t>(height);
             texture->format = nvrhi::Format::RGBA32_FLOAT;
@@ -315,7 +325,7 @@ bool TextureCache::FillTextureData(
         texture->dataLayout[0][0].rowPitch = static_cast<size_t>(width * bytesPerPixel);
         texture->dataLayout[0][0].dataSize = static_cast<size_t>(width * height * bytesPerPixel);
 
-        texture->data = std::make_shared<StbImageBlob>(bitmap);
+        texture->data = std::make_shared<StbImageBlob>(bitmap, static_cast<size_t>(width * height * bytesPerPixel));
         bitmap = nullptr; // ownership transferred to the blob
 
         switch (channels)
@@ -415,6 +425,7 @@ void TextureCache::FinalizeTexture(
     textureDesc.debugName = texture->path;
     textureDesc.isRenderTarget = texture->isRenderTarget;
     texture->texture = m_Device->createTexture(textureDesc);
+    texture->gpuMemory.Set(GetGpuMemorySize(texture->texture));
 
     commandList->beginTrackingTextureState(texture->texture, nvrhi::AllSubresources, nvrhi::ResourceStates::Common);
 
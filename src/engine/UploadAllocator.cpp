@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/UploadAllocator.h>
+#include <donut/core/log.h>
+#include <nvrhi/common/misc.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace donut::engine;
+
+UploadAllocator::UploadAllocator(nvrhi::IDevice* device, const CreateParameters& params)
+    : m_Device(device)
+    , m_Params(params)
+{
+    assert(m_Params.pageSize > 0);
+}
+
+UploadAllocator::~UploadAllocator()
+{
+    Clear();
+}
+
+bool UploadAllocator::MapPage(Page& page)
+{
+    if (page.mappedData)
+        return true;
+
+    page.mappedData = static_cast<uint8_t*>(m_Device->mapBuffer(page.buffer, nvrhi::CpuAccessMode::Write));
+    if (!page.mappedData)
+    {
+        log::error("UploadAllocator: failed to map an upload page of %llu bytes", (unsigned long long)page.size);
+        return false;
+    }
+
+    return true;
+}
+
+UploadAllocator::Page* UploadAllocator::GetPageForAllocation(uint64_t size, uint64_t alignment)
+{
+    if (!m_CurrentPages.empty())
+    {
+        Page& page = m_CurrentPages.back();
+        if (nvrhi::align(page.used, alignment) + size <= page.size)
+            return &page;
+    }
+
+    Page page;
+
+    const bool oversized = size > m_Params.pageSize;
+    if (!oversized && !m_FreePages.empty())
+    {
+        page = std::move(m_FreePages.back());
+        m_FreePages.pop_back();
+    }
+    else
+    {
+        page.size = oversized ? nvrhi::align(size, uint64_t(65536)) : m_Params.pageSize;
+
+        nvrhi::BufferDesc bufferDesc;
+        bufferDesc.byteSize = page.size;
+        bufferDesc.debugName = "UploadAllocator page";
+        bufferDesc.cpuAccess = nvrhi::CpuAccessMode::Write;
+        bufferDesc.canHaveRawViews = true;
+        page.buffer = m_Device->createBuffer(bufferDesc);
+
+        if (!page.buffer)
+        {
+            log::error("UploadAllocator: failed to create an upload page of %llu bytes", (unsigned long long)page.size);
+            return nullptr;
+        }
+
+        ++m_NumPagesTotal;
+        if (oversized)
+            ++m_CurrentStats.numOversizedAllocations;
+    }
+
+    page.used = 0;
+    m_CurrentPages.push_back(std::move(page));
+    ++m_CurrentStats.numPagesUsed;
+
+    return &m_CurrentPages.back();
+}
+
+UploadAllocation UploadAllocator::AllocateInternal(uint64_t size, uint64_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    Page* page = GetPageForAllocation(size, alignment);
+    if (!page || !MapPage(*page))
+        return UploadAllocation();
+
+    const uint64_t offset = nvrhi::align(page->used, alignment);
+    m_CurrentStats.bytesAllocated += offset + size - page->used;
+    ++m_CurrentStats.numAllocations;
+    page->used = offset + size;
+
+    UploadAllocation allocation;
+    allocation.buffer = page->buffer;
+    allocation.offset = offset;
+    allocation.cpuAddress = page->mappedData + offset;
+    return allocation;
+}
+
+UploadAllocation UploadAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    return AllocateInternal(size, alignment);
+}
+
+bool UploadAllocator::Write(nvrhi::IBuffer* destBuffer, const void* data, uint64_t size, uint64_t destOffset)
+{
+    assert(destBuffer);
+
+    if (size == 0)
+        return true;
+
+    // Hold the lock across the copy so that a concurrent Flush() cannot unmap the page in between
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    UploadAllocation allocation = AllocateInternal(size, 16);
+    if (!allocation.IsValid())
+        return false;
+
+    memcpy(allocation.cpuAddress, data, size);
+    m_PendingCopies.push_back({ destBuffer, destOffset, allocation.buffer, allocation.offset, size });
+    return true;
+}
+
+void UploadAllocator::Flush(nvrhi::ICommandList* commandList)
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    // Unmap before the copies so that D3D11 sees the data, the pages are mapped again on the next allocation
+    for (auto& page : m_CurrentPages)
+    {
+        if (page.mappedData)
+        {
+            m_Device->unmapBuffer(page.buffer);
+            page.mappedData = nullptr;
+        }
+    }
+
+    if (m_PendingCopies.empty())
+        return;
+
+    for (const auto& copy : m_PendingCopies)
+    {
+        commandList->copyBuffer(copy.destBuffer, copy.destOffset, copy.srcBuffer, copy.srcOffset, copy.size);
+    }
+
+    m_CurrentStats.numCopies += uint32_t(m_PendingCopies.size());
+    ++m_CurrentStats.numFlushes;
+    m_PendingCopies.clear();
+}
+
+void UploadAllocator::RetireCompletedFrames(bool wait)
+{
+    while (!m_FramesInFlight.empty())
+    {
+        FrameInFlight& frame = m_FramesInFlight.front();
+
+        if (wait)
+            m_Device->waitEventQuery(frame.query);
+        else if (!m_Device->pollEventQuery(frame.query))
+            break;
+
+        for (auto& page : frame.pages)
+        {
+            // Dedicated pages for oversized allocations are released instead of recycled
+            if (page.size == m_Params.pageSize)
+                m_FreePages.push_back(std::move(page));
+            else
+                --m_NumPagesTotal;
+        }
+
+        m_QueryPool.push_back(std::move(frame.query));
+        m_FramesInFlight.pop_front();
+    }
+}
+
+void UploadAllocator::BeginFrame()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    RetireCompletedFrames(false);
+
+    m_CurrentStats = UploadAllocatorStats();
+}
+
+void UploadAllocator::EndFrame()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (!m_PendingCopies.empty())
+    {
+        log::warning("UploadAllocator::EndFrame() called with %d writes that were never flushed",
+            int(m_PendingCopies.size()));
+        m_PendingCopies.clear();
+    }
+
+    if (!m_CurrentPages.empty())
+    {
+        for (auto& page : m_CurrentPages)
+        {
+            if (page.mappedData)
+            {
+                m_Device->unmapBuffer(page.buffer);
+                page.mappedData = nullptr;
+            }
+        }
+
+        FrameInFlight frame;
+        if (!m_QueryPool.empty())
+        {
+            frame.query = std::move(m_QueryPool.back());
+            m_QueryPool.pop_back();
+        }
+        else
+            frame.query = m_Device->createEventQuery();
+
+        m_Device->resetEventQuery(frame.query);
+        m_Device->setEventQuery(frame.query, nvrhi::CommandQueue::Graphics);
+        frame.pages = std::move(m_CurrentPages);
+        m_CurrentPages.clear();
+        m_FramesInFlight.push_back(std::move(frame));
+    }
+
+    m_CurrentStats.numPagesTotal = m_NumPagesTotal;
+    m_LastFrameStats = m_CurrentStats;
+    m_PeakBytesAllocated = std::max(m_PeakBytesAllocated, m_CurrentStats.bytesAllocated);
+}
+
+void UploadAllocator::Clear()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    RetireCompletedFrames(true);
+
+    for (auto& page : m_CurrentPages)
+    {
+        if (page.mappedData)
+            m_Device->unmapBuffer(page.buffer);
+    }
+
+    m_CurrentPages.clear();
+    m_FreePages.clear();
+    m_PendingCopies.clear();
+    m_NumPagesTotal = 0;
+}
@@ -21,7 +21,9 @@
 */
 
 #include <donut/render/BloomPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/MemoryReport.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/View.h>
@@ -155,6 +157,14 @@ BloomPass::BloomPass(
         };
         perViewData.bloomBlurBindingSetPass2 = m_Device->createBindingSet(bindingSetDesc, m_BloomBlurBindingLayout);
     }
+
+    uint64_t textureMemory = 0;
+    for (const PerViewData& perViewData : m_PerViewData)
+    {
+        textureMemory += GetGpuMemorySize(perViewData.textureDownscale1) + GetGpuMemorySize(perViewData.textureDownscale2)
+            + GetGpuMemorySize(perViewData.texturePass1Blur) + GetGpuMemorySize(perViewData.texturePass2Blur);
+    }
+    m_MemoryTag.Set(size_t(textureMemory));
 }
 
 void BloomPass::Render(
@@ -165,6 +175,8 @@ void BloomPass::Render(
     float sigmaInPixels,
     float blendFactor)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Bloom");
+
     float effectiveSigma = clamp(sigmaInPixels * 0.25f, 1.f, 100.f);
 
     commandList->beginMarker("Bloom");
@@ -21,9 +21,13 @@
 */
 
 #include <donut/render/CascadedShadowMap.h>
+#include <donut/engine/Profiler.h>
 #include <donut/render/DepthPass.h>
 #include <donut/render/DrawStrategy.h>
+#include <donut/render/GeometryPasses.h>
 #include <donut/render/PlanarShadowMap.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/MemoryReport.h>
 
 using namespace donut::math;
 using namespace donut::engine;
@@ -36,6 +40,7 @@ CascadedShadowMap::CascadedShadowMap(
     int numPerObjectShadows,
     nvrhi::Format format,
     bool isUAV)
+    : m_Device(device)
 {
     assert(numCascades > 0);
     assert(numCascades <= 4);
@@ -56,6 +61,7 @@ CascadedShadowMap::CascadedShadowMap(
     desc.arraySize = numCascades + numPerObjectShadows;
 	desc.isUAV = isUAV;
     m_ShadowMapTexture = device->createTexture(desc);
+    m_MemoryTag.Set(GetGpuMemorySize(m_ShadowMapTexture));
 
     nvrhi::Viewport cascadeViewport = nvrhi::Viewport(float(resolution), float(resolution));
 
@@ -68,6 +74,9 @@ CascadedShadowMap::CascadedShadowMap(
     }
 
     m_NumberOfCascades = 0;
+    m_CascadeCache.resize(numCascades);
+    m_CascadeFits.resize(numCascades);
+    m_FirstStaggeredCascade = numCascades;
 
     for (int object = 0; object < numPerObjectShadows; object++)
     {
@@ -120,11 +129,12 @@ bool CascadedShadowMap::SetupForPlanarView(const DirectionalLight& light, frustu
         if (cascade == 0)
             near = 0.f;
 
+        std::array<float3, frustum::numCorners> cascadeCorners;
         std::array<float3, frustum::numCorners> cascadeViewCorners;
         for (uint32_t i = 0; i < frustum::numCorners; i++)
         {
-            float3 corner = lerp(corners[i & 3], corners[(i & 3) + 4], (i & 4) ? far : near);
-            cascadeViewCorners[i] = worldToView.transformPoint(corner);
+            cascadeCorners[i] = lerp(corners[i & 3], corners[(i & 3) + 4], (i & 4) ? far : near);
+            cascadeViewCorners[i] = worldToView.transformPoint(cascadeCorners[i]);
         }
 
         box3 cascadeViewBounds = box3(frustum::numCorners, cascadeViewCorners.data());
@@ -139,8 +149,13 @@ bool CascadedShadowMap::SetupForPlanarView(const DirectionalLight& light, frustu
         cascadeCenter += dm::float3(light.GetDirection()) * (zDown - zUp) * 0.5f;
         halfShadowBoxSize.z = (zDown + zUp) * 0.5f;
 
-        if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, preViewTranslation, fadeRange))
-            viewModified = true;
+        if (IsCascadeUpdateDue(cascade))
+        {
+            SetCascadeReceivers(cascade, cascadeCorners);
+
+            if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, preViewTranslation, fadeRange))
+                viewModified = true;
+        }
 
         far = near;
         near = far / exponent;
@@ -215,8 +230,17 @@ bool CascadedShadowMap::SetupForPlanarViewStable(const DirectionalLight& light,
         cascadeCenter += dm::float3(light.GetDirection()) * (zDown - zUp) * 0.5f;
         halfShadowBoxSize.z = (zDown + zUp) * 0.5f;
 
-        if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, preViewTranslation, fadeRange))
-            viewModified = true;
+        if (IsCascadeUpdateDue(cascade))
+        {
+            std::array<float3, frustum::numCorners> cascadeWorldCorners;
+            for (uint32_t i = 0; i < frustum::numCorners; i++)
+                cascadeWorldCorners[i] = inverseViewMatrix.transformPoint(cascadeCorners[i]);
+
+            SetCascadeReceivers(cascade, cascadeWorldCorners);
+
+            if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, preViewTranslation, fadeRange))
+                viewModified = true;
+        }
 
         far = near;
         near = far / exponent;
@@ -251,11 +275,12 @@ bool CascadedShadowMap::SetupForCubemapView(const DirectionalLight& light, float
 
     for (int cascade = m_NumberOfCascades - 1; cascade >= 0; cascade--)
     {
+        std::array<float3, box3::numCorners> cascadeCorners;
         std::array<float3, box3::numCorners> cascadeViewCorners;
         for (uint32_t i = 0; i < box3::numCorners; i++)
         {
-            float3 corner = center + corners[i] * far;
-            cascadeViewCorners[i] = worldToView.transformPoint(corner);
+            cascadeCorners[i] = center + corners[i] * far;
+            cascadeViewCorners[i] = worldToView.transformPoint(cascadeCorners[i]);
         }
 
         box3 cascadeViewBounds = box3(box3::numCorners, cascadeViewCorners.data());
@@ -270,8 +295,13 @@ bool CascadedShadowMap::SetupForCubemapView(const DirectionalLight& light, float
         cascadeCenter += dm::float3(light.GetDirection()) * (zDown - zUp) * 0.5f;
         halfShadowBoxSize.z = (zDown + zUp) * 0.5f;
 
-        if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, fadeRange))
-            viewModified = true;
+        if (IsCascadeUpdateDue(cascade))
+        {
+            SetCascadeReceivers(cascade, cascadeCorners);
+
+            if (m_Cascades[cascade]->SetupDynamicDirectionalLightView(light, cascadeCenter, halfShadowBoxSize, fadeRange))
+                viewModified = true;
+        }
         
         far = far / exponent;
     }
@@ -284,6 +314,130 @@ bool CascadedShadowMap::SetupPerObjectShadow(const DirectionalLight& light, uint
     return m_PerObjectShadows[object]->SetupWholeSceneDirectionalLightView(light, objectBounds);
 }
 
+void CascadedShadowMap::SetCascadeReceivers(int cascade, const std::array<float3, 8>& worldCorners)
+{
+    CascadeFit& fit = m_CascadeFits[cascade];
+    fit.receiverCorners = worldCorners;
+    fit.casterVolume = box3::empty();
+    fit.fitted = false;
+}
+
+void CascadedShadowMap::FitCascadesToCasters(const SceneGraph& scene)
+{
+    if (!scene.GetRootNode())
+        return;
+
+    // The receiver corners come from the same world space frustum that the cascade view was built from,
+    // and the preViewTranslation passed to the Setup... functions only affects the texel snapping,
+    // so the receivers, the cascade views and the node bounds used below are all in world space.
+    const box3 sceneBounds = scene.GetRootNode()->GetGlobalBoundingBox();
+
+    struct PendingFit
+    {
+        int cascade;
+        affine3 worldToView;
+        box3 shadowBounds;
+        box3 receiverBounds;
+        box3 casterVolume;
+        float casterMinZ;
+    };
+
+    std::vector<PendingFit> pendingFits;
+
+    for (int cascade = 0; cascade < m_NumberOfCascades; cascade++)
+    {
+        if (!IsCascadeUpdateDue(cascade))
+            continue;
+
+        PlanarShadowMap& shadowMap = *m_Cascades[cascade];
+        CascadeFit& fit = m_CascadeFits[cascade];
+
+        const affine3 worldToView = shadowMap.GetPlanarView()->GetViewMatrix();
+        const box3 shadowBounds = shadowMap.GetOrthographicViewBounds();
+        const box3 sceneViewBounds = sceneBounds * worldToView;
+
+        // The receivers are limited by the cascade slice, the scene and the XY extent of the shadow map
+        box3 receiverBounds = box3(8, fit.receiverCorners.data()) * worldToView;
+        receiverBounds &= sceneViewBounds;
+        receiverBounds.m_mins.xy() = max(receiverBounds.m_mins.xy(), shadowBounds.m_mins.xy());
+        receiverBounds.m_maxs.xy() = min(receiverBounds.m_maxs.xy(), shadowBounds.m_maxs.xy());
+
+        fit.fitted = true;
+
+        if (receiverBounds.isempty())
+        {
+            fit.casterVolume = box3::empty();
+            continue;
+        }
+
+        // Extrude the receivers towards the light, which is -Z in the light view space
+        box3 casterVolume = receiverBounds;
+        casterVolume.m_mins.z = std::min(sceneViewBounds.m_mins.z, receiverBounds.m_mins.z);
+
+        pendingFits.push_back({ cascade, worldToView, shadowBounds, receiverBounds, casterVolume, receiverBounds.m_mins.z });
+    }
+
+    if (pendingFits.empty())
+        return;
+
+    // Find the closest caster for all cascades in one walk over the scene graph, using the subgraph bounds
+    // of the nodes as a BVH: subgraphs that are outside of all caster volumes are skipped.
+    const SceneContentFlags casterFlags = SceneContentFlags::OpaqueMeshes | SceneContentFlags::AlphaTestedMeshes | SceneContentFlags::BlendedMeshes;
+
+    SceneGraphWalker walker(scene.GetRootNode().get());
+    while (walker)
+    {
+        bool visitChildren = false;
+
+        if ((walker->GetSubgraphContentFlags() & casterFlags) != 0)
+        {
+            const box3& nodeBounds = walker->GetGlobalBoundingBox();
+            const bool isCaster = (walker->GetLeafContentFlags() & casterFlags) != 0;
+
+            for (PendingFit& pending : pendingFits)
+            {
+                const box3 viewBounds = nodeBounds * pending.worldToView;
+                if (!viewBounds.intersects(pending.casterVolume))
+                    continue;
+
+                visitChildren = true;
+
+                if (isCaster)
+                    pending.casterMinZ = std::min(pending.casterMinZ, viewBounds.m_mins.z);
+            }
+        }
+
+        walker.Next(visitChildren);
+    }
+
+    for (const PendingFit& pending : pendingFits)
+    {
+        const float casterMinZ = std::max(pending.casterMinZ, pending.casterVolume.m_mins.z);
+
+        // Snap the depth range to a grid so that small caster movements do not change the projection,
+        // which would invalidate the static cache
+        const float depthStep = (pending.shadowBounds.m_maxs.x - pending.shadowBounds.m_mins.x) / 32.f;
+        const float zNear = floorf(casterMinZ / depthStep) * depthStep;
+        const float zFar = std::max(ceilf(pending.receiverBounds.m_maxs.z / depthStep) * depthStep, zNear + depthStep);
+
+        m_Cascades[pending.cascade]->SetOrthographicDepthRange(zNear, zFar);
+
+        box3 casterVolume = pending.casterVolume;
+        casterVolume.m_mins.z = zNear;
+        casterVolume.m_maxs.z = zFar;
+        m_CascadeFits[pending.cascade].casterVolume = casterVolume;
+    }
+}
+
+bool CascadedShadowMap::IsPotentialCaster(uint32_t cascade, const box3& worldBounds) const
+{
+    if (cascade >= m_CascadeFits.size() || !m_CascadeFits[cascade].fitted)
+        return true;
+
+    const affine3 worldToView = m_Cascades[cascade]->GetPlanarView()->GetViewMatrix();
+    return (worldBounds * worldToView).intersects(m_CascadeFits[cascade].casterVolume);
+}
+
 void CascadedShadowMap::SetupProxyViews()
 {
     for (auto cascade : m_Cascades)
@@ -297,6 +451,136 @@ void CascadedShadowMap::SetupProxyViews()
     }
 }
 
+void CascadedShadowMap::SetStaticCachingEnabled(bool enabled)
+{
+    if (enabled == m_StaticCachingEnabled)
+        return;
+
+    m_StaticCachingEnabled = enabled;
+
+    if (enabled)
+    {
+        nvrhi::TextureDesc desc = m_ShadowMapTexture->getDesc();
+        desc.debugName = "StaticShadowMap";
+        desc.arraySize = uint32_t(m_Cascades.size());
+        desc.isUAV = false;
+        desc.initialState = nvrhi::ResourceStates::DepthWrite;
+        m_StaticShadowMapTexture = m_Device->createTexture(desc);
+
+        m_StaticFramebufferFactory = std::make_shared<FramebufferFactory>(m_Device);
+        m_StaticFramebufferFactory->DepthTarget = m_StaticShadowMapTexture;
+    }
+    else
+    {
+        m_StaticShadowMapTexture = nullptr;
+        m_StaticFramebufferFactory = nullptr;
+    }
+
+    m_MemoryTag.Set(GetGpuMemorySize(m_ShadowMapTexture) + GetGpuMemorySize(m_StaticShadowMapTexture));
+
+    InvalidateStaticCache();
+}
+
+void CascadedShadowMap::InvalidateStaticCache()
+{
+    for (CascadeCacheState& cache : m_CascadeCache)
+        cache.staticContentValid = false;
+}
+
+void CascadedShadowMap::SetStaggeredCascadeUpdates(int firstCascade, uint32_t interval)
+{
+    m_FirstStaggeredCascade = std::max(firstCascade, 0);
+    m_StaggeredUpdateInterval = std::max(interval, 1u);
+}
+
+bool CascadedShadowMap::IsCascadeUpdateDue(int cascade) const
+{
+    if (cascade < m_FirstStaggeredCascade || m_StaggeredUpdateInterval <= 1)
+        return true;
+
+    if (!m_CascadeCache[cascade].rendered)
+        return true;
+
+    // Offset by the cascade index so that the staggered cascades are not all updated on the same frame
+    return (m_FrameIndex + uint32_t(cascade)) % m_StaggeredUpdateInterval == 0;
+}
+
+void CascadedShadowMap::RenderCascades(
+    nvrhi::ICommandList* commandList,
+    const std::shared_ptr<SceneGraphNode>& rootNode,
+    IDrawStrategy& staticCasters,
+    IDrawStrategy& dynamicCasters,
+    IGeometryPass& depthPass,
+    GeometryPassContext& passContext)
+{
+    DONUT_PROFILE_GPU_SCOPE(commandList, "CascadedShadowMap");
+
+    if (!m_FramebufferFactory)
+    {
+        m_FramebufferFactory = std::make_shared<FramebufferFactory>(m_Device);
+        m_FramebufferFactory->DepthTarget = m_ShadowMapTexture;
+    }
+
+    const bool hasStencil = nvrhi::getFormatInfo(m_ShadowMapTexture->getDesc().format).hasStencil;
+
+    commandList->beginMarker("CascadedShadowMap");
+
+    for (int cascade = 0; cascade < m_NumberOfCascades; cascade++)
+    {
+        if (!IsCascadeUpdateDue(cascade))
+            continue;
+
+        const PlanarView& view = *m_Cascades[cascade]->GetPlanarView();
+        const nvrhi::TextureSubresourceSet subresources = view.GetSubresources();
+        CascadeCacheState& cache = m_CascadeCache[cascade];
+
+        auto isPotentialCaster = [this, cascade](const DrawItem& item)
+        {
+            const SceneGraphNode* node = item.instance->GetNode();
+            return !node || IsPotentialCaster(uint32_t(cascade), node->GetGlobalBoundingBox());
+        };
+        FilteredDrawStrategy cascadeStaticCasters(staticCasters, isPotentialCaster);
+        FilteredDrawStrategy cascadeDynamicCasters(dynamicCasters, isPotentialCaster);
+
+        if (m_StaticCachingEnabled)
+        {
+            // Any change of the light direction or the cascade bounds shows up in the view-projection matrix
+            const float4x4 viewProjection = view.GetViewProjectionMatrix();
+
+            if (!cache.staticContentValid || any(cache.viewProjection != viewProjection))
+            {
+                commandList->clearDepthStencilTexture(m_StaticShadowMapTexture, subresources, true, 1.f, hasStencil, 0);
+
+                cascadeStaticCasters.PrepareForView(rootNode, view);
+                RenderView(commandList, &view, nullptr, m_StaticFramebufferFactory->GetFramebuffer(view), cascadeStaticCasters, depthPass, passContext);
+
+                cache.viewProjection = viewProjection;
+                cache.staticContentValid = true;
+            }
+
+            nvrhi::TextureSlice slice;
+            slice.arraySlice = subresources.baseArraySlice;
+            commandList->copyTexture(m_ShadowMapTexture, slice, m_StaticShadowMapTexture, slice);
+        }
+        else
+        {
+            commandList->clearDepthStencilTexture(m_ShadowMapTexture, subresources, true, 1.f, hasStencil, 0);
+
+            cascadeStaticCasters.PrepareForView(rootNode, view);
+            RenderView(commandList, &view, nullptr, m_FramebufferFactory->GetFramebuffer(view), cascadeStaticCasters, depthPass, passContext);
+        }
+
+        cascadeDynamicCasters.PrepareForView(rootNode, view);
+        RenderView(commandList, &view, nullptr, m_FramebufferFactory->GetFramebuffer(view), cascadeDynamicCasters, depthPass, passContext);
+
+        cache.rendered = true;
+    }
+
+    commandList->endMarker();
+
+    ++m_FrameIndex;
+}
+
 void CascadedShadowMap::SetLitOutOfBounds(bool litOutOfBounds)
 {
     for (auto cascade : m_Cascades)
@@ -21,8 +21,10 @@
 */
 
 #include <donut/render/DeferredLightingPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/render/DrawStrategy.h>
 #include <donut/render/GBuffer.h>
+#include <donut/render/LightClusteringPass.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/ShadowMap.h>
@@ -30,6 +32,7 @@
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/View.h>
 #include <donut/core/log.h>
+#include <algorithm>
 #include <utility>
 
 #if DONUT_WITH_STATIC_SHADERS
@@ -113,16 +116,60 @@ void donut::render::DeferredLightingPass::Init(const std::shared_ptr<engine::Sha
         m_BindingLayout = m_Device->createBindingLayout(layoutDesc);
         
         nvrhi::ComputePipelineDesc pipelineDesc;
-        pipelineDesc.CS = CreateComputeShader(*shaderFactory);
+        pipelineDesc.CS = CreateComputeShader(*shaderFactory, DEFERRED_LIGHTING_MODE_CONSTANTS);
         pipelineDesc.bindingLayouts = { m_BindingLayout };
         
         m_Pso = m_Device->createComputePipeline(pipelineDesc);
+
+        nvrhi::BindingLayoutDesc tiledLayoutDesc = layoutDesc;
+        tiledLayoutDesc
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(DEFERRED_BINDING_TILED_LIGHTS))
+            .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(DEFERRED_BINDING_TILED_SHADOWS));
+        m_TiledBindingLayout = m_Device->createBindingLayout(tiledLayoutDesc);
+
+        pipelineDesc.CS = CreateComputeShader(*shaderFactory, DEFERRED_LIGHTING_MODE_TILED);
+        pipelineDesc.bindingLayouts = { m_TiledBindingLayout };
+
+        m_TiledPso = m_Device->createComputePipeline(pipelineDesc);
+
+        LightClusteringPass::AddBindingLayoutItems(layoutDesc, DEFERRED_BINDING_LIGHT_CLUSTER_CONSTANTS, DEFERRED_BINDING_CLUSTERED_LIGHTS);
+        m_ClusteredBindingLayout = m_Device->createBindingLayout(layoutDesc);
+
+        pipelineDesc.CS = CreateComputeShader(*shaderFactory, DEFERRED_LIGHTING_MODE_CLUSTERED);
+        pipelineDesc.bindingLayouts = { m_ClusteredBindingLayout };
+
+        m_ClusteredPso = m_Device->createComputePipeline(pipelineDesc);
     }
+
+    EnsureBufferCapacity(m_LightBuffer, 1, sizeof(LightConstants), "DeferredLights");
+    EnsureBufferCapacity(m_ShadowBuffer, 1, sizeof(ShadowConstants), "DeferredShadows");
 }
 
-nvrhi::ShaderHandle DeferredLightingPass::CreateComputeShader(ShaderFactory& shaderFactory)
+void DeferredLightingPass::EnsureBufferCapacity(nvrhi::BufferHandle& buffer, size_t numElements, uint32_t stride, const char* debugName)
 {
-    return shaderFactory.CreateAutoShader("donut/passes/deferred_lighting_cs.hlsl", "main", DONUT_MAKE_PLATFORM_SHADER(g_deferred_lighting_cs), nullptr, nvrhi::ShaderType::Compute);
+    if (buffer && buffer->getDesc().byteSize >= numElements * stride)
+        return;
+
+    // Grow in powers of two to avoid recreating the buffers and their binding sets every frame
+    size_t capacity = 64;
+    while (capacity < numElements)
+        capacity *= 2;
+
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = capacity * stride;
+    bufferDesc.structStride = stride;
+    bufferDesc.debugName = debugName;
+    bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+    bufferDesc.keepInitialState = true;
+    buffer = m_Device->createBuffer(bufferDesc);
+}
+
+nvrhi::ShaderHandle DeferredLightingPass::CreateComputeShader(ShaderFactory& shaderFactory, int lightingMode)
+{
+    std::vector<ShaderMacro> macros;
+    macros.push_back(ShaderMacro("LIGHTING_MODE", std::to_string(lightingMode)));
+
+    return shaderFactory.CreateAutoShader("donut/passes/deferred_lighting_cs.hlsl", "main", DONUT_MAKE_PLATFORM_SHADER(g_deferred_lighting_cs), &macros, nvrhi::ShaderType::Compute);
 }
 
 void DeferredLightingPass::Render(
@@ -131,6 +178,8 @@ void DeferredLightingPass::Render(
     const Inputs& inputs,
     dm::float2 randomOffset)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "DeferredLighting");
+
     assert(inputs.depth);
     assert(inputs.gbufferNormals);
     assert(inputs.gbufferDiffuse);
@@ -154,10 +203,29 @@ void DeferredLightingPass::Render(
 
     nvrhi::ITexture* shadowMapTexture = nullptr;
 
-    int numShadows = 0;
+    bool const tiledLighting = inputs.tiledLighting && !inputs.lightClusters;
+    std::vector<LightConstants> lightConstants;
+    std::vector<ShadowConstants> shadowConstants;
 
-    if (inputs.lights)
+    if (inputs.lightClusters)
+    {
+        shadowMapTexture = inputs.lightClusters->GetShadowMapTexture();
+        deferredConstants.shadowMapTextureSize = inputs.lightClusters->GetShadowMapTextureSize();
+
+        if (compositeView.GetNumChildViews(ViewType::PLANAR) != 1)
+        {
+            log::error("DeferredLightingPass::Render(...) with light clusters only supports a single planar view");
+            commandList->endMarker();
+            return;
+        }
+    }
+    else if (inputs.lights)
     {
+        // The tiled mode reads the lights from structured buffers and has no limits on their number
+        size_t const maxShadows = tiledLighting ? SIZE_MAX : DEFERRED_MAX_SHADOWS;
+        if (tiledLighting)
+            lightConstants.reserve(inputs.lights->size());
+
         for (const auto& light : *inputs.lights)
         {
             if (light->shadowMap)
@@ -177,40 +245,54 @@ void DeferredLightingPass::Render(
                 }
             }
 
-            if (deferredConstants.numLights >= DEFERRED_MAX_LIGHTS)
+            if (!tiledLighting && lightConstants.size() >= DEFERRED_MAX_LIGHTS)
             {
                 log::warning("Maximum number of active lights (%d) exceeded in DeferredLightingPass",
                     DEFERRED_MAX_LIGHTS);
                 break;
             }
 
-            LightConstants& lightConstants = deferredConstants.lights[deferredConstants.numLights];
-            light->FillLightConstants(lightConstants);
+            LightConstants& constants = lightConstants.emplace_back();
+            light->FillLightConstants(constants);
 
             if (light->shadowMap)
             {
                 for (uint32_t cascade = 0; cascade < light->shadowMap->GetNumberOfCascades(); cascade++)
                 {
-                    if (numShadows < DEFERRED_MAX_SHADOWS)
+                    if (shadowConstants.size() < maxShadows)
                     {
-                        light->shadowMap->GetCascade(cascade)->FillShadowConstants(deferredConstants.shadows[numShadows]);
-                        lightConstants.shadowCascades[cascade] = numShadows;
-                        ++numShadows;
+                        constants.shadowCascades[cascade] = int(shadowConstants.size());
+                        light->shadowMap->GetCascade(cascade)->FillShadowConstants(shadowConstants.emplace_back());
                     }
                 }
 
                 for (uint32_t perObjectShadow = 0; perObjectShadow < light->shadowMap->GetNumberOfPerObjectShadows(); perObjectShadow++)
                 {
-                    if (numShadows < DEFERRED_MAX_SHADOWS)
+                    if (shadowConstants.size() < maxShadows)
                     {
-                        light->shadowMap->GetPerObjectShadow(perObjectShadow)->FillShadowConstants(deferredConstants.shadows[numShadows]);
-                        lightConstants.perObjectShadows[perObjectShadow] = numShadows;
-                        ++numShadows;
+                        constants.perObjectShadows[perObjectShadow] = int(shadowConstants.size());
+                        light->shadowMap->GetPerObjectShadow(perObjectShadow)->FillShadowConstants(shadowConstants.emplace_back());
                     }
                 }
             }
+        }
 
-            ++deferredConstants.numLights;
+        deferredConstants.numLights = uint(lightConstants.size());
+
+        if (tiledLighting)
+        {
+            EnsureBufferCapacity(m_LightBuffer, lightConstants.size(), sizeof(LightConstants), "DeferredLights");
+            EnsureBufferCapacity(m_ShadowBuffer, shadowConstants.size(), sizeof(ShadowConstants), "DeferredShadows");
+
+            if (!lightConstants.empty())
+                commandList->writeBuffer(m_LightBuffer, lightConstants.data(), lightConstants.size() * sizeof(LightConstants));
+            if (!shadowConstants.empty())
+                commandList->writeBuffer(m_ShadowBuffer, shadowConstants.data(), shadowConstants.size() * sizeof(ShadowConstants));
+        }
+        else
+        {
+            std::copy(lightConstants.begin(), lightConstants.end(), deferredConstants.lights);
+            std::copy(shadowConstants.begin(), shadowConstants.end(), deferredConstants.shadows);
         }
     }
 
@@ -283,20 +365,38 @@ void DeferredLightingPass::Render(
             nvrhi::BindingSetItem::Sampler(3, m_CommonPasses->m_LinearClampSampler)
         };
 
-        nvrhi::BindingSetHandle bindingSet = m_BindingSets.GetOrCreateBindingSet(bindingSetDesc, m_BindingLayout);
+        nvrhi::IBindingLayout* bindingLayout = m_BindingLayout;
+        nvrhi::IComputePipeline* pipeline = m_Pso;
+
+        if (inputs.lightClusters)
+        {
+            inputs.lightClusters->AddBindingSetItems(bindingSetDesc, DEFERRED_BINDING_LIGHT_CLUSTER_CONSTANTS, DEFERRED_BINDING_CLUSTERED_LIGHTS);
+            bindingLayout = m_ClusteredBindingLayout;
+            pipeline = m_ClusteredPso;
+        }
+        else if (tiledLighting)
+        {
+            bindingSetDesc
+                .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(DEFERRED_BINDING_TILED_LIGHTS, m_LightBuffer))
+                .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(DEFERRED_BINDING_TILED_SHADOWS, m_ShadowBuffer));
+            bindingLayout = m_TiledBindingLayout;
+            pipeline = m_TiledPso;
+        }
+
+        nvrhi::BindingSetHandle bindingSet = m_BindingSets.GetOrCreateBindingSet(bindingSetDesc, bindingLayout);
     
         view->FillPlanarViewConstants(deferredConstants.view);
         commandList->writeBuffer(m_DeferredLightingCB, &deferredConstants, sizeof(deferredConstants));
 
         nvrhi::ComputeState state;
-        state.pipeline = m_Pso;
+        state.pipeline = pipeline;
         state.bindings = { bindingSet };
         commandList->setComputeState(state);
 
         auto viewExtent = view->GetViewExtent();
         commandList->dispatch(
-            dm::div_ceil(viewExtent.width(), 16),
-            dm::div_ceil(viewExtent.height(), 16));
+            dm::div_ceil(viewExtent.width(), DEFERRED_TILE_SIZE),
+            dm::div_ceil(viewExtent.height(), DEFERRED_TILE_SIZE));
     }
 
     commandList->endMarker();
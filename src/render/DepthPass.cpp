@@ -66,7 +66,9 @@ DepthPass::DepthPass(
 
 void DepthPass::Init(ShaderFactory& shaderFactory, const CreateParameters& params)
 {
+    assert(!params.useInputAssembler || !params.compactInstanceData);
     m_UseInputAssembler = params.useInputAssembler;
+    m_CompactInstanceData = params.compactInstanceData;
 
     m_VertexShader = CreateVertexShader(shaderFactory, params);
     m_PixelShader = CreatePixelShader(shaderFactory, params);
@@ -105,8 +107,11 @@ nvrhi::ShaderHandle DepthPass::CreateVertexShader(ShaderFactory& shaderFactory,
     }
     else
     {
+        std::vector<ShaderMacro> macros;
+        macros.push_back(ShaderMacro("COMPACT_INSTANCE_DATA", params.compactInstanceData ? "1" : "0"));
+
         return shaderFactory.CreateAutoShader(sourceFileName, "buffer_loads",
-            DONUT_MAKE_PLATFORM_SHADER(g_depth_vs_buffer_loads), nullptr, nvrhi::ShaderType::Vertex);
+            DONUT_MAKE_PLATFORM_SHADER(g_depth_vs_buffer_loads), &macros, nvrhi::ShaderType::Vertex);
     }
 }
 
@@ -232,6 +237,8 @@ nvrhi::BindingSetHandle DepthPass::CreateInputBindingSet(const BufferGroup* buff
 
 nvrhi::BindingSetHandle DepthPass::GetOrCreateInputBindingSet(const BufferGroup* bufferGroup)
 {
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
     auto it = m_InputBindingSets.find(bufferGroup);
     if (it == m_InputBindingSets.end())
     {
@@ -283,13 +290,8 @@ void DepthPass::SetupView(GeometryPassContext& abstractContext, nvrhi::ICommandL
     context.keyTemplate.bits.reverseDepth = view->IsReverseDepth();
 }
 
-bool DepthPass::SetupMaterial(GeometryPassContext& abstractContext, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state)
+static bool IsAlphaTestedWithTexture(const Material* material)
 {
-    auto& context = static_cast<Context&>(abstractContext);
-
-    PipelineKey key = context.keyTemplate;
-    key.bits.cullMode = cullMode;
-
     bool const hasBaseOrDiffuseTexture = material->baseOrDiffuseTexture
         && material->baseOrDiffuseTexture->texture
         && material->enableBaseOrDiffuseTexture;
@@ -297,8 +299,18 @@ bool DepthPass::SetupMaterial(GeometryPassContext& abstractContext, const engine
     bool const hasOpacityTexture = material->opacityTexture
         && material->opacityTexture->texture
         && material->enableOpacityTexture;
+
+    return material->domain == MaterialDomain::AlphaTested && (hasBaseOrDiffuseTexture || hasOpacityTexture);
+}
+
+bool DepthPass::SetupMaterial(GeometryPassContext& abstractContext, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state)
+{
+    auto& context = static_cast<Context&>(abstractContext);
+
+    PipelineKey key = context.keyTemplate;
+    key.bits.cullMode = cullMode;
         
-    if (material->domain == MaterialDomain::AlphaTested && (hasBaseOrDiffuseTexture || hasOpacityTexture))
+    if (IsAlphaTestedWithTexture(material))
     {
         nvrhi::IBindingSet* materialBindingSet = m_MaterialBindings->GetMaterialBindingSet(material);
 
@@ -328,11 +340,16 @@ bool DepthPass::SetupMaterial(GeometryPassContext& abstractContext, const engine
         std::lock_guard<std::mutex> lockGuard(m_Mutex);
 
         if (!pipeline)
+        {
             pipeline = CreateGraphicsPipeline(key, state.framebuffer);
+            m_PipelineCacheCounters.AddMiss();
+        }
 
         if (!pipeline)
             return false;
     }
+    else
+        m_PipelineCacheCounters.AddHit();
 
     assert(pipeline->getFramebufferInfo() == state.framebuffer->getFramebufferInfo());
 
@@ -340,6 +357,52 @@ bool DepthPass::SetupMaterial(GeometryPassContext& abstractContext, const engine
     return true;
 }
 
+bool DepthPass::PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer)
+{
+    PipelineKey key;
+    key.value = 0;
+    key.bits.cullMode = cullMode;
+    key.bits.frontCounterClockwise = view->IsMirrored();
+    key.bits.reverseDepth = view->IsReverseDepth();
+
+    if (IsAlphaTestedWithTexture(material))
+    {
+        if (!m_MaterialBindings->GetMaterialBindingSet(material))
+            return false;
+
+        key.bits.alphaTested = true;
+    }
+    else if (material->domain == MaterialDomain::Opaque)
+        key.bits.alphaTested = false;
+    else
+        return false;
+
+    nvrhi::GraphicsPipelineHandle& pipeline = m_Pipelines[key.value];
+
+    {
+        // Claim the key, so that materials sharing a pipeline compile it only once
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        if (pipeline || m_PrecreatingPipelines.test(key.value))
+            return false;
+
+        m_PrecreatingPipelines.set(key.value);
+    }
+
+    // Create the pipeline outside of the lock so that several pipelines can be compiled in parallel
+    nvrhi::GraphicsPipelineHandle newPipeline = CreateGraphicsPipeline(key, framebuffer);
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    m_PrecreatingPipelines.reset(key.value);
+
+    // SetupMaterial may have created the pipeline in the meantime
+    if (!newPipeline || pipeline)
+        return false;
+
+    pipeline = newPipeline;
+    m_PipelineCacheCounters.AddPrecreated();
+    return true;
+}
+
 void DepthPass::SetupInputBuffers(GeometryPassContext& abstractContext, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state)
 {
     auto& context = static_cast<Context&>(abstractContext);
@@ -47,6 +47,22 @@ void PassthroughDrawStrategy::SetData(const DrawItem* data, size_t count)
     m_Count = count;
 }
 
+void FilteredDrawStrategy::PrepareForView(const std::shared_ptr<SceneGraphNode>& rootNode, const IView& view)
+{
+    m_Inner.PrepareForView(rootNode, view);
+}
+
+const DrawItem* FilteredDrawStrategy::GetNextItem()
+{
+    while (const DrawItem* item = m_Inner.GetNextItem())
+    {
+        if (m_Predicate(*item))
+            return item;
+    }
+
+    return nullptr;
+}
+
 static int CompareDrawItemsOpaque(const DrawItem* a, const DrawItem* b)
 {
     if (a->material != b->material)
@@ -0,0 +1,156 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/DynamicResolution.h>
+#include <donut/engine/View.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+
+DynamicResolutionController::DynamicResolutionController(nvrhi::IDevice* device, uint32_t maxFramesInFlight)
+    : m_Device(device)
+{
+    assert(maxFramesInFlight > 0);
+
+    // One extra query so that the frame being recorded never waits for the oldest one
+    m_Queries.resize(maxFramesInFlight + 1);
+    for (Query& query : m_Queries)
+        query.handle = m_Device->createTimerQuery();
+
+    SetParameters(m_Params);
+}
+
+void DynamicResolutionController::SetParameters(const DynamicResolutionParameters& params)
+{
+    m_Params = params;
+    m_Params.minScale = std::clamp(m_Params.minScale, 0.01f, 1.f);
+    m_Params.maxScale = std::clamp(m_Params.maxScale, m_Params.minScale, 1.f);
+    m_Scale = std::clamp(m_Scale, m_Params.minScale, m_Params.maxScale);
+}
+
+void DynamicResolutionController::BeginFrame(nvrhi::ICommandList* commandList)
+{
+    assert(!m_InFrame);
+
+    Query& query = m_Queries[m_CurrentQuery];
+
+    // The GPU is further behind than the ring covers: skip measuring this frame instead of stalling
+    if (query.pending)
+        return;
+
+    commandList->beginTimerQuery(query.handle);
+    m_InFrame = true;
+}
+
+void DynamicResolutionController::EndFrame(nvrhi::ICommandList* commandList)
+{
+    if (!m_InFrame)
+        return;
+
+    Query& query = m_Queries[m_CurrentQuery];
+    commandList->endTimerQuery(query.handle);
+    query.pending = true;
+    m_InFrame = false;
+
+    m_CurrentQuery = (m_CurrentQuery + 1) % uint32_t(m_Queries.size());
+}
+
+void DynamicResolutionController::Update()
+{
+    // Consume the finished queries in submission order, starting with the oldest one
+    const uint32_t numQueries = uint32_t(m_Queries.size());
+    for (uint32_t i = 0; i < numQueries; i++)
+    {
+        Query& query = m_Queries[(m_CurrentQuery + i) % numQueries];
+        if (!query.pending)
+            continue;
+
+        if (!m_Device->pollTimerQuery(query.handle))
+            break;
+
+        const float frameTimeMs = m_Device->getTimerQueryTime(query.handle) * 1000.f;
+        m_Device->resetTimerQuery(query.handle);
+        query.pending = false;
+
+        AddSample(frameTimeMs);
+    }
+}
+
+void DynamicResolutionController::AddSample(float frameTimeMs)
+{
+    m_LastFrameTimeMs = frameTimeMs;
+    m_SmoothedFrameTimeMs = m_HasSamples
+        ? lerp(m_SmoothedFrameTimeMs, frameTimeMs, m_Params.smoothing)
+        : frameTimeMs;
+    m_HasSamples = true;
+
+    ++m_FramesSinceChange;
+
+    if (!m_Enabled || m_FramesSinceChange <= m_Params.cooldownFrames || m_SmoothedFrameTimeMs <= 0.f)
+        return;
+
+    const float targetMs = m_Params.targetFrameTimeMs * (1.f - m_Params.headroom);
+    const float ratio = targetMs / m_SmoothedFrameTimeMs;
+
+    if (std::abs(ratio - 1.f) <= m_Params.deadBand)
+        return;
+
+    // GPU time is roughly proportional to the pixel count, which is quadratic in the scale
+    float newScale = m_Scale * std::sqrt(ratio);
+    newScale = std::clamp(newScale, m_Scale - m_Params.maxScaleStep, m_Scale + m_Params.maxScaleStep);
+    newScale = std::clamp(newScale, m_Params.minScale, m_Params.maxScale);
+
+    if (newScale != m_Scale)
+    {
+        m_Scale = newScale;
+        m_FramesSinceChange = 0;
+    }
+}
+
+void DynamicResolutionController::SetScale(float scale)
+{
+    m_Scale = std::clamp(scale, m_Params.minScale, m_Params.maxScale);
+    m_FramesSinceChange = 0;
+}
+
+uint2 DynamicResolutionController::GetRenderSize(uint2 outputSize) const
+{
+    return uint2(
+        std::max(1u, uint32_t(std::round(float(outputSize.x) * m_Scale))),
+        std::max(1u, uint32_t(std::round(float(outputSize.y) * m_Scale))));
+}
+
+void DynamicResolutionController::ApplyToView(PlanarView& view, const nvrhi::Viewport& outputViewport) const
+{
+    const uint2 outputSize = uint2(uint32_t(outputViewport.width()), uint32_t(outputViewport.height()));
+    const uint2 renderSize = GetRenderSize(outputSize);
+
+    nvrhi::Viewport viewport = outputViewport;
+    viewport.maxX = viewport.minX + float(renderSize.x);
+    viewport.maxY = viewport.minY + float(renderSize.y);
+    view.SetViewport(viewport);
+}
@@ -21,6 +21,7 @@
 */
 
 #include <donut/render/EnvironmentMapPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
@@ -117,6 +118,8 @@ void EnvironmentMapPass::Render(
     nvrhi::ICommandList* commandList,
     const ICompositeView& compositeView)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Environment Map");
+
     commandList->beginMarker("Environment Map");
 
     for (uint viewIndex = 0; viewIndex < compositeView.GetNumChildViews(ViewType::PLANAR); viewIndex++)
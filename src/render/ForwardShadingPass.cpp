@@ -22,6 +22,7 @@
 
 #include <donut/render/ForwardShadingPass.h>
 #include <donut/render/DrawStrategy.h>
+#include <donut/render/LightClusteringPass.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/ShadowMap.h>
@@ -64,6 +65,7 @@ ForwardShadingPass::ForwardShadingPass(
     nvrhi::IDevice* device,
     std::shared_ptr<CommonRenderPasses> commonPasses)
     : m_Device(device)
+    , m_LightClusterBindingSets(device)
     , m_CommonPasses(std::move(commonPasses))
 {
     m_IsDX11 = m_Device->getGraphicsAPI() == nvrhi::GraphicsAPI::D3D11;
@@ -71,7 +73,10 @@ ForwardShadingPass::ForwardShadingPass(
 
 void ForwardShadingPass::Init(ShaderFactory& shaderFactory, const CreateParameters& params)
 {
+    assert(!params.useInputAssembler || !params.compactInstanceData);
     m_UseInputAssembler = params.useInputAssembler;
+    m_CompactInstanceData = params.compactInstanceData;
+    m_ClusteredLighting = params.clusteredLighting;
 
     m_SupportedViewTypes = ViewType::PLANAR;
     if (params.singlePassCubemap)
@@ -100,6 +105,7 @@ void ForwardShadingPass::Init(ShaderFactory& shaderFactory, const CreateParamete
     m_ViewBindingSet = CreateViewBindingSet();
     m_ShadingBindingLayout = CreateShadingBindingLayout();
     m_InputBindingLayout = CreateInputBindingLayout();
+    m_LightClusterBindingLayout = CreateLightClusterBindingLayout();
 }
 
 void ForwardShadingPass::ResetBindingCache()
@@ -107,6 +113,7 @@ void ForwardShadingPass::ResetBindingCache()
     m_MaterialBindings->Clear();
     m_ShadingBindingSets.clear();
     m_InputBindingSets.clear();
+    m_LightClusterBindingSets.Clear();
 }
 
 nvrhi::ShaderHandle ForwardShadingPass::CreateVertexShader(ShaderFactory& shaderFactory, const CreateParameters& params)
@@ -120,8 +127,11 @@ nvrhi::ShaderHandle ForwardShadingPass::CreateVertexShader(ShaderFactory& shader
     }
     else
     {
+        std::vector<ShaderMacro> macros;
+        macros.push_back(ShaderMacro("COMPACT_INSTANCE_DATA", params.compactInstanceData ? "1" : "0"));
+
         return shaderFactory.CreateAutoShader(sourceFileName, "buffer_loads",
-            DONUT_MAKE_PLATFORM_SHADER(g_forward_vs_buffer_loads), nullptr, nvrhi::ShaderType::Vertex);
+            DONUT_MAKE_PLATFORM_SHADER(g_forward_vs_buffer_loads), &macros, nvrhi::ShaderType::Vertex);
     }
 }
 
@@ -147,6 +157,7 @@ nvrhi::ShaderHandle ForwardShadingPass::CreatePixelShader(ShaderFactory& shaderF
 {
     std::vector<ShaderMacro> Macros;
     Macros.push_back(ShaderMacro("TRANSMISSIVE_MATERIAL", transmissiveMaterial ? "1" : "0"));
+    Macros.push_back(ShaderMacro("CLUSTERED_LIGHTING", params.clusteredLighting ? "1" : "0"));
 
     return shaderFactory.CreateAutoShader("donut/passes/forward_ps.hlsl", "main", DONUT_MAKE_PLATFORM_SHADER(g_forward_ps), &Macros, nvrhi::ShaderType::Pixel);
 }
@@ -247,6 +258,8 @@ nvrhi::GraphicsPipelineHandle ForwardShadingPass::CreateGraphicsPipeline(Pipelin
     pipelineDesc.renderState.rasterState.setCullMode(key.bits.cullMode);
     pipelineDesc.renderState.blendState.alphaToCoverageEnable = false;
     pipelineDesc.bindingLayouts = { m_MaterialBindings->GetLayout(), m_ViewBindingLayout, m_ShadingBindingLayout };
+    if (m_ClusteredLighting)
+        pipelineDesc.bindingLayouts.push_back(m_LightClusterBindingLayout);
     if (!m_UseInputAssembler)
         pipelineDesc.bindingLayouts.push_back(m_InputBindingLayout);
 
@@ -342,26 +355,35 @@ void ForwardShadingPass::SetupView(
     context.keyTemplate.bits.reverseDepth = view->IsReverseDepth();
 }
 
-void ForwardShadingPass::PrepareLights(
-    Context& context,
-    nvrhi::ICommandList* commandList,
-    const std::vector<std::shared_ptr<Light>>& lights,
+static void FillAmbientAndLightProbeConstants(
+    ForwardShadingLightConstants& constants,
     dm::float3 ambientColorTop,
     dm::float3 ambientColorBottom,
     const std::vector<std::shared_ptr<LightProbe>>& lightProbes)
 {
-    nvrhi::ITexture* shadowMapTexture = nullptr;
-    int2 shadowMapTextureSize = 0;
-    for (const auto& light : lights)
+    constants.ambientColorTop = float4(ambientColorTop, 0.f);
+    constants.ambientColorBottom = float4(ambientColorBottom, 0.f);
+
+    for (const auto& probe : lightProbes)
     {
-        if (light->shadowMap)
-        {
-            shadowMapTexture = light->shadowMap->GetTexture();
-            shadowMapTextureSize = light->shadowMap->GetTextureSize();
+        if (!probe->IsActive())
+            continue;
+
+        LightProbeConstants& lightProbeConstants = constants.lightProbes[constants.numLightProbes];
+        probe->FillLightProbeConstants(lightProbeConstants);
+
+        ++constants.numLightProbes;
+
+        if (constants.numLightProbes >= FORWARD_MAX_LIGHT_PROBES)
             break;
-        }
     }
+}
 
+bool ForwardShadingPass::PrepareShadingBindingSet(
+    Context& context,
+    nvrhi::ITexture* shadowMapTexture,
+    const std::vector<std::shared_ptr<LightProbe>>& lightProbes)
+{
     nvrhi::ITexture* lightProbeDiffuse = nullptr;
     nvrhi::ITexture* lightProbeSpecular = nullptr;
     nvrhi::ITexture* lightProbeEnvironmentBrdf = nullptr;
@@ -382,24 +404,54 @@ void ForwardShadingPass::PrepareLights(
             if (lightProbeDiffuse != probe->diffuseMap || lightProbeSpecular != probe->specularMap || lightProbeEnvironmentBrdf != probe->environmentBrdf)
             {
                 log::error("All lights probe submitted to ForwardShadingPass::PrepareLights(...) must use the same set of textures");
-                return;
+                return false;
             }
         }
     }
 
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    nvrhi::BindingSetHandle& shadingBindings = m_ShadingBindingSets[std::make_pair(shadowMapTexture, lightProbeDiffuse)];
+
+    if (!shadingBindings)
     {
-        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        shadingBindings = CreateShadingBindingSet(shadowMapTexture, lightProbeDiffuse, lightProbeSpecular, lightProbeEnvironmentBrdf);
+    }
+
+    context.shadingBindingSet = shadingBindings;
+
+    return true;
+}
 
-        nvrhi::BindingSetHandle& shadingBindings = m_ShadingBindingSets[std::make_pair(shadowMapTexture, lightProbeDiffuse)];
+void ForwardShadingPass::PrepareLights(
+    Context& context,
+    nvrhi::ICommandList* commandList,
+    const std::vector<std::shared_ptr<Light>>& lights,
+    dm::float3 ambientColorTop,
+    dm::float3 ambientColorBottom,
+    const std::vector<std::shared_ptr<LightProbe>>& lightProbes)
+{
+    if (m_ClusteredLighting)
+    {
+        log::error("ForwardShadingPass was created with clustered lighting, "
+            "use the PrepareLights(...) overload that takes a LightClusteringPass");
+        return;
+    }
 
-        if (!shadingBindings)
+    nvrhi::ITexture* shadowMapTexture = nullptr;
+    int2 shadowMapTextureSize = 0;
+    for (const auto& light : lights)
+    {
+        if (light->shadowMap)
         {
-            shadingBindings = CreateShadingBindingSet(shadowMapTexture, lightProbeDiffuse, lightProbeSpecular, lightProbeEnvironmentBrdf);
+            shadowMapTexture = light->shadowMap->GetTexture();
+            shadowMapTextureSize = light->shadowMap->GetTextureSize();
+            break;
         }
-
-        context.shadingBindingSet = shadingBindings;
     }
 
+    if (!PrepareShadingBindingSet(context, shadowMapTexture, lightProbes))
+        return;
 
     ForwardShadingLightConstants constants = {};
 
@@ -441,22 +493,41 @@ void ForwardShadingPass::PrepareLights(
         ++constants.numLights;
     }
 
-    constants.ambientColorTop = float4(ambientColorTop, 0.f);
-    constants.ambientColorBottom = float4(ambientColorBottom, 0.f);
+    FillAmbientAndLightProbeConstants(constants, ambientColorTop, ambientColorBottom, lightProbes);
 
-    for (const auto& probe : lightProbes)
+    commandList->writeBuffer(m_ForwardLightCB, &constants, sizeof(constants));
+}
+
+void ForwardShadingPass::PrepareLights(
+    Context& context,
+    nvrhi::ICommandList* commandList,
+    const LightClusteringPass& lightClusters,
+    dm::float3 ambientColorTop,
+    dm::float3 ambientColorBottom,
+    const std::vector<std::shared_ptr<LightProbe>>& lightProbes)
+{
+    if (!m_ClusteredLighting)
     {
-        if (!probe->IsActive())
-            continue;
+        log::error("ForwardShadingPass was created without clustered lighting, "
+            "set CreateParameters::clusteredLighting to use a LightClusteringPass");
+        return;
+    }
 
-        LightProbeConstants& lightProbeConstants = constants.lightProbes[constants.numLightProbes];
-        probe->FillLightProbeConstants(lightProbeConstants);
+    if (!PrepareShadingBindingSet(context, lightClusters.GetShadowMapTexture(), lightProbes))
+        return;
 
-        ++constants.numLightProbes;
+    auto bindingSetDesc = nvrhi::BindingSetDesc()
+        .setTrackLiveness(m_TrackLiveness);
+    lightClusters.AddBindingSetItems(bindingSetDesc, FORWARD_BINDING_LIGHT_CLUSTER_CONSTANTS, FORWARD_BINDING_CLUSTERED_LIGHTS);
+    context.lightClusterBindingSet = m_LightClusterBindingSets.GetOrCreateBindingSet(bindingSetDesc, m_LightClusterBindingLayout);
 
-        if (constants.numLightProbes >= FORWARD_MAX_LIGHT_PROBES)
-            break;
-    }
+    // The lights and shadows come from the cluster buffers, numLights stays at 0
+    ForwardShadingLightConstants constants = {};
+
+    constants.shadowMapTextureSize = lightClusters.GetShadowMapTextureSize();
+    constants.shadowMapTextureSizeInv = 1.f / constants.shadowMapTextureSize;
+
+    FillAmbientAndLightProbeConstants(constants, ambientColorTop, ambientColorBottom, lightProbes);
 
     commandList->writeBuffer(m_ForwardLightCB, &constants, sizeof(constants));
 }
@@ -492,23 +563,72 @@ bool ForwardShadingPass::SetupMaterial(GeometryPassContext& abstractContext, con
         std::lock_guard<std::mutex> lockGuard(m_Mutex);
 
         if (!pipeline)
+        {
             pipeline = CreateGraphicsPipeline(key, state.framebuffer);
+            m_PipelineCacheCounters.AddMiss();
+        }
 
         if (!pipeline)
             return false;
     }
+    else
+        m_PipelineCacheCounters.AddHit();
 
     assert(pipeline->getFramebufferInfo() == state.framebuffer->getFramebufferInfo());
 
     state.pipeline = pipeline;
     state.bindings = { materialBindingSet, m_ViewBindingSet, context.shadingBindingSet };
-    
+
+    if (m_ClusteredLighting)
+        state.bindings.push_back(context.lightClusterBindingSet);
+
     if (!m_UseInputAssembler)
         state.bindings.push_back(context.inputBindingSet);
 
     return true;
 }
 
+bool ForwardShadingPass::PrecreatePipeline(const engine::IView* view, const Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer)
+{
+    if (material->domain >= MaterialDomain::Count || cullMode > nvrhi::RasterCullMode::None)
+        return false;
+
+    if (!m_MaterialBindings->GetMaterialBindingSet(material))
+        return false;
+
+    PipelineKey key;
+    key.value = 0;
+    key.bits.cullMode = cullMode;
+    key.bits.domain = material->domain;
+    key.bits.frontCounterClockwise = view->IsMirrored();
+    key.bits.reverseDepth = view->IsReverseDepth();
+
+    nvrhi::GraphicsPipelineHandle& pipeline = m_Pipelines[key.value];
+
+    {
+        // Claim the key, so that materials sharing a pipeline compile it only once
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        if (pipeline || m_PrecreatingPipelines.test(key.value))
+            return false;
+
+        m_PrecreatingPipelines.set(key.value);
+    }
+
+    // Create the pipeline outside of the lock so that several pipelines can be compiled in parallel
+    nvrhi::GraphicsPipelineHandle newPipeline = CreateGraphicsPipeline(key, framebuffer);
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    m_PrecreatingPipelines.reset(key.value);
+
+    // SetupMaterial may have created the pipeline in the meantime
+    if (!newPipeline || pipeline)
+        return false;
+
+    pipeline = newPipeline;
+    m_PipelineCacheCounters.AddPrecreated();
+    return true;
+}
+
 void ForwardShadingPass::SetupInputBuffers(GeometryPassContext& abstractContext, const BufferGroup* buffers, nvrhi::GraphicsState& state)
 {
     auto& context = static_cast<Context&>(abstractContext);
@@ -566,8 +686,24 @@ nvrhi::BindingSetHandle ForwardShadingPass::CreateInputBindingSet(const BufferGr
     return m_Device->createBindingSet(bindingSetDesc, m_InputBindingLayout);
 }
 
+nvrhi::BindingLayoutHandle ForwardShadingPass::CreateLightClusterBindingLayout()
+{
+    if (!m_ClusteredLighting)
+        return nullptr;
+
+    auto bindingLayoutDesc = nvrhi::BindingLayoutDesc()
+        .setVisibility(nvrhi::ShaderType::Pixel)
+        .setRegisterSpace(m_IsDX11 ? 0 : FORWARD_SPACE_LIGHT_CLUSTERS)
+        .setRegisterSpaceIsDescriptorSet(!m_IsDX11);
+    LightClusteringPass::AddBindingLayoutItems(bindingLayoutDesc, FORWARD_BINDING_LIGHT_CLUSTER_CONSTANTS, FORWARD_BINDING_CLUSTERED_LIGHTS);
+
+    return m_Device->createBindingLayout(bindingLayoutDesc);
+}
+
 nvrhi::BindingSetHandle ForwardShadingPass::GetOrCreateInputBindingSet(const BufferGroup* bufferGroup)
 {
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
     auto it = m_InputBindingSets.find(bufferGroup);
     if (it == m_InputBindingSets.end())
     {
@@ -23,6 +23,7 @@
 #include <donut/render/GBuffer.h>
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/MemoryReport.h>
 #include <nvrhi/utils.h>
 
 using namespace donut::math;
@@ -98,6 +99,9 @@ void GBufferRenderTargets::Init(
     }
     MotionVectors = device->createTexture(desc);
 
+    m_MemoryTag.Set(GetGpuMemorySize(GBufferDiffuse) + GetGpuMemorySize(GBufferSpecular) + GetGpuMemorySize(GBufferNormals)
+        + GetGpuMemorySize(GBufferEmissive) + GetGpuMemorySize(Depth) + GetGpuMemorySize(MotionVectors));
+
     GBufferFramebuffer = std::make_shared<FramebufferFactory>(device);
     GBufferFramebuffer->RenderTargets = {
         GBufferDiffuse,
@@ -72,7 +72,9 @@ GBufferFillPass::GBufferFillPass(nvrhi::IDevice* device, std::shared_ptr<CommonR
 void GBufferFillPass::Init(ShaderFactory& shaderFactory, const CreateParameters& params)
 {
     m_EnableMotionVectors = params.enableMotionVectors;
+    assert(!params.useInputAssembler || !params.compactInstanceData);
     m_UseInputAssembler = params.useInputAssembler;
+    m_CompactInstanceData = params.compactInstanceData;
 
     m_SupportedViewTypes = ViewType::PLANAR;
     if (params.enableSinglePassCubemap)
@@ -120,6 +122,8 @@ nvrhi::ShaderHandle GBufferFillPass::CreateVertexShader(ShaderFactory& shaderFac
     }
     else
     {
+        VertexShaderMacros.push_back(ShaderMacro("COMPACT_INSTANCE_DATA", params.compactInstanceData ? "1" : "0"));
+
         return shaderFactory.CreateAutoShader(sourceFileName, "buffer_loads",
             DONUT_MAKE_PLATFORM_SHADER(g_gbuffer_vs_buffer_loads), &VertexShaderMacros, nvrhi::ShaderType::Vertex);
     }
@@ -301,13 +305,8 @@ void GBufferFillPass::SetupView(GeometryPassContext& abstractContext, nvrhi::ICo
     context.keyTemplate.bits.reverseDepth = view->IsReverseDepth();
 }
 
-bool GBufferFillPass::SetupMaterial(GeometryPassContext& abstractContext, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state)
+bool GBufferFillPass::GetAlphaTestedKey(const engine::Material* material, PipelineKey& key)
 {
-    auto& context = static_cast<Context&>(abstractContext);
-    
-    PipelineKey key = context.keyTemplate;
-    key.bits.cullMode = cullMode;
-
     switch (material->domain)
     {
     case MaterialDomain::Opaque:
@@ -316,13 +315,24 @@ bool GBufferFillPass::SetupMaterial(GeometryPassContext& abstractContext, const
     case MaterialDomain::TransmissiveAlphaTested:
     case MaterialDomain::TransmissiveAlphaBlended:
         key.bits.alphaTested = false;
-        break;
+        return true;
     case MaterialDomain::AlphaTested:
         key.bits.alphaTested = true;
-        break;
+        return true;
     default:
         return false;
     }
+}
+
+bool GBufferFillPass::SetupMaterial(GeometryPassContext& abstractContext, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::GraphicsState& state)
+{
+    auto& context = static_cast<Context&>(abstractContext);
+    
+    PipelineKey key = context.keyTemplate;
+    key.bits.cullMode = cullMode;
+
+    if (!GetAlphaTestedKey(material, key))
+        return false;
 
     nvrhi::IBindingSet* materialBindingSet = m_MaterialBindings->GetMaterialBindingSet(material);
 
@@ -336,11 +346,16 @@ bool GBufferFillPass::SetupMaterial(GeometryPassContext& abstractContext, const
         std::lock_guard<std::mutex> lockGuard(m_Mutex);
 
         if (!pipeline)
+        {
             pipeline = CreateGraphicsPipeline(key, state.framebuffer);
+            m_PipelineCacheCounters.AddMiss();
+        }
 
         if (!pipeline)
             return false;
     }
+    else
+        m_PipelineCacheCounters.AddHit();
 
     assert(pipeline->getFramebufferInfo() == state.framebuffer->getFramebufferInfo());
 
@@ -353,6 +368,46 @@ bool GBufferFillPass::SetupMaterial(GeometryPassContext& abstractContext, const
     return true;
 }
 
+bool GBufferFillPass::PrecreatePipeline(const engine::IView* view, const engine::Material* material, nvrhi::RasterCullMode cullMode, nvrhi::IFramebuffer* framebuffer)
+{
+    PipelineKey key;
+    key.value = 0;
+    key.bits.cullMode = cullMode;
+    key.bits.frontCounterClockwise = view->IsMirrored();
+    key.bits.reverseDepth = view->IsReverseDepth();
+
+    if (!GetAlphaTestedKey(material, key))
+        return false;
+
+    if (!m_MaterialBindings->GetMaterialBindingSet(material))
+        return false;
+
+    nvrhi::GraphicsPipelineHandle& pipeline = m_Pipelines[key.value];
+
+    {
+        // Claim the key, so that materials sharing a pipeline compile it only once
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        if (pipeline || m_PrecreatingPipelines.test(key.value))
+            return false;
+
+        m_PrecreatingPipelines.set(key.value);
+    }
+
+    // Create the pipeline outside of the lock so that several pipelines can be compiled in parallel
+    nvrhi::GraphicsPipelineHandle newPipeline = CreateGraphicsPipeline(key, framebuffer);
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+    m_PrecreatingPipelines.reset(key.value);
+
+    // SetupMaterial may have created the pipeline in the meantime
+    if (!newPipeline || pipeline)
+        return false;
+
+    pipeline = newPipeline;
+    m_PipelineCacheCounters.AddPrecreated();
+    return true;
+}
+
 void GBufferFillPass::SetupInputBuffers(GeometryPassContext& abstractContext, const engine::BufferGroup* buffers, nvrhi::GraphicsState& state)
 {
     auto& context = static_cast<Context&>(abstractContext);
@@ -395,6 +450,13 @@ nvrhi::BindingLayoutHandle GBufferFillPass::CreateInputBindingLayout()
             : nvrhi::BindingLayoutItem::StructuredBuffer_SRV(GBUFFER_BINDING_INSTANCE_BUFFER))
         .addItem(nvrhi::BindingLayoutItem::RawBuffer_SRV(GBUFFER_BINDING_VERTEX_BUFFER))
         .addItem(nvrhi::BindingLayoutItem::PushConstants(GBUFFER_BINDING_PUSH_CONSTANTS, sizeof(GBufferPushConstants)));
+
+    if (m_CompactInstanceData && m_EnableMotionVectors)
+    {
+        bindingLayoutDesc.addItem(m_IsDX11
+            ? nvrhi::BindingLayoutItem::RawBuffer_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER)
+            : nvrhi::BindingLayoutItem::StructuredBuffer_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER));
+    }
         
     return m_Device->createBindingLayout(bindingLayoutDesc);
 }
@@ -408,11 +470,20 @@ nvrhi::BindingSetHandle GBufferFillPass::CreateInputBindingSet(const BufferGroup
         .addItem(nvrhi::BindingSetItem::RawBuffer_SRV(GBUFFER_BINDING_VERTEX_BUFFER, bufferGroup->vertexBuffer))
         .addItem(nvrhi::BindingSetItem::PushConstants(GBUFFER_BINDING_PUSH_CONSTANTS, sizeof(GBufferPushConstants)));
 
+    if (m_CompactInstanceData && m_EnableMotionVectors)
+    {
+        bindingSetDesc.addItem(m_IsDX11
+            ? nvrhi::BindingSetItem::RawBuffer_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER, bufferGroup->prevTransformDeltaBuffer)
+            : nvrhi::BindingSetItem::StructuredBuffer_SRV(GBUFFER_BINDING_PREV_TRANSFORM_DELTA_BUFFER, bufferGroup->prevTransformDeltaBuffer));
+    }
+
     return m_Device->createBindingSet(bindingSetDesc, m_InputBindingLayout);
 }
 
 nvrhi::BindingSetHandle GBufferFillPass::GetOrCreateInputBindingSet(const BufferGroup* bufferGroup)
 {
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
     auto it = m_InputBindingSets.find(bufferGroup);
     if (it == m_InputBindingSets.end())
     {
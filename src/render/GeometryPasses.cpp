@@ -21,10 +21,15 @@
 */
 
 #include <donut/render/GeometryPasses.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/SceneGraph.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/render/DrawStrategy.h>
 
+#ifdef DONUT_WITH_TASKFLOW
+#include <taskflow/taskflow.hpp>
+#endif
+
 using namespace donut::math;
 using namespace donut::engine;
 using namespace donut::render;
@@ -164,6 +169,8 @@ void donut::render::RenderCompositeView(
     const char* passEvent, 
     bool materialEvents)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, passEvent ? passEvent : "RenderCompositeView");
+
     if (passEvent)
         commandList->beginMarker(passEvent);
 
@@ -192,3 +199,273 @@ void donut::render::RenderCompositeView(
     if (passEvent)
         commandList->endMarker();
 }
+
+void PipelineCacheCounters::Reset()
+{
+    m_Hits = 0;
+    m_Misses = 0;
+    m_Precreated = 0;
+}
+
+PipelineCacheStats PipelineCacheCounters::Get() const
+{
+    PipelineCacheStats stats;
+    stats.hits = m_Hits.load(std::memory_order_relaxed);
+    stats.misses = m_Misses.load(std::memory_order_relaxed);
+    stats.precreated = m_Precreated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+struct PipelineWarmupItem
+{
+    const Material* material;
+    nvrhi::RasterCullMode cullMode;
+};
+
+// Lists the material and cull mode combinations that the draw strategies can produce for the scene's materials
+static std::vector<PipelineWarmupItem> GetPipelineWarmupItems(const SceneGraph& sceneGraph)
+{
+    std::vector<PipelineWarmupItem> items;
+
+    for (const auto& material : sceneGraph.GetMaterials())
+    {
+        switch (material->domain)
+        {
+        case MaterialDomain::AlphaBlended:
+        case MaterialDomain::Transmissive:
+        case MaterialDomain::TransmissiveAlphaTested:
+        case MaterialDomain::TransmissiveAlphaBlended:
+            // TransparentDrawStrategy renders double-sided materials either with front and back culling
+            // in two draws, or with culling disabled, depending on DrawDoubleSidedMaterialsSeparately
+            if (material->doubleSided)
+            {
+                items.push_back({ material.get(), nvrhi::RasterCullMode::Front });
+                items.push_back({ material.get(), nvrhi::RasterCullMode::Back });
+            }
+            items.push_back({ material.get(), material->doubleSided ? nvrhi::RasterCullMode::None : nvrhi::RasterCullMode::Back });
+            break;
+
+        default:
+            items.push_back({ material.get(), material->doubleSided ? nvrhi::RasterCullMode::None : nvrhi::RasterCullMode::Back });
+            break;
+        }
+    }
+
+    return items;
+}
+
+size_t donut::render::PrecreatePipelines(
+    IGeometryPass& pass,
+    const IView* view,
+    nvrhi::IFramebuffer* framebuffer,
+    const SceneGraph& sceneGraph)
+{
+    size_t count = 0;
+
+    for (const PipelineWarmupItem& item : GetPipelineWarmupItems(sceneGraph))
+    {
+        if (pass.PrecreatePipeline(view, item.material, item.cullMode, framebuffer))
+            ++count;
+    }
+
+    return count;
+}
+
+#ifdef DONUT_WITH_TASKFLOW
+size_t donut::render::PrecreatePipelines(
+    IGeometryPass& pass,
+    const IView* view,
+    nvrhi::IFramebuffer* framebuffer,
+    const SceneGraph& sceneGraph,
+    tf::Executor& executor)
+{
+    std::vector<PipelineWarmupItem> const items = GetPipelineWarmupItems(sceneGraph);
+    std::atomic<size_t> count = 0;
+
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t(0), items.size(), size_t(1), [&](size_t index)
+    {
+        if (pass.PrecreatePipeline(view, items[index].material, items[index].cullMode, framebuffer))
+            count.fetch_add(1, std::memory_order_relaxed);
+    });
+    executor.run(taskflow).wait();
+
+    return count;
+}
+
+ParallelGeometryRenderer::ParallelGeometryRenderer(nvrhi::IDevice* device, tf::Executor& executor)
+    : m_Device(device)
+    , m_Executor(executor)
+{
+}
+
+nvrhi::ICommandList* ParallelGeometryRenderer::GetCommandList(size_t index)
+{
+    while (m_CommandLists.size() <= index)
+    {
+        auto params = nvrhi::CommandListParameters()
+            .setEnableImmediateExecution(false);
+
+        m_CommandLists.push_back(m_Device->createCommandList(params));
+    }
+
+    return m_CommandLists[index];
+}
+
+void ParallelGeometryRenderer::RenderCompositeView(
+    nvrhi::ICommandList* commandList,
+    const ICompositeView* compositeView,
+    const ICompositeView* compositeViewPrev,
+    FramebufferFactory& framebufferFactory,
+    const std::shared_ptr<engine::SceneGraphNode>& rootNode,
+    const DrawStrategyFactory& drawStrategyFactory,
+    IGeometryPass& pass,
+    const PassContextFactory& passContextFactory,
+    const char* passEvent,
+    bool materialEvents)
+{
+    // CPU only: the caller's command list is closed and reopened below, which a GPU scope cannot span
+    DONUT_PROFILE_CPU_SCOPE(passEvent ? passEvent : "ParallelGeometryRenderer");
+
+    if (m_Device->getGraphicsAPI() == nvrhi::GraphicsAPI::D3D11)
+    {
+        std::unique_ptr<IDrawStrategy> drawStrategy = drawStrategyFactory();
+        std::unique_ptr<GeometryPassContext> passContext = passContextFactory(commandList);
+
+        render::RenderCompositeView(commandList, compositeView, compositeViewPrev, framebufferFactory, rootNode,
+            *drawStrategy, pass, *passContext, passEvent, materialEvents);
+        return;
+    }
+
+    ViewType::Enum supportedViewTypes = pass.GetSupportedViewTypes();
+    uint32_t const numViews = compositeView->GetNumChildViews(supportedViewTypes);
+
+    if (compositeViewPrev)
+    {
+        // the views must have the same topology
+        assert(numViews == compositeViewPrev->GetNumChildViews(supportedViewTypes));
+    }
+
+    if (numViews == 0)
+        return;
+
+    struct RecordingJob
+    {
+        const IView* view = nullptr;
+        const IView* viewPrev = nullptr;
+        nvrhi::IFramebuffer* framebuffer = nullptr;
+        const DrawItem* items = nullptr; // nullptr means "walk the scene graph for this view"
+        size_t itemCount = 0;
+    };
+
+    std::vector<RecordingJob> viewJobs(numViews);
+
+    // The framebuffer factory is not thread-safe, resolve all framebuffers here
+    for (uint viewIndex = 0; viewIndex < numViews; viewIndex++)
+    {
+        RecordingJob& job = viewJobs[viewIndex];
+        job.view = compositeView->GetChildView(supportedViewTypes, viewIndex);
+        job.viewPrev = compositeViewPrev ? compositeViewPrev->GetChildView(supportedViewTypes, viewIndex) : nullptr;
+        assert(job.view != nullptr);
+
+        job.framebuffer = framebufferFactory.GetFramebuffer(*job.view);
+    }
+
+    std::vector<RecordingJob> jobs;
+    std::vector<std::vector<DrawItem>> viewItems;
+
+    if (m_MaxDrawItemsPerCommandList == 0)
+    {
+        jobs = std::move(viewJobs);
+    }
+    else
+    {
+        // Run the draw strategies first, then split the resulting draw lists into chunks.
+        // The items are copied because the strategies may reuse their storage between calls.
+        viewItems.resize(numViews);
+
+        tf::Taskflow cullingTaskflow;
+        cullingTaskflow.for_each_index(size_t(0), size_t(numViews), size_t(1), [&](size_t viewIndex)
+        {
+            const RecordingJob& job = viewJobs[viewIndex];
+            std::unique_ptr<IDrawStrategy> drawStrategy = drawStrategyFactory();
+            drawStrategy->PrepareForView(rootNode, *job.view);
+
+            while (const DrawItem* item = drawStrategy->GetNextItem())
+                viewItems[viewIndex].push_back(*item);
+        });
+        m_Executor.run(cullingTaskflow).wait();
+
+        for (uint viewIndex = 0; viewIndex < numViews; viewIndex++)
+        {
+            const std::vector<DrawItem>& items = viewItems[viewIndex];
+
+            for (size_t offset = 0; offset < items.size(); offset += m_MaxDrawItemsPerCommandList)
+            {
+                RecordingJob job = viewJobs[viewIndex];
+                job.items = items.data() + offset;
+                job.itemCount = std::min(m_MaxDrawItemsPerCommandList, items.size() - offset);
+                jobs.push_back(job);
+            }
+        }
+    }
+
+    if (jobs.empty())
+        return;
+
+    // Create the command lists on this thread, the device is not required to be thread-safe for that
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+        GetCommandList(jobIndex);
+
+    tf::Taskflow recordingTaskflow;
+    recordingTaskflow.for_each_index(size_t(0), jobs.size(), size_t(1), [&](size_t jobIndex)
+    {
+        const RecordingJob& job = jobs[jobIndex];
+        nvrhi::ICommandList* jobCommandList = m_CommandLists[jobIndex];
+
+        jobCommandList->open();
+
+        if (passEvent)
+            jobCommandList->beginMarker(passEvent);
+
+        {
+            // The GPU scope has to end before jobCommandList->close()
+            DONUT_PROFILE_GPU_SCOPE(jobCommandList, passEvent ? passEvent : "ParallelGeometryRenderer job");
+
+            std::unique_ptr<GeometryPassContext> passContext = passContextFactory(jobCommandList);
+
+            if (job.items)
+            {
+                PassthroughDrawStrategy drawStrategy;
+                drawStrategy.SetData(job.items, job.itemCount);
+
+                RenderView(jobCommandList, job.view, job.viewPrev, job.framebuffer, drawStrategy, pass, *passContext, materialEvents);
+            }
+            else
+            {
+                std::unique_ptr<IDrawStrategy> drawStrategy = drawStrategyFactory();
+                drawStrategy->PrepareForView(rootNode, *job.view);
+
+                RenderView(jobCommandList, job.view, job.viewPrev, job.framebuffer, *drawStrategy, pass, *passContext, materialEvents);
+            }
+        }
+
+        if (passEvent)
+            jobCommandList->endMarker();
+
+        jobCommandList->close();
+    });
+    m_Executor.run(recordingTaskflow).wait();
+
+    // Submit the caller's work first to keep the ordering, then continue recording into the same command list
+    std::vector<nvrhi::ICommandList*> commandLists;
+    commandLists.reserve(jobs.size() + 1);
+    commandLists.push_back(commandList);
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+        commandLists.push_back(m_CommandLists[jobIndex]);
+
+    commandList->close();
+    m_Device->executeCommandLists(commandLists.data(), commandLists.size());
+    commandList->open();
+}
+#endif
@@ -0,0 +1,333 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/InstanceCullingPass.h>
+#include <donut/engine/Profiler.h>
+#include <donut/render/GeometryPasses.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/core/log.h>
+#include <nvrhi/utils.h>
+#include <algorithm>
+
+#if DONUT_WITH_STATIC_SHADERS
+#if DONUT_WITH_DX11
+#include "compiled_shaders/passes/instance_culling_cs.dxbc.h"
+#endif
+#if DONUT_WITH_DX12
+#include "compiled_shaders/passes/instance_culling_cs.dxil.h"
+#endif
+#if DONUT_WITH_VULKAN
+#include "compiled_shaders/passes/instance_culling_cs.spirv.h"
+#endif
+#endif
+
+using namespace donut::math;
+#include <donut/shaders/instance_culling_cb.h>
+
+using namespace donut::engine;
+using namespace donut::render;
+
+static_assert(sizeof(CullingDrawRecord) == 64, "CullingDrawRecord layout must match the HLSL declaration");
+static_assert(sizeof(nvrhi::DrawIndexedIndirectArguments) == 20, "The culling shader writes 20-byte indirect arguments");
+
+InstanceCullingPass::InstanceCullingPass(
+    nvrhi::IDevice* device,
+    ShaderFactory& shaderFactory,
+    std::shared_ptr<CommonRenderPasses> commonPasses)
+    : m_Device(device)
+    , m_BindingCache(device)
+    , m_CommonPasses(std::move(commonPasses))
+{
+    m_ComputeShader = shaderFactory.CreateAutoShader("donut/passes/instance_culling_cs.hlsl", "main",
+        DONUT_MAKE_PLATFORM_SHADER(g_instance_culling_cs), nullptr, nvrhi::ShaderType::Compute);
+
+    m_CullingCB = m_Device->createBuffer(nvrhi::utils::CreateVolatileConstantBufferDesc(sizeof(InstanceCullingConstants),
+        "InstanceCullingConstants", c_MaxRenderPassConstantBufferVersions));
+
+    nvrhi::BindingLayoutDesc layoutDesc;
+    layoutDesc.visibility = nvrhi::ShaderType::Compute;
+    layoutDesc.bindings = {
+        nvrhi::BindingLayoutItem::VolatileConstantBuffer(0),
+        nvrhi::BindingLayoutItem::RawBuffer_SRV(0),
+        nvrhi::BindingLayoutItem::StructuredBuffer_SRV(1),
+        nvrhi::BindingLayoutItem::Texture_SRV(2),
+        nvrhi::BindingLayoutItem::RawBuffer_UAV(0),
+        nvrhi::BindingLayoutItem::RawBuffer_UAV(1)
+    };
+    m_BindingLayout = m_Device->createBindingLayout(layoutDesc);
+
+    nvrhi::ComputePipelineDesc pipelineDesc;
+    pipelineDesc.CS = m_ComputeShader;
+    pipelineDesc.bindingLayouts = { m_BindingLayout };
+    m_Pipeline = m_Device->createComputePipeline(pipelineDesc);
+}
+
+void InstanceCullingPass::UpdateDrawRecords(nvrhi::ICommandList* commandList, const SceneGraph& sceneGraph)
+{
+    struct PendingRecord
+    {
+        DrawBucket bucket;
+        CullingDrawRecord record;
+    };
+
+    std::vector<PendingRecord> pendingRecords;
+    pendingRecords.reserve(sceneGraph.GetGeometryInstancesCount());
+
+    for (const auto& instance : sceneGraph.GetMeshInstances())
+    {
+        const MeshInfo* mesh = instance->GetMesh().get();
+        if (!mesh || !mesh->buffers)
+            continue;
+
+        for (const auto& geometry : mesh->geometries)
+        {
+            const Material* material = geometry->material.get();
+            if (!material)
+                continue;
+
+            if (material->domain != MaterialDomain::Opaque && material->domain != MaterialDomain::AlphaTested)
+                continue;
+
+            PendingRecord item{};
+            item.bucket.material = material;
+            item.bucket.buffers = mesh->buffers.get();
+            item.bucket.cullMode = material->doubleSided ? nvrhi::RasterCullMode::None : nvrhi::RasterCullMode::Back;
+
+            CullingDrawRecord& record = item.record;
+            record.boundsMin = geometry->objectSpaceBounds.m_mins;
+            record.boundsMax = geometry->objectSpaceBounds.m_maxs;
+            record.instanceIndex = uint32_t(instance->GetInstanceIndex());
+            record.indexCount = geometry->numIndices;
+            record.startIndexLocation = mesh->indexOffset + geometry->indexOffsetInMesh;
+            record.baseVertexLocation = int(mesh->vertexOffset + geometry->vertexOffsetInMesh);
+
+            // Skinned geometry bounds are not known on the GPU
+            if (mesh->skinPrototype)
+                record.flags |= DRAW_RECORD_FLAG_NEVER_CULL;
+
+            pendingRecords.push_back(item);
+        }
+    }
+
+    // Same ordering as InstancedOpaqueDrawStrategy to minimize the state changes
+    std::sort(pendingRecords.begin(), pendingRecords.end(), [](const PendingRecord& a, const PendingRecord& b)
+    {
+        if (a.bucket.material != b.bucket.material)
+            return a.bucket.material < b.bucket.material;
+
+        if (a.bucket.buffers != b.bucket.buffers)
+            return a.bucket.buffers < b.bucket.buffers;
+
+        if (a.bucket.cullMode != b.bucket.cullMode)
+            return a.bucket.cullMode < b.bucket.cullMode;
+
+        return a.record.instanceIndex < b.record.instanceIndex;
+    });
+
+    m_Buckets.clear();
+    std::vector<CullingDrawRecord> records;
+    records.reserve(pendingRecords.size());
+
+    for (PendingRecord& item : pendingRecords)
+    {
+        DrawBucket* bucket = m_Buckets.empty() ? nullptr : &m_Buckets.back();
+
+        if (!bucket || bucket->material != item.bucket.material || bucket->buffers != item.bucket.buffers || bucket->cullMode != item.bucket.cullMode)
+        {
+            item.bucket.firstDraw = uint32_t(records.size());
+            item.bucket.numDraws = 0;
+            m_Buckets.push_back(item.bucket);
+            bucket = &m_Buckets.back();
+        }
+
+        item.record.bucketIndex = uint32_t(m_Buckets.size() - 1);
+        item.record.firstDrawInBucket = bucket->firstDraw;
+        ++bucket->numDraws;
+
+        records.push_back(item.record);
+    }
+
+    m_NumDrawRecords = uint32_t(records.size());
+
+    if (records.empty())
+        return;
+
+    uint64_t const recordBufferSize = records.size() * sizeof(CullingDrawRecord);
+    if (!m_DrawRecordBuffer || m_DrawRecordBuffer->getDesc().byteSize < recordBufferSize)
+    {
+        nvrhi::BufferDesc bufferDesc;
+        bufferDesc.byteSize = recordBufferSize;
+        bufferDesc.structStride = sizeof(CullingDrawRecord);
+        bufferDesc.debugName = "CullingDrawRecords";
+        bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+        bufferDesc.keepInitialState = true;
+        m_DrawRecordBuffer = m_Device->createBuffer(bufferDesc);
+
+        bufferDesc.byteSize = records.size() * sizeof(nvrhi::DrawIndexedIndirectArguments);
+        bufferDesc.structStride = 0;
+        bufferDesc.canHaveUAVs = true;
+        bufferDesc.canHaveRawViews = true;
+        bufferDesc.isDrawIndirectArgs = true;
+        bufferDesc.debugName = "CullingDrawArguments";
+        bufferDesc.initialState = nvrhi::ResourceStates::IndirectArgument;
+        m_DrawArgumentBuffer = m_Device->createBuffer(bufferDesc);
+    }
+
+    uint64_t const countBufferSize = m_Buckets.size() * sizeof(uint32_t);
+    if (!m_DrawCountBuffer || m_DrawCountBuffer->getDesc().byteSize < countBufferSize)
+    {
+        nvrhi::BufferDesc bufferDesc;
+        bufferDesc.byteSize = countBufferSize;
+        bufferDesc.canHaveUAVs = true;
+        bufferDesc.canHaveRawViews = true;
+        bufferDesc.debugName = "CullingDrawCounts";
+        bufferDesc.initialState = nvrhi::ResourceStates::UnorderedAccess;
+        bufferDesc.keepInitialState = true;
+        m_DrawCountBuffer = m_Device->createBuffer(bufferDesc);
+    }
+
+    commandList->writeBuffer(m_DrawRecordBuffer, records.data(), recordBufferSize);
+}
+
+void InstanceCullingPass::Cull(
+    nvrhi::ICommandList* commandList,
+    const IView& view,
+    nvrhi::IBuffer* instanceBuffer,
+    nvrhi::ITexture* hizTexture,
+    bool compactInstanceData)
+{
+    DONUT_PROFILE_GPU_SCOPE(commandList, "InstanceCulling");
+
+    m_CompactInstanceData = compactInstanceData;
+
+    if (m_NumDrawRecords == 0 || !instanceBuffer)
+        return;
+
+    commandList->beginMarker("InstanceCulling");
+
+    commandList->clearBufferUInt(m_DrawArgumentBuffer, 0);
+    commandList->clearBufferUInt(m_DrawCountBuffer, 0);
+
+    InstanceCullingConstants constants = {};
+
+    frustum const viewFrustum = view.GetViewFrustum();
+    for (int i = 0; i < frustum::PLANES_COUNT; i++)
+    {
+        const plane& p = viewFrustum.planes[i];
+        constants.frustumPlanes[i] = float4(p.normal, p.distance);
+    }
+
+    constants.matWorldToClip = view.GetViewProjectionMatrix(false);
+    constants.numRecords = m_NumDrawRecords;
+
+    if (view.IsReverseDepth())
+        constants.flags |= INSTANCE_CULLING_FLAG_REVERSE_DEPTH;
+
+    if (compactInstanceData)
+        constants.flags |= INSTANCE_CULLING_FLAG_COMPACT_INSTANCES;
+
+    if (hizTexture)
+    {
+        const nvrhi::TextureDesc& hizDesc = hizTexture->getDesc();
+        constants.hizSize = float2(float(hizDesc.width), float(hizDesc.height));
+        constants.hizMipLevels = hizDesc.mipLevels;
+        constants.flags |= INSTANCE_CULLING_FLAG_HIZ;
+    }
+
+    commandList->writeBuffer(m_CullingCB, &constants, sizeof(constants));
+
+    nvrhi::BindingSetDesc bindingSetDesc;
+    bindingSetDesc.bindings = {
+        nvrhi::BindingSetItem::ConstantBuffer(0, m_CullingCB),
+        nvrhi::BindingSetItem::RawBuffer_SRV(0, instanceBuffer),
+        nvrhi::BindingSetItem::StructuredBuffer_SRV(1, m_DrawRecordBuffer),
+        nvrhi::BindingSetItem::Texture_SRV(2, hizTexture ? hizTexture : m_CommonPasses->m_BlackTexture.Get()),
+        nvrhi::BindingSetItem::RawBuffer_UAV(0, m_DrawArgumentBuffer),
+        nvrhi::BindingSetItem::RawBuffer_UAV(1, m_DrawCountBuffer)
+    };
+
+    nvrhi::ComputeState state;
+    state.pipeline = m_Pipeline;
+    state.bindings = { m_BindingCache.GetOrCreateBindingSet(bindingSetDesc, m_BindingLayout) };
+    commandList->setComputeState(state);
+    commandList->dispatch(dm::div_ceil(int(m_NumDrawRecords), INSTANCE_CULLING_GROUP_SIZE));
+
+    commandList->endMarker();
+}
+
+void InstanceCullingPass::RenderView(
+    nvrhi::ICommandList* commandList,
+    const IView* view,
+    const IView* viewPrev,
+    nvrhi::IFramebuffer* framebuffer,
+    IGeometryPass& pass,
+    GeometryPassContext& passContext)
+{
+    if (m_Buckets.empty())
+        return;
+
+    if (m_CompactInstanceData)
+    {
+        // Compact instances can only be read with buffer loads, which take the instance index from
+        // push constants that the indirect draws cannot provide
+        log::error("InstanceCullingPass::RenderView doesn't support compact instance data.");
+        return;
+    }
+
+    pass.SetupView(passContext, commandList, view, viewPrev);
+
+    nvrhi::GraphicsState graphicsState;
+    graphicsState.framebuffer = framebuffer;
+    graphicsState.viewport = view->GetViewportState();
+    graphicsState.shadingRateState = view->GetVariableRateShadingState();
+
+    const Material* lastMaterial = nullptr;
+    const BufferGroup* lastBuffers = nullptr;
+    nvrhi::RasterCullMode lastCullMode = nvrhi::RasterCullMode::Back;
+    bool drawMaterial = true;
+
+    for (const DrawBucket& bucket : m_Buckets)
+    {
+        if (bucket.buffers != lastBuffers)
+        {
+            pass.SetupInputBuffers(passContext, bucket.buffers, graphicsState);
+            lastBuffers = bucket.buffers;
+        }
+
+        if (bucket.material != lastMaterial || bucket.cullMode != lastCullMode)
+        {
+            drawMaterial = pass.SetupMaterial(passContext, bucket.material, bucket.cullMode, graphicsState);
+            lastMaterial = bucket.material;
+            lastCullMode = bucket.cullMode;
+        }
+
+        if (!drawMaterial)
+            continue;
+
+        graphicsState.indirectParams = m_DrawArgumentBuffer;
+        commandList->setGraphicsState(graphicsState);
+
+        commandList->drawIndexedIndirect(uint32_t(bucket.firstDraw * sizeof(nvrhi::DrawIndexedIndirectArguments)), bucket.numDraws);
+    }
+}
@@ -21,6 +21,7 @@
 */
 
 #include <donut/render/JointsRenderPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/Scene.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/core/math/math.h>
@@ -178,6 +179,7 @@ namespace donut::render
                 return;
         }
         
+        DONUT_PROFILE_GPU_SCOPE(commandList, "JointsRenderPass");
         commandList->beginMarker("JointsRenderPass");
 
         PlanarViewConstants constants;
@@ -0,0 +1,400 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/LightClusteringPass.h>
+#include <donut/engine/Profiler.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShadowMap.h>
+#include <donut/engine/View.h>
+#include <donut/core/log.h>
+#include <algorithm>
+#include <cfloat>
+
+using namespace donut::math;
+#include <donut/shaders/light_cb.h>
+#include <donut/shaders/light_clusters_cb.h>
+
+using namespace donut::engine;
+using namespace donut::render;
+
+static bool IsGlobalLight(const LightConstants& light)
+{
+    if (light.lightType == LightType_Directional)
+        return true;
+
+    // Zero inverse range means infinite range
+    return light.angularSizeOrInvRange <= 0.f;
+}
+
+static bool SphereIntersectsBox(const float3& center, float radius, const box3& box)
+{
+    float3 const closestPoint = clamp(center, box.m_mins, box.m_maxs);
+    return lengthSquared(closestPoint - center) <= radius * radius;
+}
+
+LightClusteringPass::LightClusteringPass(nvrhi::IDevice* device, const CreateParameters& params)
+    : m_Device(device)
+    , m_Params(params)
+{
+    assert(m_Params.tileSize > 0);
+    assert(m_Params.numDepthSlices > 0);
+    assert(m_Params.zNear > 0.f && m_Params.zFar > m_Params.zNear);
+
+    nvrhi::BufferDesc constantBufferDesc;
+    constantBufferDesc.byteSize = sizeof(LightClusterConstants);
+    constantBufferDesc.debugName = "LightClusterConstants";
+    constantBufferDesc.isConstantBuffer = true;
+    constantBufferDesc.initialState = nvrhi::ResourceStates::ConstantBuffer;
+    constantBufferDesc.keepInitialState = true;
+    m_ConstantBuffer = m_Device->createBuffer(constantBufferDesc);
+
+    // Create the buffers upfront so that the binding sets are always valid
+    EnsureBufferCapacity(m_LightBuffer, 1, sizeof(LightConstants), "ClusteredLights");
+    EnsureBufferCapacity(m_ShadowBuffer, 1, sizeof(ShadowConstants), "ClusteredShadows");
+    EnsureBufferCapacity(m_ClusterBuffer, 1, sizeof(LightCluster), "LightClusters");
+    EnsureBufferCapacity(m_LightIndexBuffer, 1, sizeof(uint32_t), "LightClusterIndices");
+}
+
+void LightClusteringPass::EnsureBufferCapacity(nvrhi::BufferHandle& buffer, size_t numElements, uint32_t stride, const char* debugName) const
+{
+    if (buffer && buffer->getDesc().byteSize >= numElements * stride)
+        return;
+
+    // Grow in powers of two to avoid recreating the buffers and their binding sets every frame
+    size_t capacity = 64;
+    while (capacity < numElements)
+        capacity *= 2;
+
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = capacity * stride;
+    bufferDesc.structStride = stride;
+    bufferDesc.debugName = debugName;
+    bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+    bufferDesc.keepInitialState = true;
+    buffer = m_Device->createBuffer(bufferDesc);
+}
+
+void LightClusteringPass::UpdateClusterBounds(const IView& view)
+{
+    nvrhi::Rect const extent = view.GetViewExtent();
+    float2 const viewSize = float2(float(extent.width()), float(extent.height()));
+    bool const orthographic = view.IsOrthographicProjection();
+    float4x4 const invProjection = view.GetInverseProjectionMatrix(true);
+
+    // For every tile corner, compute the view-space ray through it:
+    // points are 'ray * z' for perspective projections and 'ray + (0, 0, z)' for orthographic ones.
+    uint2 const numCorners = m_GridSize.xy() + 1u;
+    std::vector<float3> cornerRays(numCorners.x * numCorners.y);
+
+    for (uint32_t y = 0; y < numCorners.y; y++)
+    {
+        for (uint32_t x = 0; x < numCorners.x; x++)
+        {
+            float2 const pixel = min(float2(float(x), float(y)) * float(m_Params.tileSize), viewSize);
+            float2 const ndc = float2(pixel.x / viewSize.x * 2.f - 1.f, 1.f - pixel.y / viewSize.y * 2.f);
+
+            float4 point = float4(ndc, 0.5f, 1.f) * invProjection;
+            float3 ray = point.xyz() / point.w;
+
+            if (orthographic)
+                ray.z = 0.f;
+            else
+                ray /= ray.z;
+
+            cornerRays[y * numCorners.x + x] = ray;
+        }
+    }
+
+    float const depthRatio = m_Params.zFar / m_Params.zNear;
+
+    m_ClusterBounds.resize(m_GridSize.x * m_GridSize.y * m_GridSize.z);
+
+    for (uint32_t slice = 0; slice < m_GridSize.z; slice++)
+    {
+        float const zMin = (slice == 0) ? 0.f : m_Params.zNear * powf(depthRatio, float(slice) / float(m_GridSize.z));
+        float const zMax = m_Params.zNear * powf(depthRatio, float(slice + 1) / float(m_GridSize.z));
+
+        for (uint32_t y = 0; y < m_GridSize.y; y++)
+        {
+            for (uint32_t x = 0; x < m_GridSize.x; x++)
+            {
+                box3 bounds = box3::empty();
+
+                for (uint32_t corner = 0; corner < 4; corner++)
+                {
+                    float3 const ray = cornerRays[(y + (corner >> 1)) * numCorners.x + x + (corner & 1)];
+
+                    if (orthographic)
+                    {
+                        bounds |= ray + float3(0.f, 0.f, zMin);
+                        bounds |= ray + float3(0.f, 0.f, zMax);
+                    }
+                    else
+                    {
+                        bounds |= ray * zMin;
+                        bounds |= ray * zMax;
+                    }
+                }
+
+                m_ClusterBounds[(slice * m_GridSize.y + y) * m_GridSize.x + x] = bounds;
+            }
+        }
+    }
+}
+
+bool LightClusteringPass::Update(
+    nvrhi::ICommandList* commandList,
+    const IView& view,
+    const std::vector<std::shared_ptr<Light>>& lights)
+{
+    DONUT_PROFILE_GPU_SCOPE(commandList, "LightClustering");
+
+    nvrhi::Rect const extent = view.GetViewExtent();
+    int const viewWidth = std::max(extent.width(), 1);
+    int const viewHeight = std::max(extent.height(), 1);
+
+    m_GridSize = uint3(
+        uint32_t(div_ceil(viewWidth, int(m_Params.tileSize))),
+        uint32_t(div_ceil(viewHeight, int(m_Params.tileSize))),
+        m_Params.numDepthSlices);
+
+    uint32_t const numClusters = m_GridSize.x * m_GridSize.y * m_GridSize.z;
+
+    // Collect the light and shadow constants, global lights go first
+
+    std::vector<LightConstants> globalLights;
+    std::vector<LightConstants> localLights;
+    std::vector<ShadowConstants> shadows;
+    m_ShadowMapTexture = nullptr;
+    m_ShadowMapTextureSize = 0.f;
+
+    for (const auto& light : lights)
+    {
+        LightConstants lightConstants = {};
+        light->FillLightConstants(lightConstants);
+
+        if (lightConstants.lightType == LightType_None)
+            continue;
+
+        if (light->shadowMap)
+        {
+            if (!m_ShadowMapTexture)
+            {
+                m_ShadowMapTexture = light->shadowMap->GetTexture();
+                m_ShadowMapTextureSize = float2(light->shadowMap->GetTextureSize());
+            }
+            else if (m_ShadowMapTexture != light->shadowMap->GetTexture())
+            {
+                log::error("All lights submitted to LightClusteringPass::Update(...) must use the same shadow map textures");
+                return false;
+            }
+
+            uint32_t const numCascades = std::min(light->shadowMap->GetNumberOfCascades(), 4u);
+            for (uint32_t cascade = 0; cascade < numCascades; cascade++)
+            {
+                lightConstants.shadowCascades[cascade] = int(shadows.size());
+                light->shadowMap->GetCascade(cascade)->FillShadowConstants(shadows.emplace_back());
+            }
+
+            uint32_t const numPerObjectShadows = std::min(light->shadowMap->GetNumberOfPerObjectShadows(), 4u);
+            for (uint32_t perObjectShadow = 0; perObjectShadow < numPerObjectShadows; perObjectShadow++)
+            {
+                lightConstants.perObjectShadows[perObjectShadow] = int(shadows.size());
+                light->shadowMap->GetPerObjectShadow(perObjectShadow)->FillShadowConstants(shadows.emplace_back());
+            }
+        }
+
+        if (IsGlobalLight(lightConstants))
+            globalLights.push_back(lightConstants);
+        else
+            localLights.push_back(lightConstants);
+    }
+
+    m_NumGlobalLights = uint32_t(globalLights.size());
+    m_NumLights = uint32_t(globalLights.size() + localLights.size());
+
+    // Assign the local lights to clusters
+
+    UpdateClusterBounds(view);
+
+    float const depthSliceScale = float(m_GridSize.z) / dm::log2f(m_Params.zFar / m_Params.zNear);
+    float const depthSliceBias = -dm::log2f(m_Params.zNear) * depthSliceScale;
+    auto getDepthSlice = [this, depthSliceScale, depthSliceBias](float z)
+    {
+        if (z <= 0.f)
+            return 0;
+        float const slice = floorf(dm::log2f(z) * depthSliceScale + depthSliceBias);
+        return clamp(int(slice), 0, int(m_GridSize.z) - 1);
+    };
+
+    affine3 const viewMatrix = view.GetViewMatrix();
+    float4x4 const projectionMatrix = view.GetProjectionMatrix(true);
+    bool const orthographic = view.IsOrthographicProjection();
+    float2 const viewSize = float2(float(viewWidth), float(viewHeight));
+    int2 const maxTile = int2(m_GridSize.xy()) - 1;
+
+    m_ClusterCounts.assign(numClusters, 0);
+    m_Assignments.clear();
+
+    for (uint32_t localIndex = 0; localIndex < uint32_t(localLights.size()); localIndex++)
+    {
+        const LightConstants& light = localLights[localIndex];
+        uint32_t const lightIndex = m_NumGlobalLights + localIndex;
+
+        // Spot lights are bounded by their range sphere as well, which is conservative
+        float const radius = 1.f / light.angularSizeOrInvRange + light.radius;
+        float3 const center = viewMatrix.transformPoint(light.position);
+
+        if (center.z + radius <= 0.f && !orthographic)
+            continue;
+
+        int const firstSlice = getDepthSlice(center.z - radius);
+        int const lastSlice = getDepthSlice(center.z + radius);
+
+        int2 firstTile = 0;
+        int2 lastTile = maxTile;
+
+        // Project the bounding box of the sphere to find the range of tiles it covers.
+        // When the sphere crosses the camera plane, the projection is unbounded and all tiles are used.
+        if (orthographic || center.z - radius > 0.f)
+        {
+            float2 minPixel = FLT_MAX;
+            float2 maxPixel = -FLT_MAX;
+
+            for (uint32_t corner = 0; corner < 8; corner++)
+            {
+                float3 const offset = float3(
+                    (corner & 1) ? radius : -radius,
+                    (corner & 2) ? radius : -radius,
+                    (corner & 4) ? radius : -radius);
+
+                float4 const clipPos = float4(center + offset, 1.f) * projectionMatrix;
+                float2 const ndc = clipPos.xy() / clipPos.w;
+                float2 const pixel = float2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * viewSize;
+
+                minPixel = min(minPixel, pixel);
+                maxPixel = max(maxPixel, pixel);
+            }
+
+            if (any(maxPixel < 0.f) || any(minPixel >= viewSize))
+                continue;
+
+            // Truncation is fine for the negative values here because they're clamped to 0 anyway
+            firstTile = clamp(int2(minPixel / float(m_Params.tileSize)), int2(0), maxTile);
+            lastTile = clamp(int2(maxPixel / float(m_Params.tileSize)), int2(0), maxTile);
+        }
+
+        for (int slice = firstSlice; slice <= lastSlice; slice++)
+        {
+            // The last slice extends to infinity, its bounds are not meaningful
+            bool const lastSliceOfGrid = slice == int(m_GridSize.z) - 1;
+
+            for (int y = firstTile.y; y <= lastTile.y; y++)
+            {
+                for (int x = firstTile.x; x <= lastTile.x; x++)
+                {
+                    uint32_t const clusterIndex = (uint32_t(slice) * m_GridSize.y + uint32_t(y)) * m_GridSize.x + uint32_t(x);
+
+                    if (!lastSliceOfGrid && !SphereIntersectsBox(center, radius, m_ClusterBounds[clusterIndex]))
+                        continue;
+
+                    ++m_ClusterCounts[clusterIndex];
+                    m_Assignments.push_back(uint2(clusterIndex, lightIndex));
+                }
+            }
+        }
+    }
+
+    // Sort the assignments by cluster using the counts computed above
+
+    std::vector<LightCluster> clusters(numClusters);
+    uint32_t offset = 0;
+    for (uint32_t clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+    {
+        clusters[clusterIndex].offset = offset;
+        clusters[clusterIndex].count = 0;
+        offset += m_ClusterCounts[clusterIndex];
+    }
+
+    m_NumLightIndices = uint32_t(m_Assignments.size());
+    std::vector<uint32_t> lightIndices(m_NumLightIndices);
+    for (const uint2& assignment : m_Assignments)
+    {
+        LightCluster& cluster = clusters[assignment.x];
+        lightIndices[cluster.offset + cluster.count] = assignment.y;
+        ++cluster.count;
+    }
+
+    // Upload the results
+
+    EnsureBufferCapacity(m_LightBuffer, m_NumLights, sizeof(LightConstants), "ClusteredLights");
+    EnsureBufferCapacity(m_ShadowBuffer, shadows.size(), sizeof(ShadowConstants), "ClusteredShadows");
+    EnsureBufferCapacity(m_ClusterBuffer, numClusters, sizeof(LightCluster), "LightClusters");
+    EnsureBufferCapacity(m_LightIndexBuffer, m_NumLightIndices, sizeof(uint32_t), "LightClusterIndices");
+
+    LightClusterConstants constants = {};
+    constants.gridSize = m_GridSize;
+    constants.numGlobalLights = m_NumGlobalLights;
+    constants.viewportOrigin = float2(float(extent.minX), float(extent.minY));
+    constants.tileSizeInv = 1.f / float(m_Params.tileSize);
+    constants.depthSliceScale = depthSliceScale;
+    constants.depthSliceBias = depthSliceBias;
+    constants.numLights = m_NumLights;
+    commandList->writeBuffer(m_ConstantBuffer, &constants, sizeof(constants));
+
+    if (!globalLights.empty())
+        commandList->writeBuffer(m_LightBuffer, globalLights.data(), globalLights.size() * sizeof(LightConstants));
+
+    if (!localLights.empty())
+        commandList->writeBuffer(m_LightBuffer, localLights.data(), localLights.size() * sizeof(LightConstants),
+            globalLights.size() * sizeof(LightConstants));
+
+    if (!shadows.empty())
+        commandList->writeBuffer(m_ShadowBuffer, shadows.data(), shadows.size() * sizeof(ShadowConstants));
+
+    commandList->writeBuffer(m_ClusterBuffer, clusters.data(), clusters.size() * sizeof(LightCluster));
+
+    if (!lightIndices.empty())
+        commandList->writeBuffer(m_LightIndexBuffer, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+
+    return true;
+}
+
+void LightClusteringPass::AddBindingLayoutItems(nvrhi::BindingLayoutDesc& layoutDesc, uint32_t constantBufferSlot, uint32_t firstSrvSlot)
+{
+    layoutDesc
+        .addItem(nvrhi::BindingLayoutItem::ConstantBuffer(constantBufferSlot))
+        .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(firstSrvSlot))
+        .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(firstSrvSlot + 1))
+        .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(firstSrvSlot + 2))
+        .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(firstSrvSlot + 3));
+}
+
+void LightClusteringPass::AddBindingSetItems(nvrhi::BindingSetDesc& setDesc, uint32_t constantBufferSlot, uint32_t firstSrvSlot) const
+{
+    setDesc
+        .addItem(nvrhi::BindingSetItem::ConstantBuffer(constantBufferSlot, m_ConstantBuffer))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(firstSrvSlot, m_LightBuffer))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(firstSrvSlot + 1, m_ShadowBuffer))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(firstSrvSlot + 2, m_ClusterBuffer))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(firstSrvSlot + 3, m_LightIndexBuffer));
+}
@@ -21,7 +21,9 @@
 */
 
 #include <donut/render/LightProbeProcessingPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/MemoryReport.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/View.h>
@@ -122,6 +124,8 @@ LightProbeProcessingPass::LightProbeProcessingPass(
     brdfTextureDesc.debugName = "EnvironmentBrdf";
 
     m_EnvironmentBrdfTexture = m_Device->createTexture(brdfTextureDesc);
+
+    m_MemoryTag.Set(GetGpuMemorySize(m_IntermediateTexture) + GetGpuMemorySize(m_EnvironmentBrdfTexture));
 }
 
 nvrhi::FramebufferHandle LightProbeProcessingPass::GetCachedFramebuffer(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources)
@@ -217,6 +221,8 @@ void LightProbeProcessingPass::GenerateCubemapMips(
     uint32_t sourceMipLevel, 
     uint32_t levelsToGenerate)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Cubemap Mips");
+
     commandList->beginMarker("Cubemap Mips");
 
     for (uint32_t index = 0; index < levelsToGenerate; index++)
@@ -236,6 +242,8 @@ void LightProbeProcessingPass::RenderDiffuseMap(
     uint32_t outBaseArraySlice,
     uint32_t outMipLevel)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Diffuse Light Probe");
+
     const nvrhi::TextureDesc& inDesc = inEnvironmentMap->getDesc();
     assert(inDesc.dimension == nvrhi::TextureDimension::TextureCube || inDesc.dimension == nvrhi::TextureDimension::TextureCubeArray);
     float inputSize = ceilf(float(inDesc.width) * powf(0.5f, float(inSubresources.baseMipLevel)));
@@ -295,6 +303,8 @@ void LightProbeProcessingPass::RenderDiffuseMap(
 
 void LightProbeProcessingPass::RenderSpecularMap(nvrhi::ICommandList* commandList, float roughness, nvrhi::ITexture* inEnvironmentMap, nvrhi::TextureSubresourceSet inSubresources, nvrhi::ITexture* outDiffuseMap, uint32_t outBaseArraySlice, uint32_t outMipLevel)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Specular Light Probe");
+
     const nvrhi::TextureDesc& inDesc = inEnvironmentMap->getDesc();
     assert(inDesc.dimension == nvrhi::TextureDimension::TextureCube || inDesc.dimension == nvrhi::TextureDimension::TextureCubeArray);
     float inputSize = ceilf(float(inDesc.width) * powf(0.5f, float(inSubresources.baseMipLevel)));
@@ -356,6 +366,8 @@ void LightProbeProcessingPass::RenderSpecularMap(nvrhi::ICommandList* commandLis
 
 void LightProbeProcessingPass::RenderEnvironmentBrdfTexture(nvrhi::ICommandList* commandList)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Environment BRDF");
+
     commandList->beginMarker("Environment BRDF");
 
     nvrhi::FramebufferHandle framebuffer = m_Device->createFramebuffer(nvrhi::FramebufferDesc().addColorAttachment(m_EnvironmentBrdfTexture));
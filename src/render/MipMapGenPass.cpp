@@ -21,8 +21,10 @@
 */
 
 #include <donut/render/MipMapGenPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/AsyncComputeScheduler.h>
 
 #if DONUT_WITH_STATIC_SHADERS
 #if DONUT_WITH_DX11
@@ -171,6 +173,8 @@ MipMapGenPass::MipMapGenPass(
 
 void MipMapGenPass::Dispatch(nvrhi::ICommandList* commandList, int maxLOD) 
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "MipMapGen");
+
     assert(m_Texture);
 
     commandList->beginMarker("MipMapGen::Dispatch");
@@ -205,6 +209,19 @@ void MipMapGenPass::Dispatch(nvrhi::ICommandList* commandList, int maxLOD)
     commandList->endMarker(); // "MipMapGen::Dispatch"
 }
 
+AsyncComputeJob MipMapGenPass::ScheduleDispatch(AsyncComputeScheduler& scheduler, nvrhi::ICommandList* commandList, int maxLOD)
+{
+    assert(m_Texture);
+
+    return scheduler.ScheduleCompute(commandList,
+        [this, maxLOD](nvrhi::ICommandList* computeCommandList)
+        {
+            Dispatch(computeCommandList, maxLOD);
+        },
+        nullptr,
+        { { m_Texture, nvrhi::ResourceStates::UnorderedAccess } });
+}
+
 
 void MipMapGenPass::Display(std::shared_ptr<donut::engine::CommonRenderPasses> commonPasses, nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* target)
 {
@@ -21,8 +21,12 @@
 */
 
 #include <donut/render/PixelReadbackPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
+#include <donut/core/log.h>
+#include <algorithm>
+#include <cstring>
 
 #if DONUT_WITH_STATIC_SHADERS
 #if DONUT_WITH_DX11
@@ -42,14 +46,22 @@ using namespace donut::math;
 using namespace donut::engine;
 using namespace donut::render;
 
+// Must match GROUP_SIZE in pixel_readback_cs.hlsl
+static constexpr uint32_t c_ReadbackGroupSize = 64;
+
+static constexpr uint32_t c_BytesPerPixel = 16;
+
 PixelReadbackPass::PixelReadbackPass(
     nvrhi::IDevice* device, 
     std::shared_ptr<ShaderFactory> shaderFactory, 
     nvrhi::ITexture* inputTexture, 
     nvrhi::Format format,
     uint32_t arraySlice,
-    uint32_t mipLevel)
+    uint32_t mipLevel,
+    uint32_t numReadbackBuffers,
+    uint32_t maxPixelsPerBatch)
     : m_Device(device)
+    , m_MaxPixelsPerBatch(std::max(maxPixelsPerBatch, 1u))
 {
     const char* formatName = "";
     switch (format)
@@ -66,7 +78,7 @@ PixelReadbackPass::PixelReadbackPass(
     m_Shader = shaderFactory->CreateAutoShader("donut/passes/pixel_readback_cs.hlsl", "main", DONUT_MAKE_PLATFORM_SHADER(g_pixel_readback_cs), &macros, nvrhi::ShaderType::Compute);
 
     nvrhi::BufferDesc bufferDesc;
-    bufferDesc.byteSize = 16;
+    bufferDesc.byteSize = uint64_t(m_MaxPixelsPerBatch) * c_BytesPerPixel;
     bufferDesc.format = format;
     bufferDesc.canHaveUAVs = true;
     bufferDesc.initialState = nvrhi::ResourceStates::CopySource;
@@ -77,9 +89,29 @@ PixelReadbackPass::PixelReadbackPass(
 
     bufferDesc.canHaveUAVs = false;
     bufferDesc.cpuAccess = nvrhi::CpuAccessMode::Read;
+    bufferDesc.byteSize = c_BytesPerPixel;
     bufferDesc.debugName = "PixelReadbackPass/ReadbackBuffer";
     m_ReadbackBuffer = m_Device->createBuffer(bufferDesc);
 
+    m_Slots.resize(std::max(numReadbackBuffers, 1u));
+    bufferDesc.byteSize = uint64_t(m_MaxPixelsPerBatch) * c_BytesPerPixel;
+    for (uint32_t slotIndex = 0; slotIndex < uint32_t(m_Slots.size()); slotIndex++)
+    {
+        ReadbackSlot& slot = m_Slots[slotIndex];
+        slot.buffer = m_Device->createBuffer(bufferDesc);
+        slot.query = m_Device->createEventQuery();
+        m_FreeSlots.push_back(slotIndex);
+    }
+
+    nvrhi::BufferDesc positionBufferDesc;
+    positionBufferDesc.byteSize = uint64_t(m_MaxPixelsPerBatch) * sizeof(uint2);
+    positionBufferDesc.format = nvrhi::Format::RG32_UINT;
+    positionBufferDesc.canHaveTypedViews = true;
+    positionBufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+    positionBufferDesc.keepInitialState = true;
+    positionBufferDesc.debugName = "PixelReadbackPass/Positions";
+    m_PositionBuffer = m_Device->createBuffer(positionBufferDesc);
+
     nvrhi::BufferDesc constantBufferDesc;
     constantBufferDesc.byteSize = sizeof(PixelReadbackConstants);
     constantBufferDesc.isConstantBuffer = true;
@@ -93,6 +125,7 @@ PixelReadbackPass::PixelReadbackPass(
     layoutDesc.bindings = { 
         nvrhi::BindingLayoutItem::VolatileConstantBuffer(0),
         nvrhi::BindingLayoutItem::Texture_SRV(0),
+        nvrhi::BindingLayoutItem::TypedBuffer_SRV(1),
         nvrhi::BindingLayoutItem::TypedBuffer_UAV(0)
     };
 
@@ -102,6 +135,7 @@ PixelReadbackPass::PixelReadbackPass(
     setDesc.bindings = {
         nvrhi::BindingSetItem::ConstantBuffer(0, m_ConstantBuffer),
         nvrhi::BindingSetItem::Texture_SRV(0, inputTexture, nvrhi::Format::UNKNOWN, nvrhi::TextureSubresourceSet(mipLevel, 1, arraySlice, 1)),
+        nvrhi::BindingSetItem::TypedBuffer_SRV(1, m_PositionBuffer),
         nvrhi::BindingSetItem::TypedBuffer_UAV(0, m_IntermediateBuffer)
     };
 
@@ -113,20 +147,35 @@ PixelReadbackPass::PixelReadbackPass(
     m_Pipeline = m_Device->createComputePipeline(pipelineDesc);
 }
 
-
-void PixelReadbackPass::Capture(nvrhi::ICommandList* commandList, dm::uint2 pixelPosition)
+void PixelReadbackPass::RecordBatch(nvrhi::ICommandList* commandList, nvrhi::IBuffer* readbackBuffer)
 {
+    const uint32_t pixelCount = uint32_t(m_PositionScratch.size());
+    assert(pixelCount > 0 && pixelCount <= m_MaxPixelsPerBatch);
+
+    commandList->writeBuffer(m_PositionBuffer, m_PositionScratch.data(), pixelCount * sizeof(uint2));
+
     PixelReadbackConstants constants = {};
-    constants.pixelPosition = dm::int2(pixelPosition);
+    constants.pixelCount = pixelCount;
     commandList->writeBuffer(m_ConstantBuffer, &constants, sizeof(constants));
 
     nvrhi::ComputeState state;
     state.pipeline = m_Pipeline;
     state.bindings = { m_BindingSet };
     commandList->setComputeState(state);
-    commandList->dispatch(1, 1, 1);
+    commandList->dispatch(div_ceil(pixelCount, c_ReadbackGroupSize), 1, 1);
 
-    commandList->copyBuffer(m_ReadbackBuffer, 0, m_IntermediateBuffer, 0, m_ReadbackBuffer->getDesc().byteSize);
+    commandList->copyBuffer(readbackBuffer, 0, m_IntermediateBuffer, 0, uint64_t(pixelCount) * c_BytesPerPixel);
+}
+
+void PixelReadbackPass::Capture(nvrhi::ICommandList* commandList, dm::uint2 pixelPosition)
+{
+    DONUT_PROFILE_GPU_SCOPE(commandList, "PixelReadback");
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    m_PositionScratch.clear();
+    m_PositionScratch.push_back(pixelPosition);
+    RecordBatch(commandList, m_ReadbackBuffer);
 }
 
 dm::float4 PixelReadbackPass::ReadFloats()
@@ -161,3 +210,175 @@ dm::int4 PixelReadbackPass::ReadInts()
     m_Device->unmapBuffer(m_ReadbackBuffer);
     return values;
 }
+
+void PixelReadbackPass::Request(dm::uint2 origin, dm::uint2 size, PixelReadbackCallback callback)
+{
+    if (size.x * size.y == 0 || size.x * size.y > m_MaxPixelsPerBatch)
+    {
+        log::warning("PixelReadbackPass: cannot read back a region of %dx%d pixels, the limit is %d per batch",
+            int(size.x), int(size.y), int(m_MaxPixelsPerBatch));
+
+        PixelReadbackResult result;
+        result.origin = origin;
+        result.size = size;
+        if (callback)
+            callback(result);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    ReadbackRequest request;
+    request.origin = origin;
+    request.size = size;
+    request.callback = std::move(callback);
+    m_PendingRequests.push_back(std::move(request));
+}
+
+std::future<PixelReadbackResult> PixelReadbackPass::Request(dm::uint2 origin, dm::uint2 size)
+{
+    // std::function needs a copyable callable, so the promise is shared
+    auto promise = std::make_shared<std::promise<PixelReadbackResult>>();
+    std::future<PixelReadbackResult> future = promise->get_future();
+
+    Request(origin, size, [promise](const PixelReadbackResult& result)
+    {
+        promise->set_value(result);
+    });
+
+    return future;
+}
+
+void PixelReadbackPass::Submit(nvrhi::ICommandList* commandList)
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    if (m_PendingRequests.empty() || m_FreeSlots.empty())
+        return;
+
+    const uint32_t slotIndex = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+    ReadbackSlot& slot = m_Slots[slotIndex];
+    assert(slot.requests.empty());
+
+    // Take the requests in order until the batch is full
+    m_PositionScratch.clear();
+    while (!m_PendingRequests.empty())
+    {
+        ReadbackRequest& request = m_PendingRequests.front();
+        const uint32_t pixelCount = request.size.x * request.size.y;
+        if (m_PositionScratch.size() + pixelCount > m_MaxPixelsPerBatch)
+            break;
+
+        request.firstPixel = uint32_t(m_PositionScratch.size());
+        for (uint32_t y = 0; y < request.size.y; y++)
+            for (uint32_t x = 0; x < request.size.x; x++)
+                m_PositionScratch.push_back(request.origin + uint2(x, y));
+
+        slot.requests.push_back(std::move(request));
+        m_PendingRequests.pop_front();
+    }
+
+    DONUT_PROFILE_GPU_SCOPE(commandList, "PixelReadback");
+    commandList->beginMarker("PixelReadback");
+    RecordBatch(commandList, slot.buffer);
+    commandList->endMarker();
+
+    m_RecordedSlots.push_back(slotIndex);
+}
+
+void PixelReadbackPass::CompleteSlot(uint32_t slotIndex, std::vector<CompletedRequest>& completed)
+{
+    ReadbackSlot& slot = m_Slots[slotIndex];
+
+    const uint8_t* pData = static_cast<const uint8_t*>(m_Device->mapBuffer(slot.buffer, nvrhi::CpuAccessMode::Read));
+    assert(pData);
+
+    for (ReadbackRequest& request : slot.requests)
+    {
+        CompletedRequest& item = completed.emplace_back();
+        item.callback = std::move(request.callback);
+        item.result.origin = request.origin;
+        item.result.size = request.size;
+        item.result.values.resize(request.size.x * request.size.y);
+        memcpy(item.result.values.data(), pData + size_t(request.firstPixel) * c_BytesPerPixel,
+            item.result.values.size() * c_BytesPerPixel);
+    }
+
+    m_Device->unmapBuffer(slot.buffer);
+
+    slot.requests.clear();
+    m_Device->resetEventQuery(slot.query);
+    m_FreeSlots.push_back(slotIndex);
+}
+
+void PixelReadbackPass::Poll(bool wait)
+{
+    DONUT_PROFILE_CPU_SCOPE("PixelReadback Poll");
+
+    std::vector<CompletedRequest> completed;
+
+    {
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+        // The command lists with the recorded batches have been executed by now, fence them
+        for (uint32_t slotIndex : m_RecordedSlots)
+        {
+            m_Device->setEventQuery(m_Slots[slotIndex].query, nvrhi::CommandQueue::Graphics);
+            m_InFlightSlots.push_back(slotIndex);
+        }
+        m_RecordedSlots.clear();
+
+        while (!m_InFlightSlots.empty())
+        {
+            const uint32_t slotIndex = m_InFlightSlots.front();
+
+            if (wait)
+                m_Device->waitEventQuery(m_Slots[slotIndex].query);
+            else if (!m_Device->pollEventQuery(m_Slots[slotIndex].query))
+                break;
+
+            m_InFlightSlots.pop_front();
+            CompleteSlot(slotIndex, completed);
+        }
+    }
+
+    // Callbacks run outside of the lock so that they can issue new requests
+    for (const CompletedRequest& item : completed)
+    {
+        if (item.callback)
+            item.callback(item.result);
+    }
+}
+
+uint32_t PixelReadbackPass::GetNumPendingRequests()
+{
+    std::lock_guard<std::mutex> lockGuard(m_Mutex);
+
+    uint32_t count = uint32_t(m_PendingRequests.size());
+    for (const ReadbackSlot& slot : m_Slots)
+        count += uint32_t(slot.requests.size());
+    return count;
+}
+
+dm::float4 PixelReadbackResult::GetFloats(uint32_t index) const
+{
+    assert(index < values.size());
+    float4 result;
+    memcpy(&result, &values[index], sizeof(result));
+    return result;
+}
+
+dm::uint4 PixelReadbackResult::GetUInts(uint32_t index) const
+{
+    assert(index < values.size());
+    return values[index];
+}
+
+dm::int4 PixelReadbackResult::GetInts(uint32_t index) const
+{
+    assert(index < values.size());
+    int4 result;
+    memcpy(&result, &values[index], sizeof(result));
+    return result;
+}
@@ -21,6 +21,7 @@
 */
 
 #include <donut/render/PlanarShadowMap.h>
+#include <donut/engine/MemoryReport.h>
 
 using namespace donut::math;
 #include <donut/shaders/light_cb.h>
@@ -47,6 +48,7 @@ PlanarShadowMap::PlanarShadowMap(
     desc.keepInitialState = true;
     desc.dimension = nvrhi::TextureDimension::Texture2DArray;
     m_ShadowMapTexture = device->createTexture(desc);
+    m_MemoryTag.Set(GetGpuMemorySize(m_ShadowMapTexture));
     
     m_ShadowMapSize = float2(static_cast<float>(resolution));
     m_TextureSize = m_ShadowMapSize;
@@ -149,6 +151,25 @@ bool PlanarShadowMap::SetupDynamicDirectionalLightView(const DirectionalLight& l
     return viewIsModified;
 }
 
+bool PlanarShadowMap::SetupPerspectiveLightView(float3 position, float3 direction, float verticalFov, float zNear, float zFar)
+{
+    float3 up = (abs(direction.y) > 0.99f * length(direction)) ? float3(1.f, 0.f, 0.f) : float3(0.f, 1.f, 0.f);
+
+    affine3 viewToWorld = scaling(float3(1.f, 1.f, -1.f)) * lookatZ(direction, up) * translation(position);
+    affine3 worldToView = inverse(viewToWorld);
+
+    float4x4 projection = perspProjD3DStyle(verticalFov, 1.f, zNear, zFar);
+
+    bool viewIsModified = m_View->GetViewMatrix() != worldToView || any(m_View->GetProjectionMatrix(false) != projection);
+
+    m_View->SetMatrices(worldToView, projection);
+    m_View->UpdateCache();
+
+    m_FadeRangeTexels = 1.f;
+
+    return viewIsModified;
+}
+
 void PlanarShadowMap::SetupProxyView()
 {
     affine3 viewToWorld = lookatZ(float3(0, 1, 0), float3(0, 0, 1));
@@ -160,6 +181,39 @@ void PlanarShadowMap::SetupProxyView()
     m_View->UpdateCache();
 }
 
+bool PlanarShadowMap::SetOrthographicDepthRange(float zNear, float zFar)
+{
+    // Patch the Z mapping of the matrix built by orthoProjD3DStyle, keeping the XY mapping
+    float4x4 projection = m_View->GetProjectionMatrix(false);
+    float zScale = 1.f / (zFar - zNear);
+    projection.m22 = zScale;
+    projection.m32 = -zNear * zScale;
+
+    bool viewIsModified = any(m_View->GetProjectionMatrix(false) != projection);
+
+    m_View->SetMatrices(m_View->GetViewMatrix(), projection);
+    m_View->UpdateCache();
+
+    return viewIsModified;
+}
+
+box3 PlanarShadowMap::GetOrthographicViewBounds() const
+{
+    float4x4 projection = m_View->GetProjectionMatrix(false);
+    float zNear = -projection.m32 / projection.m22;
+
+    return box3(
+        float3((-1.f - projection.m30) / projection.m00, (-1.f - projection.m31) / projection.m11, zNear),
+        float3((1.f - projection.m30) / projection.m00, (1.f - projection.m31) / projection.m11, zNear + 1.f / projection.m22));
+}
+
+void PlanarShadowMap::SetViewport(const nvrhi::Viewport& viewport)
+{
+    m_ShadowMapSize = float2(viewport.maxX - viewport.minX, viewport.maxY - viewport.minY);
+    m_View->SetViewport(viewport);
+    m_View->UpdateCache();
+}
+
 void PlanarShadowMap::SetLitOutOfBounds(bool litOutOfBounds)
 {
     m_IsLitOutOfBounds = litOutOfBounds;
@@ -177,13 +231,19 @@ std::shared_ptr<PlanarView> PlanarShadowMap::GetPlanarView()
 
 dm::float4x4 PlanarShadowMap::GetWorldToUvzwMatrix() const
 {
-    // Calculate alternate matrix that maps to [0, 1] UV space instead of [-1, 1] clip space
+    // Calculate alternate matrix that maps to [0, 1] UV space instead of [-1, 1] clip space.
+    // The UVs cover the viewport only, which can be a part of the texture, e.g. an atlas tile.
+    nvrhi::ViewportState viewportState = m_View->GetViewportState();
+    const nvrhi::Viewport& viewport = viewportState.viewports[0];
+    float2 uvScale = float2(viewport.maxX - viewport.minX, viewport.maxY - viewport.minY) / m_TextureSize;
+    float2 uvOffset = float2(viewport.minX, viewport.minY) / m_TextureSize;
+
     float4x4 matClipToUvzw =
     {
-        0.5f,  0,    0, 0,
-        0,    -0.5f, 0, 0,
-        0,     0,    1, 0,
-        0.5f,  0.5f, 0, 1,
+        0.5f * uvScale.x,             0,                             0, 0,
+        0,                            -0.5f * uvScale.y,             0, 0,
+        0,                            0,                             1, 0,
+        0.5f * uvScale.x + uvOffset.x, 0.5f * uvScale.y + uvOffset.y, 0, 1,
     };
 
     return m_View->GetViewProjectionMatrix() * matClipToUvzw;
@@ -0,0 +1,700 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/RenderGraph.h>
+#include <donut/engine/MemoryReport.h>
+#include <donut/core/log.h>
+#include <nvrhi/common/misc.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace donut::render;
+
+
+static bool AreTextureDescsCompatible(const nvrhi::TextureDesc& a, const nvrhi::TextureDesc& b)
+{
+    return a.width == b.width
+        && a.height == b.height
+        && a.depth == b.depth
+        && a.arraySize == b.arraySize
+        && a.mipLevels == b.mipLevels
+        && a.sampleCount == b.sampleCount
+        && a.sampleQuality == b.sampleQuality
+        && a.format == b.format
+        && a.dimension == b.dimension
+        && a.isShaderResource == b.isShaderResource
+        && a.isRenderTarget == b.isRenderTarget
+        && a.isUAV == b.isUAV
+        && a.isTypeless == b.isTypeless
+        && a.useClearValue == b.useClearValue
+        && (!a.useClearValue || (a.clearValue == b.clearValue));
+}
+
+RenderGraphTexture RenderGraphBuilder::CreateTexture(const nvrhi::TextureDesc& desc)
+{
+    return m_Graph.CreateTexture(desc);
+}
+
+void RenderGraphBuilder::Read(RenderGraphTexture texture, nvrhi::ResourceStates state)
+{
+    if (!texture.IsValid() || texture.index >= m_Graph.m_Resources.size())
+    {
+        log::error("RenderGraph pass '%s' reads an invalid texture", m_Graph.m_Passes[m_PassIndex].name.c_str());
+        return;
+    }
+
+    auto& reads = m_Graph.m_Passes[m_PassIndex].reads;
+    for (auto& access : reads)
+    {
+        if (access.resource == texture.index)
+        {
+            access.state = access.state | state;
+            return;
+        }
+    }
+    reads.push_back({ texture.index, state });
+}
+
+void RenderGraphBuilder::Write(RenderGraphTexture texture, nvrhi::ResourceStates state)
+{
+    if (!texture.IsValid() || texture.index >= m_Graph.m_Resources.size())
+    {
+        log::error("RenderGraph pass '%s' writes an invalid texture", m_Graph.m_Passes[m_PassIndex].name.c_str());
+        return;
+    }
+
+    auto& writes = m_Graph.m_Passes[m_PassIndex].writes;
+    for (auto& access : writes)
+    {
+        if (access.resource == texture.index)
+        {
+            access.state = state;
+            return;
+        }
+    }
+    writes.push_back({ texture.index, state });
+    m_Graph.m_Resources[texture.index].producers.push_back(m_PassIndex);
+}
+
+void RenderGraphBuilder::SetSideEffects()
+{
+    m_Graph.m_Passes[m_PassIndex].sideEffects = true;
+}
+
+RenderGraph::RenderGraph(nvrhi::IDevice* device)
+    : m_Device(device)
+{
+    // D3D11 has no placed resources; transients are still shared there, but only between identical descs.
+    m_UseHeap = m_Device->queryFeatureSupport(nvrhi::Feature::VirtualResources);
+}
+
+void RenderGraph::Reset()
+{
+    m_Resources.clear();
+    m_Passes.clear();
+    m_CurrentPass = ~0u;
+    m_Compiled = false;
+}
+
+RenderGraphTexture RenderGraph::ImportTexture(nvrhi::ITexture* texture, const char* name, nvrhi::ResourceStates finalState)
+{
+    assert(texture);
+
+    Resource resource;
+    resource.desc = texture->getDesc();
+    resource.name = name ? name : resource.desc.debugName;
+    resource.texture = texture;
+    resource.finalState = finalState;
+    resource.imported = true;
+    m_Resources.push_back(std::move(resource));
+
+    return RenderGraphTexture{ uint32_t(m_Resources.size() - 1) };
+}
+
+RenderGraphTexture RenderGraph::CreateTexture(const nvrhi::TextureDesc& desc)
+{
+    Resource resource;
+    resource.desc = desc;
+    resource.name = desc.debugName;
+    m_Resources.push_back(std::move(resource));
+
+    m_Compiled = false;
+    return RenderGraphTexture{ uint32_t(m_Resources.size() - 1) };
+}
+
+void RenderGraph::AddPass(const char* name, const SetupFunc& setup, ExecuteFunc execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_Passes.push_back(std::move(pass));
+
+    RenderGraphBuilder builder(*this, uint32_t(m_Passes.size() - 1));
+    if (setup)
+        setup(builder);
+
+    m_Compiled = false;
+}
+
+void RenderGraph::CullPasses()
+{
+    // Reference counting from the outputs backwards: a pass stays alive while any of the textures it writes
+    // is read by a live pass, is imported, or the pass has side effects.
+
+    for (auto& resource : m_Resources)
+        resource.refCount = 0;
+
+    for (auto& pass : m_Passes)
+    {
+        pass.culled = false;
+        pass.refCount = uint32_t(pass.writes.size());
+        for (const auto& access : pass.reads)
+            ++m_Resources[access.resource].refCount;
+    }
+
+    // Every resource is queued at most once: either here, because no pass reads it, or by cullPass
+    // when its last reader is culled, which can only happen to resources that had readers.
+    std::vector<uint32_t> unreferenced;
+
+    for (uint32_t index = 0; index < uint32_t(m_Resources.size()); index++)
+    {
+        const Resource& resource = m_Resources[index];
+        if (resource.refCount == 0 && !resource.imported)
+            unreferenced.push_back(index);
+    }
+
+    auto cullPass = [this, &unreferenced](Pass& pass)
+    {
+        pass.culled = true;
+        for (const auto& access : pass.reads)
+        {
+            Resource& resource = m_Resources[access.resource];
+            if (--resource.refCount == 0 && !resource.imported)
+                unreferenced.push_back(access.resource);
+        }
+    };
+
+    for (auto& pass : m_Passes)
+    {
+        if (pass.refCount == 0 && !pass.sideEffects)
+            cullPass(pass);
+    }
+
+    while (!unreferenced.empty())
+    {
+        const Resource& resource = m_Resources[unreferenced.back()];
+        unreferenced.pop_back();
+
+        for (uint32_t producer : resource.producers)
+        {
+            Pass& pass = m_Passes[producer];
+            if (pass.culled || pass.sideEffects)
+                continue;
+
+            if (--pass.refCount == 0)
+                cullPass(pass);
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (auto& resource : m_Resources)
+    {
+        resource.firstPass = ~0u;
+        resource.lastPass = 0;
+    }
+
+    for (uint32_t passIndex = 0; passIndex < uint32_t(m_Passes.size()); passIndex++)
+    {
+        Pass& pass = m_Passes[passIndex];
+        pass.firstUses.clear();
+
+        if (pass.culled)
+            continue;
+
+        auto touch = [this, &pass, passIndex](const Access& access, bool write)
+        {
+            Resource& resource = m_Resources[access.resource];
+            if (resource.firstPass == ~0u)
+            {
+                resource.firstPass = passIndex;
+
+                if (!resource.imported)
+                {
+                    pass.firstUses.push_back(access.resource);
+
+                    if (!write && !resource.desc.useClearValue)
+                        log::warning("RenderGraph pass '%s' reads transient texture '%s' before it is written",
+                            pass.name.c_str(), resource.name.c_str());
+                }
+            }
+            resource.lastPass = passIndex;
+        };
+
+        // Writes first so that a texture that is both read and written by its first pass is not reported
+        for (const auto& access : pass.writes)
+            touch(access, true);
+        for (const auto& access : pass.reads)
+            touch(access, false);
+    }
+}
+
+void RenderGraph::AllocatePlaced(const std::vector<uint32_t>& transients)
+{
+    // Reuse the previous frame's placement if the transient textures and their lifetimes are unchanged,
+    // which is the common case. Anything else (resize, settings change) rebuilds all placed textures.
+
+    bool reuse = m_Allocations.size() == transients.size() && m_Heap;
+    for (size_t i = 0; reuse && i < transients.size(); i++)
+    {
+        const Resource& resource = m_Resources[transients[i]];
+        const Allocation& allocation = m_Allocations[i];
+        reuse = allocation.texture
+            && allocation.firstPass == resource.firstPass
+            && allocation.lastPass == resource.lastPass
+            && AreTextureDescsCompatible(allocation.desc, resource.desc);
+    }
+
+    if (!reuse)
+    {
+        m_Allocations.clear();
+        m_FramebufferCache.clear();
+
+        std::vector<nvrhi::MemoryRequirements> requirements;
+        requirements.reserve(transients.size());
+
+        for (uint32_t index : transients)
+        {
+            const Resource& resource = m_Resources[index];
+
+            Allocation allocation;
+            allocation.desc = resource.desc;
+            allocation.desc.isVirtual = true;
+            allocation.desc.initialState = nvrhi::ResourceStates::Common;
+            allocation.desc.keepInitialState = true;
+            allocation.firstPass = resource.firstPass;
+            allocation.lastPass = resource.lastPass;
+            allocation.texture = m_Device->createTexture(allocation.desc);
+
+            nvrhi::MemoryRequirements memReq = m_Device->getTextureMemoryRequirements(allocation.texture);
+            allocation.size = memReq.size;
+            requirements.push_back(memReq);
+
+            m_Allocations.push_back(std::move(allocation));
+        }
+
+        // Greedy placement, largest first: each texture goes to the lowest offset that does not overlap
+        // any already placed texture whose lifetime intersects its own.
+
+        std::vector<size_t> order(m_Allocations.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+        {
+            return m_Allocations[a].size > m_Allocations[b].size;
+        });
+
+        std::vector<size_t> placed;
+        std::vector<size_t> overlapping;
+        uint64_t heapSize = 0;
+
+        for (size_t index : order)
+        {
+            Allocation& allocation = m_Allocations[index];
+            const uint64_t alignment = std::max<uint64_t>(requirements[index].alignment, 1);
+
+            overlapping.clear();
+            for (size_t other : placed)
+            {
+                const Allocation& otherAllocation = m_Allocations[other];
+                if (otherAllocation.firstPass <= allocation.lastPass && allocation.firstPass <= otherAllocation.lastPass)
+                    overlapping.push_back(other);
+            }
+
+            std::sort(overlapping.begin(), overlapping.end(), [this](size_t a, size_t b)
+            {
+                return m_Allocations[a].offset < m_Allocations[b].offset;
+            });
+
+            uint64_t offset = 0;
+            for (size_t other : overlapping)
+            {
+                const Allocation& otherAllocation = m_Allocations[other];
+                if (offset + allocation.size <= otherAllocation.offset)
+                    break;
+
+                offset = std::max(offset, nvrhi::align(otherAllocation.offset + otherAllocation.size, alignment));
+            }
+
+            allocation.offset = offset;
+            heapSize = std::max(heapSize, offset + allocation.size);
+            placed.push_back(index);
+        }
+
+        // Textures whose memory overlaps another one inherit its contents, within the frame or from the
+        // previous frame, so they have to be initialized at their first use
+        for (auto& allocation : m_Allocations)
+        {
+            allocation.aliased = false;
+            for (const auto& other : m_Allocations)
+            {
+                if (&other != &allocation && other.offset < allocation.offset + allocation.size && allocation.offset < other.offset + other.size)
+                {
+                    allocation.aliased = true;
+                    break;
+                }
+            }
+        }
+
+        if (heapSize > m_HeapCapacity || !m_Heap)
+        {
+            // Textures bound to the old heap keep it alive until they are released
+            nvrhi::HeapDesc heapDesc;
+            heapDesc.capacity = heapSize;
+            heapDesc.type = nvrhi::HeapType::DeviceLocal;
+            heapDesc.debugName = "RenderGraph transient heap";
+            m_Heap = m_Device->createHeap(heapDesc);
+            m_HeapCapacity = m_Heap ? heapSize : 0;
+        }
+
+        for (auto& allocation : m_Allocations)
+        {
+            if (!m_Heap || !m_Device->bindTextureMemory(allocation.texture, m_Heap, allocation.offset))
+            {
+                log::error("RenderGraph failed to bind memory for transient texture '%s'", allocation.desc.debugName.c_str());
+                allocation.texture = nullptr;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < transients.size(); i++)
+    {
+        m_Resources[transients[i]].texture = m_Allocations[i].texture;
+        m_Resources[transients[i]].aliased = m_Allocations[i].aliased;
+        m_Stats.transientMemoryRequired += m_Allocations[i].size;
+        if (m_Allocations[i].aliased)
+            ++m_Stats.numAliasedTextures;
+    }
+
+    m_Stats.transientMemoryAllocated = m_HeapCapacity;
+    m_Stats.numAllocatedTextures = uint32_t(m_Allocations.size());
+    m_MemoryTag.Set(size_t(m_HeapCapacity));
+}
+
+void RenderGraph::AllocatePooled(const std::vector<uint32_t>& transients)
+{
+    // Without placed resources, a texture is shared by transients with identical descs and disjoint lifetimes.
+    // The pool carries over between frames; textures that were not needed this frame are released.
+
+    std::vector<uint32_t> busyUntil(m_Allocations.size(), 0);
+    std::vector<bool> used(m_Allocations.size(), false);
+
+    std::vector<uint32_t> order = transients;
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        return m_Resources[a].firstPass < m_Resources[b].firstPass;
+    });
+
+    for (uint32_t index : order)
+    {
+        Resource& resource = m_Resources[index];
+
+        size_t found = m_Allocations.size();
+        for (size_t i = 0; i < m_Allocations.size(); i++)
+        {
+            if (used[i] && (!m_AliasingEnabled || busyUntil[i] >= resource.firstPass))
+                continue;
+
+            if (AreTextureDescsCompatible(m_Allocations[i].desc, resource.desc))
+            {
+                found = i;
+                break;
+            }
+        }
+
+        if (found == m_Allocations.size())
+        {
+            Allocation allocation;
+            allocation.desc = resource.desc;
+            allocation.desc.isVirtual = false;
+            allocation.desc.initialState = nvrhi::ResourceStates::Common;
+            allocation.desc.keepInitialState = true;
+            allocation.texture = m_Device->createTexture(allocation.desc);
+            m_Allocations.push_back(std::move(allocation));
+            busyUntil.push_back(0);
+            used.push_back(false);
+        }
+
+        used[found] = true;
+        busyUntil[found] = resource.lastPass;
+        resource.texture = m_Allocations[found].texture;
+        m_Stats.transientMemoryRequired += engine::GetGpuMemorySize(resource.desc);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_Allocations.size(); i++)
+    {
+        if (used[i])
+            m_Allocations[kept++] = std::move(m_Allocations[i]);
+    }
+    if (kept != m_Allocations.size())
+    {
+        m_Allocations.resize(kept);
+        m_FramebufferCache.clear();
+    }
+
+    uint64_t textureMemory = 0;
+    for (const auto& allocation : m_Allocations)
+        textureMemory += engine::GetGpuMemorySize(allocation.desc);
+
+    m_Stats.numAllocatedTextures = uint32_t(m_Allocations.size());
+    m_MemoryTag.Set(size_t(textureMemory));
+}
+
+bool RenderGraph::Compile()
+{
+    m_Stats = RenderGraphStats();
+    m_Stats.numPasses = uint32_t(m_Passes.size());
+
+    CullPasses();
+    ComputeLifetimes();
+
+    std::vector<uint32_t> transients;
+    for (uint32_t index = 0; index < uint32_t(m_Resources.size()); index++)
+    {
+        Resource& resource = m_Resources[index];
+        if (resource.imported)
+            continue;
+
+        resource.texture = nullptr;
+        resource.aliased = false;
+        if (resource.firstPass != ~0u)
+            transients.push_back(index);
+    }
+
+    for (const auto& pass : m_Passes)
+    {
+        if (pass.culled)
+            ++m_Stats.numCulledPasses;
+    }
+    m_Stats.numTransientTextures = uint32_t(transients.size());
+
+    if (m_UseHeap && m_AliasingEnabled)
+    {
+        AllocatePlaced(transients);
+    }
+    else
+    {
+        // Switching from placed to pooled textures: the placed ones cannot be reused
+        if (m_Heap)
+            ReleaseMemory();
+
+        AllocatePooled(transients);
+    }
+
+    bool success = true;
+    for (uint32_t index : transients)
+    {
+        if (!m_Resources[index].texture)
+            success = false;
+    }
+
+    m_Compiled = success;
+    return success;
+}
+
+nvrhi::ResourceStates RenderGraph::GetPassState(uint32_t passIndex, uint32_t resource) const
+{
+    const Pass& pass = m_Passes[passIndex];
+
+    for (const auto& access : pass.writes)
+    {
+        if (access.resource == resource)
+            return access.state;
+    }
+
+    for (const auto& access : pass.reads)
+    {
+        if (access.resource == resource)
+            return access.state;
+    }
+
+    return nvrhi::ResourceStates::Unknown;
+}
+
+void RenderGraph::Execute(nvrhi::ICommandList* commandList)
+{
+    if (!m_Compiled && !Compile())
+    {
+        log::error("RenderGraph::Execute(...) called on a graph that failed to compile");
+        return;
+    }
+
+    m_Stats.numBarrierBatches = 0;
+
+    for (uint32_t passIndex = 0; passIndex < uint32_t(m_Passes.size()); passIndex++)
+    {
+        const Pass& pass = m_Passes[passIndex];
+        if (pass.culled)
+            continue;
+
+        m_CurrentPass = passIndex;
+        commandList->beginMarker(pass.name.c_str());
+
+        // Transient memory holds garbage at the first use of a texture. Clear it if the desc asks for it, and
+        // always when the memory is aliased: NVRHI exposes no aliasing barrier or discard, and a clear is the
+        // initialization that D3D12 and Vulkan accept for a placed render target or UAV whose memory was used
+        // by another resource. The clear also orders the first use after the previous resource's last one.
+        for (uint32_t index : pass.firstUses)
+        {
+            const Resource& resource = m_Resources[index];
+            if (!resource.desc.useClearValue && !resource.aliased)
+                continue;
+
+            const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(resource.desc.format);
+            const nvrhi::Color clearValue = resource.desc.useClearValue ? resource.desc.clearValue : nvrhi::Color(0.f);
+
+            if (formatInfo.hasDepth || formatInfo.hasStencil)
+            {
+                if (!resource.desc.isRenderTarget)
+                    continue;
+
+                commandList->clearDepthStencilTexture(resource.texture, nvrhi::AllSubresources,
+                    true, clearValue.r, formatInfo.hasStencil, uint8_t(clearValue.g));
+            }
+            else
+            {
+                // Textures that are neither render targets nor UAVs can only be initialized by copies
+                if (!resource.desc.isRenderTarget && !resource.desc.isUAV)
+                    continue;
+
+                commandList->clearTextureFloat(resource.texture, nvrhi::AllSubresources, clearValue);
+            }
+        }
+
+        // All transitions of a pass go out in one batch; the pass itself then finds its resources in the right states
+        for (const auto& access : pass.reads)
+        {
+            // Textures that are also written get the write state below
+            if (GetPassState(passIndex, access.resource) != access.state)
+                continue;
+
+            commandList->setTextureState(m_Resources[access.resource].texture, nvrhi::AllSubresources, access.state);
+        }
+        for (const auto& access : pass.writes)
+        {
+            commandList->setTextureState(m_Resources[access.resource].texture, nvrhi::AllSubresources, access.state);
+        }
+        commandList->commitBarriers();
+        ++m_Stats.numBarrierBatches;
+
+        if (pass.execute)
+            pass.execute(commandList, *this);
+
+        commandList->endMarker();
+    }
+
+    m_CurrentPass = ~0u;
+
+    bool finalTransitions = false;
+    for (const auto& resource : m_Resources)
+    {
+        if (resource.imported && resource.firstPass != ~0u && resource.finalState != nvrhi::ResourceStates::Unknown)
+        {
+            commandList->setTextureState(resource.texture, nvrhi::AllSubresources, resource.finalState);
+            finalTransitions = true;
+        }
+    }
+    if (finalTransitions)
+    {
+        commandList->commitBarriers();
+        ++m_Stats.numBarrierBatches;
+    }
+}
+
+nvrhi::ITexture* RenderGraph::GetTexture(RenderGraphTexture texture) const
+{
+    if (!texture.IsValid() || texture.index >= m_Resources.size())
+        return nullptr;
+
+    return m_Resources[texture.index].texture;
+}
+
+nvrhi::IFramebuffer* RenderGraph::GetFramebuffer(const std::vector<RenderGraphTexture>& colorTargets, RenderGraphTexture depthTarget) const
+{
+    // The key is the attachment textures plus a marker for a read-only depth attachment
+    std::vector<nvrhi::ITexture*> key;
+    key.reserve(colorTargets.size() + 2);
+
+    nvrhi::FramebufferDesc desc;
+    for (RenderGraphTexture target : colorTargets)
+    {
+        nvrhi::ITexture* texture = GetTexture(target);
+        if (!texture)
+            return nullptr;
+
+        desc.addColorAttachment(texture);
+        key.push_back(texture);
+    }
+
+    if (depthTarget.IsValid())
+    {
+        nvrhi::ITexture* texture = GetTexture(depthTarget);
+        if (!texture)
+            return nullptr;
+
+        bool readOnly = false;
+        if (m_CurrentPass != ~0u)
+        {
+            nvrhi::ResourceStates state = GetPassState(m_CurrentPass, depthTarget.index);
+            readOnly = (uint32_t(state) & uint32_t(nvrhi::ResourceStates::DepthWrite)) == 0;
+        }
+
+        desc.setDepthAttachment(nvrhi::FramebufferAttachment().setTexture(texture).setReadOnly(readOnly));
+        key.push_back(texture);
+        key.push_back(readOnly ? texture : nullptr);
+    }
+
+    nvrhi::FramebufferHandle& framebuffer = m_FramebufferCache[key];
+    if (!framebuffer)
+        framebuffer = m_Device->createFramebuffer(desc);
+
+    return framebuffer;
+}
+
+void RenderGraph::ReleaseMemory()
+{
+    m_FramebufferCache.clear();
+    m_Allocations.clear();
+    m_Heap = nullptr;
+    m_HeapCapacity = 0;
+
+    for (auto& resource : m_Resources)
+    {
+        if (!resource.imported)
+            resource.texture = nullptr;
+    }
+    m_Compiled = false;
+}
@@ -0,0 +1,591 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/ShadowAtlas.h>
+#include <donut/engine/Profiler.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/render/GeometryPasses.h>
+#include <donut/render/PlanarShadowMap.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/MemoryReport.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/SceneTypes.h>
+#include <algorithm>
+#include <array>
+
+using namespace donut::math;
+#include <donut/shaders/light_cb.h>
+
+using namespace donut::engine;
+using namespace donut::render;
+
+static bool IsPowerOfTwo(int value)
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+QuadTreeAllocator::QuadTreeAllocator(int size, int minTileSize)
+    : m_Size(size)
+    , m_MinTileSize(std::min(minTileSize, size))
+{
+    assert(IsPowerOfTwo(m_Size));
+    assert(IsPowerOfTwo(m_MinTileSize));
+
+    m_FreeTiles.resize(GetLevel(m_MinTileSize) + 1);
+    Reset();
+}
+
+int QuadTreeAllocator::GetLevel(int tileSize) const
+{
+    int level = 0;
+    for (int size = m_Size; size > tileSize && size > m_MinTileSize; size /= 2)
+        ++level;
+
+    return level;
+}
+
+int QuadTreeAllocator::GetTileSize(int tileSize) const
+{
+    int size = m_MinTileSize;
+    while (size < tileSize && size < m_Size)
+        size *= 2;
+
+    return size;
+}
+
+bool QuadTreeAllocator::Allocate(int tileSize, int2& origin)
+{
+    const int targetLevel = GetLevel(GetTileSize(tileSize));
+
+    // Find the smallest free tile that is large enough
+    int level = targetLevel;
+    while (level >= 0 && m_FreeTiles[level].empty())
+        --level;
+
+    if (level < 0)
+        return false;
+
+    int2 tile = m_FreeTiles[level].back();
+    m_FreeTiles[level].pop_back();
+
+    // Split it down to the requested size, keeping the first quadrant at each level
+    while (level < targetLevel)
+    {
+        ++level;
+        const int childSize = m_Size >> level;
+        m_FreeTiles[level].push_back(tile + int2(childSize, 0));
+        m_FreeTiles[level].push_back(tile + int2(0, childSize));
+        m_FreeTiles[level].push_back(tile + int2(childSize, childSize));
+    }
+
+    origin = tile;
+    return true;
+}
+
+void QuadTreeAllocator::Free(int2 origin, int tileSize)
+{
+    int level = GetLevel(tileSize);
+
+    // Merge the tile with its siblings for as long as all of them are free
+    while (level > 0)
+    {
+        const int parentSize = m_Size >> (level - 1);
+        const int childSize = parentSize / 2;
+        const int2 parentOrigin = int2((origin.x / parentSize) * parentSize, (origin.y / parentSize) * parentSize);
+
+        std::vector<int2>& freeTiles = m_FreeTiles[level];
+        std::array<std::vector<int2>::iterator, 3> siblings;
+        int numSiblings = 0;
+
+        for (int child = 0; child < 4; child++)
+        {
+            const int2 childOrigin = parentOrigin + int2((child & 1) * childSize, (child >> 1) * childSize);
+            if (all(childOrigin == origin))
+                continue;
+
+            auto it = std::find_if(freeTiles.begin(), freeTiles.end(), [childOrigin](const int2& tile) { return all(tile == childOrigin); });
+            if (it == freeTiles.end())
+                break;
+
+            siblings[numSiblings++] = it;
+        }
+
+        if (numSiblings < 3)
+            break;
+
+        // Erase from the back so that the remaining iterators stay valid
+        std::sort(siblings.begin(), siblings.end(), std::greater<>());
+        for (auto it : siblings)
+            freeTiles.erase(it);
+
+        origin = parentOrigin;
+        --level;
+    }
+
+    m_FreeTiles[level].push_back(origin);
+}
+
+void QuadTreeAllocator::Reset()
+{
+    for (auto& freeTiles : m_FreeTiles)
+        freeTiles.clear();
+
+    m_FreeTiles[0].push_back(int2(0));
+}
+
+size_t QuadTreeAllocator::GetFreeArea() const
+{
+    size_t area = 0;
+    for (size_t level = 0; level < m_FreeTiles.size(); level++)
+    {
+        const size_t tileSize = size_t(m_Size >> level);
+        area += m_FreeTiles[level].size() * tileSize * tileSize;
+    }
+
+    return area;
+}
+
+AtlasShadowMap::AtlasShadowMap(nvrhi::IDevice* device, nvrhi::ITexture* texture, uint32_t arraySlice)
+    : m_Texture(texture)
+{
+    for (int face = 0; face < 6; face++)
+    {
+        auto planarShadowMap = std::make_shared<PlanarShadowMap>(device, texture, arraySlice, nvrhi::Viewport(1.f, 1.f));
+        planarShadowMap->SetLitOutOfBounds(true);
+        m_Faces.push_back(planarShadowMap);
+    }
+}
+
+std::shared_ptr<PlanarShadowMap> AtlasShadowMap::GetFace(uint32_t face) const
+{
+    if (face < m_NumFaces)
+        return m_Faces[face];
+
+    return nullptr;
+}
+
+dm::float4x4 AtlasShadowMap::GetWorldToUvzwMatrix() const
+{
+    assert(m_NumFaces == 1);
+    return m_Faces[0]->GetWorldToUvzwMatrix();
+}
+
+const ICompositeView& AtlasShadowMap::GetView() const
+{
+    return m_CompositeView;
+}
+
+nvrhi::ITexture* AtlasShadowMap::GetTexture() const
+{
+    return m_Texture;
+}
+
+uint32_t AtlasShadowMap::GetNumberOfCascades() const
+{
+    return std::min(m_NumFaces, 4u);
+}
+
+const IShadowMap* AtlasShadowMap::GetCascade(uint32_t index) const
+{
+    if (index < GetNumberOfCascades())
+        return m_Faces[index].get();
+
+    return nullptr;
+}
+
+uint32_t AtlasShadowMap::GetNumberOfPerObjectShadows() const
+{
+    return m_NumFaces - GetNumberOfCascades();
+}
+
+const IShadowMap* AtlasShadowMap::GetPerObjectShadow(uint32_t index) const
+{
+    if (index < GetNumberOfPerObjectShadows())
+        return m_Faces[4 + index].get();
+
+    return nullptr;
+}
+
+dm::int2 AtlasShadowMap::GetTextureSize() const
+{
+    const nvrhi::TextureDesc& textureDesc = m_Texture->getDesc();
+    return int2(textureDesc.width, textureDesc.height);
+}
+
+dm::box2 AtlasShadowMap::GetUVRange() const
+{
+    assert(m_NumFaces == 1);
+    return m_Faces[0]->GetUVRange();
+}
+
+dm::float2 AtlasShadowMap::GetFadeRangeInTexels() const
+{
+    return m_Faces[0]->GetFadeRangeInTexels();
+}
+
+bool AtlasShadowMap::IsLitOutOfBounds() const
+{
+    // The faces of point light shadows rely on the out-of-bounds areas being lit,
+    // and spot lights do not emit any light outside of their shadow frustum.
+    return true;
+}
+
+void AtlasShadowMap::FillShadowConstants(ShadowConstants& constants) const
+{
+    assert(m_NumFaces == 1);
+    m_Faces[0]->FillShadowConstants(constants);
+}
+
+static nvrhi::TextureHandle CreateAtlasTexture(nvrhi::IDevice* device, const ShadowAtlas::CreateParameters& params)
+{
+    nvrhi::TextureDesc desc;
+    desc.width = params.resolution;
+    desc.height = params.resolution;
+    desc.sampleCount = 1;
+    desc.isRenderTarget = true;
+    desc.isTypeless = true;
+    desc.format = params.format;
+    desc.debugName = "ShadowAtlas";
+    desc.useClearValue = true;
+    desc.clearValue = nvrhi::Color(1.f);
+    desc.initialState = nvrhi::ResourceStates::ShaderResource;
+    desc.keepInitialState = true;
+    desc.dimension = nvrhi::TextureDimension::Texture2DArray;
+    return device->createTexture(desc);
+}
+
+ShadowAtlas::ShadowAtlas(
+    nvrhi::IDevice* device,
+    std::shared_ptr<CommonRenderPasses> commonPasses,
+    const CreateParameters& params)
+    : ShadowAtlas(device, std::move(commonPasses), CreateAtlasTexture(device, params), 0, params)
+{
+    m_MemoryTag.Set(GetGpuMemorySize(m_Texture));
+}
+
+ShadowAtlas::ShadowAtlas(
+    nvrhi::IDevice* device,
+    std::shared_ptr<CommonRenderPasses> commonPasses,
+    nvrhi::ITexture* texture,
+    uint32_t arraySlice,
+    const CreateParameters& params)
+    : m_Device(device)
+    , m_CommonPasses(std::move(commonPasses))
+    , m_Params(params)
+    , m_Texture(texture)
+    , m_ArraySlice(arraySlice)
+    , m_Allocator(params.resolution, params.minTileSize)
+{
+    assert(int(texture->getDesc().width) >= params.resolution);
+    assert(int(texture->getDesc().height) >= params.resolution);
+    assert(arraySlice < texture->getDesc().arraySize);
+
+    m_FramebufferFactory = std::make_shared<FramebufferFactory>(m_Device);
+    m_FramebufferFactory->DepthTarget = m_Texture;
+}
+
+void ShadowAtlas::FreeTiles(LightEntry& entry)
+{
+    for (const int2& tile : entry.tiles)
+        m_Allocator.Free(tile, entry.tileSize);
+
+    entry.tiles.clear();
+    entry.tileSize = 0;
+    entry.contentValid = false;
+}
+
+static float GetLightRange(const Light& light, float defaultRange)
+{
+    float range = 0.f;
+    if (light.GetLightType() == LightType_Spot)
+        range = static_cast<const SpotLight&>(light).range;
+    else if (light.GetLightType() == LightType_Point)
+        range = static_cast<const PointLight&>(light).range;
+
+    return (range > 0.f) ? range : defaultRange;
+}
+
+static bool SphereIntersectsBox(const float3& center, float radius, const box3& box)
+{
+    const float3 closestPoint = max(box.m_mins, min(box.m_maxs, center));
+    return lengthSquared(closestPoint - center) <= radius * radius;
+}
+
+void ShadowAtlas::Update(const IView& view, const SceneGraph& scene, const std::vector<std::shared_ptr<Light>>& lights)
+{
+    for (auto& [key, entry] : m_Lights)
+        entry.active = false;
+
+    // Collect the current and previous bounds of the mesh instances that moved since the last frame,
+    // the lights whose range includes any of them need to be re-rendered
+    std::vector<box3> movingCasterBounds;
+    for (const auto& instance : scene.GetMeshInstances())
+    {
+        const SceneGraphNode* node = instance->GetNode();
+        if (!node || node->GetLocalToWorldTransformFloat() == node->GetPrevLocalToWorldTransformFloat())
+            continue;
+
+        movingCasterBounds.push_back(node->GetGlobalBoundingBox());
+        movingCasterBounds.push_back(instance->GetMesh()->objectSpaceBounds * node->GetPrevLocalToWorldTransformFloat());
+    }
+
+    const frustum viewFrustum = view.GetViewFrustum();
+    const affine3 worldToView = view.GetViewMatrix();
+    const float4x4 projection = view.GetProjectionMatrix(false);
+
+    std::vector<LightEntry*> activeEntries;
+
+    for (const auto& light : lights)
+    {
+        const int lightType = light->GetLightType();
+        if (lightType != LightType_Spot && lightType != LightType_Point)
+            continue;
+
+        const float3 position = float3(light->GetPosition());
+        const float range = GetLightRange(*light, m_Params.defaultRange);
+
+        if (!viewFrustum.intersectsWith(box3(position - range, position + range)))
+        {
+            light->shadowMap = nullptr;
+            continue;
+        }
+
+        LightEntry& entry = m_Lights[light.get()];
+        if (!entry.shadowMap)
+        {
+            entry.light = light;
+            entry.shadowMap = std::make_shared<AtlasShadowMap>(m_Device, m_Texture, m_ArraySlice);
+        }
+
+        const uint32_t numFaces = (lightType == LightType_Point) ? 6 : 1;
+        if (entry.shadowMap->m_NumFaces != numFaces)
+        {
+            FreeTiles(entry);
+
+            entry.shadowMap->m_NumFaces = numFaces;
+            entry.shadowMap->m_CompositeView = CompositeView();
+            for (uint32_t face = 0; face < numFaces; face++)
+                entry.shadowMap->m_CompositeView.AddView(entry.shadowMap->m_Faces[face]->GetPlanarView());
+        }
+
+        // Estimate the fraction of the view height covered by the light's sphere of influence
+        const float3 viewPosition = worldToView.transformPoint(position);
+        float coverage = 1.f;
+        if (lengthSquared(viewPosition) > range * range)
+        {
+            const float w = (float4(viewPosition, 1.f) * projection).w;
+            coverage = saturate(range * projection.m11 / std::max(w, m_Params.nearPlane));
+        }
+
+        const float importance = importanceCallback ? importanceCallback(*light) : 1.f;
+        entry.priority = coverage * importance;
+
+        int desiredTileSize = int(entry.priority * float(m_Params.fullScreenTileSize));
+        if (numFaces > 1)
+            desiredTileSize /= 2;
+        desiredTileSize = clamp(desiredTileSize, m_Params.minTileSize, m_Params.maxTileSize);
+        entry.desiredTileSize = m_Allocator.GetTileSize(desiredTileSize);
+
+        entry.active = true;
+        activeEntries.push_back(&entry);
+    }
+
+    // Release the tiles of the lights that are gone, and of those that need a different tile size
+    for (auto it = m_Lights.begin(); it != m_Lights.end(); )
+    {
+        LightEntry& entry = it->second;
+
+        if (!entry.active)
+        {
+            FreeTiles(entry);
+            it = m_Lights.erase(it);
+            continue;
+        }
+
+        if (entry.tileSize != entry.desiredTileSize)
+            FreeTiles(entry);
+
+        ++it;
+    }
+
+    std::sort(activeEntries.begin(), activeEntries.end(), [](const LightEntry* a, const LightEntry* b) { return a->priority > b->priority; });
+
+    for (LightEntry* entry : activeEntries)
+    {
+        const uint32_t numFaces = entry->shadowMap->m_NumFaces;
+
+        // Try smaller tiles when the atlas is too full for the desired size
+        for (int tileSize = entry->desiredTileSize; entry->tiles.empty() && tileSize >= m_Allocator.GetMinTileSize(); tileSize /= 2)
+        {
+            entry->tileSize = tileSize;
+
+            int2 origin;
+            while (entry->tiles.size() < numFaces && m_Allocator.Allocate(tileSize, origin))
+                entry->tiles.push_back(origin);
+
+            if (entry->tiles.size() < numFaces)
+                FreeTiles(*entry);
+        }
+
+        Light& light = *entry->light;
+
+        if (entry->tiles.empty())
+        {
+            light.shadowMap = nullptr;
+            continue;
+        }
+
+        const float3 position = float3(light.GetPosition());
+        const float range = GetLightRange(light, m_Params.defaultRange);
+        const float tileSize = float(entry->tileSize);
+
+        for (uint32_t face = 0; face < numFaces; face++)
+        {
+            PlanarShadowMap& faceShadowMap = *entry->shadowMap->m_Faces[face];
+            const float2 origin = float2(entry->tiles[face]);
+
+            if (!entry->contentValid)
+                faceShadowMap.SetViewport(nvrhi::Viewport(origin.x, origin.x + tileSize, origin.y, origin.y + tileSize, 0.f, 1.f));
+
+            float3 direction;
+            float verticalFov;
+            if (numFaces == 1)
+            {
+                direction = float3(light.GetDirection());
+                verticalFov = radians(clamp(static_cast<const SpotLight&>(light).outerAngle, 1.f, 150.f));
+            }
+            else
+            {
+                static const float3 faceDirections[6] = {
+                    float3(1.f, 0.f, 0.f), float3(-1.f, 0.f, 0.f),
+                    float3(0.f, 1.f, 0.f), float3(0.f, -1.f, 0.f),
+                    float3(0.f, 0.f, 1.f), float3(0.f, 0.f, -1.f)
+                };
+                direction = faceDirections[face];
+
+                // Widen the faces slightly so that their fade regions overlap and leave no seams
+                verticalFov = 2.f * atanf(1.f + 6.f / tileSize);
+            }
+
+            if (faceShadowMap.SetupPerspectiveLightView(position, direction, verticalFov, m_Params.nearPlane, range))
+                entry->contentValid = false;
+        }
+
+        if (entry->contentValid)
+        {
+            for (const box3& bounds : movingCasterBounds)
+            {
+                if (SphereIntersectsBox(position, range, bounds))
+                {
+                    entry->contentValid = false;
+                    break;
+                }
+            }
+        }
+
+        light.shadowMap = entry->shadowMap;
+    }
+}
+
+void ShadowAtlas::ClearTile(nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* framebuffer, const IView& view)
+{
+    // There is no way to clear a part of a texture slice, so draw a quad at the far plane instead
+    if (!m_ClearPso)
+    {
+        nvrhi::GraphicsPipelineDesc pipelineDesc;
+        pipelineDesc.primType = nvrhi::PrimitiveType::TriangleStrip;
+        pipelineDesc.VS = m_CommonPasses->m_FullscreenAtOneVS;
+        pipelineDesc.renderState.rasterState.setCullNone();
+        pipelineDesc.renderState.depthStencilState
+            .setDepthTestEnable(true)
+            .setDepthWriteEnable(true)
+            .setDepthFunc(nvrhi::ComparisonFunc::Always);
+
+        m_ClearPso = m_Device->createGraphicsPipeline(pipelineDesc, framebuffer);
+    }
+
+    nvrhi::GraphicsState state;
+    state.pipeline = m_ClearPso;
+    state.framebuffer = framebuffer;
+    state.viewport = view.GetViewportState();
+    commandList->setGraphicsState(state);
+
+    nvrhi::DrawArguments args;
+    args.vertexCount = 4;
+    commandList->draw(args);
+}
+
+void ShadowAtlas::RenderShadows(
+    nvrhi::ICommandList* commandList,
+    const std::shared_ptr<SceneGraphNode>& rootNode,
+    IDrawStrategy& drawStrategy,
+    IGeometryPass& depthPass,
+    GeometryPassContext& passContext)
+{
+    DONUT_PROFILE_GPU_SCOPE(commandList, "ShadowAtlas");
+
+    m_NumTilesRendered = 0;
+
+    commandList->beginMarker("ShadowAtlas");
+
+    for (auto& [key, entry] : m_Lights)
+    {
+        if (entry.contentValid || entry.tiles.empty())
+            continue;
+
+        for (uint32_t face = 0; face < entry.shadowMap->m_NumFaces; face++)
+        {
+            const PlanarView& view = *entry.shadowMap->m_Faces[face]->GetPlanarView();
+            nvrhi::IFramebuffer* framebuffer = m_FramebufferFactory->GetFramebuffer(view);
+
+            ClearTile(commandList, framebuffer, view);
+
+            drawStrategy.PrepareForView(rootNode, view);
+            RenderView(commandList, &view, nullptr, framebuffer, drawStrategy, depthPass, passContext);
+
+            ++m_NumTilesRendered;
+        }
+
+        entry.contentValid = true;
+    }
+
+    commandList->endMarker();
+}
+
+void ShadowAtlas::InvalidateAll()
+{
+    for (auto& [key, entry] : m_Lights)
+        entry.contentValid = false;
+}
+
+uint32_t ShadowAtlas::GetNumShadowedLights() const
+{
+    uint32_t count = 0;
+    for (const auto& [key, entry] : m_Lights)
+    {
+        if (!entry.tiles.empty())
+            ++count;
+    }
+
+    return count;
+}
@@ -21,6 +21,7 @@
 */
 
 #include <donut/render/SkyPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/render/DrawStrategy.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/engine/ShaderFactory.h>
@@ -106,6 +107,8 @@ void SkyPass::Render(
     const DirectionalLight& light,
     const SkyParameters& params) const
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "Sky");
+
     commandList->beginMarker("Sky");
 
     for (uint viewIndex = 0; viewIndex < compositeView.GetNumChildViews(ViewType::PLANAR); viewIndex++)
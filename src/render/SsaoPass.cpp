@@ -21,12 +21,14 @@
 */
 
 #include <donut/render/SsaoPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/render/DrawStrategy.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/ShadowMap.h>
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/View.h>
+#include <donut/engine/AsyncComputeScheduler.h>
 #include <nvrhi/utils.h>
 
 #if DONUT_WITH_STATIC_SHADERS
@@ -163,6 +165,8 @@ SsaoPass::SsaoPass(
 
         m_Blur.BindingSets.resize(params.numBindingSets);
     }
+
+    m_BindingSetTextures.resize(params.numBindingSets);
 }
 
 // Backwards compatibility constructor
@@ -216,6 +220,8 @@ void SsaoPass::CreateBindingSet(
         nvrhi::BindingSetItem::Sampler(0, m_CommonPasses->m_PointClampSampler)
     };
     m_Blur.BindingSets[bindingSetIndex] = m_Device->createBindingSet(BlurBindings, m_Blur.BindingLayout);
+
+    m_BindingSetTextures[bindingSetIndex] = { gbufferDepth, gbufferNormals, destinationTexture };
 }
 
 void SsaoPass::Render(
@@ -224,6 +230,8 @@ void SsaoPass::Render(
     const ICompositeView& compositeView,
     int bindingSetIndex)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "SSAO");
+
     assert(m_Deinterleave.BindingSets[bindingSetIndex]);
     assert(m_Compute.BindingSets[bindingSetIndex]);
     assert(m_Blur.BindingSets[bindingSetIndex]);
@@ -283,4 +291,27 @@ void SsaoPass::Render(
     }
 
     commandList->endMarker();
-}
\ No newline at end of file
+}
+
+AsyncComputeJob SsaoPass::ScheduleRender(
+    AsyncComputeScheduler& scheduler,
+    nvrhi::ICommandList* commandList,
+    const SsaoParameters& params,
+    const ICompositeView& compositeView,
+    int bindingSetIndex)
+{
+    const BindingSetTextures& textures = m_BindingSetTextures[bindingSetIndex];
+    assert(textures.gbufferDepth && textures.gbufferNormals && textures.destinationTexture);
+
+    return scheduler.ScheduleCompute(commandList,
+        [this, &params, &compositeView, bindingSetIndex](nvrhi::ICommandList* computeCommandList)
+        {
+            Render(computeCommandList, params, compositeView, bindingSetIndex);
+        },
+        nullptr,
+        {
+            { textures.gbufferDepth, nvrhi::ResourceStates::ShaderResource },
+            { textures.gbufferNormals, nvrhi::ResourceStates::ShaderResource },
+            { textures.destinationTexture, nvrhi::ResourceStates::UnorderedAccess }
+        });
+}
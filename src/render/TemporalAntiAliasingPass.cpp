@@ -21,6 +21,7 @@
 */
 
 #include <donut/render/TemporalAntiAliasingPass.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/FramebufferFactory.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
@@ -206,6 +207,8 @@ void TemporalAntiAliasingPass::RenderMotionVectors(
     const ICompositeView& compositeViewPrevious,
     dm::float3 preViewTranslationDifference)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "MotionVectors");
+
     assert(compositeView.GetNumChildViews(ViewType::PLANAR) == compositeViewPrevious.GetNumChildViews(ViewType::PLANAR));
     assert(m_MotionVectorsPso);
 
@@ -254,6 +257,8 @@ void TemporalAntiAliasingPass::TemporalResolve(
     const ICompositeView& compositeViewInput,
     const ICompositeView& compositeViewOutput)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "TemporalAA");
+
     assert(compositeViewInput.GetNumChildViews(ViewType::PLANAR) == compositeViewOutput.GetNumChildViews(ViewType::PLANAR));
     
     commandList->beginMarker("TemporalAA");
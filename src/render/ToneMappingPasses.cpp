@@ -21,9 +21,11 @@
 */
 
 #include <donut/render/ToneMappingPasses.h>
+#include <donut/engine/Profiler.h>
 #include <donut/engine/ShaderFactory.h>
 #include <donut/engine/CommonRenderPasses.h>
 #include <donut/engine/View.h>
+#include <donut/engine/AsyncComputeScheduler.h>
 #include <sstream>
 #include <assert.h>
 #include <donut/engine/FramebufferFactory.h>
@@ -203,6 +205,8 @@ void ToneMappingPass::Render(
     const ICompositeView& compositeView,
     nvrhi::ITexture* sourceTexture)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "ToneMapping");
+
     nvrhi::BindingSetHandle& bindingSet = m_RenderBindingSets[sourceTexture];
     if (!bindingSet)
     {
@@ -288,6 +292,8 @@ static const float g_maxLogLuminamce = 4;
 
 void ToneMappingPass::AddFrameToHistogram(nvrhi::ICommandList* commandList, const ICompositeView& compositeView, nvrhi::ITexture* sourceTexture)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "ToneMapping Histogram");
+
     nvrhi::BindingSetHandle& bindingSet = m_HistogramBindingSets[sourceTexture];
     if (!bindingSet)
     {
@@ -333,6 +339,8 @@ void ToneMappingPass::AddFrameToHistogram(nvrhi::ICommandList* commandList, cons
 
 void ToneMappingPass::ComputeExposure(nvrhi::ICommandList* commandList, const ToneMappingParameters& params)
 {
+    DONUT_PROFILE_GPU_SCOPE(commandList, "ToneMapping Exposure");
+
     ToneMappingConstants toneMappingConstants = {};
     toneMappingConstants.logLuminanceScale = g_maxLogLuminamce - g_minLogLuminance;
     toneMappingConstants.logLuminanceBias = g_minLogLuminance;
@@ -353,3 +361,22 @@ void ToneMappingPass::ComputeExposure(nvrhi::ICommandList* commandList, const To
 
     commandList->dispatch(1);
 }
+
+AsyncComputeJob ToneMappingPass::ScheduleExposureUpdate(
+    AsyncComputeScheduler& scheduler,
+    nvrhi::ICommandList* commandList,
+    const ToneMappingParameters& params,
+    const ICompositeView& compositeView,
+    nvrhi::ITexture* sourceTexture)
+{
+    return scheduler.ScheduleCompute(commandList,
+        [this, &params, &compositeView, sourceTexture](nvrhi::ICommandList* computeCommandList)
+        {
+            ResetHistogram(computeCommandList);
+            AddFrameToHistogram(computeCommandList, compositeView, sourceTexture);
+            ComputeExposure(computeCommandList, params);
+        },
+        "ToneMapping Exposure",
+        { { sourceTexture, nvrhi::ResourceStates::ShaderResource } },
+        { { m_ExposureBuffer, nvrhi::ResourceStates::UnorderedAccess } });
+}
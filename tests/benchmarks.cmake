@@ -0,0 +1,43 @@
+#
+# Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+
+# donut_benchmarks measures the CPU cost of core, engine and render code paths and
+# writes the results as JSON with --json <file>, see benchmarks/Benchmark.cpp
+
+file(GLOB donut_benchmarks_src benchmarks/*.cpp benchmarks/*.h)
+
+add_executable(donut_benchmarks ${donut_benchmarks_src})
+# the geometry pass benchmarks render through the null device from the tests
+target_link_libraries(donut_benchmarks donut_render donut_engine donut_core donut_tests_null_device)
+
+if (DONUT_WITH_MINIZ)
+    # the zip benchmarks create their archive with miniz
+    target_link_libraries(donut_benchmarks miniz)
+endif()
+
+set_property(TARGET donut_benchmarks PROPERTY FOLDER "Donut/donut_tests")
+
+if (DONUT_WITH_UNIT_TESTS)
+    # make sure that the benchmarks keep running, without measuring anything
+    add_dependencies(donut_all_tests donut_benchmarks)
+    add_test(donut_benchmarks donut_benchmarks --quick)
+endif()
@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/core/json.h>
+#include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace donut;
+using namespace donut::benchmarks;
+
+BenchmarkRunner::BenchmarkRunner(BenchmarkOptions options)
+    : m_Options(std::move(options))
+{
+    m_Options.numSamples = std::max(m_Options.numSamples, 1u);
+}
+
+bool BenchmarkRunner::IsEnabled(const std::string& name) const
+{
+    return m_Options.filter.empty() || name.find(m_Options.filter) != std::string::npos;
+}
+
+void BenchmarkRunner::Run(const std::string& name, const std::function<void()>& function, uint64_t itemsPerCall)
+{
+    if (!IsEnabled(name))
+        return;
+
+    using clock = std::chrono::high_resolution_clock;
+
+    auto measure = [&function](uint64_t calls)
+    {
+        const auto start = clock::now();
+        for (uint64_t call = 0; call < calls; call++)
+            function();
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    // Calibrate: the first call also warms up the caches and any lazily created state
+    uint64_t calls = 1;
+    double elapsedMs = measure(calls);
+    while (elapsedMs < m_Options.minSampleTimeMs && calls < (1ull << 40))
+    {
+        const double scale = elapsedMs > 0.0 ? m_Options.minSampleTimeMs / elapsedMs : 10.0;
+        calls = std::max(calls + 1, uint64_t(double(calls) * std::min(scale * 1.2, 10.0)));
+        elapsedMs = measure(calls);
+    }
+
+    std::vector<double> sampleTimes;
+    sampleTimes.reserve(m_Options.numSamples);
+    const double itemsPerSample = double(calls) * double(std::max<uint64_t>(itemsPerCall, 1));
+    for (uint32_t sample = 0; sample < m_Options.numSamples; sample++)
+        sampleTimes.push_back(measure(calls) * 1e6 / itemsPerSample);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.itemsPerCall = std::max<uint64_t>(itemsPerCall, 1);
+    result.callsPerSample = calls;
+    result.timeNs = engine::BenchmarkResults::ComputePercentiles(std::move(sampleTimes));
+    m_Results.push_back(result);
+
+    printf("%-48s %12.2f ns %12.2f ns %12.2f ns\n", name.c_str(),
+        result.timeNs.p50, result.timeNs.min, result.timeNs.max);
+    fflush(stdout);
+}
+
+void BenchmarkRunner::AddCounter(const std::string& name, const std::string& counterName, double value)
+{
+    auto it = std::find_if(m_Results.rbegin(), m_Results.rend(),
+        [&name](const BenchmarkResult& result) { return result.name == name; });
+    if (it == m_Results.rend())
+        return;
+
+    it->counters.push_back({ counterName, value });
+
+    printf("    %-44s %12.2f\n", counterName.c_str(), value);
+    fflush(stdout);
+}
+
+void BenchmarkRunner::PrintSummary() const
+{
+    printf("%zu benchmarks, %u samples each\n", m_Results.size(), m_Options.numSamples);
+}
+
+bool BenchmarkRunner::WriteJson(const std::filesystem::path& fileName) const
+{
+    Json::Value root;
+#ifdef NDEBUG
+    root["build"] = "release";
+#else
+    root["build"] = "debug";
+#endif
+    root["samples"] = m_Options.numSamples;
+    root["minSampleTimeMs"] = m_Options.minSampleTimeMs;
+
+    Json::Value& benchmarksNode = root["benchmarks"];
+    benchmarksNode = Json::Value(Json::arrayValue);
+    for (const BenchmarkResult& result : m_Results)
+    {
+        Json::Value node;
+        node["name"] = result.name;
+        node["itemsPerCall"] = Json::UInt64(result.itemsPerCall);
+        node["callsPerSample"] = Json::UInt64(result.callsPerSample);
+
+        Json::Value& timeNode = node["timeNs"];
+        timeNode["avg"] = result.timeNs.avg;
+        timeNode["min"] = result.timeNs.min;
+        timeNode["max"] = result.timeNs.max;
+        timeNode["p50"] = result.timeNs.p50;
+        timeNode["p95"] = result.timeNs.p95;
+        timeNode["p99"] = result.timeNs.p99;
+
+        if (!result.counters.empty())
+        {
+            Json::Value& countersNode = node["counters"];
+            for (const BenchmarkCounter& counter : result.counters)
+                countersNode[counter.name] = counter.value;
+        }
+
+        benchmarksNode.append(node);
+    }
+
+    vfs::NativeFileSystem fs;
+    return json::SaveToFile(fs, fileName, root);
+}
+
+static void PrintUsage()
+{
+    printf(
+        "Usage: donut_benchmarks [options]\n"
+        "  --filter <text>     Run only the benchmarks whose name contains <text>\n"
+        "  --json <file>       Write the results to <file> as JSON\n"
+        "  --samples <n>       Number of samples per benchmark (default 15)\n"
+        "  --min-time <ms>     Minimum duration of a sample in milliseconds (default 10)\n"
+        "  --quick             One short sample per benchmark, to check that they run\n");
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    std::filesystem::path jsonFileName;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--filter") && value)
+            options.filter = argv[++i];
+        else if (!strcmp(arg, "--json") && value)
+            jsonFileName = argv[++i];
+        else if (!strcmp(arg, "--samples") && value)
+            options.numSamples = uint32_t(std::max(atoi(argv[++i]), 1));
+        else if (!strcmp(arg, "--min-time") && value)
+            options.minSampleTimeMs = atof(argv[++i]);
+        else if (!strcmp(arg, "--quick"))
+        {
+            options.numSamples = 1;
+            options.minSampleTimeMs = 0.0;
+        }
+        else
+        {
+            PrintUsage();
+            return strcmp(arg, "--help") ? 1 : 0;
+        }
+    }
+
+    BenchmarkRunner runner(options);
+
+    printf("%-48s %15s %15s %15s\n", "benchmark (time per item)", "median", "min", "max");
+
+    benchmark_math(runner);
+    benchmark_animation(runner);
+    benchmark_vfs(runner);
+    benchmark_chunk(runner);
+    benchmark_scene_graph(runner);
+    benchmark_draw_strategy(runner);
+    benchmark_geometry_passes(runner);
+
+    runner.PrintSummary();
+
+    if (!jsonFileName.empty() && !runner.WriteJson(jsonFileName))
+        return 1;
+
+    return 0;
+}
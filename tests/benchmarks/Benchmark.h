@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <donut/engine/BenchmarkResults.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace donut::benchmarks
+{
+    struct BenchmarkOptions
+    {
+        // Only benchmarks whose name contains this string are run, e.g. "vfs/" or "math/frustum"
+        std::string filter;
+        uint32_t numSamples = 15;
+        // Each sample repeats the function until at least this much time has passed
+        double minSampleTimeMs = 10.0;
+    };
+
+    struct BenchmarkCounter
+    {
+        std::string name;
+        double value = 0.0;
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        uint64_t itemsPerCall = 1;
+        uint64_t callsPerSample = 0;
+        // Time per item in nanoseconds, i.e. the sample time divided by callsPerSample * itemsPerCall
+        engine::BenchmarkPercentiles timeNs;
+        // Values measured by the benchmark itself, e.g. draws per frame, see BenchmarkRunner::AddCounter
+        std::vector<BenchmarkCounter> counters;
+    };
+
+    /*
+    BenchmarkRunner measures small functions with a wall clock. The number of calls per sample is
+    calibrated first so that a sample takes at least minSampleTimeMs, then numSamples samples are taken
+    and their per-item times are reduced to percentiles. Functions that process a batch of items per
+    call, e.g. a loop over 1000 transforms, pass the batch size as itemsPerCall to amortize the call.
+    */
+    class BenchmarkRunner
+    {
+    private:
+        BenchmarkOptions m_Options;
+        std::vector<BenchmarkResult> m_Results;
+
+    public:
+        explicit BenchmarkRunner(BenchmarkOptions options);
+
+        [[nodiscard]] bool IsEnabled(const std::string& name) const;
+
+        void Run(const std::string& name, const std::function<void()>& function, uint64_t itemsPerCall = 1);
+
+        // Attaches a value to the result of the benchmark 'name' that has already been run.
+        // Does nothing if that benchmark was skipped by the filter.
+        void AddCounter(const std::string& name, const std::string& counterName, double value);
+
+        [[nodiscard]] const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+        void PrintSummary() const;
+        bool WriteJson(const std::filesystem::path& fileName) const;
+    };
+
+    // Keeps the compiler from optimizing away the computation of 'value' in a benchmark loop
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#ifdef _MSC_VER
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    void benchmark_math(BenchmarkRunner& runner);
+    void benchmark_vfs(BenchmarkRunner& runner);
+    void benchmark_chunk(BenchmarkRunner& runner);
+    void benchmark_scene_graph(BenchmarkRunner& runner);
+    void benchmark_animation(BenchmarkRunner& runner);
+    void benchmark_draw_strategy(BenchmarkRunner& runner);
+    void benchmark_geometry_passes(BenchmarkRunner& runner);
+}
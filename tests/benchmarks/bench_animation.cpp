@@ -0,0 +1,80 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/engine/KeyframeAnimation.h>
+
+#include <random>
+
+using namespace donut::math;
+using namespace donut::engine::animation;
+using namespace donut::benchmarks;
+
+static const size_t c_NumKeyframes = 256;
+static const size_t c_BatchSize = 1024;
+
+void donut::benchmarks::benchmark_animation(BenchmarkRunner& runner)
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+
+    std::vector<Keyframe> keyframes(c_NumKeyframes);
+    for (size_t i = 0; i < c_NumKeyframes; i++)
+    {
+        Keyframe& keyframe = keyframes[i];
+        keyframe.time = float(i) * 0.1f;
+        keyframe.value = normalize(float4(value(rng), value(rng), value(rng), value(rng)));
+        keyframe.inTangent = float4(value(rng), value(rng), value(rng), value(rng));
+        keyframe.outTangent = float4(value(rng), value(rng), value(rng), value(rng));
+    }
+
+    // Random times make the keyframe lookup unpredictable, like many independent animated nodes do
+    const float duration = keyframes.back().time;
+    std::uniform_real_distribution<float> time(0.f, duration);
+    std::vector<float> times(c_BatchSize);
+    for (float& t : times)
+        t = time(rng);
+
+    const std::pair<const char*, InterpolationMode> modes[] = {
+        { "step", InterpolationMode::Step },
+        { "linear", InterpolationMode::Linear },
+        { "slerp", InterpolationMode::Slerp },
+        { "catmull_rom", InterpolationMode::CatmullRomSpline },
+        { "hermite", InterpolationMode::HermiteSpline },
+    };
+
+    for (const auto& [modeName, mode] : modes)
+    {
+        Sampler sampler;
+        sampler.SetInterpolationMode(mode);
+        for (const Keyframe& keyframe : keyframes)
+            sampler.AddKeyframe(keyframe);
+
+        runner.Run(std::string("animation/sampler_evaluate_") + modeName, [&]()
+        {
+            float4 sum = 0.f;
+            for (float t : times)
+                sum += sampler.Evaluate(t, true).value_or(float4(0.f));
+            DoNotOptimize(sum);
+        }, c_BatchSize);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/core/chunk/chunk.h>
+#include <donut/core/log.h>
+
+#include <random>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::benchmarks;
+
+static const uint32_t c_NumMeshes = 64;
+static const uint32_t c_VerticesPerMesh = 4096;
+static const uint32_t c_IndicesPerMesh = 3 * 8192;
+static const uint32_t c_NumInstances = 1024;
+
+void donut::benchmarks::benchmark_chunk(BenchmarkRunner& runner)
+{
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> coordinate(-1.f, 1.f);
+    std::uniform_int_distribution<uint32_t> vertex(0, c_VerticesPerMesh - 1);
+    std::uniform_int_distribution<uint32_t> packed;
+
+    const uint32_t numVertices = c_NumMeshes * c_VerticesPerMesh;
+    const uint32_t numIndices = c_NumMeshes * c_IndicesPerMesh;
+
+    std::vector<float3> positions(numVertices);
+    std::vector<float2> texcoords(numVertices);
+    std::vector<uint32_t> normals(numVertices);
+    std::vector<uint32_t> tangents(numVertices);
+    for (uint32_t i = 0; i < numVertices; i++)
+    {
+        positions[i] = float3(coordinate(rng), coordinate(rng), coordinate(rng));
+        texcoords[i] = float2(coordinate(rng), coordinate(rng));
+        normals[i] = packed(rng);
+        tangents[i] = packed(rng);
+    }
+
+    std::vector<uint32_t> indices(numIndices);
+    for (uint32_t& index : indices)
+        index = vertex(rng);
+
+    std::vector<std::string> meshNames(c_NumMeshes);
+    std::vector<chunk::MeshInfo> meshInfos(c_NumMeshes);
+    for (uint32_t i = 0; i < c_NumMeshes; i++)
+    {
+        meshNames[i] = "mesh_" + std::to_string(i);
+
+        chunk::MeshInfo& info = meshInfos[i];
+        info.name = meshNames[i].c_str();
+        info.materialName = "material";
+        info.materialId = 0;
+        info.bbox = box3(float3(-1.f), float3(1.f));
+        info.firstVertex = i * c_VerticesPerMesh;
+        info.numVertices = c_VerticesPerMesh;
+        info.firstIndex = i * c_IndicesPerMesh;
+        info.numIndices = c_IndicesPerMesh;
+    }
+
+    std::vector<chunk::MeshInstance> instances(c_NumInstances);
+    for (uint32_t i = 0; i < c_NumInstances; i++)
+    {
+        chunk::MeshInstance& instance = instances[i];
+        instance.name = meshNames[i % c_NumMeshes].c_str();
+        instance.minfoId = i % c_NumMeshes;
+        instance.nodeId = 0;
+        instance.transform = translation(float3(float(i % 32), float(i / 32), 0.f));
+        instance.bbox = box3(float3(-1.f), float3(1.f)) * instance.transform;
+        instance.center = instance.bbox.center();
+    }
+
+    chunk::MeshNode root{};
+    root.name = "root";
+    root.parentId = root.siblingId = root.instanceId = ~0u;
+    root.transform = root.ctm = affine3::identity();
+    root.bbox = box3(float3(-1.f), float3(33.f));
+    root.center = root.bbox.center();
+
+    chunk::MeshSet meshSet;
+    meshSet.type = chunk::MeshSetBase::MESH;
+    meshSet.name = "benchmark";
+    meshSet.streams.position = positions.data();
+    meshSet.streams.texcoord0 = texcoords.data();
+    meshSet.streams.normal = normals.data();
+    meshSet.streams.tangent = tangents.data();
+    meshSet.nverts = numVertices;
+    meshSet.indices = indices.data();
+    meshSet.nindices = numIndices;
+    meshSet.meshInfos = meshInfos.data();
+    meshSet.nmeshInfos = c_NumMeshes;
+    meshSet.instances = instances.data();
+    meshSet.ninstances = c_NumInstances;
+    meshSet.nodes = &root;
+    meshSet.nnodes = 1;
+    meshSet.rootId = 0;
+    meshSet.bbox = root.bbox;
+
+    std::shared_ptr<vfs::IBlob const> blob = chunk::serialize(meshSet);
+    if (!blob || !chunk::deserialize(blob, "benchmark"))
+    {
+        log::warning("Skipping the chunk benchmarks: the test mesh set does not serialize");
+        return;
+    }
+
+    // Deserialization only validates the chunks and points into the blob, so it is not proportional to the data size
+    runner.Run("chunk/meshset_serialize_256k_verts", [&]()
+    {
+        DoNotOptimize(chunk::serialize(meshSet));
+    });
+
+    runner.Run("chunk/meshset_deserialize_256k_verts", [&]()
+    {
+        DoNotOptimize(chunk::deserialize(blob, "benchmark"));
+    });
+}
@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGenerator.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/render/DepthPass.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/render/ForwardShadingPass.h>
+#include <donut/tests/NullDevice.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::benchmarks;
+
+static nvrhi::TextureHandle CreateRenderTarget(nvrhi::IDevice* device, nvrhi::Format format)
+{
+    nvrhi::TextureDesc desc;
+    desc.width = 1920;
+    desc.height = 1080;
+    desc.format = format;
+    desc.isRenderTarget = true;
+    return device->createTexture(desc);
+}
+
+// Reports what the last frame recorded into the command list, plus the draw rate at the median frame time
+static void AddFrameCounters(BenchmarkRunner& runner, const std::string& name, nvrhi::ICommandList* commandList)
+{
+    const std::vector<BenchmarkResult>& results = runner.GetResults();
+    if (results.empty() || results.back().name != name)
+        return;
+
+    const tests::NullCommandListStats& stats = static_cast<tests::NullCommandList*>(commandList)->GetStats();
+    const double frameTimeNs = results.back().timeNs.p50;
+
+    runner.AddCounter(name, "draws/frame", double(stats.draws));
+    runner.AddCounter(name, "draws/s", frameTimeNs > 0.0 ? double(stats.draws) * 1e9 / frameTimeNs : 0.0);
+    runner.AddCounter(name, "writeBufferBytes/frame", double(stats.writeBufferBytes));
+    runner.AddCounter(name, "stateChanges/frame", double(stats.graphicsStateChanges));
+}
+
+void donut::benchmarks::benchmark_geometry_passes(BenchmarkRunner& runner)
+{
+    const std::string depthName = "render/depth_pass_generated_2k_nodes";
+    const std::string forwardName = "render/forward_pass_generated_2k_nodes";
+    if (!runner.IsEnabled(depthName) && !runner.IsEnabled(forwardName))
+        return;
+
+    // The null device does no GPU work, so the time is the CPU cost of culling, sorting and recording
+    auto device = tests::CreateNullDevice();
+    auto shaderFactory = std::make_shared<ShaderFactory>(device, nullptr, "");
+    auto commonPasses = std::make_shared<CommonRenderPasses>(device, shaderFactory);
+
+    SceneGeneratorParameters params;
+    params.nodeCount = 2000;
+    params.materialCount = 32;
+    params.alphaTestedMaterialRatio = 0.25f;
+    params.lightCount = 8;
+    params.animatedNodeRatio = 0.f;
+
+    SceneGenerator generator(nullptr);
+    Scene scene(device, *shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    scene.SetSceneGraph(generator.Generate(params));
+    scene.FinishedLoading(0);
+    const std::shared_ptr<SceneGraph> sceneGraph = scene.GetSceneGraph();
+
+    FramebufferFactory depthFramebuffer(device);
+    depthFramebuffer.DepthTarget = CreateRenderTarget(device, nvrhi::Format::D32);
+
+    FramebufferFactory forwardFramebuffer(device);
+    forwardFramebuffer.RenderTargets = { CreateRenderTarget(device, nvrhi::Format::RGBA16_FLOAT) };
+    forwardFramebuffer.DepthTarget = depthFramebuffer.DepthTarget;
+
+    // A camera in front of the generated cube that looks along +Z sees most of it
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(1920.f, 1080.f));
+    view.SetMatrices(translation(float3(0.f, 0.f, params.sceneExtent * 0.75f)),
+        perspProjD3DStyleReverse(radians(60.f), 16.f / 9.f, 0.1f));
+    view.UpdateCache();
+
+    InstancedOpaqueDrawStrategy drawStrategy;
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+
+    DepthPass depthPass(device, commonPasses);
+    depthPass.Init(*shaderFactory, DepthPass::CreateParameters());
+    DepthPass::Context depthContext;
+
+    runner.Run(depthName, [&]()
+    {
+        commandList->open();
+        RenderCompositeView(commandList, &view, &view, depthFramebuffer, sceneGraph->GetRootNode(),
+            drawStrategy, depthPass, depthContext);
+        commandList->close();
+        device->executeCommandList(commandList);
+    });
+    AddFrameCounters(runner, depthName, commandList);
+
+    ForwardShadingPass forwardPass(device, commonPasses);
+    forwardPass.Init(*shaderFactory, ForwardShadingPass::CreateParameters());
+    ForwardShadingPass::Context forwardContext;
+
+    runner.Run(forwardName, [&]()
+    {
+        commandList->open();
+        forwardPass.PrepareLights(forwardContext, commandList, sceneGraph->GetLights(), 0.1f, 0.05f, {});
+        RenderCompositeView(commandList, &view, &view, forwardFramebuffer, sceneGraph->GetRootNode(),
+            drawStrategy, forwardPass, forwardContext);
+        commandList->close();
+        device->executeCommandList(commandList);
+    });
+    AddFrameCounters(runner, forwardName, commandList);
+}
@@ -0,0 +1,105 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/core/math/math.h>
+
+#include <random>
+
+using namespace donut::math;
+using namespace donut::benchmarks;
+
+static const size_t c_BatchSize = 1024;
+
+static affine3 RandomTransform(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> angle(-PI_f, PI_f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.f);
+    std::uniform_real_distribution<float> position(-100.f, 100.f);
+
+    return scaling(float3(scale(rng), scale(rng), scale(rng)))
+        * rotation(float3(angle(rng), angle(rng), angle(rng)))
+        * translation(float3(position(rng), position(rng), position(rng)));
+}
+
+void donut::benchmarks::benchmark_math(BenchmarkRunner& runner)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-100.f, 100.f);
+    std::uniform_real_distribution<float> extent(0.1f, 10.f);
+
+    std::vector<affine3> transformsA(c_BatchSize);
+    std::vector<affine3> transformsB(c_BatchSize);
+    std::vector<affine3> transformsOut(c_BatchSize);
+    std::vector<box3> boxes(c_BatchSize);
+    std::vector<box3> boxesOut(c_BatchSize);
+
+    for (size_t i = 0; i < c_BatchSize; i++)
+    {
+        transformsA[i] = RandomTransform(rng);
+        transformsB[i] = RandomTransform(rng);
+
+        const float3 center(position(rng), position(rng), position(rng));
+        const float3 halfSize(extent(rng), extent(rng), extent(rng));
+        boxes[i] = box3(center - halfSize, center + halfSize);
+    }
+
+    // A camera at the origin looking along +Z, so that only a part of the boxes is visible
+    const frustum viewFrustum(perspProjD3DStyleReverse(radians(60.f), 16.f / 9.f, 0.1f), true);
+
+    runner.Run("math/affine3_multiply", [&]()
+    {
+        for (size_t i = 0; i < c_BatchSize; i++)
+            transformsOut[i] = transformsA[i] * transformsB[i];
+        DoNotOptimize(transformsOut.data());
+    }, c_BatchSize);
+
+    runner.Run("math/affine3_inverse", [&]()
+    {
+        for (size_t i = 0; i < c_BatchSize; i++)
+            transformsOut[i] = inverse(transformsA[i]);
+        DoNotOptimize(transformsOut.data());
+    }, c_BatchSize);
+
+    runner.Run("math/box3_transform", [&]()
+    {
+        for (size_t i = 0; i < c_BatchSize; i++)
+            boxesOut[i] = boxes[i] * transformsA[i];
+        DoNotOptimize(boxesOut.data());
+    }, c_BatchSize);
+
+    runner.Run("math/frustum_intersects_box", [&]()
+    {
+        uint32_t visible = 0;
+        for (size_t i = 0; i < c_BatchSize; i++)
+            visible += viewFrustum.intersectsWith(boxes[i]) ? 1 : 0;
+        DoNotOptimize(visible);
+    }, c_BatchSize);
+
+    runner.Run("math/frustum_intersects_point", [&]()
+    {
+        uint32_t visible = 0;
+        for (size_t i = 0; i < c_BatchSize; i++)
+            visible += viewFrustum.intersectsWith(boxes[i].center()) ? 1 : 0;
+        DoNotOptimize(visible);
+    }, c_BatchSize);
+}
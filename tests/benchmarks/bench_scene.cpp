@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/SceneTypes.h>
+#include <donut/engine/View.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/render/GeometryPasses.h>
+
+#include <random>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::benchmarks;
+
+static const int c_FanOut = 16;
+static const int c_NumMeshes = 32;
+static const int c_NumInstances = c_FanOut * c_FanOut * c_FanOut;
+
+static std::vector<std::shared_ptr<MeshInfo>> CreateMeshes()
+{
+    auto opaqueMaterial = std::make_shared<Material>();
+    opaqueMaterial->name = "Opaque";
+
+    auto blendedMaterial = std::make_shared<Material>();
+    blendedMaterial->name = "AlphaBlended";
+    blendedMaterial->domain = MaterialDomain::AlphaBlended;
+
+    // The meshes have no vertex data, culling only looks at the bounds
+    std::vector<std::shared_ptr<MeshInfo>> meshes;
+    for (int i = 0; i < c_NumMeshes; i++)
+    {
+        auto mesh = std::make_shared<MeshInfo>();
+        mesh->name = "Mesh" + std::to_string(i);
+        mesh->buffers = std::make_shared<BufferGroup>();
+        mesh->objectSpaceBounds = box3(float3(-0.5f), float3(0.5f));
+
+        // Every fourth mesh has a transparent part, like a window or foliage
+        const int numGeometries = (i % 4 == 0) ? 2 : 1;
+        for (int g = 0; g < numGeometries; g++)
+        {
+            auto geometry = std::make_shared<MeshGeometry>();
+            geometry->material = (g == 0) ? opaqueMaterial : blendedMaterial;
+            geometry->numIndices = 3;
+            geometry->numVertices = 3;
+            geometry->objectSpaceBounds = mesh->objectSpaceBounds;
+            mesh->geometries.push_back(geometry);
+        }
+
+        meshes.push_back(mesh);
+    }
+
+    return meshes;
+}
+
+// Three levels of c_FanOut nodes with a mesh instance in each leaf, spread in a cube around the origin
+static std::shared_ptr<SceneGraph> CreateSceneGraph(const std::vector<std::shared_ptr<MeshInfo>>& meshes)
+{
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> offset(-4.0, 4.0);
+
+    int meshIndex = 0;
+    for (int i = 0; i < c_FanOut; i++)
+    {
+        auto group = std::make_shared<SceneGraphNode>();
+        sceneGraph->Attach(root, group);
+        group->SetTranslation(double3(double(i % 4) * 50.0 - 75.0, double(i / 4) * 50.0 - 75.0, 0.0));
+
+        for (int j = 0; j < c_FanOut; j++)
+        {
+            auto subgroup = std::make_shared<SceneGraphNode>();
+            sceneGraph->Attach(group, subgroup);
+            subgroup->SetTranslation(double3(0.0, 0.0, double(j) * 12.5 - 100.0));
+
+            for (int k = 0; k < c_FanOut; k++)
+            {
+                auto instance = std::make_shared<MeshInstance>(meshes[meshIndex]);
+                meshIndex = (meshIndex + 1) % int(meshes.size());
+
+                auto node = sceneGraph->AttachLeafNode(subgroup, instance);
+                node->SetTranslation(double3(offset(rng), offset(rng), offset(rng)));
+            }
+        }
+    }
+
+    return sceneGraph;
+}
+
+void donut::benchmarks::benchmark_scene_graph(BenchmarkRunner& runner)
+{
+    const auto meshes = CreateMeshes();
+
+    runner.Run("scene/build_4k_instances", [&]()
+    {
+        auto sceneGraph = CreateSceneGraph(meshes);
+        sceneGraph->Refresh(0);
+        DoNotOptimize(sceneGraph->GetRootNode()->GetGlobalBoundingBox());
+    });
+
+    auto sceneGraph = CreateSceneGraph(meshes);
+    uint32_t frameIndex = 0;
+    sceneGraph->Refresh(frameIndex++);
+
+    // Items are the mesh instances in the graph
+    runner.Run("scene/refresh_static_4k_instances", [&]()
+    {
+        sceneGraph->Refresh(frameIndex++);
+    }, c_NumInstances);
+
+    std::vector<SceneGraphNode*> animatedNodes;
+    for (size_t i = 0; i < sceneGraph->GetMeshInstances().size(); i += 10)
+        animatedNodes.push_back(sceneGraph->GetMeshInstances()[i]->GetNode());
+
+    runner.Run("scene/refresh_10pct_moving_4k_instances", [&]()
+    {
+        const double offset = double(frameIndex % 2) * 0.1;
+        for (SceneGraphNode* node : animatedNodes)
+            node->SetTranslation(double3(offset, 0.0, 0.0));
+        sceneGraph->Refresh(frameIndex++);
+    }, c_NumInstances);
+
+    runner.Run("scene/refresh_root_moving_4k_instances", [&]()
+    {
+        sceneGraph->GetRootNode()->SetTranslation(double3(double(frameIndex % 2), 0.0, 0.0));
+        sceneGraph->Refresh(frameIndex++);
+    }, c_NumInstances);
+}
+
+void donut::benchmarks::benchmark_draw_strategy(BenchmarkRunner& runner)
+{
+    const auto meshes = CreateMeshes();
+    auto sceneGraph = CreateSceneGraph(meshes);
+    sceneGraph->Refresh(0);
+
+    // A camera at the origin looking along +Z sees a part of the instances, the rest is culled
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(1920.f, 1080.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 16.f / 9.f, 0.1f));
+    view.UpdateCache();
+
+    auto drainItems = [&sceneGraph, &view](IDrawStrategy& strategy)
+    {
+        strategy.PrepareForView(sceneGraph->GetRootNode(), view);
+        uint32_t numItems = 0;
+        while (strategy.GetNextItem())
+            numItems++;
+        DoNotOptimize(numItems);
+    };
+
+    InstancedOpaqueDrawStrategy opaqueStrategy;
+    runner.Run("render/instanced_opaque_cull_4k_instances", [&]()
+    {
+        drainItems(opaqueStrategy);
+    }, c_NumInstances);
+
+    TransparentDrawStrategy transparentStrategy;
+    runner.Run("render/transparent_cull_sort_4k_instances", [&]()
+    {
+        drainItems(transparentStrategy);
+    }, c_NumInstances);
+}
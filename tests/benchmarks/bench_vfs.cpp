@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Benchmark.h"
+#include <donut/core/vfs/VFS.h>
+#include <donut/core/vfs/TarFile.h>
+#include <donut/core/log.h>
+
+#ifdef DONUT_WITH_LZ4
+#include <donut/core/vfs/Compression.h>
+#endif
+
+#ifdef DONUT_WITH_MINIZ
+#include <donut/core/vfs/ZipFile.h>
+#include <miniz.h>
+#include <miniz_zip.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <random>
+
+using namespace donut;
+using namespace donut::benchmarks;
+
+static const size_t c_NumFiles = 32;
+static const size_t c_FileSize = 256 * 1024;
+
+static std::filesystem::path const c_DataPath = std::filesystem::path(DONUT_TEST_BINARY_DIR) / "benchmark_data" / "vfs";
+
+static std::string GetFileName(size_t index)
+{
+    return "assets/file_" + std::to_string(index) + ".bin";
+}
+
+// Random words from a small dictionary, which compress about as well as typical text assets
+static std::vector<char> GenerateFileData(std::mt19937& rng)
+{
+    static const char* words[] = { "mesh ", "texture ", "material ", "node ", "float3 ", "0.5 ", "1.0 ", "-2.25 ", "\n" };
+    std::uniform_int_distribution<size_t> word(0, std::size(words) - 1);
+
+    std::vector<char> data;
+    data.reserve(c_FileSize);
+    while (data.size() < c_FileSize)
+    {
+        const char* w = words[word(rng)];
+        data.insert(data.end(), w, w + strlen(w));
+    }
+    data.resize(c_FileSize);
+    return data;
+}
+
+static bool WriteTarArchive(const std::filesystem::path& archivePath, const std::vector<std::vector<char>>& files)
+{
+    std::ofstream archive(archivePath, std::ios::binary);
+    if (!archive.is_open())
+        return false;
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        // posix ustar header, see TarFile.cpp
+        char header[512] = {};
+        const std::string name = GetFileName(i);
+        strncpy(header, name.c_str(), 99);
+        snprintf(header + 100, 8, "%07o", 0644);
+        snprintf(header + 108, 8, "%07o", 0);
+        snprintf(header + 116, 8, "%07o", 0);
+        snprintf(header + 124, 12, "%011llo", (unsigned long long)files[i].size());
+        snprintf(header + 136, 12, "%011o", 0);
+        header[156] = '0';
+        memcpy(header + 257, "ustar", 6);
+        memcpy(header + 263, "00", 2);
+
+        // the checksum is computed with the checksum field filled with spaces
+        memset(header + 148, ' ', 8);
+        unsigned checksum = 0;
+        for (char c : header)
+            checksum += uint8_t(c);
+        snprintf(header + 148, 8, "%06o", checksum);
+
+        archive.write(header, sizeof(header));
+        archive.write(files[i].data(), std::streamsize(files[i].size()));
+
+        const size_t padding = ((files[i].size() + 511) & ~size_t(511)) - files[i].size();
+        const char zeros[512] = {};
+        archive.write(zeros, std::streamsize(padding));
+    }
+
+    // end of archive
+    const char zeros[1024] = {};
+    archive.write(zeros, sizeof(zeros));
+
+    return archive.good();
+}
+
+#ifdef DONUT_WITH_MINIZ
+static bool WriteZipArchive(const std::filesystem::path& archivePath, const std::vector<std::vector<char>>& files, mz_uint level)
+{
+    mz_zip_archive zip;
+    mz_zip_zero_struct(&zip);
+
+    if (!mz_zip_writer_init_file(&zip, archivePath.generic_string().c_str(), 0))
+        return false;
+
+    bool success = true;
+    for (size_t i = 0; i < files.size() && success; i++)
+        success = mz_zip_writer_add_mem(&zip, GetFileName(i).c_str(), files[i].data(), files[i].size(), level);
+
+    success = success && mz_zip_writer_finalize_archive(&zip);
+    mz_zip_writer_end(&zip);
+    return success;
+}
+#endif
+
+static void ReadAllFiles(BenchmarkRunner& runner, const std::string& name, vfs::IFileSystem& fs, const std::filesystem::path& basePath)
+{
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 0; i < c_NumFiles; i++)
+        paths.push_back(basePath / GetFileName(i));
+
+    if (!fs.readFile(paths[0]))
+    {
+        log::warning("Skipping benchmark '%s': cannot read '%s'", name.c_str(), paths[0].generic_string().c_str());
+        return;
+    }
+
+    runner.Run(name, [&]()
+    {
+        for (const auto& path : paths)
+            DoNotOptimize(fs.readFile(path));
+    }, c_NumFiles);
+}
+
+void donut::benchmarks::benchmark_vfs(BenchmarkRunner& runner)
+{
+    std::mt19937 rng(3);
+    std::vector<std::vector<char>> files;
+    for (size_t i = 0; i < c_NumFiles; i++)
+        files.push_back(GenerateFileData(rng));
+
+    auto nativeFS = std::make_shared<vfs::NativeFileSystem>();
+
+    // Loose files
+    const std::filesystem::path nativePath = c_DataPath / "native";
+    for (size_t i = 0; i < c_NumFiles; i++)
+    {
+        const std::filesystem::path path = nativePath / GetFileName(i);
+        std::filesystem::create_directories(path.parent_path());
+        nativeFS->writeFile(path, files[i].data(), files[i].size());
+    }
+    ReadAllFiles(runner, "vfs/native_read_256k", *nativeFS, nativePath);
+
+    // Tar archive
+    const std::filesystem::path tarPath = c_DataPath / "files.tar";
+    if (WriteTarArchive(tarPath, files))
+    {
+        vfs::TarFile tarFS(tarPath);
+        ReadAllFiles(runner, "vfs/tar_read_256k", tarFS, "");
+    }
+
+#ifdef DONUT_WITH_MINIZ
+    // Zip archives, stored and deflated
+    const std::filesystem::path zipStoredPath = c_DataPath / "files_stored.zip";
+    if (WriteZipArchive(zipStoredPath, files, MZ_NO_COMPRESSION))
+    {
+        vfs::ZipFile zipFS(zipStoredPath);
+        ReadAllFiles(runner, "vfs/zip_stored_read_256k", zipFS, "");
+    }
+
+    const std::filesystem::path zipDeflatePath = c_DataPath / "files_deflate.zip";
+    if (WriteZipArchive(zipDeflatePath, files, MZ_DEFAULT_LEVEL))
+    {
+        vfs::ZipFile zipFS(zipDeflatePath);
+        ReadAllFiles(runner, "vfs/zip_deflate_read_256k", zipFS, "");
+    }
+#endif
+
+#ifdef DONUT_WITH_LZ4
+    // LZ4 compressed loose files, found by the compression layer through the .lz4 extension
+    const std::filesystem::path lz4Path = c_DataPath / "lz4";
+    vfs::CompressionLayer compressionFS(nativeFS);
+    for (size_t i = 0; i < c_NumFiles; i++)
+    {
+        std::filesystem::path path = lz4Path / GetFileName(i);
+        std::filesystem::create_directories(path.parent_path());
+        path += ".lz4";
+        compressionFS.writeFile(path, files[i].data(), files[i].size());
+    }
+    ReadAllFiles(runner, "vfs/lz4_read_256k", compressionFS, lz4Path);
+#endif
+}
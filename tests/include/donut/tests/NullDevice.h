@@ -0,0 +1,354 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+NullDevice is an nvrhi device that doesn't talk to any GPU. Resources are cheap objects that only keep
+their descriptors, and command lists count (and optionally record) the commands instead of executing them.
+It lets the engine and render code run on machines without a GPU, for unit tests and CPU overhead
+benchmarks of scene updates, draw strategies and passes.
+
+Semantics:
+- Command lists execute instantly: event and timer queries are always complete, timers read zero.
+- Buffers only have storage when they are CPU-accessible or NullDeviceDesc::storeBufferContents is set.
+  With storage, writeBuffer, copyBuffer and clearBufferUInt are applied when they are recorded.
+- Ray tracing, meshlets, sampler feedback and tiled resources are not supported and reported as such
+  by queryFeatureSupport. Their creation functions return null.
+*/
+
+namespace donut::tests
+{
+    struct NullDeviceDesc
+    {
+        nvrhi::GraphicsAPI graphicsAPI = nvrhi::GraphicsAPI::VULKAN;
+        nvrhi::IMessageCallback* messageCallback = nullptr;
+        bool storeBufferContents = false;
+        bool recordCommands = false;
+        // Reported through queryFeatureSupport, to test the code paths for devices without placed resources
+        bool virtualResources = true;
+    };
+
+    struct NullCommandListStats
+    {
+        uint64_t draws = 0;             // draw and drawIndexed calls
+        uint64_t indirectDraws = 0;     // drawIndirect and drawIndexedIndirect calls
+        uint64_t instances = 0;         // instances in direct draws
+        uint64_t primitiveVertices = 0; // vertices or indices times instances in direct draws
+        uint64_t dispatches = 0;        // dispatch and dispatchIndirect calls
+        uint64_t graphicsStateChanges = 0;
+        uint64_t computeStateChanges = 0;
+        uint64_t pipelineChanges = 0;
+        uint64_t bindingSetChanges = 0; // binding slots that changed between consecutive states
+        uint64_t vertexBufferChanges = 0;
+        uint64_t indexBufferChanges = 0;
+        uint64_t pushConstantBytes = 0;
+        uint64_t writeBufferCalls = 0;
+        uint64_t writeBufferBytes = 0;
+        uint64_t writeTextureCalls = 0;
+        uint64_t writeTextureBytes = 0;
+        uint64_t copies = 0;
+        uint64_t clears = 0;
+        uint64_t stateTransitions = 0;  // set*State and beginTracking*State calls
+        uint64_t markers = 0;
+
+        void Accumulate(const NullCommandListStats& other);
+    };
+
+    struct NullDeviceStats
+    {
+        uint64_t buffersCreated = 0;
+        uint64_t bufferBytesCreated = 0;
+        uint64_t texturesCreated = 0;
+        uint64_t textureBytesCreated = 0;
+        uint64_t shadersCreated = 0;
+        uint64_t pipelinesCreated = 0;
+        uint64_t bindingLayoutsCreated = 0;
+        uint64_t bindingSetsCreated = 0;
+        uint64_t descriptorTableWrites = 0;
+        uint64_t commandListsExecuted = 0;
+
+        // Sum of the stats of all executed command lists
+        NullCommandListStats commands;
+    };
+
+    enum class NullCommandType : uint8_t
+    {
+        Draw,
+        DrawIndexed,
+        DrawIndirect,
+        DrawIndexedIndirect,
+        Dispatch,
+        DispatchIndirect,
+        SetGraphicsState,
+        SetComputeState,
+        SetPushConstants,
+        WriteBuffer,
+        WriteTexture,
+        CopyBuffer,
+        CopyTexture,
+        ClearBuffer,
+        ClearTexture,
+        ResolveTexture,
+        BeginTimerQuery,
+        EndTimerQuery,
+        BeginMarker,
+        EndMarker
+    };
+
+    struct NullCommand
+    {
+        NullCommandType type;
+        // Vertex, index or group count, or size in bytes, depending on the type
+        uint64_t value = 0;
+        nvrhi::IResource* resource = nullptr;
+    };
+
+    enum class NullQueueOperationType : uint8_t
+    {
+        Execute,
+        Wait
+    };
+
+    // Queue operation recorded by the device when NullDeviceDesc::recordCommands is set
+    struct NullQueueOperation
+    {
+        NullQueueOperationType type;
+        // Queue that executes the command lists or waits
+        nvrhi::CommandQueue queue;
+        // Queue that is waited for, only for Wait operations
+        nvrhi::CommandQueue waitedQueue = nvrhi::CommandQueue::Graphics;
+        // Submitted or waited for instance on the respective queue
+        uint64_t instance = 0;
+        // Dispatches in the executed command lists
+        uint64_t dispatches = 0;
+        // Executed command lists in submission order, only for Execute operations. Not owning references.
+        std::vector<nvrhi::ICommandList*> commandLists;
+    };
+
+    class NullDevice;
+
+    class NullCommandList : public nvrhi::RefCounter<nvrhi::ICommandList>
+    {
+    private:
+        NullDevice* m_Device;
+        nvrhi::CommandListParameters m_Desc;
+        NullCommandListStats m_Stats;
+        std::vector<NullCommand> m_Commands;
+        bool m_RecordCommands = false;
+
+        nvrhi::GraphicsState m_GraphicsState;
+        nvrhi::ComputeState m_ComputeState;
+        bool m_GraphicsStateValid = false;
+        bool m_ComputeStateValid = false;
+
+        std::unordered_map<nvrhi::ITexture*, nvrhi::ResourceStates> m_TextureStates;
+        std::unordered_map<nvrhi::IBuffer*, nvrhi::ResourceStates> m_BufferStates;
+
+        void Record(NullCommandType type, uint64_t value = 0, nvrhi::IResource* resource = nullptr);
+        void CountBindingChanges(const nvrhi::BindingSetVector& previous, const nvrhi::BindingSetVector& current);
+
+    public:
+        NullCommandList(NullDevice* device, const nvrhi::CommandListParameters& params, bool recordCommands);
+
+        [[nodiscard]] const NullCommandListStats& GetStats() const { return m_Stats; }
+        [[nodiscard]] const std::vector<NullCommand>& GetCommands() const { return m_Commands; }
+
+        void open() override;
+        void close() override;
+        void clearState() override;
+
+        void clearTextureFloat(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, const nvrhi::Color& clearColor) override;
+        void clearDepthStencilTexture(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, bool clearDepth, float depth, bool clearStencil, uint8_t stencil) override;
+        void clearTextureUInt(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, uint32_t clearColor) override;
+        void clearSamplerFeedbackTexture(nvrhi::ISamplerFeedbackTexture* texture) override { }
+        void decodeSamplerFeedbackTexture(nvrhi::IBuffer* buffer, nvrhi::ISamplerFeedbackTexture* texture, nvrhi::Format format) override { }
+        void setSamplerFeedbackTextureState(nvrhi::ISamplerFeedbackTexture* texture, nvrhi::ResourceStates stateBits) override { }
+
+        void copyTexture(nvrhi::ITexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::ITexture* src, const nvrhi::TextureSlice& srcSlice) override;
+        void copyTexture(nvrhi::IStagingTexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::ITexture* src, const nvrhi::TextureSlice& srcSlice) override;
+        void copyTexture(nvrhi::ITexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::IStagingTexture* src, const nvrhi::TextureSlice& srcSlice) override;
+        void writeTexture(nvrhi::ITexture* dest, uint32_t arraySlice, uint32_t mipLevel, const void* data, size_t rowPitch, size_t depthPitch) override;
+        void resolveTexture(nvrhi::ITexture* dest, const nvrhi::TextureSubresourceSet& dstSubresources, nvrhi::ITexture* src, const nvrhi::TextureSubresourceSet& srcSubresources) override;
+
+        void writeBuffer(nvrhi::IBuffer* b, const void* data, size_t dataSize, uint64_t destOffsetBytes) override;
+        void clearBufferUInt(nvrhi::IBuffer* b, uint32_t clearValue) override;
+        void copyBuffer(nvrhi::IBuffer* dest, uint64_t destOffsetBytes, nvrhi::IBuffer* src, uint64_t srcOffsetBytes, uint64_t dataSizeBytes) override;
+
+        void setPushConstants(const void* data, size_t byteSize) override;
+
+        void setGraphicsState(const nvrhi::GraphicsState& state) override;
+        void draw(const nvrhi::DrawArguments& args) override;
+        void drawIndexed(const nvrhi::DrawArguments& args) override;
+        void drawIndirect(uint32_t offsetBytes, uint32_t drawCount) override;
+        void drawIndexedIndirect(uint32_t offsetBytes, uint32_t drawCount) override;
+
+        void setComputeState(const nvrhi::ComputeState& state) override;
+        void dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+        void dispatchIndirect(uint32_t offsetBytes) override;
+
+        void setMeshletState(const nvrhi::MeshletState& state) override { }
+        void dispatchMesh(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override { }
+
+        void setRayTracingState(const nvrhi::rt::State& state) override { }
+        void dispatchRays(const nvrhi::rt::DispatchRaysArguments& args) override { }
+        void buildOpacityMicromap(nvrhi::rt::IOpacityMicromap* omm, const nvrhi::rt::OpacityMicromapDesc& desc) override { }
+        void buildBottomLevelAccelStruct(nvrhi::rt::IAccelStruct* as, const nvrhi::rt::GeometryDesc* pGeometries, size_t numGeometries, nvrhi::rt::AccelStructBuildFlags buildFlags) override { }
+        void compactBottomLevelAccelStructs() override { }
+        void buildTopLevelAccelStruct(nvrhi::rt::IAccelStruct* as, const nvrhi::rt::InstanceDesc* pInstances, size_t numInstances, nvrhi::rt::AccelStructBuildFlags buildFlags) override { }
+        void buildTopLevelAccelStructFromBuffer(nvrhi::rt::IAccelStruct* as, nvrhi::IBuffer* instanceBuffer, uint64_t instanceBufferOffset, size_t numInstances, nvrhi::rt::AccelStructBuildFlags buildFlags) override { }
+        void executeMultiIndirectClusterOperation(const nvrhi::rt::cluster::OperationDesc& desc) override { }
+
+        void beginTimerQuery(nvrhi::ITimerQuery* query) override;
+        void endTimerQuery(nvrhi::ITimerQuery* query) override;
+        void beginMarker(const char* name) override;
+        void endMarker() override;
+
+        void setEnableAutomaticBarriers(bool enable) override { }
+        void setResourceStatesForBindingSet(nvrhi::IBindingSet* bindingSet) override { }
+        void setEnableUavBarriersForTexture(nvrhi::ITexture* texture, bool enableBarriers) override { }
+        void setEnableUavBarriersForBuffer(nvrhi::IBuffer* buffer, bool enableBarriers) override { }
+        void beginTrackingTextureState(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources, nvrhi::ResourceStates stateBits) override;
+        void beginTrackingBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits) override;
+        void setTextureState(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources, nvrhi::ResourceStates stateBits) override;
+        void setBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits) override;
+        void setAccelStructState(nvrhi::rt::IAccelStruct* as, nvrhi::ResourceStates stateBits) override { }
+        void setPermanentTextureState(nvrhi::ITexture* texture, nvrhi::ResourceStates stateBits) override;
+        void setPermanentBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits) override;
+        void commitBarriers() override { }
+        nvrhi::ResourceStates getTextureSubresourceState(nvrhi::ITexture* texture, nvrhi::ArraySlice arraySlice, nvrhi::MipLevel mipLevel) override;
+        nvrhi::ResourceStates getBufferState(nvrhi::IBuffer* buffer) override;
+
+        nvrhi::IDevice* getDevice() override;
+        const nvrhi::CommandListParameters& getDesc() override { return m_Desc; }
+    };
+
+    class NullDevice : public nvrhi::RefCounter<nvrhi::IDevice>
+    {
+    private:
+        NullDeviceDesc m_Desc;
+        nvrhi::AftermathCrashDumpHelper m_AftermathCrashDumpHelper;
+        // Instances are counted per queue, like on the real devices
+        uint64_t m_LastSubmittedInstances[size_t(nvrhi::CommandQueue::Count)] = {};
+
+        std::mutex m_StatsMutex;
+        NullDeviceStats m_Stats;
+        std::vector<NullQueueOperation> m_QueueOperations;
+
+        void CountCreation(uint64_t NullDeviceStats::* counter, uint64_t NullDeviceStats::* bytesCounter = nullptr, uint64_t bytes = 0);
+
+    public:
+        explicit NullDevice(const NullDeviceDesc& desc);
+
+        [[nodiscard]] const NullDeviceDesc& GetDesc() const { return m_Desc; }
+        [[nodiscard]] NullDeviceStats GetStats();
+        void ResetStats();
+        [[nodiscard]] std::vector<NullQueueOperation> GetQueueOperations();
+
+        nvrhi::HeapHandle createHeap(const nvrhi::HeapDesc& d) override;
+
+        nvrhi::TextureHandle createTexture(const nvrhi::TextureDesc& d) override;
+        nvrhi::MemoryRequirements getTextureMemoryRequirements(nvrhi::ITexture* texture) override;
+        bool bindTextureMemory(nvrhi::ITexture* texture, nvrhi::IHeap* heap, uint64_t offset) override { return true; }
+        nvrhi::TextureHandle createHandleForNativeTexture(nvrhi::ObjectType objectType, nvrhi::Object texture, const nvrhi::TextureDesc& desc) override;
+
+        nvrhi::StagingTextureHandle createStagingTexture(const nvrhi::TextureDesc& d, nvrhi::CpuAccessMode cpuAccess) override;
+        void* mapStagingTexture(nvrhi::IStagingTexture* tex, const nvrhi::TextureSlice& slice, nvrhi::CpuAccessMode cpuAccess, size_t* outRowPitch) override;
+        void unmapStagingTexture(nvrhi::IStagingTexture* tex) override { }
+
+        void getTextureTiling(nvrhi::ITexture* texture, uint32_t* numTiles, nvrhi::PackedMipDesc* desc, nvrhi::TileShape* tileShape, uint32_t* subresourceTilingsNum, nvrhi::SubresourceTiling* subresourceTilings) override;
+        void updateTextureTileMappings(nvrhi::ITexture* texture, const nvrhi::TextureTilesMapping* tileMappings, uint32_t numTileMappings, nvrhi::CommandQueue executionQueue) override { }
+
+        nvrhi::SamplerFeedbackTextureHandle createSamplerFeedbackTexture(nvrhi::ITexture* pairedTexture, const nvrhi::SamplerFeedbackTextureDesc& desc) override { return nullptr; }
+        nvrhi::SamplerFeedbackTextureHandle createSamplerFeedbackForNativeTexture(nvrhi::ObjectType objectType, nvrhi::Object texture, nvrhi::ITexture* pairedTexture) override { return nullptr; }
+
+        nvrhi::BufferHandle createBuffer(const nvrhi::BufferDesc& d) override;
+        void* mapBuffer(nvrhi::IBuffer* buffer, nvrhi::CpuAccessMode cpuAccess) override;
+        void unmapBuffer(nvrhi::IBuffer* buffer) override { }
+        nvrhi::MemoryRequirements getBufferMemoryRequirements(nvrhi::IBuffer* buffer) override;
+        bool bindBufferMemory(nvrhi::IBuffer* buffer, nvrhi::IHeap* heap, uint64_t offset) override { return true; }
+        nvrhi::BufferHandle createHandleForNativeBuffer(nvrhi::ObjectType objectType, nvrhi::Object buffer, const nvrhi::BufferDesc& desc) override;
+
+        nvrhi::ShaderHandle createShader(const nvrhi::ShaderDesc& d, const void* binary, size_t binarySize) override;
+        nvrhi::ShaderHandle createShaderSpecialization(nvrhi::IShader* baseShader, const nvrhi::ShaderSpecialization* constants, uint32_t numConstants) override;
+        nvrhi::ShaderLibraryHandle createShaderLibrary(const void* binary, size_t binarySize) override;
+
+        nvrhi::SamplerHandle createSampler(const nvrhi::SamplerDesc& d) override;
+        nvrhi::InputLayoutHandle createInputLayout(const nvrhi::VertexAttributeDesc* d, uint32_t attributeCount, nvrhi::IShader* vertexShader) override;
+
+        nvrhi::EventQueryHandle createEventQuery() override;
+        void setEventQuery(nvrhi::IEventQuery* query, nvrhi::CommandQueue queue) override { }
+        bool pollEventQuery(nvrhi::IEventQuery* query) override { return true; }
+        void waitEventQuery(nvrhi::IEventQuery* query) override { }
+        void resetEventQuery(nvrhi::IEventQuery* query) override { }
+
+        nvrhi::TimerQueryHandle createTimerQuery() override;
+        bool pollTimerQuery(nvrhi::ITimerQuery* query) override { return true; }
+        float getTimerQueryTime(nvrhi::ITimerQuery* query) override { return 0.f; }
+        void resetTimerQuery(nvrhi::ITimerQuery* query) override { }
+
+        nvrhi::GraphicsAPI getGraphicsAPI() override { return m_Desc.graphicsAPI; }
+
+        nvrhi::FramebufferHandle createFramebuffer(const nvrhi::FramebufferDesc& desc) override;
+        nvrhi::GraphicsPipelineHandle createGraphicsPipeline(const nvrhi::GraphicsPipelineDesc& desc, nvrhi::IFramebuffer* fb) override;
+        nvrhi::ComputePipelineHandle createComputePipeline(const nvrhi::ComputePipelineDesc& desc) override;
+        nvrhi::MeshletPipelineHandle createMeshletPipeline(const nvrhi::MeshletPipelineDesc& desc, nvrhi::IFramebuffer* fb) override { return nullptr; }
+        nvrhi::rt::PipelineHandle createRayTracingPipeline(const nvrhi::rt::PipelineDesc& desc) override { return nullptr; }
+
+        nvrhi::BindingLayoutHandle createBindingLayout(const nvrhi::BindingLayoutDesc& desc) override;
+        nvrhi::BindingLayoutHandle createBindlessLayout(const nvrhi::BindlessLayoutDesc& desc) override;
+        nvrhi::BindingSetHandle createBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout) override;
+        nvrhi::DescriptorTableHandle createDescriptorTable(nvrhi::IBindingLayout* layout) override;
+        void resizeDescriptorTable(nvrhi::IDescriptorTable* descriptorTable, uint32_t newSize, bool keepContents = true) override;
+        bool writeDescriptorTable(nvrhi::IDescriptorTable* descriptorTable, const nvrhi::BindingSetItem& item) override;
+
+        nvrhi::rt::OpacityMicromapHandle createOpacityMicromap(const nvrhi::rt::OpacityMicromapDesc& desc) override { return nullptr; }
+        nvrhi::rt::AccelStructHandle createAccelStruct(const nvrhi::rt::AccelStructDesc& desc) override { return nullptr; }
+        nvrhi::MemoryRequirements getAccelStructMemoryRequirements(nvrhi::rt::IAccelStruct* as) override { return nvrhi::MemoryRequirements(); }
+        nvrhi::rt::cluster::OperationSizeInfo getClusterOperationSizeInfo(const nvrhi::rt::cluster::OperationParams& params) override { return nvrhi::rt::cluster::OperationSizeInfo(); }
+        bool bindAccelStructMemory(nvrhi::rt::IAccelStruct* as, nvrhi::IHeap* heap, uint64_t offset) override { return false; }
+
+        nvrhi::CommandListHandle createCommandList(const nvrhi::CommandListParameters& params = nvrhi::CommandListParameters()) override;
+        uint64_t executeCommandLists(nvrhi::ICommandList* const* pCommandLists, size_t numCommandLists, nvrhi::CommandQueue executionQueue = nvrhi::CommandQueue::Graphics) override;
+        void queueWaitForCommandList(nvrhi::CommandQueue waitQueue, nvrhi::CommandQueue executionQueue, uint64_t instance) override;
+        bool waitForIdle() override { return true; }
+        void runGarbageCollection() override { }
+
+        bool queryFeatureSupport(nvrhi::Feature feature, void* pInfo = nullptr, size_t infoSize = 0) override;
+        nvrhi::FormatSupport queryFormatSupport(nvrhi::Format format) override;
+        nvrhi::Object getNativeQueue(nvrhi::ObjectType objectType, nvrhi::CommandQueue queue) override { return nullptr; }
+        nvrhi::IMessageCallback* getMessageCallback() override { return m_Desc.messageCallback; }
+        bool isAftermathEnabled() override { return false; }
+        nvrhi::AftermathCrashDumpHelper& getAftermathCrashDumpHelper() override { return m_AftermathCrashDumpHelper; }
+    };
+
+    nvrhi::RefCountPtr<NullDevice> CreateNullDevice(const NullDeviceDesc& desc = NullDeviceDesc());
+
+    // Returns the CPU copy of a buffer's contents, or nullptr if the buffer has no storage.
+    uint8_t* GetNullBufferData(nvrhi::IBuffer* buffer);
+}
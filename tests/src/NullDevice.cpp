@@ -0,0 +1,864 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/tests/NullDevice.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace donut::tests;
+
+namespace
+{
+    class NullHeap : public nvrhi::RefCounter<nvrhi::IHeap>
+    {
+    public:
+        nvrhi::HeapDesc desc;
+
+        explicit NullHeap(const nvrhi::HeapDesc& d) : desc(d) { }
+        const nvrhi::HeapDesc& getDesc() override { return desc; }
+    };
+
+    class NullTexture : public nvrhi::RefCounter<nvrhi::ITexture>
+    {
+    public:
+        nvrhi::TextureDesc desc;
+
+        explicit NullTexture(const nvrhi::TextureDesc& d) : desc(d) { }
+        const nvrhi::TextureDesc& getDesc() const override { return desc; }
+        nvrhi::Object getNativeView(nvrhi::ObjectType objectType, nvrhi::Format format, nvrhi::TextureSubresourceSet subresources,
+            nvrhi::TextureDimension dimension, bool isReadOnlyDSV) override { return nullptr; }
+    };
+
+    class NullStagingTexture : public nvrhi::RefCounter<nvrhi::IStagingTexture>
+    {
+    public:
+        nvrhi::TextureDesc desc;
+        std::vector<uint8_t> data;
+
+        explicit NullStagingTexture(const nvrhi::TextureDesc& d) : desc(d) { }
+        const nvrhi::TextureDesc& getDesc() const override { return desc; }
+    };
+
+    class NullBuffer : public nvrhi::RefCounter<nvrhi::IBuffer>
+    {
+    public:
+        nvrhi::BufferDesc desc;
+        std::vector<uint8_t> data;
+
+        explicit NullBuffer(const nvrhi::BufferDesc& d) : desc(d) { }
+        const nvrhi::BufferDesc& getDesc() const override { return desc; }
+        nvrhi::GpuVirtualAddress getGpuVirtualAddress() const override { return 0; }
+    };
+
+    class NullShader : public nvrhi::RefCounter<nvrhi::IShader>
+    {
+    public:
+        nvrhi::ShaderDesc desc;
+        std::vector<uint8_t> bytecode;
+
+        explicit NullShader(const nvrhi::ShaderDesc& d) : desc(d) { }
+        const nvrhi::ShaderDesc& getDesc() const override { return desc; }
+        void getBytecode(const void** ppBytecode, size_t* pSize) const override
+        {
+            if (ppBytecode) *ppBytecode = bytecode.data();
+            if (pSize) *pSize = bytecode.size();
+        }
+    };
+
+    class NullShaderLibrary : public nvrhi::RefCounter<nvrhi::IShaderLibrary>
+    {
+    public:
+        std::vector<uint8_t> bytecode;
+
+        void getBytecode(const void** ppBytecode, size_t* pSize) const override
+        {
+            if (ppBytecode) *ppBytecode = bytecode.data();
+            if (pSize) *pSize = bytecode.size();
+        }
+
+        nvrhi::ShaderHandle getShader(const char* entryName, nvrhi::ShaderType shaderType) override
+        {
+            NullShader* shader = new NullShader(nvrhi::ShaderDesc().setShaderType(shaderType).setEntryName(entryName));
+            shader->bytecode = bytecode;
+            return nvrhi::ShaderHandle::Create(shader);
+        }
+    };
+
+    class NullSampler : public nvrhi::RefCounter<nvrhi::ISampler>
+    {
+    public:
+        nvrhi::SamplerDesc desc;
+
+        explicit NullSampler(const nvrhi::SamplerDesc& d) : desc(d) { }
+        const nvrhi::SamplerDesc& getDesc() const override { return desc; }
+    };
+
+    class NullInputLayout : public nvrhi::RefCounter<nvrhi::IInputLayout>
+    {
+    public:
+        std::vector<nvrhi::VertexAttributeDesc> attributes;
+
+        uint32_t getNumAttributes() const override { return uint32_t(attributes.size()); }
+        const nvrhi::VertexAttributeDesc* getAttributeDesc(uint32_t index) const override
+        {
+            return index < attributes.size() ? &attributes[index] : nullptr;
+        }
+    };
+
+    class NullEventQuery : public nvrhi::RefCounter<nvrhi::IEventQuery>
+    {
+    };
+
+    class NullTimerQuery : public nvrhi::RefCounter<nvrhi::ITimerQuery>
+    {
+    };
+
+    class NullFramebuffer : public nvrhi::RefCounter<nvrhi::IFramebuffer>
+    {
+    public:
+        nvrhi::FramebufferDesc desc;
+        nvrhi::FramebufferInfoEx info;
+
+        explicit NullFramebuffer(const nvrhi::FramebufferDesc& d) : desc(d), info(d) { }
+        const nvrhi::FramebufferDesc& getDesc() const override { return desc; }
+        const nvrhi::FramebufferInfoEx& getFramebufferInfo() const override { return info; }
+    };
+
+    class NullBindingLayout : public nvrhi::RefCounter<nvrhi::IBindingLayout>
+    {
+    public:
+        nvrhi::BindingLayoutDesc desc;
+        nvrhi::BindlessLayoutDesc bindlessDesc;
+        bool isBindless = false;
+
+        const nvrhi::BindingLayoutDesc* getDesc() const override { return isBindless ? nullptr : &desc; }
+        const nvrhi::BindlessLayoutDesc* getBindlessDesc() const override { return isBindless ? &bindlessDesc : nullptr; }
+    };
+
+    class NullBindingSet : public nvrhi::RefCounter<nvrhi::IBindingSet>
+    {
+    public:
+        nvrhi::BindingSetDesc desc;
+        nvrhi::BindingLayoutHandle layout;
+
+        const nvrhi::BindingSetDesc* getDesc() const override { return &desc; }
+        nvrhi::IBindingLayout* getLayout() const override { return layout; }
+    };
+
+    class NullDescriptorTable : public nvrhi::RefCounter<nvrhi::IDescriptorTable>
+    {
+    public:
+        nvrhi::BindingLayoutHandle layout;
+        uint32_t capacity = 0;
+
+        const nvrhi::BindingSetDesc* getDesc() const override { return nullptr; }
+        nvrhi::IBindingLayout* getLayout() const override { return layout; }
+        uint32_t getCapacity() const override { return capacity; }
+        uint32_t getFirstDescriptorIndexInHeap() const override { return 0; }
+    };
+
+    class NullGraphicsPipeline : public nvrhi::RefCounter<nvrhi::IGraphicsPipeline>
+    {
+    public:
+        nvrhi::GraphicsPipelineDesc desc;
+        nvrhi::FramebufferInfo framebufferInfo;
+
+        const nvrhi::GraphicsPipelineDesc& getDesc() const override { return desc; }
+        const nvrhi::FramebufferInfo& getFramebufferInfo() const override { return framebufferInfo; }
+    };
+
+    class NullComputePipeline : public nvrhi::RefCounter<nvrhi::IComputePipeline>
+    {
+    public:
+        nvrhi::ComputePipelineDesc desc;
+
+        const nvrhi::ComputePipelineDesc& getDesc() const override { return desc; }
+    };
+
+    uint64_t GetTextureSize(const nvrhi::TextureDesc& desc)
+    {
+        const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(desc.format);
+        const uint32_t blockSize = std::max(uint32_t(formatInfo.blockSize), 1u);
+
+        uint64_t size = 0;
+        for (uint32_t mipLevel = 0; mipLevel < std::max(desc.mipLevels, 1u); mipLevel++)
+        {
+            uint64_t width = std::max(desc.width >> mipLevel, 1u);
+            uint64_t height = std::max(desc.height >> mipLevel, 1u);
+            uint64_t depth = std::max(desc.depth >> mipLevel, 1u);
+            uint64_t blocks = ((width + blockSize - 1) / blockSize) * ((height + blockSize - 1) / blockSize) * depth;
+            size += blocks * formatInfo.bytesPerBlock;
+        }
+
+        return size * std::max(desc.arraySize, 1u) * std::max(desc.sampleCount, 1u);
+    }
+}
+
+void NullCommandListStats::Accumulate(const NullCommandListStats& other)
+{
+    draws += other.draws;
+    indirectDraws += other.indirectDraws;
+    instances += other.instances;
+    primitiveVertices += other.primitiveVertices;
+    dispatches += other.dispatches;
+    graphicsStateChanges += other.graphicsStateChanges;
+    computeStateChanges += other.computeStateChanges;
+    pipelineChanges += other.pipelineChanges;
+    bindingSetChanges += other.bindingSetChanges;
+    vertexBufferChanges += other.vertexBufferChanges;
+    indexBufferChanges += other.indexBufferChanges;
+    pushConstantBytes += other.pushConstantBytes;
+    writeBufferCalls += other.writeBufferCalls;
+    writeBufferBytes += other.writeBufferBytes;
+    writeTextureCalls += other.writeTextureCalls;
+    writeTextureBytes += other.writeTextureBytes;
+    copies += other.copies;
+    clears += other.clears;
+    stateTransitions += other.stateTransitions;
+    markers += other.markers;
+}
+
+NullCommandList::NullCommandList(NullDevice* device, const nvrhi::CommandListParameters& params, bool recordCommands)
+    : m_Device(device)
+    , m_Desc(params)
+    , m_RecordCommands(recordCommands)
+{
+}
+
+void NullCommandList::Record(NullCommandType type, uint64_t value, nvrhi::IResource* resource)
+{
+    if (m_RecordCommands)
+        m_Commands.push_back(NullCommand{ type, value, resource });
+}
+
+void NullCommandList::open()
+{
+    m_Stats = NullCommandListStats();
+    m_Commands.clear();
+    m_TextureStates.clear();
+    m_BufferStates.clear();
+    clearState();
+}
+
+void NullCommandList::close()
+{
+}
+
+void NullCommandList::clearState()
+{
+    m_GraphicsState = nvrhi::GraphicsState();
+    m_ComputeState = nvrhi::ComputeState();
+    m_GraphicsStateValid = false;
+    m_ComputeStateValid = false;
+}
+
+void NullCommandList::clearTextureFloat(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, const nvrhi::Color& clearColor)
+{
+    ++m_Stats.clears;
+    Record(NullCommandType::ClearTexture, 0, t);
+}
+
+void NullCommandList::clearDepthStencilTexture(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, bool clearDepth, float depth, bool clearStencil, uint8_t stencil)
+{
+    ++m_Stats.clears;
+    Record(NullCommandType::ClearTexture, 0, t);
+}
+
+void NullCommandList::clearTextureUInt(nvrhi::ITexture* t, nvrhi::TextureSubresourceSet subresources, uint32_t clearColor)
+{
+    ++m_Stats.clears;
+    Record(NullCommandType::ClearTexture, 0, t);
+}
+
+void NullCommandList::copyTexture(nvrhi::ITexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::ITexture* src, const nvrhi::TextureSlice& srcSlice)
+{
+    ++m_Stats.copies;
+    Record(NullCommandType::CopyTexture, 0, dest);
+}
+
+void NullCommandList::copyTexture(nvrhi::IStagingTexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::ITexture* src, const nvrhi::TextureSlice& srcSlice)
+{
+    ++m_Stats.copies;
+    Record(NullCommandType::CopyTexture, 0, dest);
+}
+
+void NullCommandList::copyTexture(nvrhi::ITexture* dest, const nvrhi::TextureSlice& destSlice, nvrhi::IStagingTexture* src, const nvrhi::TextureSlice& srcSlice)
+{
+    ++m_Stats.copies;
+    Record(NullCommandType::CopyTexture, 0, dest);
+}
+
+void NullCommandList::writeTexture(nvrhi::ITexture* dest, uint32_t arraySlice, uint32_t mipLevel, const void* data, size_t rowPitch, size_t depthPitch)
+{
+    const nvrhi::TextureDesc& desc = dest->getDesc();
+    const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(desc.format);
+    const uint32_t blockSize = std::max(uint32_t(formatInfo.blockSize), 1u);
+    const uint64_t columns = (std::max(desc.width >> mipLevel, 1u) + blockSize - 1) / blockSize;
+    const uint64_t rows = (std::max(desc.height >> mipLevel, 1u) + blockSize - 1) / blockSize;
+    const uint64_t depth = std::max(desc.depth >> mipLevel, 1u);
+    // Some callers pass a zero pitch for single-row textures
+    const uint64_t rowBytes = rowPitch ? rowPitch : columns * formatInfo.bytesPerBlock;
+    const uint64_t bytes = depthPitch ? depthPitch * depth : rowBytes * rows * depth;
+
+    ++m_Stats.writeTextureCalls;
+    m_Stats.writeTextureBytes += bytes;
+    Record(NullCommandType::WriteTexture, bytes, dest);
+}
+
+void NullCommandList::resolveTexture(nvrhi::ITexture* dest, const nvrhi::TextureSubresourceSet& dstSubresources, nvrhi::ITexture* src, const nvrhi::TextureSubresourceSet& srcSubresources)
+{
+    ++m_Stats.copies;
+    Record(NullCommandType::ResolveTexture, 0, dest);
+}
+
+void NullCommandList::writeBuffer(nvrhi::IBuffer* b, const void* data, size_t dataSize, uint64_t destOffsetBytes)
+{
+    ++m_Stats.writeBufferCalls;
+    m_Stats.writeBufferBytes += dataSize;
+    Record(NullCommandType::WriteBuffer, dataSize, b);
+
+    auto* buffer = static_cast<NullBuffer*>(b);
+    if (!buffer->data.empty() && destOffsetBytes + dataSize <= buffer->data.size())
+        memcpy(buffer->data.data() + destOffsetBytes, data, dataSize);
+}
+
+void NullCommandList::clearBufferUInt(nvrhi::IBuffer* b, uint32_t clearValue)
+{
+    ++m_Stats.clears;
+    Record(NullCommandType::ClearBuffer, 0, b);
+
+    auto* buffer = static_cast<NullBuffer*>(b);
+    for (size_t offset = 0; offset + sizeof(uint32_t) <= buffer->data.size(); offset += sizeof(uint32_t))
+        memcpy(buffer->data.data() + offset, &clearValue, sizeof(uint32_t));
+}
+
+void NullCommandList::copyBuffer(nvrhi::IBuffer* dest, uint64_t destOffsetBytes, nvrhi::IBuffer* src, uint64_t srcOffsetBytes, uint64_t dataSizeBytes)
+{
+    ++m_Stats.copies;
+    Record(NullCommandType::CopyBuffer, dataSizeBytes, dest);
+
+    auto* destBuffer = static_cast<NullBuffer*>(dest);
+    auto* srcBuffer = static_cast<NullBuffer*>(src);
+    if (!destBuffer->data.empty() && !srcBuffer->data.empty() &&
+        destOffsetBytes + dataSizeBytes <= destBuffer->data.size() &&
+        srcOffsetBytes + dataSizeBytes <= srcBuffer->data.size())
+    {
+        memmove(destBuffer->data.data() + destOffsetBytes, srcBuffer->data.data() + srcOffsetBytes, dataSizeBytes);
+    }
+}
+
+void NullCommandList::setPushConstants(const void* data, size_t byteSize)
+{
+    m_Stats.pushConstantBytes += byteSize;
+    Record(NullCommandType::SetPushConstants, byteSize);
+}
+
+void NullCommandList::CountBindingChanges(const nvrhi::BindingSetVector& previous, const nvrhi::BindingSetVector& current)
+{
+    const size_t count = std::max(previous.size(), current.size());
+    for (size_t index = 0; index < count; index++)
+    {
+        if (index >= previous.size() || index >= current.size() || previous[index] != current[index])
+            ++m_Stats.bindingSetChanges;
+    }
+}
+
+void NullCommandList::setGraphicsState(const nvrhi::GraphicsState& state)
+{
+    ++m_Stats.graphicsStateChanges;
+    Record(NullCommandType::SetGraphicsState, 0, state.pipeline);
+
+    if (!m_GraphicsStateValid || state.pipeline != m_GraphicsState.pipeline)
+        ++m_Stats.pipelineChanges;
+
+    CountBindingChanges(m_GraphicsStateValid ? m_GraphicsState.bindings : nvrhi::BindingSetVector(), state.bindings);
+
+    bool vertexBuffersChanged = !m_GraphicsStateValid || state.vertexBuffers.size() != m_GraphicsState.vertexBuffers.size();
+    for (size_t index = 0; !vertexBuffersChanged && index < state.vertexBuffers.size(); index++)
+    {
+        const nvrhi::VertexBufferBinding& a = state.vertexBuffers[index];
+        const nvrhi::VertexBufferBinding& b = m_GraphicsState.vertexBuffers[index];
+        vertexBuffersChanged = a.buffer != b.buffer || a.slot != b.slot || a.offset != b.offset;
+    }
+    if (vertexBuffersChanged && !state.vertexBuffers.empty())
+        ++m_Stats.vertexBufferChanges;
+
+    const nvrhi::IndexBufferBinding& index = state.indexBuffer;
+    if (index.buffer && (!m_GraphicsStateValid || index.buffer != m_GraphicsState.indexBuffer.buffer ||
+        index.offset != m_GraphicsState.indexBuffer.offset || index.format != m_GraphicsState.indexBuffer.format))
+    {
+        ++m_Stats.indexBufferChanges;
+    }
+
+    m_GraphicsState = state;
+    m_GraphicsStateValid = true;
+    m_ComputeStateValid = false;
+}
+
+void NullCommandList::draw(const nvrhi::DrawArguments& args)
+{
+    ++m_Stats.draws;
+    m_Stats.instances += args.instanceCount;
+    m_Stats.primitiveVertices += uint64_t(args.vertexCount) * args.instanceCount;
+    Record(NullCommandType::Draw, args.vertexCount);
+}
+
+void NullCommandList::drawIndexed(const nvrhi::DrawArguments& args)
+{
+    ++m_Stats.draws;
+    m_Stats.instances += args.instanceCount;
+    m_Stats.primitiveVertices += uint64_t(args.vertexCount) * args.instanceCount;
+    Record(NullCommandType::DrawIndexed, args.vertexCount);
+}
+
+void NullCommandList::drawIndirect(uint32_t offsetBytes, uint32_t drawCount)
+{
+    m_Stats.indirectDraws += drawCount;
+    Record(NullCommandType::DrawIndirect, drawCount);
+}
+
+void NullCommandList::drawIndexedIndirect(uint32_t offsetBytes, uint32_t drawCount)
+{
+    m_Stats.indirectDraws += drawCount;
+    Record(NullCommandType::DrawIndexedIndirect, drawCount);
+}
+
+void NullCommandList::setComputeState(const nvrhi::ComputeState& state)
+{
+    ++m_Stats.computeStateChanges;
+    Record(NullCommandType::SetComputeState, 0, state.pipeline);
+
+    if (!m_ComputeStateValid || state.pipeline != m_ComputeState.pipeline)
+        ++m_Stats.pipelineChanges;
+
+    CountBindingChanges(m_ComputeStateValid ? m_ComputeState.bindings : nvrhi::BindingSetVector(), state.bindings);
+
+    m_ComputeState = state;
+    m_ComputeStateValid = true;
+    m_GraphicsStateValid = false;
+}
+
+void NullCommandList::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+    ++m_Stats.dispatches;
+    Record(NullCommandType::Dispatch, uint64_t(groupsX) * groupsY * groupsZ);
+}
+
+void NullCommandList::dispatchIndirect(uint32_t offsetBytes)
+{
+    ++m_Stats.dispatches;
+    Record(NullCommandType::DispatchIndirect);
+}
+
+void NullCommandList::beginTimerQuery(nvrhi::ITimerQuery* query)
+{
+    Record(NullCommandType::BeginTimerQuery, 0, query);
+}
+
+void NullCommandList::endTimerQuery(nvrhi::ITimerQuery* query)
+{
+    Record(NullCommandType::EndTimerQuery, 0, query);
+}
+
+void NullCommandList::beginMarker(const char* name)
+{
+    ++m_Stats.markers;
+    Record(NullCommandType::BeginMarker);
+}
+
+void NullCommandList::endMarker()
+{
+    Record(NullCommandType::EndMarker);
+}
+
+void NullCommandList::beginTrackingTextureState(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_TextureStates[texture] = stateBits;
+}
+
+void NullCommandList::beginTrackingBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_BufferStates[buffer] = stateBits;
+}
+
+void NullCommandList::setTextureState(nvrhi::ITexture* texture, nvrhi::TextureSubresourceSet subresources, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_TextureStates[texture] = stateBits;
+}
+
+void NullCommandList::setBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_BufferStates[buffer] = stateBits;
+}
+
+void NullCommandList::setPermanentTextureState(nvrhi::ITexture* texture, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_TextureStates[texture] = stateBits;
+}
+
+void NullCommandList::setPermanentBufferState(nvrhi::IBuffer* buffer, nvrhi::ResourceStates stateBits)
+{
+    ++m_Stats.stateTransitions;
+    m_BufferStates[buffer] = stateBits;
+}
+
+nvrhi::ResourceStates NullCommandList::getTextureSubresourceState(nvrhi::ITexture* texture, nvrhi::ArraySlice arraySlice, nvrhi::MipLevel mipLevel)
+{
+    auto it = m_TextureStates.find(texture);
+    return it != m_TextureStates.end() ? it->second : nvrhi::ResourceStates::Unknown;
+}
+
+nvrhi::ResourceStates NullCommandList::getBufferState(nvrhi::IBuffer* buffer)
+{
+    auto it = m_BufferStates.find(buffer);
+    return it != m_BufferStates.end() ? it->second : nvrhi::ResourceStates::Unknown;
+}
+
+nvrhi::IDevice* NullCommandList::getDevice()
+{
+    return m_Device;
+}
+
+NullDevice::NullDevice(const NullDeviceDesc& desc)
+    : m_Desc(desc)
+{
+}
+
+NullDeviceStats NullDevice::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_Stats;
+}
+
+void NullDevice::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    m_Stats = NullDeviceStats();
+    m_QueueOperations.clear();
+}
+
+std::vector<NullQueueOperation> NullDevice::GetQueueOperations()
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    return m_QueueOperations;
+}
+
+void NullDevice::CountCreation(uint64_t NullDeviceStats::* counter, uint64_t NullDeviceStats::* bytesCounter, uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    ++(m_Stats.*counter);
+    if (bytesCounter)
+        m_Stats.*bytesCounter += bytes;
+}
+
+nvrhi::HeapHandle NullDevice::createHeap(const nvrhi::HeapDesc& d)
+{
+    return nvrhi::HeapHandle::Create(new NullHeap(d));
+}
+
+nvrhi::TextureHandle NullDevice::createTexture(const nvrhi::TextureDesc& d)
+{
+    CountCreation(&NullDeviceStats::texturesCreated, &NullDeviceStats::textureBytesCreated, GetTextureSize(d));
+    return nvrhi::TextureHandle::Create(new NullTexture(d));
+}
+
+nvrhi::MemoryRequirements NullDevice::getTextureMemoryRequirements(nvrhi::ITexture* texture)
+{
+    nvrhi::MemoryRequirements requirements;
+    requirements.size = GetTextureSize(texture->getDesc());
+    requirements.alignment = 65536;
+    return requirements;
+}
+
+nvrhi::TextureHandle NullDevice::createHandleForNativeTexture(nvrhi::ObjectType objectType, nvrhi::Object texture, const nvrhi::TextureDesc& desc)
+{
+    return nvrhi::TextureHandle::Create(new NullTexture(desc));
+}
+
+nvrhi::StagingTextureHandle NullDevice::createStagingTexture(const nvrhi::TextureDesc& d, nvrhi::CpuAccessMode cpuAccess)
+{
+    return nvrhi::StagingTextureHandle::Create(new NullStagingTexture(d));
+}
+
+void* NullDevice::mapStagingTexture(nvrhi::IStagingTexture* tex, const nvrhi::TextureSlice& slice, nvrhi::CpuAccessMode cpuAccess, size_t* outRowPitch)
+{
+    auto* stagingTexture = static_cast<NullStagingTexture*>(tex);
+    const nvrhi::TextureSlice resolvedSlice = slice.resolve(stagingTexture->desc);
+    const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(stagingTexture->desc.format);
+    const uint32_t blockSize = std::max(uint32_t(formatInfo.blockSize), 1u);
+
+    const size_t rowPitch = size_t((resolvedSlice.width + blockSize - 1) / blockSize) * formatInfo.bytesPerBlock;
+    const size_t rows = (resolvedSlice.height + blockSize - 1) / blockSize;
+    stagingTexture->data.resize(rowPitch * rows * std::max(resolvedSlice.depth, 1u));
+
+    if (outRowPitch)
+        *outRowPitch = rowPitch;
+
+    return stagingTexture->data.data();
+}
+
+void NullDevice::getTextureTiling(nvrhi::ITexture* texture, uint32_t* numTiles, nvrhi::PackedMipDesc* desc, nvrhi::TileShape* tileShape, uint32_t* subresourceTilingsNum, nvrhi::SubresourceTiling* subresourceTilings)
+{
+    if (numTiles)
+        *numTiles = 0;
+    if (subresourceTilingsNum)
+        *subresourceTilingsNum = 0;
+}
+
+nvrhi::BufferHandle NullDevice::createBuffer(const nvrhi::BufferDesc& d)
+{
+    CountCreation(&NullDeviceStats::buffersCreated, &NullDeviceStats::bufferBytesCreated, d.byteSize);
+
+    auto* buffer = new NullBuffer(d);
+    if (m_Desc.storeBufferContents || d.cpuAccess != nvrhi::CpuAccessMode::None)
+        buffer->data.resize(d.byteSize);
+
+    return nvrhi::BufferHandle::Create(buffer);
+}
+
+void* NullDevice::mapBuffer(nvrhi::IBuffer* buffer, nvrhi::CpuAccessMode cpuAccess)
+{
+    auto* nullBuffer = static_cast<NullBuffer*>(buffer);
+    if (nullBuffer->data.empty())
+        nullBuffer->data.resize(nullBuffer->desc.byteSize);
+
+    return nullBuffer->data.data();
+}
+
+nvrhi::MemoryRequirements NullDevice::getBufferMemoryRequirements(nvrhi::IBuffer* buffer)
+{
+    nvrhi::MemoryRequirements requirements;
+    requirements.size = buffer->getDesc().byteSize;
+    requirements.alignment = 256;
+    return requirements;
+}
+
+nvrhi::BufferHandle NullDevice::createHandleForNativeBuffer(nvrhi::ObjectType objectType, nvrhi::Object buffer, const nvrhi::BufferDesc& desc)
+{
+    return nvrhi::BufferHandle::Create(new NullBuffer(desc));
+}
+
+nvrhi::ShaderHandle NullDevice::createShader(const nvrhi::ShaderDesc& d, const void* binary, size_t binarySize)
+{
+    CountCreation(&NullDeviceStats::shadersCreated);
+
+    auto* shader = new NullShader(d);
+    if (binary && binarySize)
+        shader->bytecode.assign(static_cast<const uint8_t*>(binary), static_cast<const uint8_t*>(binary) + binarySize);
+
+    return nvrhi::ShaderHandle::Create(shader);
+}
+
+nvrhi::ShaderHandle NullDevice::createShaderSpecialization(nvrhi::IShader* baseShader, const nvrhi::ShaderSpecialization* constants, uint32_t numConstants)
+{
+    const auto* base = static_cast<const NullShader*>(baseShader);
+    return createShader(base->desc, base->bytecode.data(), base->bytecode.size());
+}
+
+nvrhi::ShaderLibraryHandle NullDevice::createShaderLibrary(const void* binary, size_t binarySize)
+{
+    auto* library = new NullShaderLibrary();
+    if (binary && binarySize)
+        library->bytecode.assign(static_cast<const uint8_t*>(binary), static_cast<const uint8_t*>(binary) + binarySize);
+
+    return nvrhi::ShaderLibraryHandle::Create(library);
+}
+
+nvrhi::SamplerHandle NullDevice::createSampler(const nvrhi::SamplerDesc& d)
+{
+    return nvrhi::SamplerHandle::Create(new NullSampler(d));
+}
+
+nvrhi::InputLayoutHandle NullDevice::createInputLayout(const nvrhi::VertexAttributeDesc* d, uint32_t attributeCount, nvrhi::IShader* vertexShader)
+{
+    auto* inputLayout = new NullInputLayout();
+    inputLayout->attributes.assign(d, d + attributeCount);
+    return nvrhi::InputLayoutHandle::Create(inputLayout);
+}
+
+nvrhi::EventQueryHandle NullDevice::createEventQuery()
+{
+    return nvrhi::EventQueryHandle::Create(new NullEventQuery());
+}
+
+nvrhi::TimerQueryHandle NullDevice::createTimerQuery()
+{
+    return nvrhi::TimerQueryHandle::Create(new NullTimerQuery());
+}
+
+nvrhi::FramebufferHandle NullDevice::createFramebuffer(const nvrhi::FramebufferDesc& desc)
+{
+    return nvrhi::FramebufferHandle::Create(new NullFramebuffer(desc));
+}
+
+nvrhi::GraphicsPipelineHandle NullDevice::createGraphicsPipeline(const nvrhi::GraphicsPipelineDesc& desc, nvrhi::IFramebuffer* fb)
+{
+    CountCreation(&NullDeviceStats::pipelinesCreated);
+
+    auto* pipeline = new NullGraphicsPipeline();
+    pipeline->desc = desc;
+    if (fb)
+        pipeline->framebufferInfo = fb->getFramebufferInfo();
+
+    return nvrhi::GraphicsPipelineHandle::Create(pipeline);
+}
+
+nvrhi::ComputePipelineHandle NullDevice::createComputePipeline(const nvrhi::ComputePipelineDesc& desc)
+{
+    CountCreation(&NullDeviceStats::pipelinesCreated);
+
+    auto* pipeline = new NullComputePipeline();
+    pipeline->desc = desc;
+    return nvrhi::ComputePipelineHandle::Create(pipeline);
+}
+
+nvrhi::BindingLayoutHandle NullDevice::createBindingLayout(const nvrhi::BindingLayoutDesc& desc)
+{
+    CountCreation(&NullDeviceStats::bindingLayoutsCreated);
+
+    auto* layout = new NullBindingLayout();
+    layout->desc = desc;
+    return nvrhi::BindingLayoutHandle::Create(layout);
+}
+
+nvrhi::BindingLayoutHandle NullDevice::createBindlessLayout(const nvrhi::BindlessLayoutDesc& desc)
+{
+    CountCreation(&NullDeviceStats::bindingLayoutsCreated);
+
+    auto* layout = new NullBindingLayout();
+    layout->bindlessDesc = desc;
+    layout->isBindless = true;
+    return nvrhi::BindingLayoutHandle::Create(layout);
+}
+
+nvrhi::BindingSetHandle NullDevice::createBindingSet(const nvrhi::BindingSetDesc& desc, nvrhi::IBindingLayout* layout)
+{
+    CountCreation(&NullDeviceStats::bindingSetsCreated);
+
+    auto* bindingSet = new NullBindingSet();
+    bindingSet->desc = desc;
+    bindingSet->layout = layout;
+    return nvrhi::BindingSetHandle::Create(bindingSet);
+}
+
+nvrhi::DescriptorTableHandle NullDevice::createDescriptorTable(nvrhi::IBindingLayout* layout)
+{
+    auto* descriptorTable = new NullDescriptorTable();
+    descriptorTable->layout = layout;
+    return nvrhi::DescriptorTableHandle::Create(descriptorTable);
+}
+
+void NullDevice::resizeDescriptorTable(nvrhi::IDescriptorTable* descriptorTable, uint32_t newSize, bool keepContents)
+{
+    static_cast<NullDescriptorTable*>(descriptorTable)->capacity = newSize;
+}
+
+bool NullDevice::writeDescriptorTable(nvrhi::IDescriptorTable* descriptorTable, const nvrhi::BindingSetItem& item)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        ++m_Stats.descriptorTableWrites;
+    }
+
+    return item.slot < descriptorTable->getCapacity();
+}
+
+nvrhi::CommandListHandle NullDevice::createCommandList(const nvrhi::CommandListParameters& params)
+{
+    return nvrhi::CommandListHandle::Create(new NullCommandList(this, params, m_Desc.recordCommands));
+}
+
+uint64_t NullDevice::executeCommandLists(nvrhi::ICommandList* const* pCommandLists, size_t numCommandLists, nvrhi::CommandQueue executionQueue)
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+    NullQueueOperation operation;
+    operation.type = NullQueueOperationType::Execute;
+    operation.queue = executionQueue;
+    operation.instance = ++m_LastSubmittedInstances[size_t(executionQueue)];
+
+    for (size_t index = 0; index < numCommandLists; index++)
+    {
+        auto* commandList = static_cast<NullCommandList*>(pCommandLists[index]);
+        m_Stats.commands.Accumulate(commandList->GetStats());
+        ++m_Stats.commandListsExecuted;
+        operation.dispatches += commandList->GetStats().dispatches;
+        if (m_Desc.recordCommands)
+            operation.commandLists.push_back(commandList);
+    }
+
+    if (m_Desc.recordCommands)
+        m_QueueOperations.push_back(operation);
+
+    return operation.instance;
+}
+
+void NullDevice::queueWaitForCommandList(nvrhi::CommandQueue waitQueue, nvrhi::CommandQueue executionQueue, uint64_t instance)
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+    if (m_Desc.recordCommands)
+    {
+        NullQueueOperation operation;
+        operation.type = NullQueueOperationType::Wait;
+        operation.queue = waitQueue;
+        operation.waitedQueue = executionQueue;
+        operation.instance = instance;
+        m_QueueOperations.push_back(operation);
+    }
+}
+
+bool NullDevice::queryFeatureSupport(nvrhi::Feature feature, void* pInfo, size_t infoSize)
+{
+    switch (feature)
+    {
+    case nvrhi::Feature::DeferredCommandLists:
+    case nvrhi::Feature::ComputeQueue:
+    case nvrhi::Feature::CopyQueue:
+        return true;
+    case nvrhi::Feature::VirtualResources:
+        return m_Desc.virtualResources;
+    default:
+        return false;
+    }
+}
+
+nvrhi::FormatSupport NullDevice::queryFormatSupport(nvrhi::Format format)
+{
+    return static_cast<nvrhi::FormatSupport>(~0u);
+}
+
+nvrhi::RefCountPtr<NullDevice> donut::tests::CreateNullDevice(const NullDeviceDesc& desc)
+{
+    return nvrhi::RefCountPtr<NullDevice>::Create(new NullDevice(desc));
+}
+
+uint8_t* donut::tests::GetNullBufferData(nvrhi::IBuffer* buffer)
+{
+    auto* nullBuffer = static_cast<NullBuffer*>(buffer);
+    return nullBuffer->data.empty() ? nullptr : nullBuffer->data.data();
+}
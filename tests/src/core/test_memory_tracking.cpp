@@ -0,0 +1,146 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/core/memory_tracking.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/tests/utils.h>
+#include <cstdlib>
+
+using namespace donut;
+
+void test_tags()
+{
+    const memory::Snapshot before = memory::GetSnapshot();
+
+    {
+        memory::Tag tag(memory::Category::MeshData, 1000);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == 1000);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].allocations == 1);
+
+        // Copies account for their own data, moves transfer it
+        memory::Tag copy = tag;
+        memory::Tag moved = std::move(tag);
+        CHECK(tag.GetBytes() == 0);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == 2000);
+
+        copy.Set(500);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == 1500);
+
+        moved.SetCategory(memory::Category::TextureData);
+        const memory::Snapshot diff = memory::Diff(before, memory::GetSnapshot());
+        CHECK(diff[memory::Category::MeshData].bytes == 500);
+        CHECK(diff[memory::Category::TextureData].bytes == 1000);
+        CHECK(diff[memory::Category::MeshData].allocations == 1);
+        CHECK(diff[memory::Category::TextureData].allocations == 1);
+
+        copy.Set(0);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].allocations == 0);
+    }
+
+    const memory::Snapshot diff = memory::Diff(before, memory::GetSnapshot());
+    for (const memory::CategoryStats& stats : diff.categories)
+    {
+        CHECK(stats.bytes == 0);
+        CHECK(stats.allocations == 0);
+    }
+    CHECK(memory::GetSnapshot()[memory::Category::MeshData].peakBytes >= before[memory::Category::MeshData].bytes + 2000);
+
+    memory::ResetPeaks();
+    const memory::Snapshot reset = memory::GetSnapshot();
+    CHECK(reset[memory::Category::MeshData].peakBytes == reset[memory::Category::MeshData].bytes);
+}
+
+void test_counting_allocator()
+{
+    const int64_t before = memory::GetSnapshot()[memory::Category::SceneGraph].bytes;
+
+    {
+        memory::vector<uint64_t, memory::Category::SceneGraph> values;
+        values.reserve(100);
+        CHECK(memory::GetSnapshot()[memory::Category::SceneGraph].bytes == before + 800);
+
+        values.resize(10);
+        values.shrink_to_fit();
+        CHECK(memory::GetSnapshot()[memory::Category::SceneGraph].bytes == before + 80);
+
+        auto copy = values;
+        CHECK(memory::GetSnapshot()[memory::Category::SceneGraph].bytes == before + 160);
+    }
+
+    CHECK(memory::GetSnapshot()[memory::Category::SceneGraph].bytes == before);
+}
+
+void test_blobs()
+{
+    const memory::Snapshot before = memory::GetSnapshot();
+
+    {
+        auto blob = std::make_shared<vfs::Blob>(malloc(256), 256);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::FileBlobs].bytes == 256);
+
+        blob->SetMemoryCategory(memory::Category::TextureData);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::FileBlobs].bytes == 0);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::TextureData].bytes == 256);
+    }
+
+    CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::TextureData].bytes == 0);
+}
+
+void test_report()
+{
+    CHECK(memory::FormatBytes(0) == "0 B");
+    CHECK(memory::FormatBytes(1023) == "1023 B");
+    CHECK(memory::FormatBytes(1536) == "1.50 KB");
+    CHECK(memory::FormatBytes(-3 * 1024 * 1024) == "-3.00 MB");
+
+    const memory::Snapshot before = memory::GetSnapshot();
+    memory::Tag tag(memory::Category::GpuTextures, 2048);
+    const memory::Snapshot after = memory::GetSnapshot();
+
+    const std::string report = memory::FormatReport(after);
+    for (size_t index = 0; index < memory::CategoryCount; index++)
+        CHECK(report.find(memory::GetCategoryName(memory::Category(index))) != std::string::npos);
+    CHECK(report.find("Total CPU") != std::string::npos);
+    CHECK(report.find("Total GPU") != std::string::npos);
+
+    const std::string diff = memory::FormatDiff(before, after);
+    CHECK(diff.find("+2.00 KB") != std::string::npos);
+    CHECK(memory::Diff(before, after).GetTotalBytes(true) == 2048);
+    CHECK(memory::Diff(before, after).GetTotalBytes(false) == 0);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_tags();
+        test_counting_allocator();
+        test_blobs();
+        test_report();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
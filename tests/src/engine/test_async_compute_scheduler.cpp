@@ -0,0 +1,232 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/AsyncComputeScheduler.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static void RecordJob(nvrhi::ICommandList* commandList)
+{
+    commandList->dispatch(4);
+}
+
+static nvrhi::CommandListHandle CreateGraphicsCommandList(nvrhi::IDevice* device)
+{
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    return commandList;
+}
+
+void test_queue_ordering()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.recordCommands = true;
+    auto device = CreateNullDevice(deviceDesc);
+    nvrhi::CommandListHandle commandList = CreateGraphicsCommandList(device);
+
+    AsyncComputeScheduler scheduler(device, true);
+    CHECK(scheduler.IsAsyncComputeActive());
+
+    nvrhi::TextureHandle sharedTexture = device->createTexture(nvrhi::TextureDesc()
+        .setWidth(64)
+        .setHeight(64)
+        .setFormat(nvrhi::Format::R8_UNORM)
+        .setIsUAV(true)
+        .setInitialState(nvrhi::ResourceStates::UnorderedAccess)
+        .setKeepInitialState(true));
+
+    AsyncComputeJob first = scheduler.ScheduleCompute(commandList, RecordJob, "First",
+        { { sharedTexture, nvrhi::ResourceStates::UnorderedAccess } });
+    AsyncComputeJob second = scheduler.ScheduleCompute(commandList, RecordJob, "Second");
+    CHECK(first.IsAsync() && second.IsAsync());
+    CHECK(first.computeInstance == 1 && second.computeInstance == 2);
+
+    // Waiting for the later job covers the earlier one
+    scheduler.WaitForCompute(commandList, second);
+    scheduler.WaitForCompute(commandList, first);
+    scheduler.WaitForCompute(commandList, second);
+
+    const std::vector<NullQueueOperation> operations = device->GetQueueOperations();
+    CHECK(operations.size() == 8);
+
+    // Each job waits for the graphics work recorded before it, and runs on the compute queue
+    for (int job = 0; job < 2; job++)
+    {
+        const NullQueueOperation& submit = operations[job * 3 + 0];
+        const NullQueueOperation& wait = operations[job * 3 + 1];
+        const NullQueueOperation& execute = operations[job * 3 + 2];
+
+        CHECK(submit.type == NullQueueOperationType::Execute && submit.queue == nvrhi::CommandQueue::Graphics);
+        CHECK(wait.type == NullQueueOperationType::Wait && wait.queue == nvrhi::CommandQueue::Compute);
+        CHECK(wait.waitedQueue == nvrhi::CommandQueue::Graphics && wait.instance == submit.instance);
+        CHECK(execute.type == NullQueueOperationType::Execute && execute.queue == nvrhi::CommandQueue::Compute);
+        CHECK(execute.instance == uint64_t(job + 1) && execute.dispatches == 1);
+        CHECK(submit.dispatches == 0);
+    }
+
+    // The graphics queue waits for the latest job once
+    CHECK(operations[6].type == NullQueueOperationType::Execute && operations[6].queue == nvrhi::CommandQueue::Graphics);
+    CHECK(operations[6].instance == 3);
+    CHECK(operations[7].type == NullQueueOperationType::Wait && operations[7].queue == nvrhi::CommandQueue::Graphics);
+    CHECK(operations[7].waitedQueue == nvrhi::CommandQueue::Compute && operations[7].instance == second.computeInstance);
+
+    const AsyncComputeStats& stats = scheduler.GetStats();
+    CHECK(stats.numAsyncJobs == 2);
+    CHECK(stats.numInlineJobs == 0);
+    CHECK(stats.numGraphicsSubmissions == 3);
+    CHECK(stats.numCrossQueueWaits == 1);
+
+    commandList->close();
+}
+
+void test_inline_jobs()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.recordCommands = true;
+    auto device = CreateNullDevice(deviceDesc);
+    nvrhi::CommandListHandle commandList = CreateGraphicsCommandList(device);
+
+    // A depth buffer cannot be handed over to the compute queue in its depth write state
+    nvrhi::TextureHandle depthTexture = device->createTexture(nvrhi::TextureDesc()
+        .setWidth(64)
+        .setHeight(64)
+        .setFormat(nvrhi::Format::D32)
+        .setIsRenderTarget(true)
+        .setInitialState(nvrhi::ResourceStates::DepthWrite)
+        .setKeepInitialState(true)
+        .setDebugName("Depth"));
+
+    // Neither can a buffer in a graphics-only handoff state
+    nvrhi::BufferHandle vertexBuffer = device->createBuffer(nvrhi::BufferDesc()
+        .setByteSize(256)
+        .setIsVertexBuffer(true)
+        .setDebugName("Vertices"));
+
+    AsyncComputeScheduler scheduler(device, true);
+
+    AsyncComputeJob job = scheduler.ScheduleCompute(commandList, RecordJob, "Depth",
+        { { depthTexture, nvrhi::ResourceStates::ShaderResource } });
+    CHECK(!job.IsAsync());
+    job = scheduler.ScheduleCompute(commandList, RecordJob, "Vertices", {},
+        { { vertexBuffer, nvrhi::ResourceStates::VertexBuffer } });
+    CHECK(!job.IsAsync());
+
+    CHECK(scheduler.GetStats().numRejectedJobs == 2);
+    CHECK(scheduler.GetStats().numInlineJobs == 2);
+    CHECK(static_cast<NullCommandList*>(commandList.Get())->GetStats().dispatches == 2);
+
+    // Disabled async compute records inline and makes the waits no-ops
+    scheduler.SetAsyncComputeEnabled(false);
+    job = scheduler.ScheduleCompute(commandList, RecordJob);
+    scheduler.WaitForCompute(commandList, job);
+    CHECK(!job.IsAsync());
+    CHECK(scheduler.GetStats().numInlineJobs == 3);
+    CHECK(scheduler.GetStats().numCrossQueueWaits == 0);
+    CHECK(static_cast<NullCommandList*>(commandList.Get())->GetStats().dispatches == 3);
+
+    CHECK(device->GetQueueOperations().empty());
+    commandList->close();
+}
+
+void test_resource_handoff()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.recordCommands = true;
+    auto device = CreateNullDevice(deviceDesc);
+    nvrhi::CommandListHandle commandList = CreateGraphicsCommandList(device);
+
+    nvrhi::TextureHandle inputTexture = device->createTexture(nvrhi::TextureDesc()
+        .setWidth(64)
+        .setHeight(64)
+        .setFormat(nvrhi::Format::R8_UNORM)
+        .setIsRenderTarget(true)
+        .setInitialState(nvrhi::ResourceStates::RenderTarget));
+
+    nvrhi::BufferHandle outputBuffer = device->createBuffer(nvrhi::BufferDesc()
+        .setByteSize(256)
+        .setCanHaveUAVs(true));
+
+    AsyncComputeScheduler scheduler(device, true);
+
+    commandList->beginTrackingTextureState(inputTexture, nvrhi::AllSubresources, nvrhi::ResourceStates::RenderTarget);
+    commandList->beginTrackingBufferState(outputBuffer, nvrhi::ResourceStates::CopyDest);
+
+    // The compute command list starts with the resources in the handoff states
+    nvrhi::ResourceStates computeTextureState = nvrhi::ResourceStates::Unknown;
+    nvrhi::ResourceStates computeBufferState = nvrhi::ResourceStates::Unknown;
+    auto record = [&](nvrhi::ICommandList* computeCommandList)
+    {
+        computeTextureState = computeCommandList->getTextureSubresourceState(inputTexture, 0, 0);
+        computeBufferState = computeCommandList->getBufferState(outputBuffer);
+        computeCommandList->dispatch(1);
+        computeCommandList->setBufferState(outputBuffer, nvrhi::ResourceStates::CopyDest);
+    };
+
+    AsyncComputeJob job = scheduler.ScheduleCompute(commandList, record, "Handoff",
+        { { inputTexture, nvrhi::ResourceStates::ShaderResource } },
+        { { outputBuffer, nvrhi::ResourceStates::UnorderedAccess } });
+
+    CHECK(job.IsAsync());
+    CHECK(computeTextureState == nvrhi::ResourceStates::ShaderResource);
+    CHECK(computeBufferState == nvrhi::ResourceStates::UnorderedAccess);
+
+    // The graphics command list was reopened and doesn't know the states until it waits for the job,
+    // which returns the resources to the handoff states
+    CHECK(commandList->getTextureSubresourceState(inputTexture, 0, 0) == nvrhi::ResourceStates::Unknown);
+
+    scheduler.WaitForCompute(commandList, job);
+    CHECK(commandList->getTextureSubresourceState(inputTexture, 0, 0) == nvrhi::ResourceStates::ShaderResource);
+    CHECK(commandList->getBufferState(outputBuffer) == nvrhi::ResourceStates::UnorderedAccess);
+
+    // The handoff is not repeated after the following submissions
+    job = scheduler.ScheduleCompute(commandList, RecordJob);
+    scheduler.WaitForCompute(commandList, job);
+    CHECK(commandList->getTextureSubresourceState(inputTexture, 0, 0) == nvrhi::ResourceStates::Unknown);
+
+    const std::vector<NullQueueOperation> operations = device->GetQueueOperations();
+    CHECK(operations.size() == 10);
+    CHECK(operations[2].queue == nvrhi::CommandQueue::Compute && operations[2].dispatches == 1);
+    CHECK(scheduler.GetStats().numAsyncJobs == 2);
+    CHECK(scheduler.GetStats().numRejectedJobs == 0);
+
+    commandList->close();
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_queue_ordering();
+        test_inline_jobs();
+        test_resource_handoff();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/BenchmarkResults.h>
+#include <donut/engine/KeyframeAnimation.h>
+#include <donut/tests/utils.h>
+
+#include <json/value.h>
+#include <cmath>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+
+void test_percentiles()
+{
+    std::vector<double> values;
+    for (int i = 100; i >= 1; i--)
+        values.push_back(double(i));
+
+    BenchmarkPercentiles p = BenchmarkResults::ComputePercentiles(values);
+    CHECK(p.numSamples == 100);
+    CHECK(p.min == 1.0);
+    CHECK(p.max == 100.0);
+    CHECK(std::abs(p.avg - 50.5) < 1e-9);
+    CHECK(p.p50 == 51.0);
+    CHECK(p.p95 == 95.0);
+    CHECK(p.p99 == 99.0);
+
+    BenchmarkPercentiles empty = BenchmarkResults::ComputePercentiles({});
+    CHECK(empty.numSamples == 0);
+}
+
+void test_hitches()
+{
+    BenchmarkResults results;
+    results.maxHitches = 2;
+
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        BenchmarkFrame frame;
+        frame.frameIndex = i;
+        frame.time = double(i) / 60.0;
+        frame.cpuTimeMs = (i == 5) ? 40.0 : (i == 12) ? 25.0 : (i == 17) ? 21.0 : 10.0;
+        size_t index = results.AddFrame(frame);
+        if (i % 2 == 0)
+            results.SetGpuTime(index, 8.0);
+    }
+
+    BenchmarkReport report = results.Analyze();
+    CHECK(report.cpu.numSamples == 20);
+    CHECK(report.gpu.numSamples == 10);
+    CHECK(report.gpu.p99 == 8.0);
+    CHECK(report.gpuHitches.empty());
+
+    // Frames 5, 12 and 17 are above 2x the median, only the two worst are kept
+    CHECK(report.cpuHitches.size() == 2);
+    CHECK(report.cpuHitches[0].frameIndex == 5);
+    CHECK(report.cpuHitches[1].frameIndex == 12);
+    CHECK(std::abs(report.cpuHitches[0].time - 5.0 / 60.0) < 1e-9);
+    CHECK(std::abs(report.cpuHitches[0].ratio - 4.0) < 1e-9);
+}
+
+void test_sequence_round_trip()
+{
+    animation::Sequence sequence;
+    auto track = std::make_shared<animation::Sampler>();
+    track->SetInterpolationMode(animation::InterpolationMode::CatmullRomSpline);
+    for (int i = 0; i < 4; i++)
+    {
+        animation::Keyframe keyframe;
+        keyframe.time = float(i);
+        keyframe.value = float4(float(i), float(i * i), 1.f, 0.f);
+        track->AddKeyframe(keyframe);
+    }
+    sequence.AddTrack("position", track);
+
+    Json::Value node;
+    sequence.Save(node);
+
+    animation::Sequence loaded;
+    loaded.Load(node);
+    CHECK(loaded.GetDuration() == 3.f);
+
+    auto loadedTrack = loaded.GetTrack("position");
+    CHECK(loadedTrack);
+    CHECK(loadedTrack->GetMode() == animation::InterpolationMode::CatmullRomSpline);
+    CHECK(loadedTrack->GetKeyframes().size() == 4);
+
+    for (float t = 0.f; t <= 3.f; t += 0.25f)
+    {
+        float4 expected = track->Evaluate(t, true).value();
+        float4 actual = loadedTrack->Evaluate(t, true).value();
+        CHECK(all(abs(expected - actual) < 1e-5f));
+    }
+
+    // Keyframes added after AddTrack only extend the sequence after RecomputeDuration
+    animation::Keyframe keyframe;
+    keyframe.time = 5.f;
+    loadedTrack->AddKeyframe(keyframe);
+    CHECK(loaded.GetDuration() == 3.f);
+    loaded.RecomputeDuration();
+    CHECK(loaded.GetDuration() == 5.f);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_percentiles();
+        test_hitches();
+        test_sequence_round_trip();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/BindingCache.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static nvrhi::BindingLayoutHandle CreateLayout(nvrhi::IDevice* device)
+{
+    nvrhi::BindingLayoutDesc layoutDesc;
+    layoutDesc.visibility = nvrhi::ShaderType::All;
+    layoutDesc.bindings = { nvrhi::BindingLayoutItem::ConstantBuffer(0) };
+    return device->createBindingLayout(layoutDesc);
+}
+
+static std::vector<nvrhi::BindingSetDesc> CreateDescs(nvrhi::IDevice* device, int count)
+{
+    std::vector<nvrhi::BindingSetDesc> descs;
+    for (int i = 0; i < count; i++)
+    {
+        nvrhi::BufferHandle buffer = device->createBuffer(nvrhi::BufferDesc()
+            .setByteSize(256)
+            .setIsConstantBuffer(true));
+
+        nvrhi::BindingSetDesc desc;
+        desc.bindings = { nvrhi::BindingSetItem::ConstantBuffer(0, buffer) };
+        descs.push_back(desc);
+    }
+    return descs;
+}
+
+void test_lookup()
+{
+    auto device = CreateNullDevice();
+    nvrhi::BindingLayoutHandle layoutA = CreateLayout(device);
+    nvrhi::BindingLayoutHandle layoutB = CreateLayout(device);
+    auto descs = CreateDescs(device, 2);
+
+    BindingCache cache(device);
+    CHECK(cache.GetCapacity() == BindingCache::DefaultCapacity);
+    CHECK(!cache.GetCachedBindingSet(descs[0], layoutA));
+
+    nvrhi::BindingSetHandle set0A = cache.GetOrCreateBindingSet(descs[0], layoutA);
+    CHECK(set0A);
+    CHECK(cache.GetOrCreateBindingSet(descs[0], layoutA) == set0A);
+    CHECK(cache.GetCachedBindingSet(descs[0], layoutA) == set0A);
+
+    // Entries are compared with the full descriptor and layout, not only by hash
+    nvrhi::BindingSetHandle set0B = cache.GetOrCreateBindingSet(descs[0], layoutB);
+    nvrhi::BindingSetHandle set1A = cache.GetOrCreateBindingSet(descs[1], layoutA);
+    CHECK(set0B && set0B != set0A);
+    CHECK(set1A && set1A != set0A && set1A != set0B);
+    CHECK(set0B->getLayout() == layoutB);
+    CHECK(*set1A->getDesc() == descs[1]);
+
+    BindingCacheStats stats = cache.GetStats();
+    CHECK(stats.size == 3);
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 4);
+    CHECK(stats.evictions == 0);
+
+    cache.Clear();
+    CHECK(cache.GetStats().size == 0);
+    CHECK(!cache.GetCachedBindingSet(descs[0], layoutA));
+}
+
+void test_lru_eviction()
+{
+    auto device = CreateNullDevice();
+    nvrhi::BindingLayoutHandle layout = CreateLayout(device);
+    auto descs = CreateDescs(device, 9);
+
+    BindingCache cache(device, 8);
+
+    std::vector<nvrhi::BindingSetHandle> sets;
+    for (int i = 0; i < 8; i++)
+        sets.push_back(cache.GetOrCreateBindingSet(descs[i], layout));
+
+    // Use the first half again within the same frame, the LRU order does not depend on BeginFrame()
+    for (int i = 0; i < 4; i++)
+        CHECK(cache.GetOrCreateBindingSet(descs[i], layout) == sets[i]);
+
+    // A full cache evicts 1/8 of its entries, which is the least recently used one here
+    cache.GetOrCreateBindingSet(descs[8], layout);
+    CHECK(cache.GetStats().size == 8);
+    CHECK(cache.GetStats().evictions == 1);
+    CHECK(!cache.GetCachedBindingSet(descs[4], layout));
+
+    for (int i = 0; i < 4; i++)
+        CHECK(cache.GetCachedBindingSet(descs[i], layout) == sets[i]);
+    for (int i = 5; i < 8; i++)
+        CHECK(cache.GetCachedBindingSet(descs[i], layout) == sets[i]);
+
+    // Shrinking the cache evicts immediately
+    cache.SetCapacity(4);
+    CHECK(cache.GetStats().size <= 4);
+
+    cache.SetCapacity(0);
+    for (int i = 0; i < 9; i++)
+        cache.GetOrCreateBindingSet(descs[i], layout);
+    CHECK(cache.GetStats().size == 9);
+}
+
+void test_age_out()
+{
+    auto device = CreateNullDevice();
+    nvrhi::BindingLayoutHandle layout = CreateLayout(device);
+    auto descs = CreateDescs(device, 2);
+
+    BindingCache cache(device, 0);
+    cache.SetMaxUnusedFrames(2);
+
+    cache.GetOrCreateBindingSet(descs[0], layout);
+    cache.GetOrCreateBindingSet(descs[1], layout);
+
+    cache.BeginFrame();
+    cache.GetOrCreateBindingSet(descs[0], layout);
+    cache.BeginFrame();
+    CHECK(cache.GetStats().size == 2);
+
+    // The second entry was last used 3 frames ago
+    cache.BeginFrame();
+    BindingCacheStats stats = cache.GetStats();
+    CHECK(stats.size == 1);
+    CHECK(stats.evictions == 1);
+    CHECK(cache.GetCachedBindingSet(descs[0], layout));
+
+    // The evicted binding set is recreated on demand
+    CHECK(cache.GetOrCreateBindingSet(descs[1], layout));
+
+    cache.BeginFrame();
+    cache.BeginFrame();
+    cache.BeginFrame();
+    CHECK(cache.GetStats().size == 0);
+    CHECK(cache.GetStats().evictions == 3);
+
+    cache.ResetStats();
+    stats = cache.GetStats();
+    CHECK(stats.hits == 0 && stats.misses == 0 && stats.evictions == 0);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_lookup();
+        test_lru_eviction();
+        test_age_out();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::tests;
+#include <donut/shaders/bindless.h>
+
+static std::shared_ptr<MeshInfo> CreateTriangleMesh()
+{
+    auto buffers = std::make_shared<BufferGroup>();
+    buffers->positionData = { float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f) };
+    buffers->indexData = { 0, 1, 2 };
+
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = std::make_shared<Material>();
+    geometry->numIndices = 3;
+    geometry->numVertices = 3;
+    geometry->objectSpaceBounds = box3(float3(0.f), float3(1.f, 1.f, 0.f));
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->buffers = buffers;
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+    mesh->totalIndices = 3;
+    mesh->totalVertices = 3;
+    return mesh;
+}
+
+// Returns the half float for element 'index' of the row-major 3x4 delta matrix
+static uint16_t GetDeltaElement(const PrevTransformDelta& delta, int index)
+{
+    const uint32_t packed[6] = { delta.packed0.x, delta.packed0.y, delta.packed0.z, delta.packed0.w, delta.packed1.x, delta.packed1.y };
+    return uint16_t(packed[index / 2] >> ((index & 1) * 16));
+}
+
+void test_prev_transform_deltas()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    auto device = CreateNullDevice(deviceDesc);
+
+    ShaderFactory shaderFactory(device, nullptr, "");
+    Scene scene(device, shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    scene.SetCompactInstanceData(true);
+
+    auto mesh = CreateTriangleMesh();
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    // static, tie rounding down to even, tie rounding up to even, teleport
+    const double offsets[] = { 0.0, 1.0 + 1.0 / 2048.0, 1.0 + 3.0 / 2048.0, 1.0e6 };
+    std::vector<std::shared_ptr<SceneGraphNode>> nodes;
+    for (double offset : offsets)
+    {
+        (void)offset;
+        nodes.push_back(sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(mesh)));
+    }
+
+    scene.SetSceneGraph(sceneGraph);
+    scene.FinishedLoading(0);
+    CHECK(scene.IsCompactInstanceDataEnabled());
+
+    for (size_t i = 0; i < nodes.size(); i++)
+        nodes[i]->SetTranslation(double3(offsets[i], 0.0, 0.0));
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    scene.Refresh(commandList, 1);
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    const CompactInstanceData* instances = reinterpret_cast<const CompactInstanceData*>(GetNullBufferData(scene.GetInstanceBuffer()));
+    const PrevTransformDelta* deltas = reinterpret_cast<const PrevTransformDelta*>(GetNullBufferData(scene.GetPrevTransformDeltaBuffer()));
+    CHECK(instances);
+    CHECK(deltas);
+
+    auto getInstance = [&](size_t nodeIndex) -> const CompactInstanceData&
+    {
+        auto instance = std::dynamic_pointer_cast<MeshInstance>(nodes[nodeIndex]->GetLeaf());
+        return instances[instance->GetInstanceIndex()];
+    };
+
+    auto hasDelta = [](const CompactInstanceData& instance)
+    {
+        return ((instance.flagsAndNumGeometries >> c_CompactInstanceFlagsShift) & InstanceFlags_HasPrevTransformDelta) != 0;
+    };
+
+    CHECK(!hasDelta(getInstance(0)));
+
+    // Translation x is element 3 of the first row, and the delta is prev - current
+    const CompactInstanceData& roundDown = getInstance(1);
+    CHECK(hasDelta(roundDown));
+    CHECK(GetDeltaElement(deltas[roundDown.prevTransformDeltaIndex], 3) == 0xbc00); // -1.0
+    CHECK(GetDeltaElement(deltas[roundDown.prevTransformDeltaIndex], 0) == 0);
+
+    const CompactInstanceData& roundUp = getInstance(2);
+    CHECK(hasDelta(roundUp));
+    CHECK(GetDeltaElement(deltas[roundUp.prevTransformDeltaIndex], 3) == 0xbc02); // -(1 + 2/1024)
+
+    // Deltas that overflow half precision are dropped instead of producing infinite motion
+    CHECK(!hasDelta(getInstance(3)));
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_prev_transform_deltas();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/DescriptorTableManager.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <set>
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static std::shared_ptr<DescriptorTableManager> CreateManager(nvrhi::IDevice* device)
+{
+    nvrhi::BindingLayoutHandle layout = device->createBindlessLayout(nvrhi::BindlessLayoutDesc());
+    return std::make_shared<DescriptorTableManager>(device, layout);
+}
+
+static std::vector<nvrhi::BufferHandle> CreateBuffers(nvrhi::IDevice* device, int count)
+{
+    std::vector<nvrhi::BufferHandle> buffers;
+    for (int i = 0; i < count; i++)
+        buffers.push_back(device->createBuffer(nvrhi::BufferDesc().setByteSize(256).setCanHaveRawViews(true)));
+    return buffers;
+}
+
+static nvrhi::BindingSetItem SRV(nvrhi::IBuffer* buffer)
+{
+    return nvrhi::BindingSetItem::RawBuffer_SRV(0, buffer);
+}
+
+void test_free_list()
+{
+    auto device = CreateNullDevice();
+    auto manager = CreateManager(device);
+    auto buffers = CreateBuffers(device, 4);
+
+    // The lowest slots are allocated first
+    DescriptorIndex a = manager->CreateDescriptor(SRV(buffers[0]));
+    DescriptorIndex b = manager->CreateDescriptor(SRV(buffers[1]));
+    DescriptorIndex c = manager->CreateDescriptor(SRV(buffers[2]));
+    CHECK(a == 0 && b == 1 && c == 2);
+    CHECK(manager->GetDescriptor(b).resourceHandle == buffers[1]);
+    CHECK(manager->GetDescriptor(b).slot == uint32_t(b));
+
+    // A released slot is reused by the next allocation
+    manager->ReleaseDescriptor(b);
+    CHECK(manager->GetDescriptor(b).resourceHandle == nullptr);
+    CHECK(manager->GetDescriptor(b).type == nvrhi::ResourceType::None);
+
+    DescriptorIndex d = manager->CreateDescriptor(SRV(buffers[3]));
+    CHECK(d == b);
+    CHECK(manager->GetDescriptor(d).resourceHandle == buffers[3]);
+
+    // The released item is not found by the index map anymore
+    DescriptorIndex b2 = manager->CreateDescriptor(SRV(buffers[1]));
+    CHECK(b2 == 3);
+
+    // Out of range indices return an empty descriptor
+    CHECK(manager->GetDescriptor(100000).type == nvrhi::ResourceType::None);
+}
+
+void test_reference_counts()
+{
+    auto device = CreateNullDevice();
+    auto manager = CreateManager(device);
+    auto buffers = CreateBuffers(device, 2);
+
+    DescriptorIndex first = manager->CreateDescriptor(SRV(buffers[0]));
+    DescriptorIndex second = manager->CreateDescriptor(SRV(buffers[0]));
+    CHECK(first == second);
+
+    // The slot stays allocated until every reference is released
+    manager->ReleaseDescriptor(first);
+    CHECK(manager->GetDescriptor(first).resourceHandle == buffers[0]);
+    manager->ReleaseDescriptor(second);
+    CHECK(manager->GetDescriptor(first).resourceHandle == nullptr);
+
+    // Handles for the same item share the index and each one owns a reference
+    {
+        DescriptorHandle handleA = manager->CreateDescriptorHandle(SRV(buffers[1]));
+        DescriptorIndex index;
+        {
+            DescriptorHandle handleB = manager->CreateDescriptorHandle(SRV(buffers[1]));
+            CHECK(handleA.Get() == handleB.Get());
+            index = handleA.Get();
+        }
+        CHECK(handleA.IsValid());
+        CHECK(manager->GetDescriptor(index).resourceHandle == buffers[1]);
+    }
+    CHECK(manager->GetDescriptor(0).resourceHandle == nullptr);
+
+    // Handles do not keep the manager alive
+    DescriptorHandle orphan = manager->CreateDescriptorHandle(SRV(buffers[1]));
+    manager = nullptr;
+    CHECK(!orphan.IsValid());
+}
+
+void test_grow()
+{
+    auto device = CreateNullDevice();
+    auto manager = CreateManager(device);
+    auto buffers = CreateBuffers(device, 65);
+
+    // The null descriptor table starts empty, so the first allocation grows it to 64 slots
+    std::set<DescriptorIndex> indices;
+    for (int i = 0; i < 64; i++)
+        indices.insert(manager->CreateDescriptor(SRV(buffers[i])));
+    CHECK(manager->GetDescriptorTable()->getCapacity() == 64);
+
+    DescriptorIndex last = manager->CreateDescriptor(SRV(buffers[64]));
+    indices.insert(last);
+    CHECK(manager->GetDescriptorTable()->getCapacity() == 128);
+    CHECK(last == 64);
+    CHECK(indices.size() == 65);
+    CHECK(*indices.rbegin() == 64);
+
+    // The existing descriptors survive the resize
+    for (int i = 0; i < 65; i++)
+        CHECK(manager->GetDescriptor(i).resourceHandle == buffers[i]);
+}
+
+void test_batched_writes()
+{
+    auto device = CreateNullDevice();
+    auto manager = CreateManager(device);
+    auto buffers = CreateBuffers(device, 4);
+
+    // Allocate the table storage before counting the writes
+    manager->ReleaseDescriptor(manager->CreateDescriptor(SRV(buffers[3])));
+    device->ResetStats();
+
+    manager->SetBatchedWrites(true);
+    CHECK(manager->IsBatchedWritesEnabled());
+
+    DescriptorIndex a = manager->CreateDescriptor(SRV(buffers[0]));
+    manager->CreateDescriptor(SRV(buffers[1]));
+    manager->CreateDescriptor(SRV(buffers[2]));
+    manager->ReleaseDescriptor(a);
+    CHECK(device->GetStats().descriptorTableWrites == 0);
+
+    // Each slot is written once per flush, no matter how many times it changed
+    manager->FlushPendingWrites();
+    CHECK(device->GetStats().descriptorTableWrites == 3);
+    manager->FlushPendingWrites();
+    CHECK(device->GetStats().descriptorTableWrites == 3);
+
+    // Disabling the batching flushes the pending writes
+    manager->CreateDescriptor(SRV(buffers[0]));
+    manager->SetBatchedWrites(false);
+    CHECK(!manager->IsBatchedWritesEnabled());
+    CHECK(device->GetStats().descriptorTableWrites == 4);
+
+    manager->CreateDescriptor(SRV(buffers[3]));
+    CHECK(device->GetStats().descriptorTableWrites == 5);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_free_list();
+        test_reference_counts();
+        test_grow();
+        test_batched_writes();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
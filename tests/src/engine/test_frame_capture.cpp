@@ -0,0 +1,271 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/FrameCapture.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static std::string GetFileName(const char* name)
+{
+    return (std::filesystem::path(DONUT_TEST_BINARY_DIR) / (std::string("test_frame_capture_") + name + ".raw")).generic_string();
+}
+
+// Records the written files in order. The encoder thread blocks on the file named 'blockedFile'
+// until Unblock() is called, which keeps its staging texture busy.
+class WrittenFiles
+{
+public:
+    std::string blockedFile;
+
+    void OnFileWritten(const std::string& fileName, bool success)
+    {
+        if (fileName == blockedFile)
+            m_Unblocked.wait();
+
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        m_Files.push_back(success ? fileName : std::string());
+        m_Condition.notify_all();
+    }
+
+    void Unblock() { m_Unblock.set_value(); }
+
+    void WaitFor(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this, count]() { return m_Files.size() >= count; });
+    }
+
+    std::vector<std::string> GetFiles()
+    {
+        std::lock_guard<std::mutex> lockGuard(m_Mutex);
+        return m_Files;
+    }
+
+private:
+    std::promise<void> m_Unblock;
+    std::shared_future<void> m_Unblocked = m_Unblock.get_future().share();
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<std::string> m_Files;
+};
+
+struct TestSetup
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    nvrhi::TextureHandle texture;
+    // Declared before the capture, which can still call back while it is destroyed
+    WrittenFiles writtenFiles;
+    std::unique_ptr<FrameCapture> capture;
+};
+
+// One encoder thread, so the files are written in the order of the encoding queue.
+// RAW captures of an RGBA8 texture are copied without a blit, so no CommonRenderPasses are needed.
+static void CreateSetup(TestSetup& setup, uint32_t numStagingTextures, FrameCaptureBackpressure backpressure)
+{
+    setup.device = CreateNullDevice();
+
+    nvrhi::TextureDesc textureDesc;
+    textureDesc.width = 16;
+    textureDesc.height = 8;
+    textureDesc.format = nvrhi::Format::RGBA8_UNORM;
+    setup.texture = setup.device->createTexture(textureDesc);
+
+    FrameCapture::CreateParameters params;
+    params.numStagingTextures = numStagingTextures;
+    params.numEncoderThreads = 1;
+    params.backpressure = backpressure;
+    params.onFileWritten = [&setup](const std::string& fileName, bool success)
+    {
+        setup.writtenFiles.OnFileWritten(fileName, success);
+    };
+    setup.capture = std::make_unique<FrameCapture>(setup.device, nullptr, params);
+}
+
+static bool Capture(TestSetup& setup, const std::string& fileName)
+{
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    commandList->open();
+    const bool result = setup.capture->Capture(commandList, setup.texture, fileName);
+    commandList->close();
+    setup.device->executeCommandList(commandList);
+    return result;
+}
+
+void test_drop_frames_when_full()
+{
+    TestSetup setup;
+    CreateSetup(setup, 2, FrameCaptureBackpressure::DropFrames);
+    setup.writtenFiles.blockedFile = GetFileName("drop_0");
+
+    // The first capture is stuck in the encoder, the second waits for it
+    CHECK(Capture(setup, GetFileName("drop_0")));
+    CHECK(Capture(setup, GetFileName("drop_1")));
+    setup.capture->Poll();
+
+    // Every staging texture is busy, the frame is dropped without waiting
+    CHECK(!Capture(setup, GetFileName("drop_2")));
+    FrameCaptureStats stats = setup.capture->GetStats();
+    CHECK(stats.captured == 2);
+    CHECK(stats.dropped == 1);
+    CHECK(stats.stalls == 0);
+
+    setup.writtenFiles.Unblock();
+    setup.capture->Flush();
+
+    stats = setup.capture->GetStats();
+    CHECK(stats.written == 2);
+    CHECK(stats.failed == 0);
+    CHECK(setup.writtenFiles.GetFiles() == std::vector<std::string>({ GetFileName("drop_0"), GetFileName("drop_1") }));
+
+    // The staging textures are free again
+    CHECK(Capture(setup, GetFileName("drop_3")));
+    setup.capture->Flush();
+    CHECK(setup.capture->GetStats().written == 3);
+}
+
+void test_wait_when_full()
+{
+    TestSetup setup;
+    CreateSetup(setup, 2, FrameCaptureBackpressure::Wait);
+    setup.writtenFiles.blockedFile = GetFileName("wait_0");
+
+    // Unsubmitted captures cannot be waited for, the frame is dropped instead of deadlocking
+    CHECK(Capture(setup, GetFileName("wait_0")));
+    CHECK(Capture(setup, GetFileName("wait_1")));
+    CHECK(!Capture(setup, GetFileName("wait_dropped")));
+    CHECK(setup.capture->GetStats().dropped == 1);
+
+    setup.capture->Poll();
+
+    // With both captures submitted, Capture() blocks until the encoder releases a staging texture
+    std::atomic<bool> unblocked = false;
+    std::thread unblockThread([&setup, &unblocked]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        unblocked = true;
+        setup.writtenFiles.Unblock();
+    });
+
+    CHECK(Capture(setup, GetFileName("wait_2")));
+    CHECK(unblocked);
+    unblockThread.join();
+
+    setup.capture->Flush();
+
+    const FrameCaptureStats stats = setup.capture->GetStats();
+    CHECK(stats.captured == 3);
+    CHECK(stats.written == 3);
+    CHECK(stats.dropped == 1);
+    CHECK(stats.stalls == 2);
+    CHECK(setup.writtenFiles.GetFiles() == std::vector<std::string>({ GetFileName("wait_0"), GetFileName("wait_1"), GetFileName("wait_2") }));
+}
+
+void test_encoding_order()
+{
+    TestSetup setup;
+    CreateSetup(setup, 3, FrameCaptureBackpressure::DropFrames);
+    setup.writtenFiles.blockedFile = GetFileName("order_0");
+
+    // Captures 0 and 1 use slots 0 and 1 and are submitted, 0 blocks the encoder
+    CHECK(Capture(setup, GetFileName("order_0")));
+    CHECK(Capture(setup, GetFileName("order_1")));
+    setup.capture->Poll();
+
+    // Capture 2 goes into slot 2 and is not fenced yet
+    CHECK(Capture(setup, GetFileName("order_2")));
+
+    setup.writtenFiles.Unblock();
+    setup.writtenFiles.WaitFor(2);
+
+    // Capture 3 reuses slot 0, which comes before slot 2 but must be encoded after it
+    CHECK(Capture(setup, GetFileName("order_3")));
+    setup.capture->Flush();
+
+    CHECK(setup.writtenFiles.GetFiles() == std::vector<std::string>({
+        GetFileName("order_0"), GetFileName("order_1"), GetFileName("order_2"), GetFileName("order_3") }));
+
+    // RAW files hold the texels without padding
+    CHECK(std::filesystem::file_size(GetFileName("order_3")) == 16 * 8 * 4);
+}
+
+void test_sequence_gaps()
+{
+    TestSetup setup;
+    CreateSetup(setup, 1, FrameCaptureBackpressure::DropFrames);
+
+    const std::filesystem::path directory = std::filesystem::path(DONUT_TEST_BINARY_DIR) / "test_frame_capture_sequence";
+    std::filesystem::remove_all(directory);
+    setup.capture->BeginSequence(directory, "raw");
+
+    // The second frame finds the only staging texture busy and leaves a gap in the numbering
+    auto captureFrame = [&setup]()
+    {
+        nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+        commandList->open();
+        const bool result = setup.capture->CaptureSequenceFrame(commandList, setup.texture);
+        commandList->close();
+        setup.device->executeCommandList(commandList);
+        return result;
+    };
+
+    CHECK(captureFrame());
+    CHECK(!captureFrame());
+    setup.capture->Flush();
+    CHECK(captureFrame());
+    setup.capture->EndSequence();
+    setup.capture->Flush();
+
+    CHECK(std::filesystem::exists(directory / "frame_00000.raw"));
+    CHECK(!std::filesystem::exists(directory / "frame_00001.raw"));
+    CHECK(std::filesystem::exists(directory / "frame_00002.raw"));
+    CHECK(!captureFrame());
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_drop_frames_when_full();
+        test_wait_when_full();
+        test_encoding_order();
+        test_sequence_gaps();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/MaterialBindingCache.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+struct TestResources
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    nvrhi::SamplerHandle sampler;
+    nvrhi::TextureHandle fallbackTexture;
+};
+
+static TestResources CreateResources()
+{
+    TestResources resources;
+    resources.device = CreateNullDevice();
+    resources.sampler = resources.device->createSampler(nvrhi::SamplerDesc());
+    resources.fallbackTexture = resources.device->createTexture(nvrhi::TextureDesc().setWidth(1).setHeight(1).setFormat(nvrhi::Format::RGBA8_UNORM));
+    return resources;
+}
+
+static std::unique_ptr<MaterialBindingCache> CreateCache(const TestResources& resources)
+{
+    std::vector<MaterialResourceBinding> bindings = {
+        { MaterialResource::ConstantBuffer, 0 },
+        { MaterialResource::DiffuseTexture, 0 },
+        { MaterialResource::Sampler, 0 }
+    };
+
+    return std::make_unique<MaterialBindingCache>(resources.device, nvrhi::ShaderType::Pixel, 0, false, bindings,
+        resources.sampler, resources.fallbackTexture);
+}
+
+static std::shared_ptr<Material> CreateMaterial(nvrhi::IDevice* device)
+{
+    auto material = std::make_shared<Material>();
+    material->materialConstants = device->createBuffer(nvrhi::BufferDesc().setByteSize(256).setIsConstantBuffer(true));
+    return material;
+}
+
+static unsigned long GetRefCount(nvrhi::IResource* resource)
+{
+    resource->AddRef();
+    return resource->Release();
+}
+
+void test_lookup_and_invalidation()
+{
+    TestResources resources = CreateResources();
+    auto cache = CreateCache(resources);
+    auto material = CreateMaterial(resources.device);
+
+    nvrhi::BindingSetHandle first = cache->GetMaterialBindingSet(material.get());
+    CHECK(first);
+    CHECK(first->getLayout() == cache->GetLayout());
+    CHECK(first->getDesc()->bindings[0].resourceHandle == material->materialConstants);
+    CHECK(first->getDesc()->bindings[1].resourceHandle == resources.fallbackTexture);
+    CHECK(cache->GetMaterialBindingSet(material.get()) == first);
+    CHECK(resources.device->GetStats().bindingSetsCreated == 1);
+
+    // Copies of a material start without binding sets
+    Material copy = *material;
+    nvrhi::BindingSetHandle copySet = cache->GetMaterialBindingSet(&copy);
+    CHECK(copySet && copySet != first);
+
+    // Invalidation creates a new binding set, the old one is kept alive for the readers until Clear()
+    material->materialConstants = resources.device->createBuffer(nvrhi::BufferDesc().setByteSize(256).setIsConstantBuffer(true));
+    material->bindingSlots.Invalidate();
+    nvrhi::BindingSetHandle second = cache->GetMaterialBindingSet(material.get());
+    CHECK(second && second != first);
+    CHECK(second->getDesc()->bindings[0].resourceHandle == material->materialConstants);
+    CHECK(GetRefCount(first) == 2);
+    CHECK(GetRefCount(second) == 2);
+
+    // Clear() removes the binding sets from the materials
+    cache->Clear();
+    CHECK(GetRefCount(first) == 1);
+    CHECK(GetRefCount(second) == 1);
+    CHECK(GetRefCount(copySet) == 1);
+
+    nvrhi::BindingSetHandle third = cache->GetMaterialBindingSet(material.get());
+    CHECK(third && third != second);
+}
+
+void test_destruction_and_slot_reuse()
+{
+    TestResources resources = CreateResources();
+    auto material = CreateMaterial(resources.device);
+    auto shortLivedMaterial = CreateMaterial(resources.device);
+
+    auto cacheA = CreateCache(resources);
+    nvrhi::BindingSetHandle setA = cacheA->GetMaterialBindingSet(material.get());
+    cacheA->GetMaterialBindingSet(shortLivedMaterial.get());
+    CHECK(GetRefCount(setA) == 2);
+
+    // Materials that die before the cache release their entries themselves
+    shortLivedMaterial = nullptr;
+
+    // The destroyed cache removes its binding sets from the materials that are still alive
+    cacheA = nullptr;
+    CHECK(GetRefCount(setA) == 1);
+
+    // A new cache reuses the slot without seeing the entries of the destroyed one
+    auto cacheB = CreateCache(resources);
+    nvrhi::BindingSetHandle setB = cacheB->GetMaterialBindingSet(material.get());
+    CHECK(setB && setB != setA);
+    CHECK(setB->getLayout() == cacheB->GetLayout());
+
+    // The material outlives the cache, and the cache outlives other materials
+    auto otherMaterial = CreateMaterial(resources.device);
+    CHECK(cacheB->GetMaterialBindingSet(otherMaterial.get()));
+    otherMaterial = nullptr;
+    cacheB = nullptr;
+    CHECK(GetRefCount(setB) == 1);
+}
+
+void test_slot_overflow()
+{
+    TestResources resources = CreateResources();
+    auto material = CreateMaterial(resources.device);
+
+    // The caches beyond the slot count use the locked map and still return distinct binding sets
+    std::vector<std::unique_ptr<MaterialBindingCache>> caches;
+    std::vector<nvrhi::BindingSetHandle> sets;
+    for (uint32_t i = 0; i < MaterialBindingCache::MaxSlots + 2; i++)
+    {
+        caches.push_back(CreateCache(resources));
+        sets.push_back(caches.back()->GetMaterialBindingSet(material.get()));
+        CHECK(sets.back());
+        CHECK(caches.back()->GetMaterialBindingSet(material.get()) == sets.back());
+    }
+
+    for (size_t i = 1; i < sets.size(); i++)
+        CHECK(sets[i] != sets[i - 1]);
+
+    // Invalidation makes the binding sets stale in the caches with slots and in the locked map
+    material->materialConstants = resources.device->createBuffer(nvrhi::BufferDesc().setByteSize(256).setIsConstantBuffer(true));
+    material->bindingSlots.Invalidate();
+    for (size_t i = 0; i < caches.size(); i++)
+    {
+        nvrhi::BindingSetHandle updated = caches[i]->GetMaterialBindingSet(material.get());
+        CHECK(updated && updated != sets[i]);
+        CHECK(updated->getDesc()->bindings[0].resourceHandle == material->materialConstants);
+        CHECK(caches[i]->GetMaterialBindingSet(material.get()) == updated);
+
+        // The stale set is kept alive for the readers until Clear()
+        CHECK(GetRefCount(sets[i]) == 2);
+    }
+
+    caches.back()->Clear();
+    CHECK(GetRefCount(sets.back()) == 1);
+
+    caches.clear();
+    for (const auto& set : sets)
+        CHECK(GetRefCount(set) == 1);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_lookup_and_invalidation();
+        test_destruction_and_slot_reuse();
+        test_slot_overflow();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/MemoryReport.h>
+#include <donut/engine/ConsoleInterpreter.h>
+#include <donut/engine/KeyframeAnimation.h>
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGenerator.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::math;
+using namespace donut::tests;
+
+void test_gpu_memory_size()
+{
+    nvrhi::TextureDesc desc;
+    desc.width = 256;
+    desc.height = 128;
+    desc.format = nvrhi::Format::RGBA8_UNORM;
+    CHECK(GetGpuMemorySize(desc) == 256 * 128 * 4);
+
+    desc.mipLevels = 2;
+    desc.arraySize = 6;
+    CHECK(GetGpuMemorySize(desc) == (256 * 128 + 128 * 64) * 4 * 6);
+
+    // Block compressed formats round up to whole blocks
+    desc.width = 6;
+    desc.height = 6;
+    desc.mipLevels = 1;
+    desc.arraySize = 1;
+    desc.format = nvrhi::Format::BC1_UNORM;
+    CHECK(GetGpuMemorySize(desc) == 2 * 2 * 8);
+
+    auto device = CreateNullDevice();
+    nvrhi::BufferHandle buffer = device->createBuffer(nvrhi::BufferDesc().setByteSize(1000));
+    CHECK(GetGpuMemorySize(buffer) == 1000);
+    CHECK(GetGpuMemorySize(static_cast<nvrhi::IBuffer*>(nullptr)) == 0);
+}
+
+void test_snapshots()
+{
+    MemoryReport report;
+    CHECK(report.RegisterConsoleCommands());
+
+    console::Interpreter interpreter;
+    CHECK(interpreter.Execute("memory snapshot before").status);
+
+    {
+        memory::Tag tag(memory::Category::GpuRenderTargets, 4096);
+        report.SaveSnapshot("after");
+
+        auto result = interpreter.Execute("memory diff before after");
+        CHECK(result.status);
+        CHECK(result.output.find("+4.00 KB") != std::string::npos);
+
+        result = interpreter.Execute("memory report");
+        CHECK(result.status && result.output.find("GpuRenderTargets") != std::string::npos);
+    }
+
+    memory::Snapshot before;
+    memory::Snapshot after;
+    CHECK(report.GetSnapshot("before", before));
+    CHECK(report.GetSnapshot("after", after));
+    CHECK(memory::Diff(before, after)[memory::Category::GpuRenderTargets].bytes == 4096);
+    CHECK(report.GetSnapshotNames().size() == 2);
+
+    CHECK(!interpreter.Execute("memory diff missing").status);
+
+    report.DeleteSnapshot("after");
+    CHECK(!report.GetSnapshot("after", after));
+}
+
+void test_data_tags()
+{
+    const memory::Snapshot before = memory::GetSnapshot();
+
+    {
+        animation::Sampler sampler;
+        for (int i = 0; i < 10; i++)
+        {
+            animation::Keyframe keyframe;
+            keyframe.time = float(i);
+            sampler.AddKeyframe(keyframe);
+        }
+
+        const size_t keyframeBytes = sampler.GetKeyframes().capacity() * sizeof(animation::Keyframe);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::AnimationKeyframes].bytes == int64_t(keyframeBytes));
+
+        // Mesh data is counted when the code that fills or releases the arrays updates the tag
+        BufferGroup buffers;
+        buffers.positionData.resize(100);
+        buffers.indexData.resize(300);
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == 0);
+
+        buffers.updateCpuMemory();
+        const size_t meshBytes = buffers.getCpuDataSize();
+        CHECK(meshBytes >= 100 * sizeof(float3) + 300 * sizeof(uint32_t));
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == int64_t(meshBytes));
+
+        BufferGroup copy = buffers;
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == int64_t(meshBytes * 2));
+
+        std::vector<float3>().swap(buffers.positionData);
+        std::vector<uint32_t>().swap(buffers.indexData);
+        buffers.updateCpuMemory();
+        CHECK(memory::Diff(before, memory::GetSnapshot())[memory::Category::MeshData].bytes == int64_t(meshBytes));
+    }
+
+    const memory::Snapshot released = memory::Diff(before, memory::GetSnapshot());
+    CHECK(released[memory::Category::AnimationKeyframes].bytes == 0);
+    CHECK(released[memory::Category::MeshData].bytes == 0);
+}
+
+void test_scene_memory()
+{
+    const memory::Snapshot before = memory::GetSnapshot();
+
+    {
+        auto device = CreateNullDevice();
+        ShaderFactory shaderFactory(device, nullptr, "");
+        Scene scene(device, shaderFactory, nullptr, nullptr, nullptr, nullptr);
+
+        SceneGeneratorParameters params;
+        params.nodeCount = 200;
+        SceneGenerator generator(nullptr);
+        auto sceneGraph = generator.Generate(params);
+        const SceneGeneratorStats& stats = generator.GetStats();
+
+        const memory::Snapshot generated = memory::Diff(before, memory::GetSnapshot());
+        CHECK(generated[memory::Category::SceneGraph].bytes >= int64_t(stats.nodes * sizeof(SceneGraphNode)));
+        CHECK(generated[memory::Category::MeshData].bytes >= int64_t(stats.vertices * sizeof(float3) + stats.indices * sizeof(uint32_t)));
+        CHECK(generated[memory::Category::AnimationKeyframes].bytes > 0);
+        CHECK(generated[memory::Category::GpuMeshBuffers].bytes == 0);
+
+        scene.SetSceneGraph(sceneGraph);
+        scene.FinishedLoading(0);
+
+        // The vertex and index data moved to the GPU
+        const memory::Snapshot loaded = memory::Diff(before, memory::GetSnapshot());
+        CHECK(loaded[memory::Category::MeshData].bytes == 0);
+        CHECK(loaded[memory::Category::GpuMeshBuffers].bytes >= int64_t(stats.vertices * sizeof(float3) + stats.indices * sizeof(uint32_t)));
+        CHECK(loaded[memory::Category::GpuSceneBuffers].bytes > 0);
+    }
+
+    const memory::Snapshot released = memory::Diff(before, memory::GetSnapshot());
+    for (const memory::CategoryStats& stats : released.categories)
+        CHECK(stats.bytes == 0);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_gpu_memory_size();
+        test_snapshots();
+        test_data_tags();
+        test_scene_memory();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static std::shared_ptr<MeshInfo> CreateTriangleMesh(const std::shared_ptr<Material>& material)
+{
+    auto buffers = std::make_shared<BufferGroup>();
+    buffers->positionData = { float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f) };
+    buffers->indexData = { 0, 1, 2 };
+
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = material;
+    geometry->numIndices = 3;
+    geometry->numVertices = 3;
+    geometry->objectSpaceBounds = box3(float3(0.f), float3(1.f, 1.f, 0.f));
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->name = "Triangle";
+    mesh->buffers = buffers;
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+    mesh->totalIndices = 3;
+    mesh->totalVertices = 3;
+    return mesh;
+}
+
+void test_command_counters()
+{
+    auto device = CreateNullDevice();
+
+    nvrhi::BufferHandle buffer = device->createBuffer(nvrhi::BufferDesc().setByteSize(256));
+    CHECK(buffer);
+
+    nvrhi::GraphicsPipelineHandle pipeline = device->createGraphicsPipeline(nvrhi::GraphicsPipelineDesc(), nullptr);
+    nvrhi::BindingSetHandle bindingSetA = device->createBindingSet(nvrhi::BindingSetDesc(), nullptr);
+    nvrhi::BindingSetHandle bindingSetB = device->createBindingSet(nvrhi::BindingSetDesc(), nullptr);
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+
+    uint32_t data[16] = {};
+    commandList->writeBuffer(buffer, data, sizeof(data));
+
+    nvrhi::GraphicsState state;
+    state.pipeline = pipeline;
+    state.bindings = { bindingSetA };
+    commandList->setGraphicsState(state);
+    commandList->draw(nvrhi::DrawArguments().setVertexCount(3).setInstanceCount(4));
+
+    // Same pipeline, different binding set
+    state.bindings = { bindingSetB };
+    commandList->setGraphicsState(state);
+    commandList->drawIndexed(nvrhi::DrawArguments().setVertexCount(6));
+    commandList->drawIndexedIndirect(0, 5);
+
+    commandList->close();
+
+    const NullCommandListStats& listStats = static_cast<NullCommandList*>(commandList.Get())->GetStats();
+    CHECK(listStats.draws == 2);
+    CHECK(listStats.indirectDraws == 5);
+    CHECK(listStats.instances == 5);
+    CHECK(listStats.primitiveVertices == 18);
+    CHECK(listStats.graphicsStateChanges == 2);
+    CHECK(listStats.pipelineChanges == 1);
+    CHECK(listStats.bindingSetChanges == 2);
+    CHECK(listStats.writeBufferCalls == 1);
+    CHECK(listStats.writeBufferBytes == sizeof(data));
+
+    // Stats reach the device only when the command list is executed
+    CHECK(device->GetStats().commandListsExecuted == 0);
+    device->executeCommandList(commandList);
+
+    NullDeviceStats deviceStats = device->GetStats();
+    CHECK(deviceStats.commandListsExecuted == 1);
+    CHECK(deviceStats.buffersCreated == 1);
+    CHECK(deviceStats.bufferBytesCreated == 256);
+    CHECK(deviceStats.pipelinesCreated == 1);
+    CHECK(deviceStats.commands.draws == 2);
+
+    // Queries complete immediately
+    nvrhi::EventQueryHandle query = device->createEventQuery();
+    device->setEventQuery(query, nvrhi::CommandQueue::Graphics);
+    CHECK(device->pollEventQuery(query));
+}
+
+void test_buffer_contents()
+{
+    NullDeviceDesc desc;
+    desc.storeBufferContents = true;
+    desc.recordCommands = true;
+    auto device = CreateNullDevice(desc);
+
+    nvrhi::BufferHandle source = device->createBuffer(nvrhi::BufferDesc().setByteSize(16));
+    nvrhi::BufferHandle dest = device->createBuffer(nvrhi::BufferDesc().setByteSize(16));
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    const uint32_t values[4] = { 1, 2, 3, 4 };
+    commandList->writeBuffer(source, values, sizeof(values));
+    commandList->clearBufferUInt(dest, 7);
+    commandList->copyBuffer(dest, 8, source, 0, 8);
+    commandList->close();
+
+    const uint32_t* result = reinterpret_cast<const uint32_t*>(GetNullBufferData(dest));
+    CHECK(result);
+    CHECK(result[0] == 7 && result[1] == 7 && result[2] == 1 && result[3] == 2);
+
+    const std::vector<NullCommand>& commands = static_cast<NullCommandList*>(commandList.Get())->GetCommands();
+    CHECK(commands.size() == 3);
+    CHECK(commands[0].type == NullCommandType::WriteBuffer && commands[0].value == sizeof(values));
+    CHECK(commands[2].type == NullCommandType::CopyBuffer && commands[2].resource == dest.Get());
+}
+
+void test_scene_refresh()
+{
+    auto device = CreateNullDevice();
+
+    // Without a file system, ShaderFactory returns null shaders, which the null device accepts
+    ShaderFactory shaderFactory(device, nullptr, "");
+    Scene scene(device, shaderFactory, nullptr, nullptr, nullptr, nullptr);
+
+    auto material = std::make_shared<Material>();
+    material->name = "Material";
+    auto mesh = CreateTriangleMesh(material);
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    const int numInstances = 64;
+    std::vector<std::shared_ptr<SceneGraphNode>> nodes;
+    for (int i = 0; i < numInstances; i++)
+    {
+        auto node = sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(mesh));
+        node->SetTranslation(double3(double(i), 0.0, 0.0));
+        nodes.push_back(node);
+    }
+
+    scene.SetSceneGraph(sceneGraph);
+    scene.FinishedLoading(0);
+
+    CHECK(sceneGraph->GetMeshInstances().size() == numInstances);
+    CHECK(mesh->buffers->indexBuffer);
+    CHECK(mesh->buffers->vertexBuffer);
+    CHECK(scene.GetInstanceBuffer());
+    CHECK(scene.GetMaterialBuffer());
+    CHECK(material->materialConstants);
+
+    NullDeviceStats loadStats = device->GetStats();
+    CHECK(loadStats.commandListsExecuted == 1);
+    CHECK(loadStats.commands.writeBufferBytes > 0);
+
+    // Moving one node re-uploads the instance data, but not the meshes
+    device->ResetStats();
+    nodes[5]->SetTranslation(double3(0.0, 10.0, 0.0));
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    scene.Refresh(commandList, 1);
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    NullDeviceStats refreshStats = device->GetStats();
+    CHECK(refreshStats.buffersCreated == 0);
+    CHECK(refreshStats.commands.writeBufferCalls > 0);
+    CHECK(refreshStats.commands.writeBufferBytes < loadStats.commands.writeBufferBytes);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_command_counters();
+        test_buffer_contents();
+        test_scene_refresh();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
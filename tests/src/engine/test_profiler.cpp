@@ -0,0 +1,220 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/Profiler.h>
+#include <donut/tests/utils.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+
+// Only CPU scopes are used here, which don't need a device
+
+static void RecordFrame(int innerScopes)
+{
+    DONUT_PROFILE_CPU_SCOPE("Frame");
+
+    for (int i = 0; i < innerScopes; i++)
+    {
+        DONUT_PROFILE_CPU_SCOPE("Inner");
+    }
+
+    {
+        DONUT_PROFILE_CPU_SCOPE("Other");
+    }
+}
+
+static const ProfilerScopeStats* FindScope(const std::vector<ProfilerScopeStats>& stats, const char* name)
+{
+    for (const auto& scope : stats)
+    {
+        if (scope.name == name)
+            return &scope;
+    }
+    return nullptr;
+}
+
+void test_inactive_profiler()
+{
+    Profiler::SetActive(nullptr);
+
+    Profiler profiler(nullptr, Profiler::CreateParameters());
+    profiler.BeginFrame();
+    RecordFrame(1);
+    profiler.EndFrame();
+    profiler.BeginFrame();
+    profiler.EndFrame();
+
+    CHECK(profiler.GetStats(false).empty());
+}
+
+void test_scope_hierarchy()
+{
+    Profiler::CreateParameters params;
+    params.historyFrames = 8;
+    Profiler profiler(nullptr, params);
+    Profiler::SetActive(&profiler);
+
+    for (int frame = 0; frame < 12; frame++)
+    {
+        profiler.BeginFrame();
+        RecordFrame(3);
+        profiler.EndFrame();
+    }
+
+    // Frames are resolved at the next BeginFrame
+    profiler.BeginFrame();
+    profiler.EndFrame();
+
+    std::vector<ProfilerScopeStats> stats = profiler.GetStats(false);
+    CHECK(stats.size() == 3);
+    CHECK(stats[0].name == "Frame");
+    CHECK(stats[1].name == "Inner");
+    CHECK(stats[2].name == "Other");
+
+    const ProfilerScopeStats* frame = FindScope(stats, "Frame");
+    const ProfilerScopeStats* inner = FindScope(stats, "Inner");
+    CHECK(frame && frame->depth == 0);
+    CHECK(inner && inner->depth == 1);
+    CHECK(frame->numSamples == params.historyFrames);
+    CHECK(frame->minMs <= frame->p50Ms && frame->p50Ms <= frame->p95Ms && frame->p95Ms <= frame->maxMs);
+    // Repeated scopes in a frame are summed, so the children cannot exceed the parent
+    CHECK(inner->avgMs <= frame->avgMs);
+
+    CHECK(profiler.GetStats(true).empty());
+
+    profiler.ResetStats();
+    CHECK(profiler.GetStats(false).empty());
+
+    Profiler::SetActive(nullptr);
+}
+
+void test_worker_threads()
+{
+    Profiler profiler(nullptr, Profiler::CreateParameters());
+    Profiler::SetActive(&profiler);
+
+    const int numThreads = 4;
+    const int numFrames = 3;
+
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        profiler.BeginFrame();
+
+        // Each thread records into its own buffer, which is merged into the frame at EndFrame
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; i++)
+        {
+            threads.emplace_back([]()
+            {
+                DONUT_PROFILE_CPU_SCOPE("Worker");
+                for (int task = 0; task < 3; task++)
+                {
+                    DONUT_PROFILE_CPU_SCOPE("Task");
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        RecordFrame(1);
+        profiler.EndFrame();
+    }
+
+    // A scope that is still open at EndFrame is dropped
+    profiler.BeginFrame();
+    {
+        DONUT_PROFILE_CPU_SCOPE("Spanning");
+        profiler.EndFrame();
+        profiler.BeginFrame();
+    }
+    profiler.EndFrame();
+    profiler.BeginFrame();
+    profiler.EndFrame();
+
+    std::vector<ProfilerScopeStats> stats = profiler.GetStats(false);
+    const ProfilerScopeStats* worker = FindScope(stats, "Worker");
+    const ProfilerScopeStats* task = FindScope(stats, "Task");
+    const ProfilerScopeStats* frame = FindScope(stats, "Frame");
+    CHECK(worker && worker->depth == 0 && worker->numSamples == numFrames);
+    CHECK(task && task->depth == 1 && task->numSamples == numFrames);
+    CHECK(frame && frame->depth == 0 && frame->numSamples == numFrames);
+    CHECK(task->avgMs <= worker->avgMs);
+    CHECK(!FindScope(stats, "Spanning"));
+
+    Profiler::SetActive(nullptr);
+}
+
+void test_chrome_trace()
+{
+    Profiler profiler(nullptr, Profiler::CreateParameters());
+    Profiler::SetActive(&profiler);
+
+    const std::filesystem::path fileName = std::filesystem::path(DONUT_TEST_BINARY_DIR) / "test_profiler_trace.json";
+    std::filesystem::remove(fileName);
+
+    CHECK(profiler.BeginCapture(2, fileName.string()));
+    CHECK(!profiler.BeginCapture(2, fileName.string()));
+
+    for (int frame = 0; frame < 4; frame++)
+    {
+        profiler.BeginFrame();
+        RecordFrame(1);
+        profiler.EndFrame();
+    }
+
+    CHECK(!profiler.IsCapturing());
+    CHECK(std::filesystem::exists(fileName));
+
+    std::ifstream file(fileName);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string trace = contents.str();
+
+    CHECK(trace.rfind("{\"traceEvents\":[", 0) == 0);
+    CHECK(trace.find("\"name\":\"Inner\"") != std::string::npos);
+    CHECK(trace.find("},\n]") == std::string::npos);
+
+    Profiler::SetActive(nullptr);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_inactive_profiler();
+        test_scope_hierarchy();
+        test_worker_threads();
+        test_chrome_trace();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/GltfImporter.h>
+#include <donut/engine/SceneGenerator.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/TextureCache.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/core/json.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+#include <json/reader.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+
+static SceneGeneratorParameters GetTestParameters()
+{
+    SceneGeneratorParameters params;
+    params.seed = 7;
+    params.nodeCount = 500;
+    params.maxDepth = 4;
+    params.fanOut = 6;
+    params.instanceRatio = 0.5f;
+    params.meshReuseRatio = 0.75f;
+    params.geometriesPerMesh = 2;
+    params.materialCount = 8;
+    params.alphaTestedMaterialRatio = 0.25f;
+    params.alphaBlendedMaterialRatio = 0.25f;
+    params.lightCount = 5;
+    params.animatedNodeRatio = 0.1f;
+    return params;
+}
+
+void test_generate()
+{
+    const SceneGeneratorParameters params = GetTestParameters();
+
+    SceneGenerator generator(nullptr);
+    std::shared_ptr<SceneGraph> sceneGraph = generator.Generate(params);
+    CHECK(sceneGraph && sceneGraph->GetRootNode());
+    sceneGraph->Refresh(0);
+
+    const SceneGeneratorStats& stats = generator.GetStats();
+    CHECK(stats.nodes == params.nodeCount);
+    CHECK(stats.maxDepth == params.maxDepth);
+    CHECK(stats.meshInstances == 250);
+    CHECK(stats.lights == params.lightCount);
+    CHECK(stats.animatedNodes == 50);
+    CHECK(stats.meshes < stats.meshInstances);
+    CHECK(stats.materials == params.materialCount);
+    CHECK(stats.vertices > 0 && stats.indices > 0);
+
+    uint32_t nodes = 0;
+    uint32_t maxDepth = 0;
+    int depth = 0;
+    for (SceneGraphWalker walker(sceneGraph->GetRootNode().get()); walker; )
+    {
+        ++nodes;
+        maxDepth = std::max(maxDepth, uint32_t(depth));
+        depth += walker.Next(true);
+    }
+    CHECK(nodes == params.nodeCount);
+    CHECK(maxDepth == params.maxDepth);
+
+    CHECK(sceneGraph->GetMeshInstances().size() == stats.meshInstances);
+    CHECK(sceneGraph->GetMeshes().size() == stats.meshes);
+    CHECK(sceneGraph->GetLights().size() == stats.lights);
+    CHECK(sceneGraph->GetAnimations().size() == 1);
+
+    for (const auto& mesh : sceneGraph->GetMeshes())
+    {
+        CHECK(mesh->geometries.size() == params.geometriesPerMesh);
+        CHECK(mesh->buffers && mesh->indexOffset + mesh->totalIndices <= mesh->buffers->indexData.size());
+        CHECK(mesh->vertexOffset + mesh->totalVertices <= mesh->buffers->positionData.size());
+    }
+
+    // The directional light points down into the scene
+    for (const auto& light : sceneGraph->GetLights())
+    {
+        if (light->GetLightType() == LightType_Directional)
+            CHECK(light->GetDirection().y < 0.0);
+    }
+}
+
+void test_determinism()
+{
+    SceneGeneratorParameters params = GetTestParameters();
+
+    SceneGenerator generator(nullptr);
+    std::shared_ptr<SceneGraph> first = generator.Generate(params);
+    std::shared_ptr<SceneGraph> second = generator.Generate(params);
+    params.seed++;
+    std::shared_ptr<SceneGraph> third = generator.Generate(params);
+
+    bool differentSeedDiffers = false;
+    SceneGraphWalker a(first->GetRootNode().get());
+    SceneGraphWalker b(second->GetRootNode().get());
+    SceneGraphWalker c(third->GetRootNode().get());
+    for (; a && b; a.Next(true), b.Next(true))
+    {
+        CHECK(all(a->GetTranslation() == b->GetTranslation()));
+        CHECK(all(a->GetRotation() == b->GetRotation()));
+        CHECK(bool(a->GetLeaf()) == bool(b->GetLeaf()));
+
+        if (c)
+        {
+            differentSeedDiffers |= any(a->GetTranslation() != c->GetTranslation());
+            c.Next(true);
+        }
+    }
+    CHECK(!a && !b);
+    CHECK(differentSeedDiffers);
+}
+
+void test_write_gltf()
+{
+    SceneGeneratorParameters params = GetTestParameters();
+    params.nodeCount = 100;
+
+    SceneGenerator generator(nullptr);
+    std::shared_ptr<SceneGraph> sceneGraph = generator.Generate(params);
+    const SceneGeneratorStats& stats = generator.GetStats();
+
+    vfs::NativeFileSystem fs;
+    const std::filesystem::path gltfFileName = std::filesystem::path(DONUT_TEST_BINARY_DIR) / "test_scene_generator.gltf";
+    const std::filesystem::path glbFileName = std::filesystem::path(DONUT_TEST_BINARY_DIR) / "test_scene_generator.glb";
+
+    CHECK(SceneGenerator::WriteGltf(*sceneGraph, fs, gltfFileName));
+    CHECK(SceneGenerator::WriteGltf(*sceneGraph, fs, glbFileName));
+
+    Json::Value root;
+    CHECK(json::LoadFromFile(fs, gltfFileName, root));
+    CHECK(root["asset"]["version"].asString() == "2.0");
+    CHECK(root["nodes"].size() == stats.nodes);
+    CHECK(root["meshes"].size() == stats.meshes);
+    CHECK(root["materials"].size() == stats.materials);
+    CHECK(root["extensions"]["KHR_lights_punctual"]["lights"].size() == stats.lights);
+    CHECK(root["animations"].size() == 1);
+    CHECK(root["animations"][0]["channels"].size() == stats.animatedNodes);
+    CHECK(root["animations"][0]["samplers"].size() == 1);
+
+    const std::filesystem::path binFileName = std::filesystem::path(gltfFileName).replace_extension(".bin");
+    CHECK(root["buffers"][0]["uri"].asString() == binFileName.filename().generic_string());
+    CHECK(std::filesystem::file_size(binFileName) == root["buffers"][0]["byteLength"].asUInt64());
+
+    std::shared_ptr<vfs::IBlob> glb = fs.readFile(glbFileName);
+    CHECK(glb && glb->size() > 28);
+    const uint32_t* header = static_cast<const uint32_t*>(glb->data());
+    CHECK(header[0] == 0x46546C67);
+    CHECK(header[1] == 2);
+    CHECK(header[2] == glb->size());
+    CHECK(header[4] == 0x4E4F534A);
+    CHECK(header[3] % 4 == 0);
+
+    Json::Value glbRoot;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    const char* jsonText = static_cast<const char*>(glb->data()) + 20;
+    CHECK(reader->parse(jsonText, jsonText + header[3], &glbRoot, nullptr));
+    CHECK(glbRoot["nodes"].size() == stats.nodes);
+    CHECK(!glbRoot["buffers"][0].isMember("uri"));
+
+    const uint32_t* binChunk = reinterpret_cast<const uint32_t*>(jsonText + header[3]);
+    CHECK(binChunk[1] == 0x004E4942);
+    CHECK(binChunk[0] == glbRoot["buffers"][0]["byteLength"].asUInt());
+}
+
+void test_gltf_round_trip()
+{
+    SceneGeneratorParameters params = GetTestParameters();
+    params.nodeCount = 100;
+
+    SceneGenerator generator(nullptr);
+    std::shared_ptr<SceneGraph> generated = generator.Generate(params);
+    const SceneGeneratorStats& stats = generator.GetStats();
+
+    auto device = tests::CreateNullDevice();
+    auto fs = std::make_shared<vfs::NativeFileSystem>();
+    auto sceneTypeFactory = std::make_shared<SceneTypeFactory>();
+    TextureCache textureCache(device, fs, nullptr);
+    GltfImporter importer(fs, sceneTypeFactory);
+
+    for (const char* extension : { ".gltf", ".glb" })
+    {
+        const std::filesystem::path fileName = std::filesystem::path(DONUT_TEST_BINARY_DIR) / (std::string("test_scene_generator_round_trip") + extension);
+        CHECK(SceneGenerator::WriteGltf(*generated, *fs, fileName));
+
+        SceneLoadingStats loadingStats;
+        SceneImportResult result;
+        CHECK(importer.Load(fileName, textureCache, loadingStats, nullptr, result));
+        CHECK(result.rootNode);
+
+        auto imported = std::make_shared<SceneGraph>();
+        imported->SetRootNode(result.rootNode);
+        imported->Refresh(0);
+
+        // The importer adds a root node named after the file, and a node for each animation
+        uint32_t nodes = 0;
+        uint32_t animationNodes = 0;
+        for (SceneGraphWalker walker(imported->GetRootNode().get()); walker; walker.Next(true))
+        {
+            ++nodes;
+            if (dynamic_cast<SceneGraphAnimation*>(walker->GetLeaf().get()))
+                ++animationNodes;
+        }
+        CHECK(animationNodes == 1);
+        CHECK(nodes == stats.nodes + 1 + animationNodes);
+
+        CHECK(imported->GetMeshInstances().size() == stats.meshInstances);
+        CHECK(imported->GetMeshes().size() == stats.meshes);
+        CHECK(imported->GetLights().size() == stats.lights);
+        CHECK(imported->GetAnimations().size() == 1);
+    }
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_generate();
+        test_determinism();
+        test_write_gltf();
+        test_gltf_round_trip();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/engine/UploadAllocator.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::tests;
+
+static UploadAllocator::CreateParameters GetParameters()
+{
+    UploadAllocator::CreateParameters params;
+    params.pageSize = 4096;
+    return params;
+}
+
+void test_page_selection()
+{
+    auto device = CreateNullDevice();
+    UploadAllocator allocator(device, GetParameters());
+    allocator.BeginFrame();
+
+    // Four allocations of 1000 bytes with 16 byte alignment end at 4024 and share the first page
+    std::vector<UploadAllocation> allocations;
+    for (int i = 0; i < 4; i++)
+        allocations.push_back(allocator.Allocate(1000));
+
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(allocations[i].IsValid());
+        CHECK(allocations[i].buffer == allocations[0].buffer);
+        CHECK(allocations[i].offset == uint64_t(i) * 1008);
+    }
+    CHECK(allocations[0].buffer->getDesc().byteSize == 4096);
+    CHECK(allocations[0].buffer->getDesc().cpuAccess == nvrhi::CpuAccessMode::Write);
+
+    // The fifth does not fit and starts a new page
+    UploadAllocation fifth = allocator.Allocate(1000);
+    CHECK(fifth.buffer != allocations[0].buffer);
+    CHECK(fifth.offset == 0);
+    CHECK(allocator.GetCurrentFrameStats().numPagesUsed == 2);
+
+    allocator.EndFrame();
+}
+
+void test_oversized_pages()
+{
+    auto device = CreateNullDevice();
+    UploadAllocator allocator(device, GetParameters());
+
+    allocator.BeginFrame();
+    UploadAllocation regular = allocator.Allocate(100);
+    UploadAllocation oversized = allocator.Allocate(10000);
+    CHECK(oversized.IsValid());
+    CHECK(oversized.buffer != regular.buffer);
+    CHECK(oversized.offset == 0);
+    CHECK(oversized.buffer->getDesc().byteSize == 65536);
+    CHECK(allocator.GetCurrentFrameStats().numOversizedAllocations == 1);
+    allocator.EndFrame();
+
+    CHECK(allocator.GetLastFrameStats().numPagesUsed == 2);
+    CHECK(allocator.GetLastFrameStats().numPagesTotal == 2);
+
+    // The dedicated page is released when the frame retires, the regular page is recycled
+    const uint64_t buffersCreated = device->GetStats().buffersCreated;
+    allocator.BeginFrame();
+    UploadAllocation next = allocator.Allocate(100);
+    CHECK(next.buffer->getDesc().byteSize == 4096);
+    allocator.EndFrame();
+
+    CHECK(device->GetStats().buffersCreated == buffersCreated);
+    CHECK(allocator.GetLastFrameStats().numPagesTotal == 1);
+    CHECK(allocator.GetLastFrameStats().numOversizedAllocations == 0);
+}
+
+void test_alignment()
+{
+    auto device = CreateNullDevice();
+    UploadAllocator allocator(device, GetParameters());
+    allocator.BeginFrame();
+
+    UploadAllocation a = allocator.Allocate(1, 16);
+    UploadAllocation b = allocator.Allocate(1, 256);
+    UploadAllocation c = allocator.Allocate(3, 4);
+    UploadAllocation d = allocator.Allocate(8, 1);
+
+    CHECK(a.offset == 0);
+    CHECK(b.offset == 256);
+    CHECK(c.offset == 260);
+    CHECK(d.offset == 263);
+
+    // The CPU addresses follow the offsets
+    CHECK(static_cast<uint8_t*>(b.cpuAddress) - static_cast<uint8_t*>(a.cpuAddress) == 256);
+    CHECK(static_cast<uint8_t*>(d.cpuAddress) - static_cast<uint8_t*>(a.cpuAddress) == 263);
+
+    // Padding counts as allocated
+    CHECK(allocator.GetCurrentFrameStats().bytesAllocated == 271);
+
+    // An aligned allocation that would cross the end of the page goes to a new page
+    UploadAllocation e = allocator.Allocate(3584, 256);
+    CHECK(e.buffer == a.buffer);
+    CHECK(e.offset == 256 * 2);
+    UploadAllocation f = allocator.Allocate(1, 256);
+    CHECK(f.buffer != a.buffer);
+    CHECK(f.offset == 0);
+
+    allocator.EndFrame();
+}
+
+void test_frame_stats()
+{
+    auto device = CreateNullDevice();
+    UploadAllocator allocator(device, GetParameters());
+
+    nvrhi::BufferHandle destBuffer = device->createBuffer(nvrhi::BufferDesc().setByteSize(1024));
+    uint8_t data[100] = {};
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+
+    allocator.BeginFrame();
+    CHECK(allocator.Write(destBuffer, data, 100));
+    CHECK(allocator.Write(destBuffer, data, 50, 200));
+    allocator.Allocate(20);
+    allocator.Flush(commandList);
+    CHECK(allocator.Write(destBuffer, data, 10, 500));
+    allocator.Flush(commandList);
+
+    const UploadAllocatorStats& current = allocator.GetCurrentFrameStats();
+    CHECK(current.numAllocations == 4);
+    CHECK(current.numCopies == 3);
+    CHECK(current.numFlushes == 2);
+    CHECK(current.bytesAllocated == 100 + (12 + 50) + (14 + 20) + (12 + 10));
+    allocator.EndFrame();
+
+    commandList->close();
+    device->executeCommandList(commandList);
+    CHECK(static_cast<NullCommandList*>(commandList.Get())->GetStats().copies == 3);
+
+    // The last frame keeps the totals, the current frame starts over
+    allocator.BeginFrame();
+    CHECK(allocator.GetCurrentFrameStats().numAllocations == 0);
+    CHECK(allocator.GetLastFrameStats().numCopies == 3);
+    CHECK(allocator.GetLastFrameStats().numPagesUsed == 1);
+    CHECK(allocator.GetLastFrameStats().numPagesTotal == 1);
+
+    allocator.Allocate(16);
+    allocator.EndFrame();
+    CHECK(allocator.GetLastFrameStats().bytesAllocated == 16);
+    CHECK(allocator.GetPeakBytesAllocated() == 218);
+
+    // A flush without writes is not counted
+    allocator.BeginFrame();
+    commandList->open();
+    allocator.Flush(commandList);
+    commandList->close();
+    allocator.EndFrame();
+    CHECK(allocator.GetLastFrameStats().numFlushes == 0);
+    CHECK(allocator.GetLastFrameStats().numPagesUsed == 0);
+}
+
+void test_page_reuse()
+{
+    auto device = CreateNullDevice();
+    UploadAllocator allocator(device, GetParameters());
+
+    allocator.BeginFrame();
+    UploadAllocation first = allocator.Allocate(3000);
+    UploadAllocation second = allocator.Allocate(3000);
+    CHECK(first.buffer != second.buffer);
+    allocator.EndFrame();
+
+    const uint64_t buffersCreated = device->GetStats().buffersCreated;
+
+    // Both pages are free again once the frame has retired, and they are handed out from the start
+    allocator.BeginFrame();
+    UploadAllocation reused = allocator.Allocate(3000);
+    CHECK(reused.offset == 0);
+    CHECK(reused.buffer == first.buffer || reused.buffer == second.buffer);
+    UploadAllocation reused2 = allocator.Allocate(3000);
+    CHECK(reused2.offset == 0);
+    CHECK(reused2.buffer != reused.buffer);
+    CHECK(reused2.buffer == first.buffer || reused2.buffer == second.buffer);
+    allocator.EndFrame();
+
+    CHECK(device->GetStats().buffersCreated == buffersCreated);
+    CHECK(allocator.GetLastFrameStats().numPagesTotal == 2);
+
+    // Clear() releases all pages
+    allocator.Clear();
+    allocator.BeginFrame();
+    allocator.Allocate(16);
+    allocator.EndFrame();
+    CHECK(device->GetStats().buffersCreated == buffersCreated + 1);
+    CHECK(allocator.GetLastFrameStats().numPagesTotal == 1);
+}
+
+void test_write_contents()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    auto device = CreateNullDevice(deviceDesc);
+    UploadAllocator allocator(device, GetParameters());
+
+    nvrhi::BufferHandle destBuffer = device->createBuffer(nvrhi::BufferDesc().setByteSize(256));
+    memset(GetNullBufferData(destBuffer), 0, 256);
+
+    std::vector<uint32_t> first = { 1, 2, 3, 4 };
+    std::vector<uint32_t> second = { 5, 6, 7 };
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+
+    allocator.BeginFrame();
+    CHECK(allocator.Write(destBuffer, first.data(), first.size() * sizeof(uint32_t), 64));
+    CHECK(allocator.Write(destBuffer, second.data(), second.size() * sizeof(uint32_t), 128));
+
+    // Nothing reaches the destination before the flush
+    CHECK(static_cast<NullCommandList*>(commandList.Get())->GetStats().copies == 0);
+    allocator.Flush(commandList);
+    allocator.EndFrame();
+
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    const uint32_t* contents = reinterpret_cast<const uint32_t*>(GetNullBufferData(destBuffer));
+    CHECK(contents[0] == 0);
+    CHECK(memcmp(contents + 16, first.data(), first.size() * sizeof(uint32_t)) == 0);
+    CHECK(contents[20] == 0);
+    CHECK(memcmp(contents + 32, second.data(), second.size() * sizeof(uint32_t)) == 0);
+
+    // Empty writes succeed without a copy
+    CHECK(allocator.Write(destBuffer, nullptr, 0));
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_page_selection();
+        test_oversized_pages();
+        test_alignment();
+        test_frame_stats();
+        test_page_reuse();
+        test_write_contents();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/SsaoPass.h>
+#include <donut/render/ToneMappingPasses.h>
+#include <donut/render/MipMapGenPass.h>
+#include <donut/engine/AsyncComputeScheduler.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+
+struct TestSetup
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    std::shared_ptr<ShaderFactory> shaderFactory;
+    std::shared_ptr<CommonRenderPasses> commonPasses;
+    nvrhi::CommandListHandle commandList;
+    PlanarView view;
+};
+
+static void CreateSetup(TestSetup& setup)
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.recordCommands = true;
+    setup.device = CreateNullDevice(deviceDesc);
+
+    setup.shaderFactory = std::make_shared<ShaderFactory>(setup.device, nullptr, "");
+    setup.commonPasses = std::make_shared<CommonRenderPasses>(setup.device, setup.shaderFactory);
+
+    setup.commandList = setup.device->createCommandList();
+    setup.commandList->open();
+
+    setup.view.SetViewport(nvrhi::Viewport(64.f, 64.f));
+    setup.view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    setup.view.UpdateCache();
+}
+
+// Textures that are rendered on the graphics queue and don't keep their initial states
+static nvrhi::TextureHandle CreateTexture(nvrhi::IDevice* device, nvrhi::Format format, bool isUAV, uint32_t mipLevels = 1)
+{
+    return device->createTexture(nvrhi::TextureDesc()
+        .setWidth(64)
+        .setHeight(64)
+        .setMipLevels(mipLevels)
+        .setFormat(format)
+        .setIsRenderTarget(!isUAV)
+        .setIsUAV(isUAV));
+}
+
+// Checks that the last job executed on the compute queue, after the graphics work, with the expected dispatches
+static void CheckAsyncJob(NullDevice* device, uint32_t expectedDispatches)
+{
+    const std::vector<NullQueueOperation> operations = device->GetQueueOperations();
+    CHECK(operations.size() >= 3);
+
+    const NullQueueOperation& submit = operations[operations.size() - 3];
+    const NullQueueOperation& wait = operations[operations.size() - 2];
+    const NullQueueOperation& execute = operations[operations.size() - 1];
+    CHECK(submit.type == NullQueueOperationType::Execute && submit.queue == nvrhi::CommandQueue::Graphics);
+    CHECK(wait.type == NullQueueOperationType::Wait && wait.instance == submit.instance);
+    CHECK(execute.type == NullQueueOperationType::Execute && execute.queue == nvrhi::CommandQueue::Compute);
+    CHECK(execute.dispatches == expectedDispatches);
+}
+
+void test_ssao()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    nvrhi::TextureHandle depth = CreateTexture(setup.device, nvrhi::Format::R32_FLOAT, false);
+    nvrhi::TextureHandle normals = CreateTexture(setup.device, nvrhi::Format::RGBA16_FLOAT, false);
+    nvrhi::TextureHandle occlusion = CreateTexture(setup.device, nvrhi::Format::R8_UNORM, true);
+
+    SsaoPass::CreateParameters ssaoParams;
+    ssaoParams.dimensions = int2(64);
+    SsaoPass ssaoPass(setup.device, setup.shaderFactory, setup.commonPasses, ssaoParams);
+    ssaoPass.CreateBindingSet(depth, normals, occlusion);
+
+    AsyncComputeScheduler scheduler(setup.device, true);
+
+    setup.commandList->beginTrackingTextureState(depth, nvrhi::AllSubresources, nvrhi::ResourceStates::RenderTarget);
+    AsyncComputeJob job = ssaoPass.ScheduleRender(scheduler, setup.commandList, SsaoParameters(), setup.view);
+    CHECK(job.IsAsync());
+
+    // Deinterleave, compute and blur
+    CheckAsyncJob(setup.device, 3);
+    CHECK(setup.device->GetQueueOperations().back().commandLists.size() == 1);
+
+    scheduler.WaitForCompute(setup.commandList, job);
+    CHECK(setup.commandList->getTextureSubresourceState(depth, 0, 0) == nvrhi::ResourceStates::ShaderResource);
+    CHECK(setup.commandList->getTextureSubresourceState(occlusion, 0, 0) == nvrhi::ResourceStates::UnorderedAccess);
+
+    // A depth buffer that keeps its depth write state, like the G-buffer one, cannot be handed over
+    nvrhi::TextureHandle gbufferDepth = setup.device->createTexture(nvrhi::TextureDesc()
+        .setWidth(64)
+        .setHeight(64)
+        .setFormat(nvrhi::Format::D32)
+        .setIsRenderTarget(true)
+        .setInitialState(nvrhi::ResourceStates::DepthWrite)
+        .setKeepInitialState(true));
+
+    ssaoPass.CreateBindingSet(gbufferDepth, normals, occlusion);
+    job = ssaoPass.ScheduleRender(scheduler, setup.commandList, SsaoParameters(), setup.view);
+    CHECK(!job.IsAsync());
+    CHECK(scheduler.GetStats().numRejectedJobs == 1);
+    CHECK(static_cast<NullCommandList*>(setup.commandList.Get())->GetStats().dispatches == 3);
+
+    setup.commandList->close();
+}
+
+void test_tone_mapping_exposure()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    nvrhi::TextureHandle hdrColor = CreateTexture(setup.device, nvrhi::Format::RGBA16_FLOAT, false);
+
+    auto framebufferFactory = std::make_shared<FramebufferFactory>(setup.device);
+    framebufferFactory->RenderTargets = { CreateTexture(setup.device, nvrhi::Format::RGBA8_UNORM, false) };
+
+    ToneMappingPass toneMappingPass(setup.device, setup.shaderFactory, setup.commonPasses, framebufferFactory,
+        setup.view, ToneMappingPass::CreateParameters());
+
+    AsyncComputeScheduler scheduler(setup.device, true);
+
+    ToneMappingParameters params;
+    AsyncComputeJob job = toneMappingPass.ScheduleExposureUpdate(scheduler, setup.commandList, params, setup.view, hdrColor);
+    CHECK(job.IsAsync());
+
+    // The histogram of the single viewport, and the exposure
+    CheckAsyncJob(setup.device, 2);
+
+    scheduler.WaitForCompute(setup.commandList, job);
+    CHECK(setup.commandList->getTextureSubresourceState(hdrColor, 0, 0) == nvrhi::ResourceStates::ShaderResource);
+    CHECK(scheduler.GetStats().numRejectedJobs == 0);
+
+    setup.commandList->close();
+}
+
+void test_mip_map_generation()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    nvrhi::TextureHandle texture = CreateTexture(setup.device, nvrhi::Format::R32_FLOAT, true, 7);
+    MipMapGenPass mipMapGenPass(setup.device, setup.shaderFactory, texture);
+
+    AsyncComputeScheduler scheduler(setup.device, true);
+
+    AsyncComputeJob job = mipMapGenPass.ScheduleDispatch(scheduler, setup.commandList);
+    CHECK(job.IsAsync());
+
+    // 6 mip levels are reduced in passes of 4
+    CheckAsyncJob(setup.device, 2);
+
+    scheduler.WaitForCompute(setup.commandList, job);
+    CHECK(setup.commandList->getTextureSubresourceState(texture, 0, 6) == nvrhi::ResourceStates::UnorderedAccess);
+
+    // Without a compute queue the pass dispatches on the graphics command list
+    scheduler.SetAsyncComputeEnabled(false);
+    job = mipMapGenPass.ScheduleDispatch(scheduler, setup.commandList);
+    CHECK(!job.IsAsync());
+    CHECK(static_cast<NullCommandList*>(setup.commandList.Get())->GetStats().dispatches == 2);
+
+    setup.commandList->close();
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_ssao();
+        test_tone_mapping_exposure();
+        test_mip_map_generation();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/CascadedShadowMap.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+
+static const float3 c_CameraPosition = float3(1000.f, 2.f, 1000.f);
+
+static std::shared_ptr<MeshInfo> CreateBoxMesh(const box3& bounds)
+{
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = std::make_shared<Material>();
+    geometry->objectSpaceBounds = bounds;
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->buffers = std::make_shared<BufferGroup>();
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = bounds;
+    return mesh;
+}
+
+static box3 AddBox(SceneGraph& sceneGraph, const box3& worldBounds)
+{
+    sceneGraph.AttachLeafNode(sceneGraph.GetRootNode(), std::make_shared<MeshInstance>(CreateBoxMesh(worldBounds)));
+    return worldBounds;
+}
+
+void test_fit_to_casters()
+{
+    auto device = CreateNullDevice();
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    sceneGraph->SetRootNode(std::make_shared<SceneGraphNode>());
+
+    // The scene is far from the origin, like in a large world rendered with a pre-view translation
+    const float3 offset = c_CameraPosition * float3(1.f, 0.f, 1.f);
+    const box3 ground = AddBox(*sceneGraph, box3(float3(-100.f, -1.f, -100.f) + offset, float3(100.f, 0.f, 100.f) + offset));
+    const box3 caster = AddBox(*sceneGraph, box3(float3(-1.f, 5.f, 6.f) + offset, float3(1.f, 6.f, 8.f) + offset));
+    const box3 farAway = AddBox(*sceneGraph, box3(float3(5000.f, 5.f, 5.f) + offset, float3(5001.f, 6.f, 6.f) + offset));
+    const box3 belowReceivers = AddBox(*sceneGraph, box3(float3(-1.f, -200.f, 6.f) + offset, float3(1.f, -199.f, 8.f) + offset));
+
+    auto sun = std::make_shared<DirectionalLight>();
+    sceneGraph->AttachLeafNode(sceneGraph->GetRootNode(), sun);
+    sun->SetDirection(normalize(double3(0.1, -1.0, 0.05)));
+
+    sceneGraph->Refresh(0);
+
+    // The camera looks along +Z, slightly down
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 256.f));
+    view.SetMatrices(translation(-c_CameraPosition) * rotation(float3(1.f, 0.f, 0.f), radians(-10.f)),
+        perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    view.UpdateCache();
+
+    // The pre-view translation only changes the texel snapping, so the results must not depend on it
+    const float3 preViewTranslations[] = { float3(0.f), -c_CameraPosition };
+
+    for (const float3& preViewTranslation : preViewTranslations)
+    {
+        CascadedShadowMap shadowMap(device, 1024, 4, 0, nvrhi::Format::D32);
+        shadowMap.SetupForPlanarView(*sun, view.GetViewFrustum(), 50.f, 10.f, 10.f, 4.f, preViewTranslation);
+
+        // Without fitting, everything is a potential caster
+        CHECK(shadowMap.IsPotentialCaster(0, farAway));
+
+        shadowMap.FitCascadesToCasters(*sceneGraph);
+
+        // The caster is above the receivers of the cascade that covers [3.1, 12.5] units from the camera
+        CHECK(shadowMap.IsPotentialCaster(2, caster));
+        CHECK(shadowMap.IsPotentialCaster(2, ground));
+
+        for (int cascade = 0; cascade < 4; cascade++)
+        {
+            CHECK(!shadowMap.IsPotentialCaster(cascade, farAway));
+            CHECK(!shadowMap.IsPotentialCaster(cascade, belowReceivers));
+        }
+    }
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_fit_to_casters();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
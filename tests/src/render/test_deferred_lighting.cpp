@@ -0,0 +1,281 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/DeferredLightingPass.h>
+#include <donut/render/LightClusteringPass.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+#include <map>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+#include <donut/shaders/deferred_lighting_cb.h>
+
+// Creates a distinct empty shader per lighting mode so that the tests can tell which pipeline was used
+class TestDeferredLightingPass : public DeferredLightingPass
+{
+public:
+    std::map<int, nvrhi::ShaderHandle> shaders;
+
+    TestDeferredLightingPass(nvrhi::IDevice* device, std::shared_ptr<CommonRenderPasses> commonPasses)
+        : DeferredLightingPass(device, std::move(commonPasses))
+        , m_Device(device)
+    { }
+
+    int GetLightingMode(nvrhi::IResource* pipeline) const
+    {
+        nvrhi::IShader* shader = static_cast<nvrhi::IComputePipeline*>(pipeline)->getDesc().CS;
+        for (const auto& [mode, modeShader] : shaders)
+        {
+            if (modeShader == shader)
+                return mode;
+        }
+        return -1;
+    }
+
+protected:
+    nvrhi::ShaderHandle CreateComputeShader(ShaderFactory& shaderFactory, int lightingMode) override
+    {
+        nvrhi::ShaderHandle shader = m_Device->createShader(nvrhi::ShaderDesc().setShaderType(nvrhi::ShaderType::Compute),
+            &lightingMode, sizeof(lightingMode));
+        shaders[lightingMode] = shader;
+        return shader;
+    }
+
+private:
+    nvrhi::IDevice* m_Device;
+};
+
+struct TestSetup
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    std::shared_ptr<ShaderFactory> shaderFactory;
+    std::shared_ptr<CommonRenderPasses> commonPasses;
+    std::unique_ptr<TestDeferredLightingPass> lightingPass;
+    std::vector<nvrhi::TextureHandle> textures;
+    DeferredLightingPass::Inputs inputs;
+    PlanarView view;
+};
+
+static void CreateSetup(TestSetup& setup)
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    deviceDesc.recordCommands = true;
+    setup.device = CreateNullDevice(deviceDesc);
+
+    setup.shaderFactory = std::make_shared<ShaderFactory>(setup.device, nullptr, "");
+    setup.commonPasses = std::make_shared<CommonRenderPasses>(setup.device, setup.shaderFactory);
+    setup.lightingPass = std::make_unique<TestDeferredLightingPass>(setup.device, setup.commonPasses);
+    setup.lightingPass->Init(setup.shaderFactory);
+
+    auto createTexture = [&setup](nvrhi::Format format, bool isUAV)
+    {
+        nvrhi::TextureDesc desc;
+        desc.width = 64;
+        desc.height = 64;
+        desc.format = format;
+        desc.isUAV = isUAV;
+        setup.textures.push_back(setup.device->createTexture(desc));
+        return setup.textures.back().Get();
+    };
+
+    setup.inputs.depth = createTexture(nvrhi::Format::D32, false);
+    setup.inputs.gbufferNormals = createTexture(nvrhi::Format::RGBA16_FLOAT, false);
+    setup.inputs.gbufferDiffuse = createTexture(nvrhi::Format::RGBA8_UNORM, false);
+    setup.inputs.gbufferSpecular = createTexture(nvrhi::Format::RGBA8_UNORM, false);
+    setup.inputs.gbufferEmissive = createTexture(nvrhi::Format::RGBA16_FLOAT, false);
+    setup.inputs.output = createTexture(nvrhi::Format::RGBA16_FLOAT, true);
+
+    setup.view.SetViewport(nvrhi::Viewport(64.f, 64.f));
+    setup.view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    setup.view.UpdateCache();
+}
+
+// Point lights that are told apart by their intensity, 1 to 'count'
+static std::vector<std::shared_ptr<Light>> CreateLights(int count)
+{
+    std::vector<std::shared_ptr<Light>> lights;
+    for (int index = 0; index < count; index++)
+    {
+        auto light = std::make_shared<PointLight>();
+        light->intensity = float(index + 1);
+        light->range = 1.f;
+        lights.push_back(light);
+    }
+    return lights;
+}
+
+struct RenderResult
+{
+    int lightingMode = -1;
+    uint32_t numLights = 0;
+    nvrhi::IBuffer* lightBuffer = nullptr; // written by the tiled mode only
+    uint64_t lightBytesWritten = 0;
+    uint64_t dispatchedGroups = 0;
+};
+
+static RenderResult Render(TestSetup& setup, const std::vector<std::shared_ptr<Light>>& lights, bool tiledLighting)
+{
+    setup.inputs.lights = &lights;
+    setup.inputs.tiledLighting = tiledLighting;
+
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    commandList->open();
+    setup.lightingPass->Render(commandList, setup.view, setup.inputs);
+    commandList->close();
+    setup.device->executeCommandList(commandList);
+
+    RenderResult result;
+    for (const NullCommand& command : static_cast<NullCommandList*>(commandList.Get())->GetCommands())
+    {
+        switch (command.type)
+        {
+        case NullCommandType::SetComputeState:
+            result.lightingMode = setup.lightingPass->GetLightingMode(command.resource);
+            break;
+        case NullCommandType::Dispatch:
+            result.dispatchedGroups += command.value;
+            break;
+        case NullCommandType::WriteBuffer: {
+            auto* buffer = static_cast<nvrhi::IBuffer*>(command.resource);
+            if (buffer->getDesc().isConstantBuffer)
+            {
+                const auto* constants = reinterpret_cast<const DeferredLightingConstants*>(GetNullBufferData(buffer));
+                result.numLights = constants->numLights;
+            }
+            else if (buffer->getDesc().structStride == sizeof(LightConstants))
+            {
+                result.lightBuffer = buffer;
+                result.lightBytesWritten = command.value;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return result;
+}
+
+void test_tiled_lights_beyond_constant_limit()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    const int numLights = DEFERRED_MAX_LIGHTS * 2 + 8;
+    const auto lights = CreateLights(numLights);
+
+    RenderResult result = Render(setup, lights, true);
+    CHECK(result.lightingMode == DEFERRED_LIGHTING_MODE_TILED);
+    CHECK(result.numLights == numLights);
+    CHECK(result.dispatchedGroups == (64 / DEFERRED_TILE_SIZE) * (64 / DEFERRED_TILE_SIZE));
+
+    // All lights are uploaded, in submission order, into a buffer with the initial capacity of 64
+    CHECK(result.lightBuffer);
+    CHECK(result.lightBytesWritten == numLights * sizeof(LightConstants));
+    CHECK(result.lightBuffer->getDesc().byteSize == 64 * sizeof(LightConstants));
+
+    const auto* lightData = reinterpret_cast<const LightConstants*>(GetNullBufferData(result.lightBuffer));
+    CHECK(lightData);
+    for (int index = 0; index < numLights; index++)
+        CHECK(lightData[index].intensity == float(index + 1));
+}
+
+void test_tiled_light_buffer_growth()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    const auto fewLights = CreateLights(40);
+    const auto manyLights = CreateLights(100);
+
+    RenderResult first = Render(setup, fewLights, true);
+    CHECK(first.lightBuffer->getDesc().byteSize == 64 * sizeof(LightConstants));
+
+    // Grows to the next power of two
+    RenderResult grown = Render(setup, manyLights, true);
+    CHECK(grown.numLights == 100);
+    CHECK(grown.lightBuffer != first.lightBuffer);
+    CHECK(grown.lightBuffer->getDesc().byteSize == 128 * sizeof(LightConstants));
+    CHECK(grown.lightBytesWritten == 100 * sizeof(LightConstants));
+
+    // Does not shrink, and creates no buffers or binding sets for fewer lights
+    const NullDeviceStats statsBefore = setup.device->GetStats();
+    RenderResult smaller = Render(setup, fewLights, true);
+    CHECK(smaller.numLights == 40);
+    CHECK(smaller.lightBuffer == grown.lightBuffer);
+    CHECK(setup.device->GetStats().buffersCreated == statsBefore.buffersCreated);
+    CHECK(setup.device->GetStats().bindingSetsCreated == statsBefore.bindingSetsCreated);
+}
+
+void test_lighting_mode_selection()
+{
+    TestSetup setup;
+    CreateSetup(setup);
+
+    const auto lights = CreateLights(DEFERRED_MAX_LIGHTS * 2 + 8);
+
+    // The constant buffer mode is limited to DEFERRED_MAX_LIGHTS and does not touch the light buffer
+    RenderResult constants = Render(setup, lights, false);
+    CHECK(constants.lightingMode == DEFERRED_LIGHTING_MODE_CONSTANTS);
+    CHECK(constants.numLights == DEFERRED_MAX_LIGHTS);
+    CHECK(constants.lightBuffer == nullptr);
+
+    // Light clusters take precedence over tiled lighting
+    LightClusteringPass::CreateParameters clusteringParams;
+    LightClusteringPass clusteringPass(setup.device, clusteringParams);
+
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    commandList->open();
+    CHECK(clusteringPass.Update(commandList, setup.view, lights));
+    commandList->close();
+    setup.device->executeCommandList(commandList);
+
+    setup.inputs.lightClusters = &clusteringPass;
+    RenderResult clustered = Render(setup, lights, true);
+    CHECK(clustered.lightingMode == DEFERRED_LIGHTING_MODE_CLUSTERED);
+    CHECK(clustered.lightBuffer == nullptr);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_tiled_lights_beyond_constant_limit();
+        test_tiled_light_buffer_growth();
+        test_lighting_mode_selection();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
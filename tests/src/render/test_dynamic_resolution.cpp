@@ -0,0 +1,185 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/DynamicResolution.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <cmath>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::render;
+using namespace donut::tests;
+
+static bool NearlyEqual(float a, float b)
+{
+    return std::abs(a - b) < 1e-4f;
+}
+
+static void AddSamples(DynamicResolutionController& controller, float frameTimeMs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        controller.AddSample(frameTimeMs);
+}
+
+void test_scale_adjustment()
+{
+    auto device = CreateNullDevice();
+
+    DynamicResolutionParameters params;
+    params.targetFrameTimeMs = 10.f;
+    params.headroom = 0.f;
+    params.maxScaleStep = 0.05f;
+    params.cooldownFrames = 4;
+    DynamicResolutionController controller(device, 2);
+    controller.SetParameters(params);
+    CHECK(controller.GetScale() == 1.f);
+
+    // Twice the budget: no change until the cooldown after construction has passed
+    AddSamples(controller, 20.f, 4);
+    CHECK(controller.GetScale() == 1.f);
+
+    // The ideal scale is sqrt(0.5), but one adjustment is limited to maxScaleStep
+    controller.AddSample(20.f);
+    CHECK(NearlyEqual(controller.GetScale(), 0.95f));
+
+    // Cooldown after the change
+    AddSamples(controller, 20.f, 4);
+    CHECK(NearlyEqual(controller.GetScale(), 0.95f));
+    controller.AddSample(20.f);
+    CHECK(NearlyEqual(controller.GetScale(), 0.90f));
+
+    // Small error without a step limit: the scale follows the square root of the time ratio
+    params.maxScaleStep = 1.f;
+    params.smoothing = 1.f;
+    controller.SetParameters(params);
+    controller.SetScale(0.8f);
+    AddSamples(controller, 12.5f, 5);
+    CHECK(NearlyEqual(controller.GetScale(), 0.8f * std::sqrt(0.8f)));
+    CHECK(NearlyEqual(controller.GetSmoothedFrameTimeMs(), 12.5f));
+    CHECK(NearlyEqual(controller.GetLastFrameTimeMs(), 12.5f));
+}
+
+void test_hysteresis()
+{
+    auto device = CreateNullDevice();
+
+    DynamicResolutionParameters params;
+    params.targetFrameTimeMs = 10.f;
+    params.headroom = 0.f;
+    params.deadBand = 0.05f;
+    params.smoothing = 1.f;
+    params.cooldownFrames = 0;
+    DynamicResolutionController controller(device, 2);
+    controller.SetParameters(params);
+    controller.SetScale(0.75f);
+
+    // Within the dead band on both sides of the target
+    AddSamples(controller, 10.4f, 10);
+    CHECK(controller.GetScale() == 0.75f);
+    AddSamples(controller, 9.6f, 10);
+    CHECK(controller.GetScale() == 0.75f);
+
+    // Just outside of it
+    controller.AddSample(11.f);
+    CHECK(controller.GetScale() < 0.75f);
+
+    // The smoothing averages out a single spike
+    controller.AddSample(10.f);
+    params.smoothing = 0.1f;
+    controller.SetParameters(params);
+    controller.SetScale(0.75f);
+    AddSamples(controller, 10.f, 10);
+    controller.AddSample(14.f);
+    CHECK(controller.GetScale() == 0.75f);
+    CHECK(NearlyEqual(controller.GetSmoothedFrameTimeMs(), 10.4f));
+
+    // Disabled controllers keep measuring but leave the scale alone
+    controller.SetEnabled(false);
+    AddSamples(controller, 40.f, 20);
+    CHECK(controller.GetScale() == 0.75f);
+    CHECK(NearlyEqual(controller.GetLastFrameTimeMs(), 40.f));
+}
+
+void test_clamping()
+{
+    auto device = CreateNullDevice();
+
+    DynamicResolutionParameters params;
+    params.targetFrameTimeMs = 10.f;
+    params.headroom = 0.f;
+    params.minScale = 0.5f;
+    params.maxScale = 0.9f;
+    params.smoothing = 1.f;
+    params.cooldownFrames = 0;
+    DynamicResolutionController controller(device, 2);
+    controller.SetParameters(params);
+
+    // The initial scale of 1 is brought into the range
+    CHECK(controller.GetScale() == 0.9f);
+
+    AddSamples(controller, 100.f, 100);
+    CHECK(controller.GetScale() == 0.5f);
+
+    AddSamples(controller, 1.f, 100);
+    CHECK(controller.GetScale() == 0.9f);
+
+    controller.SetScale(0.1f);
+    CHECK(controller.GetScale() == 0.5f);
+    controller.SetScale(2.f);
+    CHECK(controller.GetScale() == 0.9f);
+
+    // Invalid ranges are fixed up
+    params.minScale = 0.f;
+    params.maxScale = 2.f;
+    controller.SetParameters(params);
+    CHECK(controller.GetParameters().minScale > 0.f);
+    CHECK(controller.GetParameters().maxScale == 1.f);
+
+    params.minScale = 0.8f;
+    params.maxScale = 0.6f;
+    controller.SetParameters(params);
+    CHECK(controller.GetParameters().maxScale == 0.8f);
+    CHECK(controller.GetScale() == 0.8f);
+
+    uint2 renderSize = controller.GetRenderSize(uint2(1000, 500));
+    CHECK(renderSize.x == 800 && renderSize.y == 400);
+    renderSize = controller.GetRenderSize(uint2(1, 1));
+    CHECK(renderSize.x == 1 && renderSize.y == 1);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_scale_adjustment();
+        test_hysteresis();
+        test_clamping();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,272 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/DepthPass.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#ifdef DONUT_WITH_TASKFLOW
+#include <taskflow/taskflow.hpp>
+#endif
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+
+static const int c_VisibleInstances = 32;
+static const int c_HiddenInstances = 32;
+
+// Builds a scene with one triangle mesh instanced in front of and behind a camera at the origin that looks along +Z
+static std::shared_ptr<SceneGraph> CreateSceneGraph()
+{
+    auto material = std::make_shared<Material>();
+    material->name = "Material";
+
+    auto buffers = std::make_shared<BufferGroup>();
+    buffers->positionData = { float3(0.f, 0.f, 0.f), float3(0.5f, 0.f, 0.f), float3(0.f, 0.5f, 0.f) };
+    buffers->indexData = { 0, 1, 2 };
+
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = material;
+    geometry->numIndices = 3;
+    geometry->numVertices = 3;
+    geometry->objectSpaceBounds = box3(float3(0.f), float3(0.5f, 0.5f, 0.f));
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->buffers = buffers;
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+    mesh->totalIndices = 3;
+    mesh->totalVertices = 3;
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    for (int i = 0; i < c_VisibleInstances + c_HiddenInstances; i++)
+    {
+        const bool visible = i < c_VisibleInstances;
+        auto node = sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(mesh));
+        node->SetTranslation(double3(double(i % 8) - 4.0, double(i / 8 % 4) - 2.0, visible ? 10.0 : -10.0));
+    }
+
+    return sceneGraph;
+}
+
+void test_depth_pass_draws()
+{
+    auto device = CreateNullDevice();
+
+    auto shaderFactory = std::make_shared<ShaderFactory>(device, nullptr, "");
+    auto commonPasses = std::make_shared<CommonRenderPasses>(device, shaderFactory);
+
+    auto sceneGraph = CreateSceneGraph();
+    Scene scene(device, *shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    scene.SetSceneGraph(sceneGraph);
+    scene.FinishedLoading(0);
+
+    nvrhi::TextureDesc depthDesc;
+    depthDesc.width = 256;
+    depthDesc.height = 256;
+    depthDesc.format = nvrhi::Format::D32;
+    depthDesc.isRenderTarget = true;
+    FramebufferFactory framebufferFactory(device);
+    framebufferFactory.DepthTarget = device->createTexture(depthDesc);
+
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 256.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    view.UpdateCache();
+
+    DepthPass depthPass(device, commonPasses);
+    depthPass.Init(*shaderFactory, DepthPass::CreateParameters());
+    DepthPass::Context context;
+
+    auto renderFrame = [&](IDrawStrategy& drawStrategy)
+    {
+        nvrhi::CommandListHandle commandList = device->createCommandList();
+        commandList->open();
+        RenderCompositeView(commandList, &view, &view, framebufferFactory, sceneGraph->GetRootNode(), drawStrategy, depthPass, context);
+        commandList->close();
+        device->executeCommandList(commandList);
+        return static_cast<NullCommandList*>(commandList.Get())->GetStats();
+    };
+
+    // The instanced strategy culls the instances behind the camera and merges the rest into instanced draws
+    InstancedOpaqueDrawStrategy instancedStrategy;
+    NullCommandListStats culled = renderFrame(instancedStrategy);
+    CHECK(culled.instances == c_VisibleInstances);
+    CHECK(culled.draws >= 1 && culled.draws <= c_VisibleInstances);
+    CHECK(culled.primitiveVertices == c_VisibleInstances * 3);
+    CHECK(culled.pipelineChanges == 1);
+
+    // Moving the hidden instances in front of the camera makes them visible after a scene refresh
+    for (const auto& instance : sceneGraph->GetMeshInstances())
+    {
+        SceneGraphNode* node = instance->GetNode();
+        if (node->GetTranslation().z < 0.0)
+            node->SetTranslation(node->GetTranslation() * double3(1.0, 1.0, -1.0));
+    }
+
+    nvrhi::CommandListHandle refreshCommandList = device->createCommandList();
+    refreshCommandList->open();
+    scene.Refresh(refreshCommandList, 1);
+    refreshCommandList->close();
+    device->executeCommandList(refreshCommandList);
+
+    NullCommandListStats all = renderFrame(instancedStrategy);
+    CHECK(all.instances == c_VisibleInstances + c_HiddenInstances);
+
+    // Pipelines and binding sets are cached between frames
+    const NullDeviceStats before = device->GetStats();
+    renderFrame(instancedStrategy);
+    const NullDeviceStats after = device->GetStats();
+    CHECK(after.pipelinesCreated == before.pipelinesCreated);
+    CHECK(after.bindingSetsCreated == before.bindingSetsCreated);
+}
+
+// Builds a scene where many opaque materials share two depth pipelines: single-sided and double-sided
+static std::shared_ptr<SceneGraph> CreateMaterialSceneGraph(int numMaterials)
+{
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    for (int i = 0; i < numMaterials; i++)
+    {
+        auto material = std::make_shared<Material>();
+        material->name = "Material " + std::to_string(i);
+        material->doubleSided = (i % 4) == 0;
+
+        auto buffers = std::make_shared<BufferGroup>();
+        buffers->positionData = { float3(0.f, 0.f, 0.f), float3(0.5f, 0.f, 0.f), float3(0.f, 0.5f, 0.f) };
+        buffers->indexData = { 0, 1, 2 };
+
+        auto geometry = std::make_shared<MeshGeometry>();
+        geometry->material = material;
+        geometry->numIndices = 3;
+        geometry->numVertices = 3;
+        geometry->objectSpaceBounds = box3(float3(0.f), float3(0.5f, 0.5f, 0.f));
+
+        auto mesh = std::make_shared<MeshInfo>();
+        mesh->buffers = buffers;
+        mesh->geometries.push_back(geometry);
+        mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+        mesh->totalIndices = 3;
+        mesh->totalVertices = 3;
+
+        auto node = sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(mesh));
+        node->SetTranslation(double3(double(i % 8) - 4.0, 0.0, 10.0));
+    }
+
+    return sceneGraph;
+}
+
+void test_pipeline_precreation()
+{
+    auto device = CreateNullDevice();
+
+    auto shaderFactory = std::make_shared<ShaderFactory>(device, nullptr, "");
+    auto commonPasses = std::make_shared<CommonRenderPasses>(device, shaderFactory);
+
+    auto sceneGraph = CreateMaterialSceneGraph(16);
+    Scene scene(device, *shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    scene.SetSceneGraph(sceneGraph);
+    scene.FinishedLoading(0);
+    CHECK(sceneGraph->GetMaterials().size() == 16);
+
+    nvrhi::TextureDesc depthDesc;
+    depthDesc.width = 256;
+    depthDesc.height = 256;
+    depthDesc.format = nvrhi::Format::D32;
+    depthDesc.isRenderTarget = true;
+    FramebufferFactory framebufferFactory(device);
+    framebufferFactory.DepthTarget = device->createTexture(depthDesc);
+    nvrhi::IFramebuffer* framebuffer = framebufferFactory.GetFramebuffer(nvrhi::AllSubresources);
+
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 256.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    view.UpdateCache();
+
+    // The materials map to two pipeline keys, back-face culled and not culled; each is created once
+    const size_t uniqueKeys = 2;
+
+    DepthPass depthPass(device, commonPasses);
+    depthPass.Init(*shaderFactory, DepthPass::CreateParameters());
+
+    uint64_t pipelinesCreated = device->GetStats().pipelinesCreated;
+    CHECK(PrecreatePipelines(depthPass, &view, framebuffer, *sceneGraph) == uniqueKeys);
+    CHECK(device->GetStats().pipelinesCreated - pipelinesCreated == uniqueKeys);
+    CHECK(depthPass.GetPipelineCacheStats().precreated == uniqueKeys);
+
+    // Nothing left to create, neither by a second warm-up nor by rendering
+    pipelinesCreated = device->GetStats().pipelinesCreated;
+    CHECK(PrecreatePipelines(depthPass, &view, framebuffer, *sceneGraph) == 0);
+
+    InstancedOpaqueDrawStrategy drawStrategy;
+    DepthPass::Context context;
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    RenderCompositeView(commandList, &view, &view, framebufferFactory, sceneGraph->GetRootNode(), drawStrategy, depthPass, context);
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    CHECK(device->GetStats().pipelinesCreated == pipelinesCreated);
+    CHECK(depthPass.GetPipelineCacheStats().misses == 0);
+
+#ifdef DONUT_WITH_TASKFLOW
+    // The workers share the keys instead of compiling one pipeline per material
+    DepthPass parallelPass(device, commonPasses);
+    parallelPass.Init(*shaderFactory, DepthPass::CreateParameters());
+
+    tf::Executor executor(4);
+    pipelinesCreated = device->GetStats().pipelinesCreated;
+    CHECK(PrecreatePipelines(parallelPass, &view, framebuffer, *sceneGraph, executor) == uniqueKeys);
+    CHECK(device->GetStats().pipelinesCreated - pipelinesCreated == uniqueKeys);
+    CHECK(parallelPass.GetPipelineCacheStats().precreated == uniqueKeys);
+#endif
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_depth_pass_draws();
+        test_pipeline_precreation();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
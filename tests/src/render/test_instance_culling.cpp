@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/InstanceCullingPass.h>
+#include <donut/render/DepthPass.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+#include <donut/shaders/bindless.h>
+#include <donut/shaders/instance_culling_cb.h>
+
+static const int c_VisibleInstances = 24;
+static const int c_HiddenInstances = 39;
+
+static std::shared_ptr<MeshInfo> CreateTriangleMesh(const std::shared_ptr<Material>& material)
+{
+    auto buffers = std::make_shared<BufferGroup>();
+    buffers->positionData = { float3(0.f, 0.f, 0.f), float3(0.5f, 0.f, 0.f), float3(0.f, 0.5f, 0.f) };
+    buffers->indexData = { 0, 1, 2 };
+
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = material;
+    geometry->numIndices = 3;
+    geometry->numVertices = 3;
+    geometry->objectSpaceBounds = box3(float3(0.f), float3(0.5f, 0.5f, 0.f));
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->buffers = buffers;
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+    mesh->totalIndices = 3;
+    mesh->totalVertices = 3;
+    return mesh;
+}
+
+// Culls the uploaded draw records on the CPU the same way as instance_culling_cs.hlsl does without HiZ,
+// reading the transforms from the scene instance buffer. Returns the number of visible draws per bucket.
+static std::vector<uint32_t> CullDrawRecordsOnCpu(const InstanceCullingPass& pass, nvrhi::IBuffer* instanceBuffer, const IView& view)
+{
+    const CullingDrawRecord* records = reinterpret_cast<const CullingDrawRecord*>(GetNullBufferData(pass.GetDrawRecordBuffer()));
+    const InstanceData* instances = reinterpret_cast<const InstanceData*>(GetNullBufferData(instanceBuffer));
+    CHECK(records);
+    CHECK(instances);
+
+    frustum const viewFrustum = view.GetViewFrustum();
+    std::vector<uint32_t> counts(pass.GetBuckets().size(), 0);
+
+    for (uint32_t i = 0; i < pass.GetNumDrawRecords(); i++)
+    {
+        const CullingDrawRecord& record = records[i];
+        const float3x4& transform = instances[record.instanceIndex].transform;
+
+        float3 const localCenter = (record.boundsMin + record.boundsMax) * 0.5f;
+        float3 const localExtents = (record.boundsMax - record.boundsMin) * 0.5f;
+
+        float3 center;
+        float3 extents;
+        for (int row = 0; row < 3; row++)
+        {
+            center[row] = dot(transform[row].xyz(), localCenter) + transform[row].w;
+            extents[row] = dot(abs(transform[row].xyz()), localExtents);
+        }
+
+        bool visible = true;
+        if ((record.flags & DRAW_RECORD_FLAG_NEVER_CULL) == 0)
+        {
+            for (const plane& p : viewFrustum.planes)
+            {
+                if (dot(p.normal, center) - dot(abs(p.normal), extents) > p.distance)
+                    visible = false;
+            }
+        }
+
+        if (visible)
+            ++counts[record.bucketIndex];
+    }
+
+    return counts;
+}
+
+void test_instance_culling_setup()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    deviceDesc.recordCommands = true;
+    auto device = CreateNullDevice(deviceDesc);
+
+    auto shaderFactory = std::make_shared<ShaderFactory>(device, nullptr, "");
+    auto commonPasses = std::make_shared<CommonRenderPasses>(device, shaderFactory);
+
+    auto opaqueMaterial = std::make_shared<Material>();
+    auto doubleSidedMaterial = std::make_shared<Material>();
+    doubleSidedMaterial->doubleSided = true;
+    auto transparentMaterial = std::make_shared<Material>();
+    transparentMaterial->domain = MaterialDomain::Transmissive;
+
+    const std::shared_ptr<MeshInfo> meshes[] = {
+        CreateTriangleMesh(opaqueMaterial),
+        CreateTriangleMesh(doubleSidedMaterial),
+        CreateTriangleMesh(transparentMaterial)
+    };
+
+    // A camera at the origin looks along +Z, the hidden instances are behind it
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    for (int i = 0; i < c_VisibleInstances + c_HiddenInstances; i++)
+    {
+        const bool visible = i < c_VisibleInstances;
+        auto node = sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(meshes[i % 3]));
+        node->SetTranslation(double3(double(i % 8) - 4.0, double(i / 8 % 4) - 2.0, visible ? 10.0 : -10.0));
+    }
+
+    Scene scene(device, *shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    scene.SetSceneGraph(sceneGraph);
+    scene.FinishedLoading(0);
+
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 256.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    view.UpdateCache();
+
+    InstanceCullingPass cullingPass(device, *shaderFactory, commonPasses);
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    cullingPass.UpdateDrawRecords(commandList, *sceneGraph);
+
+    // Transparent geometry is skipped, the two other materials get one bucket each
+    const int numOpaqueRecords = (c_VisibleInstances + c_HiddenInstances) * 2 / 3;
+    CHECK(cullingPass.GetNumDrawRecords() == uint32_t(numOpaqueRecords));
+    CHECK(cullingPass.GetBuckets().size() == 2);
+
+    uint32_t nextDraw = 0;
+    for (const InstanceCullingPass::DrawBucket& bucket : cullingPass.GetBuckets())
+    {
+        CHECK(bucket.firstDraw == nextDraw);
+        CHECK(bucket.cullMode == (bucket.material == doubleSidedMaterial.get() ? nvrhi::RasterCullMode::None : nvrhi::RasterCullMode::Back));
+        nextDraw += bucket.numDraws;
+    }
+    CHECK(nextDraw == cullingPass.GetNumDrawRecords());
+
+    const CullingDrawRecord* records = reinterpret_cast<const CullingDrawRecord*>(GetNullBufferData(cullingPass.GetDrawRecordBuffer()));
+    CHECK(records);
+    for (uint32_t i = 0; i < cullingPass.GetNumDrawRecords(); i++)
+    {
+        const InstanceCullingPass::DrawBucket& bucket = cullingPass.GetBuckets()[records[i].bucketIndex];
+        CHECK(records[i].firstDrawInBucket == bucket.firstDraw);
+        CHECK(i >= bucket.firstDraw && i < bucket.firstDraw + bucket.numDraws);
+        CHECK(records[i].indexCount == 3);
+    }
+
+    CHECK(cullingPass.GetDrawArgumentBuffer()->getDesc().isDrawIndirectArgs);
+    CHECK(cullingPass.GetDrawArgumentBuffer()->getDesc().byteSize == numOpaqueRecords * sizeof(nvrhi::DrawIndexedIndirectArguments));
+    CHECK(cullingPass.GetDrawCountBuffer()->getDesc().byteSize == cullingPass.GetBuckets().size() * sizeof(uint32_t));
+
+    // Culling clears the argument and count buffers and dispatches one thread per record
+    cullingPass.Cull(commandList, view, scene.GetInstanceBuffer());
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    const std::vector<NullCommand>& commands = static_cast<NullCommandList*>(commandList.Get())->GetCommands();
+    int clears = 0;
+    uint64_t dispatchedGroups = 0;
+    for (const NullCommand& command : commands)
+    {
+        if (command.type == NullCommandType::ClearBuffer)
+            ++clears;
+        if (command.type == NullCommandType::Dispatch)
+            dispatchedGroups += command.value;
+    }
+    CHECK(clears == 2);
+    CHECK(dispatchedGroups == uint64_t(div_ceil(numOpaqueRecords, INSTANCE_CULLING_GROUP_SIZE)));
+
+    // The culling shader's view of the uploaded data must agree with the CPU draw strategy
+    std::vector<uint32_t> visibleDraws = CullDrawRecordsOnCpu(cullingPass, scene.GetInstanceBuffer(), view);
+    uint32_t totalVisibleDraws = 0;
+    for (uint32_t count : visibleDraws)
+        totalVisibleDraws += count;
+
+    nvrhi::TextureDesc depthDesc;
+    depthDesc.width = 256;
+    depthDesc.height = 256;
+    depthDesc.format = nvrhi::Format::D32;
+    depthDesc.isRenderTarget = true;
+    FramebufferFactory framebufferFactory(device);
+    framebufferFactory.DepthTarget = device->createTexture(depthDesc);
+
+    DepthPass::CreateParameters depthParams;
+    depthParams.useInputAssembler = true;
+    DepthPass depthPass(device, commonPasses);
+    depthPass.Init(*shaderFactory, depthParams);
+    DepthPass::Context context;
+
+    commandList = device->createCommandList();
+    commandList->open();
+    InstancedOpaqueDrawStrategy drawStrategy;
+    RenderCompositeView(commandList, &view, &view, framebufferFactory, sceneGraph->GetRootNode(), drawStrategy, depthPass, context);
+    commandList->close();
+    const NullCommandListStats cpuStats = static_cast<NullCommandList*>(commandList.Get())->GetStats();
+    CHECK(cpuStats.instances == totalVisibleDraws);
+    CHECK(totalVisibleDraws == uint32_t(c_VisibleInstances * 2 / 3));
+
+    // RenderView issues one indirect draw per bucket, covering all the bucket's argument slots
+    commandList = device->createCommandList();
+    commandList->open();
+    cullingPass.RenderView(commandList, &view, &view, framebufferFactory.GetFramebuffer(view), depthPass, context);
+    commandList->close();
+    const NullCommandListStats gpuStats = static_cast<NullCommandList*>(commandList.Get())->GetStats();
+    CHECK(gpuStats.indirectDraws == cullingPass.GetNumDrawRecords());
+    CHECK(gpuStats.graphicsStateChanges == cullingPass.GetBuckets().size());
+    CHECK(gpuStats.draws == 0);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_instance_culling_setup();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
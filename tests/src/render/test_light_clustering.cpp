@@ -0,0 +1,162 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/LightClusteringPass.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+#include <algorithm>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+#include <donut/shaders/light_cb.h>
+#include <donut/shaders/light_clusters_cb.h>
+
+static std::vector<uint32_t> GetClustersOfLight(const LightCluster* clusters, const uint32_t* lightIndices, uint32_t numClusters, uint32_t lightIndex)
+{
+    std::vector<uint32_t> result;
+    for (uint32_t clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+    {
+        const LightCluster& cluster = clusters[clusterIndex];
+        if (std::find(lightIndices + cluster.offset, lightIndices + cluster.offset + cluster.count, lightIndex) != lightIndices + cluster.offset + cluster.count)
+            result.push_back(clusterIndex);
+    }
+    return result;
+}
+
+void test_light_assignment()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    auto device = CreateNullDevice(deviceDesc);
+
+    // 256x128 pixels with 64 pixel tiles make a 4x2 tile grid.
+    // With zNear = 1, zFar = 256 and 8 slices, every slice ends at twice the depth of the previous one:
+    // slice 0 is [0, 2], slice 1 is [2, 4], slice 3 is [8, 16], slice 5 is [32, 64], slice 7 is [128, inf).
+    LightClusteringPass::CreateParameters params;
+    params.tileSize = 64;
+    params.numDepthSlices = 8;
+    params.zNear = 1.f;
+    params.zFar = 256.f;
+    LightClusteringPass clusteringPass(device, params);
+
+    // The camera is at the origin and looks along +Z, so world space is view space
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 128.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 2.f, 0.1f));
+    view.UpdateCache();
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    auto sun = std::make_shared<DirectionalLight>();
+    sceneGraph->AttachLeafNode(root, sun);
+
+    // On the view axis, overlaps the four center tiles in slice 1
+    auto centerLight = std::make_shared<PointLight>();
+    centerLight->range = 0.5f;
+    sceneGraph->AttachLeafNode(root, centerLight)->SetTranslation(double3(0.0, 0.0, 3.0));
+
+    // In the middle of the top right tile, in slice 3. At z = 12, the view is 27.7 units wide and 13.9 units high.
+    auto cornerLight = std::make_shared<PointLight>();
+    cornerLight->range = 0.5f;
+    sceneGraph->AttachLeafNode(root, cornerLight)->SetTranslation(double3(0.75 * 13.856, 0.5 * 6.928, 12.0));
+
+    // Spot lights are bounded by their range sphere, on the view axis in slice 5
+    auto spotLight = std::make_shared<SpotLight>();
+    spotLight->range = 1.f;
+    sceneGraph->AttachLeafNode(root, spotLight)->SetTranslation(double3(0.0, 0.0, 40.0));
+
+    // Behind the camera, not assigned to any cluster
+    auto hiddenLight = std::make_shared<PointLight>();
+    hiddenLight->range = 1.f;
+    sceneGraph->AttachLeafNode(root, hiddenLight)->SetTranslation(double3(0.0, 0.0, -10.0));
+
+    sceneGraph->Refresh(0);
+
+    const std::vector<std::shared_ptr<Light>> lights = { centerLight, sun, cornerLight, spotLight, hiddenLight };
+
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    CHECK(clusteringPass.Update(commandList, view, lights));
+    commandList->close();
+    device->executeCommandList(commandList);
+
+    CHECK(all(clusteringPass.GetGridSize() == uint3(4, 2, 8)));
+    CHECK(clusteringPass.GetNumLights() == 5);
+    CHECK(clusteringPass.GetNumGlobalLights() == 1);
+    CHECK(clusteringPass.GetNumLightIndices() == 4 + 1 + 4);
+
+    nvrhi::BindingSetDesc setDesc;
+    clusteringPass.AddBindingSetItems(setDesc, 0, 0);
+    CHECK(setDesc.bindings.size() == 5);
+
+    const LightConstants* lightData = reinterpret_cast<const LightConstants*>(GetNullBufferData(static_cast<nvrhi::IBuffer*>(setDesc.bindings[1].resourceHandle)));
+    const LightCluster* clusters = reinterpret_cast<const LightCluster*>(GetNullBufferData(static_cast<nvrhi::IBuffer*>(setDesc.bindings[3].resourceHandle)));
+    const uint32_t* lightIndices = reinterpret_cast<const uint32_t*>(GetNullBufferData(static_cast<nvrhi::IBuffer*>(setDesc.bindings[4].resourceHandle)));
+    CHECK(lightData);
+    CHECK(clusters);
+    CHECK(lightIndices);
+
+    // Global lights go first, the local lights follow in submission order
+    CHECK(lightData[0].lightType == LightType_Directional);
+    CHECK(lightData[1].lightType == LightType_Point);
+    CHECK(lightData[3].lightType == LightType_Spot);
+
+    // Cluster index = (slice * gridHeight + tileY) * gridWidth + tileX
+    uint32_t const numClusters = 4 * 2 * 8;
+    CHECK(GetClustersOfLight(clusters, lightIndices, numClusters, 1) == std::vector<uint32_t>({ 9, 10, 13, 14 }));
+    CHECK(GetClustersOfLight(clusters, lightIndices, numClusters, 2) == std::vector<uint32_t>({ 27 }));
+    CHECK(GetClustersOfLight(clusters, lightIndices, numClusters, 3) == std::vector<uint32_t>({ 41, 42, 45, 46 }));
+    CHECK(GetClustersOfLight(clusters, lightIndices, numClusters, 4).empty());
+
+    // The global light is never stored in the clusters
+    CHECK(GetClustersOfLight(clusters, lightIndices, numClusters, 0).empty());
+
+    // Cluster ranges are contiguous
+    uint32_t offset = 0;
+    for (uint32_t clusterIndex = 0; clusterIndex < numClusters; clusterIndex++)
+    {
+        CHECK(clusters[clusterIndex].offset == offset);
+        offset += clusters[clusterIndex].count;
+    }
+    CHECK(offset == clusteringPass.GetNumLightIndices());
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_light_assignment();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,296 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/DepthPass.h>
+#include <donut/render/DrawStrategy.h>
+#include <donut/render/GeometryPasses.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/FramebufferFactory.h>
+#include <donut/engine/Scene.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#ifdef DONUT_WITH_TASKFLOW
+#include <taskflow/taskflow.hpp>
+#endif
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+
+#ifdef DONUT_WITH_TASKFLOW
+
+// Instances in front of a camera at the origin looking along +Z, and behind it
+static const int c_FrontInstances = 8;
+static const int c_BackInstances = 24;
+
+static std::shared_ptr<SceneGraph> CreateSceneGraph()
+{
+    auto material = std::make_shared<Material>();
+    material->name = "Material";
+
+    auto buffers = std::make_shared<BufferGroup>();
+    buffers->positionData = { float3(0.f, 0.f, 0.f), float3(0.5f, 0.f, 0.f), float3(0.f, 0.5f, 0.f) };
+    buffers->indexData = { 0, 1, 2 };
+
+    auto geometry = std::make_shared<MeshGeometry>();
+    geometry->material = material;
+    geometry->numIndices = 3;
+    geometry->numVertices = 3;
+    geometry->objectSpaceBounds = box3(float3(0.f), float3(0.5f, 0.5f, 0.f));
+
+    auto mesh = std::make_shared<MeshInfo>();
+    mesh->buffers = buffers;
+    mesh->geometries.push_back(geometry);
+    mesh->objectSpaceBounds = geometry->objectSpaceBounds;
+    mesh->totalIndices = 3;
+    mesh->totalVertices = 3;
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    for (int i = 0; i < c_FrontInstances + c_BackInstances; i++)
+    {
+        const bool front = i < c_FrontInstances;
+        auto node = sceneGraph->AttachLeafNode(root, std::make_shared<MeshInstance>(mesh));
+        node->SetTranslation(double3(double(i % 8) - 4.0, double(i / 8 % 4) - 2.0, front ? 10.0 : -10.0));
+    }
+
+    return sceneGraph;
+}
+
+struct TestSetup
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    std::shared_ptr<ShaderFactory> shaderFactory;
+    std::shared_ptr<CommonRenderPasses> commonPasses;
+    std::shared_ptr<SceneGraph> sceneGraph;
+    std::unique_ptr<Scene> scene;
+    std::unique_ptr<FramebufferFactory> framebufferFactory;
+    std::unique_ptr<DepthPass> depthPass;
+
+    // View 0 looks at the front instances, view 1 at the back instances
+    CompositeView compositeView;
+};
+
+static void CreateSetup(TestSetup& setup, nvrhi::GraphicsAPI graphicsAPI)
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.graphicsAPI = graphicsAPI;
+    deviceDesc.recordCommands = true;
+    setup.device = CreateNullDevice(deviceDesc);
+
+    setup.shaderFactory = std::make_shared<ShaderFactory>(setup.device, nullptr, "");
+    setup.commonPasses = std::make_shared<CommonRenderPasses>(setup.device, setup.shaderFactory);
+
+    setup.sceneGraph = CreateSceneGraph();
+    setup.scene = std::make_unique<Scene>(setup.device, *setup.shaderFactory, nullptr, nullptr, nullptr, nullptr);
+    setup.scene->SetSceneGraph(setup.sceneGraph);
+    setup.scene->FinishedLoading(0);
+
+    nvrhi::TextureDesc depthDesc;
+    depthDesc.width = 256;
+    depthDesc.height = 256;
+    depthDesc.format = nvrhi::Format::D32;
+    depthDesc.isRenderTarget = true;
+    setup.framebufferFactory = std::make_unique<FramebufferFactory>(setup.device);
+    setup.framebufferFactory->DepthTarget = setup.device->createTexture(depthDesc);
+
+    setup.depthPass = std::make_unique<DepthPass>(setup.device, setup.commonPasses);
+    setup.depthPass->Init(*setup.shaderFactory, DepthPass::CreateParameters());
+
+    for (int viewIndex = 0; viewIndex < 2; viewIndex++)
+    {
+        auto view = std::make_shared<PlanarView>();
+        view->SetViewport(nvrhi::Viewport(256.f, 256.f));
+        const affine3 viewMatrix = viewIndex == 0 ? affine3::identity() : rotation(float3(0.f, 1.f, 0.f), PI_f);
+        view->SetMatrices(viewMatrix, perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+        view->UpdateCache();
+        setup.compositeView.AddView(view);
+    }
+}
+
+static ParallelGeometryRenderer::DrawStrategyFactory GetDrawStrategyFactory()
+{
+    return []() { return std::make_unique<InstancedOpaqueDrawStrategy>(); };
+}
+
+static ParallelGeometryRenderer::PassContextFactory GetPassContextFactory()
+{
+    return [](nvrhi::ICommandList*) { return std::make_unique<DepthPass::Context>(); };
+}
+
+// Renders the composite view with the serial RenderCompositeView and returns the stats of the command list
+static NullCommandListStats RenderSerial(TestSetup& setup)
+{
+    InstancedOpaqueDrawStrategy drawStrategy;
+    DepthPass::Context context;
+
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    commandList->open();
+    render::RenderCompositeView(commandList, &setup.compositeView, &setup.compositeView, *setup.framebufferFactory,
+        setup.sceneGraph->GetRootNode(), drawStrategy, *setup.depthPass, context);
+    commandList->close();
+    setup.device->executeCommandList(commandList);
+    return static_cast<NullCommandList*>(commandList.Get())->GetStats();
+}
+
+// Renders the composite view with the parallel renderer after some work in the caller's command list,
+// and returns the command lists of the renderer's submission in order
+static std::vector<NullCommandList*> RenderParallel(TestSetup& setup, ParallelGeometryRenderer& renderer, nvrhi::ICommandList* commandList)
+{
+    commandList->open();
+    commandList->clearDepthStencilTexture(setup.framebufferFactory->DepthTarget, nvrhi::AllSubresources, true, 0.f, false, 0);
+
+    const size_t firstOperation = setup.device->GetQueueOperations().size();
+    renderer.RenderCompositeView(commandList, &setup.compositeView, &setup.compositeView, *setup.framebufferFactory,
+        setup.sceneGraph->GetRootNode(), GetDrawStrategyFactory(), *setup.depthPass, GetPassContextFactory());
+    commandList->close();
+
+    std::vector<NullCommandList*> submitted;
+    std::vector<NullQueueOperation> operations = setup.device->GetQueueOperations();
+    for (size_t index = firstOperation; index < operations.size(); index++)
+    {
+        for (nvrhi::ICommandList* executed : operations[index].commandLists)
+            submitted.push_back(static_cast<NullCommandList*>(executed));
+    }
+    return submitted;
+}
+
+void test_per_view_command_lists()
+{
+    TestSetup setup;
+    CreateSetup(setup, nvrhi::GraphicsAPI::VULKAN);
+
+    const NullCommandListStats serial = RenderSerial(setup);
+    CHECK(serial.instances == c_FrontInstances + c_BackInstances);
+
+    tf::Executor executor(4);
+    ParallelGeometryRenderer renderer(setup.device, executor);
+
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    std::vector<NullCommandList*> submitted = RenderParallel(setup, renderer, commandList);
+
+    // The caller's work goes first, then one command list per view in view order
+    CHECK(submitted.size() == 3);
+    CHECK(submitted[0] == commandList.Get());
+    CHECK(submitted[1]->GetStats().instances == c_FrontInstances);
+    CHECK(submitted[2]->GetStats().instances == c_BackInstances);
+
+    // Same draws as the serial path
+    NullCommandListStats parallel;
+    parallel.Accumulate(submitted[1]->GetStats());
+    parallel.Accumulate(submitted[2]->GetStats());
+    CHECK(parallel.draws == serial.draws);
+    CHECK(parallel.instances == serial.instances);
+    CHECK(parallel.primitiveVertices == serial.primitiveVertices);
+
+    // The caller's command list was reopened after the submission and nothing was drawn into it
+    CHECK(submitted[0]->GetStats().clears == 0);
+    CHECK(submitted[0]->GetStats().draws == 0);
+}
+
+void test_draw_list_chunks()
+{
+    TestSetup setup;
+    CreateSetup(setup, nvrhi::GraphicsAPI::VULKAN);
+
+    const NullCommandListStats serial = RenderSerial(setup);
+
+    tf::Executor executor(4);
+    ParallelGeometryRenderer renderer(setup.device, executor);
+    renderer.SetMaxDrawItemsPerCommandList(5);
+
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    std::vector<NullCommandList*> submitted = RenderParallel(setup, renderer, commandList);
+
+    // Each instance is one draw item: 8 items make 2 chunks for view 0, 24 items make 5 chunks for view 1
+    const size_t frontChunks = (c_FrontInstances + 4) / 5;
+    const size_t backChunks = (c_BackInstances + 4) / 5;
+    CHECK(submitted.size() == 1 + frontChunks + backChunks);
+    CHECK(submitted[0] == commandList.Get());
+
+    NullCommandListStats parallel;
+    uint64_t frontInstances = 0;
+    for (size_t index = 1; index < submitted.size(); index++)
+    {
+        const NullCommandListStats& stats = submitted[index]->GetStats();
+        CHECK(stats.instances >= 1 && stats.instances <= 5);
+        if (index <= frontChunks)
+            frontInstances += stats.instances;
+        parallel.Accumulate(stats);
+    }
+
+    // The chunks of view 0 come first, and together they draw the same instances as the serial path
+    CHECK(frontInstances == c_FrontInstances);
+    CHECK(parallel.instances == serial.instances);
+    CHECK(parallel.primitiveVertices == serial.primitiveVertices);
+
+    // The command lists are reused on the next frame
+    const uint64_t executedBefore = setup.device->GetStats().commandListsExecuted;
+    std::vector<NullCommandList*> nextFrame = RenderParallel(setup, renderer, commandList);
+    CHECK(nextFrame == submitted);
+    CHECK(setup.device->GetStats().commandListsExecuted - executedBefore == submitted.size());
+}
+
+void test_d3d11_fallback()
+{
+    TestSetup setup;
+    CreateSetup(setup, nvrhi::GraphicsAPI::D3D11);
+
+    tf::Executor executor(4);
+    ParallelGeometryRenderer renderer(setup.device, executor);
+
+    // Without deferred command lists, everything is recorded into the caller's command list
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    std::vector<NullCommandList*> submitted = RenderParallel(setup, renderer, commandList);
+    CHECK(submitted.empty());
+
+    const NullCommandListStats& stats = static_cast<NullCommandList*>(commandList.Get())->GetStats();
+    CHECK(stats.instances == c_FrontInstances + c_BackInstances);
+}
+
+#endif // DONUT_WITH_TASKFLOW
+
+int main(int, char**)
+{
+    try
+    {
+#ifdef DONUT_WITH_TASKFLOW
+        test_per_view_command_lists();
+        test_draw_list_chunks();
+        test_d3d11_fallback();
+#endif
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/PixelReadbackPass.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+
+struct TestSetup
+{
+    nvrhi::RefCountPtr<NullDevice> device;
+    nvrhi::TextureHandle texture;
+    std::unique_ptr<PixelReadbackPass> pass;
+};
+
+static void CreateSetup(TestSetup& setup, uint32_t numReadbackBuffers, uint32_t maxPixelsPerBatch)
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.storeBufferContents = true;
+    deviceDesc.recordCommands = true;
+    setup.device = CreateNullDevice(deviceDesc);
+
+    nvrhi::TextureDesc textureDesc;
+    textureDesc.width = 64;
+    textureDesc.height = 64;
+    textureDesc.format = nvrhi::Format::RGBA32_UINT;
+    setup.texture = setup.device->createTexture(textureDesc);
+
+    auto shaderFactory = std::make_shared<ShaderFactory>(setup.device, nullptr, "");
+    setup.pass = std::make_unique<PixelReadbackPass>(setup.device, shaderFactory, setup.texture,
+        nvrhi::Format::RGBA32_UINT, 0, 0, numReadbackBuffers, maxPixelsPerBatch);
+}
+
+struct SubmittedBatch
+{
+    uint32_t dispatches = 0;
+    nvrhi::IBuffer* readbackBuffer = nullptr;
+    uint64_t copiedBytes = 0;
+    std::vector<uint2> positions;
+};
+
+// Calls Submit and does the work of the shader: every texel read back is (x, y, x * y, 1)
+static SubmittedBatch Submit(TestSetup& setup)
+{
+    nvrhi::CommandListHandle commandList = setup.device->createCommandList();
+    commandList->open();
+    setup.pass->Submit(commandList);
+    commandList->close();
+    setup.device->executeCommandList(commandList);
+
+    SubmittedBatch batch;
+    for (const NullCommand& command : static_cast<NullCommandList*>(commandList.Get())->GetCommands())
+    {
+        auto* buffer = static_cast<nvrhi::IBuffer*>(command.resource);
+        switch (command.type)
+        {
+        case NullCommandType::Dispatch:
+            batch.dispatches++;
+            break;
+        case NullCommandType::WriteBuffer:
+            if (buffer->getDesc().format == nvrhi::Format::RG32_UINT)
+            {
+                batch.positions.resize(command.value / sizeof(uint2));
+                memcpy(batch.positions.data(), GetNullBufferData(buffer), command.value);
+            }
+            break;
+        case NullCommandType::CopyBuffer:
+            batch.readbackBuffer = buffer;
+            batch.copiedBytes = command.value;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (batch.readbackBuffer)
+    {
+        auto* texels = reinterpret_cast<uint4*>(GetNullBufferData(batch.readbackBuffer));
+        for (size_t index = 0; index < batch.positions.size(); index++)
+        {
+            const uint2 position = batch.positions[index];
+            texels[index] = uint4(position.x, position.y, position.x * position.y, 1);
+        }
+    }
+
+    return batch;
+}
+
+static bool CheckResult(const PixelReadbackResult& result, uint2 origin, uint2 size)
+{
+    if (any(result.origin != origin) || any(result.size != size) || result.values.size() != size.x * size.y)
+        return false;
+
+    for (uint32_t y = 0; y < size.y; y++)
+    {
+        for (uint32_t x = 0; x < size.x; x++)
+        {
+            const uint2 position = origin + uint2(x, y);
+            if (any(result.GetUInts(y * size.x + x) != uint4(position.x, position.y, position.x * position.y, 1)))
+                return false;
+        }
+    }
+    return true;
+}
+
+void test_batched_requests()
+{
+    TestSetup setup;
+    CreateSetup(setup, 2, 16);
+
+    std::vector<int> completionOrder;
+    std::vector<PixelReadbackResult> results(3);
+    auto makeCallback = [&](int index)
+    {
+        return [&completionOrder, &results, index](const PixelReadbackResult& result)
+        {
+            completionOrder.push_back(index);
+            results[index] = result;
+        };
+    };
+
+    setup.pass->Request(uint2(1, 2), uint2(1), makeCallback(0));
+    setup.pass->Request(uint2(4, 4), uint2(2, 2), makeCallback(1));
+    std::future<PixelReadbackResult> future = setup.pass->Request(uint2(30, 7), uint2(3, 1));
+    setup.pass->Request(uint2(10, 3), uint2(3, 1), makeCallback(2));
+    CHECK(setup.pass->GetNumPendingRequests() == 4);
+
+    // One dispatch and one copy for all requests, with the pixels in request order
+    SubmittedBatch batch = Submit(setup);
+    CHECK(batch.dispatches == 1);
+    CHECK(batch.readbackBuffer);
+    CHECK(batch.copiedBytes == 11 * sizeof(uint4));
+    CHECK(batch.positions.size() == 11);
+    CHECK(all(batch.positions[0] == uint2(1, 2)));
+    CHECK(all(batch.positions[1] == uint2(4, 4)));
+    CHECK(all(batch.positions[2] == uint2(5, 4)));
+    CHECK(all(batch.positions[3] == uint2(4, 5)));
+    CHECK(all(batch.positions[5] == uint2(30, 7)));
+    CHECK(all(batch.positions[10] == uint2(12, 3)));
+
+    // Nothing completes before Poll
+    CHECK(completionOrder.empty());
+    CHECK(future.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    CHECK(setup.pass->GetNumPendingRequests() == 4);
+
+    setup.pass->Poll();
+
+    CHECK(completionOrder == std::vector<int>({ 0, 1, 2 }));
+    CHECK(CheckResult(results[0], uint2(1, 2), uint2(1)));
+    CHECK(CheckResult(results[1], uint2(4, 4), uint2(2, 2)));
+    CHECK(CheckResult(results[2], uint2(10, 3), uint2(3, 1)));
+
+    CHECK(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    CHECK(CheckResult(future.get(), uint2(30, 7), uint2(3, 1)));
+    CHECK(setup.pass->GetNumPendingRequests() == 0);
+
+    // Nothing to submit
+    CHECK(Submit(setup).dispatches == 0);
+}
+
+void test_readback_slot_ring()
+{
+    TestSetup setup;
+    CreateSetup(setup, 2, 4);
+
+    std::vector<uint2> completed;
+    for (uint32_t index = 0; index < 10; index++)
+    {
+        setup.pass->Request(uint2(index, 0), uint2(1), [&completed](const PixelReadbackResult& result)
+        {
+            CHECK(result.IsValid());
+            completed.push_back(result.origin);
+        });
+    }
+
+    // Each batch takes at most 4 pixels, and uses its own readback buffer
+    SubmittedBatch first = Submit(setup);
+    SubmittedBatch second = Submit(setup);
+    CHECK(first.positions.size() == 4);
+    CHECK(second.positions.size() == 4);
+    CHECK(first.readbackBuffer != second.readbackBuffer);
+
+    // Both readback buffers are in flight, the remaining requests stay queued
+    SubmittedBatch blocked = Submit(setup);
+    CHECK(blocked.dispatches == 0);
+    CHECK(setup.pass->GetNumPendingRequests() == 10);
+
+    // Poll releases the buffers, which are then reused
+    setup.pass->Poll();
+    CHECK(completed.size() == 8);
+    CHECK(setup.pass->GetNumPendingRequests() == 2);
+
+    SubmittedBatch third = Submit(setup);
+    CHECK(third.dispatches == 1);
+    CHECK(third.positions.size() == 2);
+    CHECK(third.readbackBuffer == first.readbackBuffer || third.readbackBuffer == second.readbackBuffer);
+
+    setup.pass->Poll(true);
+    CHECK(completed.size() == 10);
+    for (uint32_t index = 0; index < 10; index++)
+        CHECK(all(completed[index] == uint2(index, 0)));
+}
+
+void test_oversized_request()
+{
+    TestSetup setup;
+    CreateSetup(setup, 2, 4);
+
+    // Fails immediately, without a submission
+    std::future<PixelReadbackResult> future = setup.pass->Request(uint2(0, 0), uint2(3, 2));
+    CHECK(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+
+    PixelReadbackResult result = future.get();
+    CHECK(!result.IsValid());
+    CHECK(all(result.size == uint2(3, 2)));
+    CHECK(setup.pass->GetNumPendingRequests() == 0);
+    CHECK(Submit(setup).dispatches == 0);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_batched_requests();
+        test_readback_slot_ring();
+        test_oversized_request();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
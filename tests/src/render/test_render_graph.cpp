@@ -0,0 +1,289 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/RenderGraph.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace donut;
+using namespace donut::render;
+using namespace donut::tests;
+
+// 256 KB with the null device, which is a multiple of its 64 KB placement alignment
+static nvrhi::TextureDesc GetTransientDesc(const char* name)
+{
+    return nvrhi::TextureDesc()
+        .setWidth(256)
+        .setHeight(256)
+        .setFormat(nvrhi::Format::RGBA8_UNORM)
+        .setIsRenderTarget(true)
+        .setDebugName(name);
+}
+
+static nvrhi::TextureHandle CreateOutput(nvrhi::IDevice* device)
+{
+    return device->createTexture(GetTransientDesc("Output"));
+}
+
+static RenderGraph::ExecuteFunc Record(std::vector<std::string>& executed, const char* name)
+{
+    return [&executed, name](nvrhi::ICommandList*, const RenderGraph&) { executed.push_back(name); };
+}
+
+void test_culling()
+{
+    auto device = CreateNullDevice();
+    nvrhi::TextureHandle outputTexture = CreateOutput(device);
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+
+    RenderGraph graph(device);
+    std::vector<std::string> executed;
+
+    RenderGraphTexture output = graph.ImportTexture(outputTexture, "Output");
+    RenderGraphTexture x, y, unused;
+
+    // Writes X, which is only read by a pass without outputs, and Y, which reaches the output
+    graph.AddPass("Producer", [&](RenderGraphBuilder& builder)
+    {
+        x = builder.CreateTexture(GetTransientDesc("X"));
+        y = builder.CreateTexture(GetTransientDesc("Y"));
+        builder.Write(x);
+        builder.Write(y);
+    }, Record(executed, "Producer"));
+
+    graph.AddPass("ReadsX", [&](RenderGraphBuilder& builder)
+    {
+        builder.Read(x);
+    }, Record(executed, "ReadsX"));
+
+    graph.AddPass("Unused", [&](RenderGraphBuilder& builder)
+    {
+        unused = builder.CreateTexture(GetTransientDesc("Unused"));
+        builder.Read(y);
+        builder.Write(unused);
+    }, Record(executed, "Unused"));
+
+    graph.AddPass("SideEffects", [&](RenderGraphBuilder& builder)
+    {
+        builder.SetSideEffects();
+    }, Record(executed, "SideEffects"));
+
+    graph.AddPass("Output", [&](RenderGraphBuilder& builder)
+    {
+        builder.Read(y);
+        builder.Write(output);
+    }, Record(executed, "Output"));
+
+    CHECK(graph.Compile());
+
+    // X is unreferenced once ReadsX is culled, which must release the producer only once:
+    // the producer still writes Y for the output pass
+    const RenderGraphStats& stats = graph.GetStats();
+    CHECK(stats.numPasses == 5);
+    CHECK(stats.numCulledPasses == 2);
+
+    commandList->open();
+    graph.Execute(commandList);
+    commandList->close();
+
+    CHECK(executed == std::vector<std::string>({ "Producer", "SideEffects", "Output" }));
+
+    // Only the textures used by live passes are allocated
+    CHECK(graph.GetTexture(x) && graph.GetTexture(y));
+    CHECK(!graph.GetTexture(unused));
+    CHECK(graph.GetTexture(output) == outputTexture);
+}
+
+struct ChainGraph
+{
+    RenderGraphTexture transients[3];
+    RenderGraphTexture output;
+};
+
+// Pass i writes transient i and reads transient i - 1, so the lifetimes are [0, 1], [1, 2] and [2, 3]
+static ChainGraph BuildChain(RenderGraph& graph, nvrhi::ITexture* outputTexture, bool clearMiddle)
+{
+    ChainGraph chain;
+    graph.Reset();
+    chain.output = graph.ImportTexture(outputTexture, "Output", nvrhi::ResourceStates::ShaderResource);
+
+    for (int i = 0; i < 3; i++)
+    {
+        graph.AddPass("Chain", [&chain, i, clearMiddle](RenderGraphBuilder& builder)
+        {
+            nvrhi::TextureDesc desc = GetTransientDesc("Transient");
+            if (i == 1 && clearMiddle)
+                desc.setClearValue(nvrhi::Color(1.f));
+
+            chain.transients[i] = builder.CreateTexture(desc);
+            builder.Write(chain.transients[i]);
+            if (i > 0)
+                builder.Read(chain.transients[i - 1]);
+        }, nullptr);
+    }
+
+    graph.AddPass("Output", [&chain](RenderGraphBuilder& builder)
+    {
+        builder.Read(chain.transients[2]);
+        builder.Write(chain.output);
+    }, nullptr);
+
+    return chain;
+}
+
+static std::set<nvrhi::IResource*> GetClearedTextures(nvrhi::ICommandList* commandList)
+{
+    std::set<nvrhi::IResource*> cleared;
+    for (const NullCommand& command : static_cast<NullCommandList*>(commandList)->GetCommands())
+    {
+        if (command.type == NullCommandType::ClearTexture)
+            cleared.insert(command.resource);
+    }
+    return cleared;
+}
+
+void test_lifetimes_and_aliasing()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.recordCommands = true;
+    auto device = CreateNullDevice(deviceDesc);
+    nvrhi::TextureHandle outputTexture = CreateOutput(device);
+
+    RenderGraph graph(device);
+    ChainGraph chain = BuildChain(graph, outputTexture, false);
+    CHECK(graph.Compile());
+
+    // The first and the last transients do not overlap in time and share memory
+    const uint64_t textureSize = 256 * 256 * 4;
+    const RenderGraphStats& stats = graph.GetStats();
+    CHECK(stats.numTransientTextures == 3);
+    CHECK(stats.numAllocatedTextures == 3);
+    CHECK(stats.transientMemoryRequired == 3 * textureSize);
+    CHECK(stats.transientMemoryAllocated == 2 * textureSize);
+    CHECK(stats.numAliasedTextures == 2);
+
+    nvrhi::ITexture* first = graph.GetTexture(chain.transients[0]);
+    nvrhi::ITexture* middle = graph.GetTexture(chain.transients[1]);
+    nvrhi::ITexture* last = graph.GetTexture(chain.transients[2]);
+    CHECK(first && middle && last);
+    CHECK(first != last && first != middle && middle != last);
+    CHECK(first->getDesc().isVirtual);
+
+    // The aliased textures are cleared at their first use even without a clear value
+    nvrhi::CommandListHandle commandList = device->createCommandList();
+    commandList->open();
+    graph.Execute(commandList);
+    commandList->close();
+
+    std::set<nvrhi::IResource*> cleared = GetClearedTextures(commandList);
+    CHECK(cleared.size() == 2);
+    CHECK(cleared.count(first) && cleared.count(last));
+
+    // The same graph next frame reuses the placement and the textures
+    const uint64_t texturesCreated = device->GetStats().texturesCreated;
+    chain = BuildChain(graph, outputTexture, false);
+    CHECK(graph.Compile());
+    CHECK(device->GetStats().texturesCreated == texturesCreated);
+    CHECK(graph.GetTexture(chain.transients[0]) == first);
+    CHECK(graph.GetTexture(chain.transients[2]) == last);
+    CHECK(graph.GetStats().numAliasedTextures == 2);
+
+    // A texture with a clear value is cleared even if its memory is not aliased
+    chain = BuildChain(graph, outputTexture, true);
+    CHECK(graph.Compile());
+    commandList = device->createCommandList();
+    commandList->open();
+    graph.Execute(commandList);
+    commandList->close();
+
+    cleared = GetClearedTextures(commandList);
+    CHECK(cleared.size() == 3);
+    CHECK(cleared.count(graph.GetTexture(chain.transients[1])));
+
+    // Without aliasing, the transients with identical descs get separate pooled textures
+    graph.SetAliasingEnabled(false);
+    chain = BuildChain(graph, outputTexture, false);
+    CHECK(graph.Compile());
+    CHECK(graph.GetStats().numAllocatedTextures == 3);
+    CHECK(graph.GetStats().numAliasedTextures == 0);
+    CHECK(graph.GetStats().transientMemoryRequired == 3 * textureSize);
+    CHECK(!graph.GetTexture(chain.transients[0])->getDesc().isVirtual);
+
+    commandList = device->createCommandList();
+    commandList->open();
+    graph.Execute(commandList);
+    commandList->close();
+    CHECK(GetClearedTextures(commandList).empty());
+}
+
+void test_pooled_textures()
+{
+    NullDeviceDesc deviceDesc;
+    deviceDesc.virtualResources = false;
+    auto device = CreateNullDevice(deviceDesc);
+    nvrhi::TextureHandle outputTexture = CreateOutput(device);
+
+    // Without placed resources, the first and the last transients share one pooled texture
+    RenderGraph graph(device);
+    ChainGraph chain = BuildChain(graph, outputTexture, false);
+    CHECK(graph.Compile());
+
+    const uint64_t textureSize = 256 * 256 * 4;
+    const RenderGraphStats& stats = graph.GetStats();
+    CHECK(stats.numTransientTextures == 3);
+    CHECK(stats.numAllocatedTextures == 2);
+    CHECK(stats.transientMemoryRequired == 3 * textureSize);
+    CHECK(stats.transientMemoryAllocated == 0);
+
+    nvrhi::ITexture* first = graph.GetTexture(chain.transients[0]);
+    CHECK(first && first == graph.GetTexture(chain.transients[2]));
+    CHECK(first != graph.GetTexture(chain.transients[1]));
+    CHECK(!first->getDesc().isVirtual);
+
+    // The same graph next frame reuses the pool
+    const uint64_t texturesCreated = device->GetStats().texturesCreated;
+    chain = BuildChain(graph, outputTexture, false);
+    CHECK(graph.Compile());
+    CHECK(device->GetStats().texturesCreated == texturesCreated);
+    CHECK(graph.GetTexture(chain.transients[0]) == first);
+    CHECK(graph.GetStats().transientMemoryRequired == 3 * textureSize);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_culling();
+        test_lifetimes_and_aliasing();
+        test_pooled_textures();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
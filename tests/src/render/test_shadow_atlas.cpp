@@ -0,0 +1,182 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <donut/render/ShadowAtlas.h>
+#include <donut/render/PlanarShadowMap.h>
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+#include <donut/tests/NullDevice.h>
+#include <donut/tests/utils.h>
+
+using namespace donut;
+using namespace donut::math;
+using namespace donut::engine;
+using namespace donut::render;
+using namespace donut::tests;
+#include <donut/shaders/light_cb.h>
+
+static float2 ProjectToUV(const IShadowMap& shadowMap, float3 worldPos)
+{
+    float4 uvzw = float4(worldPos, 1.f) * shadowMap.GetWorldToUvzwMatrix();
+    return uvzw.xy() / uvzw.w;
+}
+
+static bool NearlyEqual(float2 a, float2 b)
+{
+    return all(abs(a - b) < 1e-4f);
+}
+
+static nvrhi::TextureHandle CreateShadowTexture(nvrhi::IDevice* device, int resolution)
+{
+    nvrhi::TextureDesc desc;
+    desc.width = resolution;
+    desc.height = resolution;
+    desc.format = nvrhi::Format::D32;
+    desc.isRenderTarget = true;
+    desc.dimension = nvrhi::TextureDimension::Texture2DArray;
+    return device->createTexture(desc);
+}
+
+void test_planar_shadow_map_tile()
+{
+    auto device = CreateNullDevice();
+    nvrhi::TextureHandle texture = CreateShadowTexture(device, 1024);
+
+    // A 256x256 tile in the middle of the texture
+    PlanarShadowMap shadowMap(device, texture, 0, nvrhi::Viewport(256.f, 512.f, 512.f, 768.f, 0.f, 1.f));
+
+    const float3 position = float3(1.f, 2.f, 3.f);
+    const float3 direction = float3(0.f, 0.f, 1.f);
+    shadowMap.SetupPerspectiveLightView(position, direction, radians(90.f), 0.1f, 100.f);
+
+    // Points on the light axis project into the center of the tile, not of the texture
+    const float2 tileCenter = float2(384.f, 640.f) / 1024.f;
+    CHECK(NearlyEqual(ProjectToUV(shadowMap, position + direction * 10.f), tileCenter));
+    CHECK(NearlyEqual(ProjectToUV(shadowMap, position + direction * 50.f), tileCenter));
+    CHECK(shadowMap.GetUVRange().contains(tileCenter));
+
+    ShadowConstants constants;
+    shadowMap.FillShadowConstants(constants);
+    CHECK(NearlyEqual(constants.shadowMapCenterUV, tileCenter));
+
+    // With a 90 degree field of view, a point 45 degrees off the axis is on the edge of the tile
+    const float2 edgeUV = ProjectToUV(shadowMap, position + float3(10.f, 0.f, 10.f));
+    CHECK(NearlyEqual(edgeUV, float2(256.f, 640.f) / 1024.f) || NearlyEqual(edgeUV, float2(512.f, 640.f) / 1024.f));
+
+    // A shadow map that covers the whole texture keeps the plain clip to UV mapping
+    PlanarShadowMap fullShadowMap(device, texture, 0, nvrhi::Viewport(1024.f, 1024.f));
+    fullShadowMap.SetupPerspectiveLightView(position, direction, radians(90.f), 0.1f, 100.f);
+    CHECK(NearlyEqual(ProjectToUV(fullShadowMap, position + direction * 10.f), float2(0.5f)));
+}
+
+void test_atlas_lookups()
+{
+    auto device = CreateNullDevice();
+    auto shaderFactory = std::make_shared<ShaderFactory>(device, nullptr, "");
+    auto commonPasses = std::make_shared<CommonRenderPasses>(device, shaderFactory);
+
+    ShadowAtlas::CreateParameters params;
+    params.resolution = 1024;
+    params.minTileSize = 64;
+    params.maxTileSize = 256;
+    ShadowAtlas atlas(device, commonPasses, params);
+
+    auto sceneGraph = std::make_shared<SceneGraph>();
+    auto root = std::make_shared<SceneGraphNode>();
+    sceneGraph->SetRootNode(root);
+
+    auto spotLight = std::make_shared<SpotLight>();
+    spotLight->range = 10.f;
+    spotLight->outerAngle = 60.f;
+    sceneGraph->AttachLeafNode(root, spotLight)->SetTranslation(double3(-2.0, 0.0, 10.0));
+
+    auto pointLight = std::make_shared<PointLight>();
+    pointLight->range = 5.f;
+    sceneGraph->AttachLeafNode(root, pointLight)->SetTranslation(double3(2.0, 0.0, 10.0));
+
+    sceneGraph->Refresh(0);
+
+    PlanarView view;
+    view.SetViewport(nvrhi::Viewport(256.f, 256.f));
+    view.SetMatrices(affine3::identity(), perspProjD3DStyleReverse(radians(60.f), 1.f, 0.1f));
+    view.UpdateCache();
+
+    atlas.Update(view, *sceneGraph, { spotLight, pointLight });
+
+    auto spotShadow = std::dynamic_pointer_cast<AtlasShadowMap>(spotLight->shadowMap);
+    auto pointShadow = std::dynamic_pointer_cast<AtlasShadowMap>(pointLight->shadowMap);
+    CHECK(spotShadow);
+    CHECK(pointShadow);
+    CHECK(spotShadow->GetNumberOfFaces() == 1);
+    CHECK(pointShadow->GetNumberOfFaces() == 6);
+    CHECK(pointShadow->GetNumberOfCascades() == 4);
+    CHECK(pointShadow->GetNumberOfPerObjectShadows() == 2);
+
+    // Every face's axis projects into the center of its own tile
+    auto checkFace = [](const PlanarShadowMap& face, float3 position, float3 direction)
+    {
+        const box2 uvRange = face.GetUVRange();
+        const float2 uv = ProjectToUV(face, position + direction * 2.f);
+        CHECK(uvRange.contains(uv));
+        CHECK(NearlyEqual(uv, uvRange.center()));
+    };
+
+    checkFace(*spotShadow->GetFace(0), float3(spotLight->GetPosition()), float3(spotLight->GetDirection()));
+    CHECK(NearlyEqual(ProjectToUV(*spotShadow, float3(spotLight->GetPosition() + spotLight->GetDirection())), spotShadow->GetUVRange().center()));
+
+    static const float3 faceDirections[6] = {
+        float3(1.f, 0.f, 0.f), float3(-1.f, 0.f, 0.f),
+        float3(0.f, 1.f, 0.f), float3(0.f, -1.f, 0.f),
+        float3(0.f, 0.f, 1.f), float3(0.f, 0.f, -1.f)
+    };
+
+    for (uint32_t face = 0; face < 6; face++)
+        checkFace(*pointShadow->GetFace(face), float3(pointLight->GetPosition()), faceDirections[face]);
+
+    // The tiles don't overlap, so at most one of them starts at the texture origin
+    int tilesAtOrigin = 0;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        if (all(pointShadow->GetFace(face)->GetUVRange().m_mins < float2(0.01f)))
+            ++tilesAtOrigin;
+    }
+    if (all(spotShadow->GetUVRange().m_mins < float2(0.01f)))
+        ++tilesAtOrigin;
+    CHECK(tilesAtOrigin <= 1);
+}
+
+int main(int, char**)
+{
+    try
+    {
+        test_planar_shadow_map_tile();
+        test_atlas_lookups();
+    }
+    catch (const std::runtime_error& err)
+    {
+        fprintf(stderr, "%s", err.what());
+        return 1;
+    }
+    return 0;
+}
@@ -28,7 +28,7 @@ foreach(test_src ${donut_engine_tests})
     #message(STATUS "Added test ${test_name}")
 
     add_executable("${test_name}" "${test_src}")
-    target_link_libraries("${test_name}" donut_engine donut_core donut_tests_utils)
+    target_link_libraries("${test_name}" donut_engine donut_core donut_tests_utils donut_tests_null_device)
 
     add_dependencies(donut_all_tests "${test_name}")
 